@@ -0,0 +1,134 @@
+/*
+ * Benchmark of message logging. Counts log lines per second written to a
+ * file the way centrald wrote them before - std::endl after every line -
+ * and through AsyncLog from one and four threads. Also measures debug
+ * LogStream messages of an application without debugging enabled, which
+ * are no longer formatted.
+ * Run it with ./bench_asynclog [messages].
+ */
+
+#include "app.h"
+#include "asynclog.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+class BenchApp:public rts2core::App
+{
+	public:
+		BenchApp (int argc, char **argv):rts2core::App (argc, argv) {}
+
+		virtual int run () { return 0; }
+};
+
+static double usecNow ()
+{
+	struct timeval tv;
+	gettimeofday (&tv, NULL);
+	return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+struct producerArg
+{
+	rts2core::AsyncLog *alog;
+	int messages;
+};
+
+static void *producer (void *arg)
+{
+	producerArg *pa = (producerArg *) arg;
+	rts2core::Message msg ("C0", MESSAGE_DEBUG, "C0 serial port data: 0x41 0x42 0x43 0x0d 0x0a");
+	for (int i = 0; i < pa->messages; i++)
+		pa->alog->log (msg);
+	return NULL;
+}
+
+static void benchAsync (const char *logname, int messages, int threads)
+{
+	// ring large enough to hold all messages, so producers measure only queuing cost
+	rts2core::AsyncLog *alog = new rts2core::AsyncLog (messages);
+	alog->open (logname);
+	alog->start ();
+
+	pthread_t *th = new pthread_t[threads];
+	producerArg pa;
+	pa.alog = alog;
+	pa.messages = messages / threads;
+
+	double t0 = usecNow ();
+	for (int i = 0; i < threads; i++)
+		pthread_create (th + i, NULL, producer, &pa);
+	for (int i = 0; i < threads; i++)
+		pthread_join (th[i], NULL);
+	double tq = usecNow () - t0;
+	delete[] th;
+	unsigned long dropped = alog->getDropped ();
+	// destructor writes queued messages
+	delete alog;
+	double t = usecNow () - t0;
+
+	printf ("AsyncLog, %d thread(s): %.0f lines/s queued, %.0f lines/s written, %lu dropped\n", threads, 1e6 * messages / tq, 1e6 * (messages - dropped) / t, dropped);
+}
+
+int main (int argc, char **argv)
+{
+	int messages = argc > 1 ? atoi (argv[1]) : 200000;
+
+	BenchApp app (0, NULL);
+
+	char logname[50];
+	strcpy (logname, "/tmp/bench_asynclog_XXXXXX");
+	int fd = mkstemp (logname);
+	if (fd < 0)
+	{
+		perror ("mkstemp");
+		return 1;
+	}
+	close (fd);
+
+	rts2core::Message msg ("C0", MESSAGE_DEBUG, "C0 serial port data: 0x41 0x42 0x43 0x0d 0x0a");
+
+	std::ofstream ofs (logname, std::ios_base::out | std::ios_base::app);
+	double t0 = usecNow ();
+	for (int i = 0; i < messages; i++)
+		ofs << msg << std::endl;
+	double t = usecNow () - t0;
+	ofs.close ();
+	printf ("std::endl per line: %.0f lines/s\n", 1e6 * messages / t);
+
+	benchAsync (logname, messages, 1);
+	benchAsync (logname, messages, 4);
+
+	unlink (logname);
+
+	char data[] = "ABC\r\n";
+
+	t0 = usecNow ();
+	for (int i = 0; i < messages; i++)
+	{
+		std::ostringstream os;
+		os << "C0 serial port data: ";
+		for (int j = 0; j < 5; j++)
+			os << "0x" << std::hex << (int) data[j] << ' ';
+	}
+	t = usecNow () - t0;
+	printf ("formatting debug message: %.0f lines/s\n", 1e6 * messages / t);
+
+	t0 = usecNow ();
+	for (int i = 0; i < messages; i++)
+	{
+		rts2core::LogStream ls = app.logStream (MESSAGE_DEBUG);
+		ls << "C0 serial port data: ";
+		ls.logArrAsHex (data, 5);
+		ls << sendLog;
+	}
+	t = usecNow () - t0;
+	printf ("LogStream debug message, debug off: %.0f lines/s\n", 1e6 * messages / t);
+
+	return 0;
+}
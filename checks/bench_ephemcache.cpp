@@ -0,0 +1,242 @@
+/*
+ * Benchmark of ephemeris cache. Runs target selection every few minutes
+ * during a night over a catalog of fixed, elliptical and planet targets,
+ * checking altitude, Sun altitude and lunar distance constraints for every
+ * target and sorting targets which satisfy constraints by altitude, as
+ * queue sorting functors do. First with positions calculated by libnova on
+ * every call, then with positions interpolated from EphemerisCache.
+ * Run it with ./bench_ephemcache [targets] [interval in minutes].
+ */
+
+#include "ephemcache.h"
+#include "libnova_cpp.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <algorithm>
+#include <vector>
+
+// 2015-03-20 18:00 UT
+#define JD_NIGHT    2457102.25
+
+#define MIN_ALT     20.0
+#define SUN_ALT     -12.0
+#define LUNAR_DIST  30.0
+
+static double usecNow ()
+{
+	struct timeval tv;
+	gettimeofday (&tv, NULL);
+	return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+static double randomRange (double min, double max)
+{
+	return min + (max - min) * (random () / (double) RAND_MAX);
+}
+
+struct ln_lnlat_posn observer;
+
+class CatalogTarget:public rts2core::EphemerisCache
+{
+	public:
+		CatalogTarget ():rts2core::EphemerisCache () {}
+
+		void getExact (struct ln_equ_posn *pos, double JD) { computePosition (pos, JD); }
+};
+
+class FixedTarget:public CatalogTarget
+{
+	public:
+		FixedTarget ():CatalogTarget ()
+		{
+			position.ra = randomRange (0, 360);
+			position.dec = randomRange (-40, 90);
+			pm.ra = randomRange (-1e-4, 1e-4);
+			pm.dec = randomRange (-1e-4, 1e-4);
+		}
+
+	protected:
+		virtual void computePosition (struct ln_equ_posn *pos, double JD) { ln_get_equ_pm (&position, &pm, JD, pos); }
+
+	private:
+		struct ln_equ_posn position;
+		struct ln_equ_posn pm;
+};
+
+class OrbitTarget:public CatalogTarget
+{
+	public:
+		OrbitTarget ():CatalogTarget ()
+		{
+			orbit.a = randomRange (1.5, 4);
+			orbit.e = randomRange (0, 0.3);
+			orbit.i = randomRange (0, 30);
+			orbit.w = randomRange (0, 360);
+			orbit.omega = randomRange (0, 360);
+			orbit.n = ln_get_ell_mean_motion (orbit.a);
+			orbit.JD = JD_NIGHT - randomRange (0, 1000);
+		}
+
+	protected:
+		virtual void computePosition (struct ln_equ_posn *pos, double JD)
+		{
+			struct ln_equ_posn parallax;
+			LibnovaCurrentFromOrbit (pos, &orbit, &::observer, 1706, JD, &parallax);
+		}
+
+	private:
+		struct ln_ell_orbit orbit;
+};
+
+typedef void (*planet_func_t) (double, struct ln_equ_posn *);
+
+class PlanetTarget:public CatalogTarget
+{
+	public:
+		PlanetTarget (planet_func_t _func):CatalogTarget () { func = _func; }
+
+	protected:
+		virtual void computePosition (struct ln_equ_posn *pos, double JD) { func (JD, pos); }
+
+	private:
+		planet_func_t func;
+};
+
+static void getAltAz (CatalogTarget *tar, struct ln_hrz_posn *hrz, double JD, bool cached)
+{
+	if (cached)
+	{
+		tar->getHrzPosition (hrz, JD, &observer);
+	}
+	else
+	{
+		struct ln_equ_posn pos;
+		tar->getExact (&pos, JD);
+		ln_get_hrz_from_equ (&pos, &observer, JD, hrz);
+	}
+}
+
+// sort by altitude, as sortQueByAltitude in executorque.cpp
+struct sortByAltitude
+{
+	double JD;
+	bool cached;
+
+	bool operator () (CatalogTarget *t1, CatalogTarget *t2)
+	{
+		struct ln_hrz_posn hr1, hr2;
+		getAltAz (t1, &hr1, JD, cached);
+		getAltAz (t2, &hr2, JD, cached);
+		return hr1.alt > hr2.alt;
+	}
+};
+
+/**
+ * Check constraints of all targets, as selector does, and sort targets
+ * which satisfy them by altitude. Returns the highest target, NULL if there
+ * is not any.
+ */
+static CatalogTarget *selectorPass (std::vector <CatalogTarget *> &catalog, double JD, bool cached, long &visible)
+{
+	std::vector <CatalogTarget *> good;
+	for (size_t i = 0; i < catalog.size (); i++)
+	{
+		CatalogTarget *tar = catalog[i];
+		struct ln_equ_posn pos, sun, moon;
+		struct ln_hrz_posn hrz, hsun;
+		getAltAz (tar, &hrz, JD, cached);
+		if (hrz.alt < MIN_ALT)
+			continue;
+		if (cached)
+		{
+			rts2core::SolarEphemeris::instance ()->getHrzPosition (&hsun, JD, &observer);
+			if (hsun.alt > SUN_ALT)
+				continue;
+			tar->getEquPosition (&pos, JD);
+			rts2core::LunarEphemeris::instance ()->getEquPosition (&moon, JD);
+		}
+		else
+		{
+			tar->getExact (&pos, JD);
+			ln_get_solar_equ_coords (JD, &sun);
+			ln_get_hrz_from_equ (&sun, &observer, JD, &hsun);
+			if (hsun.alt > SUN_ALT)
+				continue;
+			ln_get_lunar_equ_coords (JD, &moon);
+		}
+		if (ln_get_angular_separation (&pos, &moon) < LUNAR_DIST)
+			continue;
+		good.push_back (tar);
+	}
+	visible += good.size ();
+	if (good.empty ())
+		return NULL;
+	sortByAltitude sa = { JD, cached };
+	std::sort (good.begin (), good.end (), sa);
+	return good[0];
+}
+
+int main (int argc, char **argv)
+{
+	size_t n = 10000;
+	double interval = 5;
+	if (argc > 1)
+		n = atol (argv[1]);
+	if (argc > 2)
+		interval = atof (argv[2]);
+
+	observer.lng = 14.7833;
+	observer.lat = 49.9100;
+
+	planet_func_t planets[] = {ln_get_mercury_equ_coords, ln_get_venus_equ_coords, ln_get_mars_equ_coords, ln_get_jupiter_equ_coords, ln_get_saturn_equ_coords, ln_get_uranus_equ_coords, ln_get_neptune_equ_coords};
+
+	srandom (1);
+	std::vector <CatalogTarget *> catalog;
+	for (size_t i = 0; i < n; i++)
+	{
+		// 90% fixed, 9% elliptical, 1% planet targets
+		switch (i % 100)
+		{
+			case 0:
+				catalog.push_back (new PlanetTarget (planets[(i / 100) % 7]));
+				break;
+			case 1: case 2: case 3: case 4: case 5: case 6: case 7: case 8: case 9:
+				catalog.push_back (new OrbitTarget ());
+				break;
+			default:
+				catalog.push_back (new FixedTarget ());
+		}
+	}
+
+	std::vector <CatalogTarget *> bestExact, bestCached;
+	long visibleExact = 0, visibleCached = 0;
+
+	double t0 = usecNow ();
+	for (double JD = JD_NIGHT; JD < JD_NIGHT + 0.5; JD += interval / 1440.0)
+		bestExact.push_back (selectorPass (catalog, JD, false, visibleExact));
+	double tExact = usecNow () - t0;
+
+	t0 = usecNow ();
+	for (double JD = JD_NIGHT; JD < JD_NIGHT + 0.5; JD += interval / 1440.0)
+		bestCached.push_back (selectorPass (catalog, JD, true, visibleCached));
+	double tCached = usecNow () - t0;
+
+	int differ = 0;
+	for (size_t i = 0; i < bestExact.size (); i++)
+		if (bestExact[i] != bestCached[i])
+			differ++;
+
+	long misses = 0;
+	for (size_t i = 0; i < catalog.size (); i++)
+	{
+		misses += catalog[i]->getMisses ();
+		delete catalog[i];
+	}
+
+	printf ("%lu targets, %lu selections: libnova %.0f ms, cached %.0f ms, speedup %.2fx\n", (unsigned long) n, (unsigned long) bestExact.size (), tExact / 1000.0, tCached / 1000.0, tExact / tCached);
+	printf ("satisfied constraints %ld / %ld, %d different selections, %ld buckets calculated\n", visibleExact, visibleCached, differ, misses);
+
+	return 0;
+}
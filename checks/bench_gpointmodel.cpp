@@ -0,0 +1,114 @@
+/*
+ * Benchmark of GPoint model evaluation. Evaluates alt-az model with extra
+ * terms on random positions, first with ExtraParam::getValue as model did
+ * before it was compiled, then with compiled model for every position and
+ * with batch evaluation of position arrays.
+ * Run it with ./bench_gpointmodel [positions].
+ */
+
+#include "gpointmodel.h"
+#include "gpointref.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+static double usecNow ()
+{
+	struct timeval tv;
+	gettimeofday (&tv, NULL);
+	return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+int main (int argc, char **argv)
+{
+	size_t n = 1000000;
+	if (argc > 1)
+		n = atol (argv[1]);
+
+	rts2telmodel::GPointModel model (-32.53);
+	std::istringstream iss ("RTS2_ALTAZ -32.9560351668\" -0.378603669032\" 3.69867556175\" -22.4029458503\" -6.3810740497\" -15.8279575851\" 9.97752718308\"\n"
+		"AZ 6.52266606181\" sincos az;el 2.0;2.0\n"
+		"AZ 2.86981868859\" sincos el;az 5.0;3.0\n"
+		"AZ 1.2\" cos az 4\n"
+		"AZ -0.8\" sin az 3\n"
+		"EL -0.142425289668\" sincos az;el 4.0;4.0\n"
+		"EL 1.42907527224\" sin az 1.0\n"
+		"EL 0.53\" cos az 2\n"
+		"EL -0.31\" sin el 3\n");
+	model.load (iss);
+
+	double *az = new double[n];
+	double *alt = new double[n];
+	double *ha = new double[n];
+	double *dec = new double[n];
+	double *err_az = new double[n];
+	double *err_alt = new double[n];
+	double *ref_az = new double[n];
+	double *ref_alt = new double[n];
+
+	srandom (1);
+	for (size_t i = 0; i < n; i++)
+	{
+		az[i] = 360.0 * random () / RAND_MAX;
+		alt[i] = 5 + 84.0 * random () / RAND_MAX;
+		ha[i] = -180 + 360.0 * random () / RAND_MAX;
+		dec[i] = -85 + 170.0 * random () / RAND_MAX;
+	}
+
+	double t0 = usecNow ();
+	for (size_t i = 0; i < n; i++)
+		referenceErrAltAz (model, az[i], alt[i], ha[i], dec[i], ref_az[i], ref_alt[i]);
+	double tLegacy = usecNow () - t0;
+
+	t0 = usecNow ();
+	for (size_t i = 0; i < n; i++)
+	{
+		struct ln_hrz_posn hrz, err;
+		struct ln_equ_posn equ;
+		hrz.az = az[i];
+		hrz.alt = alt[i];
+		equ.ra = ha[i];
+		equ.dec = dec[i];
+		model.getErrAltAz (&hrz, &equ, &err);
+		err_az[i] = err.az;
+		err_alt[i] = err.alt;
+	}
+	double tSingle = usecNow () - t0;
+
+	double maxDiff = 0;
+	for (size_t i = 0; i < n; i++)
+	{
+		if (fabs (err_az[i] - ref_az[i]) > maxDiff)
+			maxDiff = fabs (err_az[i] - ref_az[i]);
+		if (fabs (err_alt[i] - ref_alt[i]) > maxDiff)
+			maxDiff = fabs (err_alt[i] - ref_alt[i]);
+	}
+
+	t0 = usecNow ();
+	model.getErrAltAz (n, az, alt, ha, dec, err_az, err_alt);
+	double tBatch = usecNow () - t0;
+
+	for (size_t i = 0; i < n; i++)
+	{
+		if (fabs (err_az[i] - ref_az[i]) > maxDiff)
+			maxDiff = fabs (err_az[i] - ref_az[i]);
+		if (fabs (err_alt[i] - ref_alt[i]) > maxDiff)
+			maxDiff = fabs (err_alt[i] - ref_alt[i]);
+	}
+
+	printf ("%lu positions: legacy %.0f ms, compiled %.0f ms (%.2fx), batch %.0f ms (%.2fx)\n", (unsigned long) n, tLegacy / 1000.0, tSingle / 1000.0, tLegacy / tSingle, tBatch / 1000.0, tLegacy / tBatch);
+	printf ("maximal difference %.3g arcsec\n", maxDiff * 3600.0);
+
+	delete[] az;
+	delete[] alt;
+	delete[] ha;
+	delete[] dec;
+	delete[] err_az;
+	delete[] err_alt;
+	delete[] ref_az;
+	delete[] ref_alt;
+
+	return 0;
+}
@@ -0,0 +1,133 @@
+/*
+ * Benchmark of horizon checks. Replays a night of selector checks - targets
+ * spread over the sky checked every minute of a night against surveyed
+ * horizon with 3600 points. Checks are run with linear search of the
+ * horizon, as ObjectCheck did before azimuth index was added, then with
+ * ObjectCheck::is_good for every position and with batch is_good.
+ * Run it with ./bench_horizon [targets] [horizon points].
+ */
+
+#include "objectcheck.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include <libnova/libnova.h>
+
+static double usecNow ()
+{
+	struct timeval tv;
+	gettimeofday (&tv, NULL);
+	return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+static double interpolate (double az, const HorizonEntry &h1, const HorizonEntry &h2)
+{
+	double az1 = h1.hrz.az > h2.hrz.az ? h1.hrz.az - 360.0 : h1.hrz.az;
+	return h1.hrz.alt + ln_range_degrees (az - az1) * (h2.hrz.alt - h1.hrz.alt) / (h2.hrz.az - az1);
+}
+
+// linear search, as used before azimuth index
+static double linearHeight (horizon_t &horizon, double az)
+{
+	if (az < horizon.front ().hrz.az)
+		return interpolate (az, horizon.back (), horizon.front ());
+	for (size_t i = 1; i < horizon.size (); i++)
+	{
+		if (horizon[i].hrz.az > az)
+			return interpolate (az, horizon[i - 1], horizon[i]);
+	}
+	return interpolate (az, horizon.back (), horizon.front ());
+}
+
+int main (int argc, char **argv)
+{
+	size_t nTargets = 300;
+	size_t nHorizon = 3600;
+	if (argc > 1)
+		nTargets = atol (argv[1]);
+	if (argc > 2)
+		nHorizon = atol (argv[2]);
+
+	srandom (1);
+
+	char fn[] = "/tmp/bench_horizon_XXXXXX";
+	int fd = mkstemp (fn);
+	FILE *f = fdopen (fd, "w");
+	fprintf (f, "AZ-ALT\n");
+	for (size_t i = 0; i < nHorizon; i++)
+		fprintf (f, "%f %+f\n", (i + 0.5) * 360.0 / nHorizon, 10 + 5 * sin (i * 0.01) + 3.0 * random () / RAND_MAX);
+	fclose (f);
+
+	ObjectCheck checker (fn);
+	unlink (fn);
+
+	horizon_t horizon (checker.begin (), checker.end ());
+
+	struct ln_lnlat_posn observer;
+	observer.lng = 14.78;
+	observer.lat = 49.91;
+
+	// night from 19:00 to 05:00 UT, every minute
+	size_t nSteps = 600;
+	size_t n = nTargets * nSteps;
+	double *alt = new double[n];
+	double *az = new double[n];
+	int *good = new int[n];
+	int *ref = new int[n];
+
+	double JD0 = 2457101.5 + 19.0 / 24.0;
+	for (size_t i = 0; i < nTargets; i++)
+	{
+		struct ln_equ_posn pos;
+		pos.ra = 360.0 * random () / RAND_MAX;
+		pos.dec = -30 + 120.0 * random () / RAND_MAX;
+		for (size_t j = 0; j < nSteps; j++)
+		{
+			struct ln_hrz_posn hrz;
+			ln_get_hrz_from_equ (&pos, &observer, JD0 + j / 1440.0, &hrz);
+			alt[i * nSteps + j] = hrz.alt;
+			az[i * nSteps + j] = hrz.az;
+		}
+	}
+
+	double t0 = usecNow ();
+	for (size_t i = 0; i < n; i++)
+		ref[i] = alt[i] > linearHeight (horizon, az[i]);
+	double tLegacy = usecNow () - t0;
+
+	t0 = usecNow ();
+	for (size_t i = 0; i < n; i++)
+	{
+		struct ln_hrz_posn hrz;
+		hrz.alt = alt[i];
+		hrz.az = az[i];
+		good[i] = checker.is_good (&hrz);
+	}
+	double tSingle = usecNow () - t0;
+
+	size_t diffs = 0;
+	for (size_t i = 0; i < n; i++)
+		if (good[i] != ref[i])
+			diffs++;
+
+	t0 = usecNow ();
+	checker.is_good (n, alt, az, good);
+	double tBatch = usecNow () - t0;
+
+	for (size_t i = 0; i < n; i++)
+		if (good[i] != ref[i])
+			diffs++;
+
+	printf ("%lu checks, %lu horizon points: linear %.0f ms, indexed %.1f ms (%.0fx), batch %.1f ms (%.0fx), %lu differences\n", (unsigned long) n, (unsigned long) horizon.size (), tLegacy / 1000.0, tSingle / 1000.0, tLegacy / tSingle, tBatch / 1000.0, tLegacy / tBatch, (unsigned long) diffs);
+
+	delete[] alt;
+	delete[] az;
+	delete[] good;
+	delete[] ref;
+
+	return 0;
+}
@@ -0,0 +1,196 @@
+/*
+ * Benchmark of camd readout statistics. Compares the original per-pixel
+ * statistics, mode and center loops with the single pass PixelStatistics
+ * kernel, on 4096x4096 frames delivered as a whole frame and in 64 row chunks.
+ * Run it with ./bench_pixelstat [repeats].
+ */
+
+#include "pixelstat.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <sys/time.h>
+
+#define FRAME_W   4096
+#define FRAME_H   4096
+
+static double usecNow ()
+{
+	struct timeval tv;
+	gettimeofday (&tv, NULL);
+	return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+/**
+ * Original statistics calculation. Histogram is limited to 65536 bins, as the
+ * original code cannot process float or signed data.
+ */
+class LegacyStatistics
+{
+	public:
+		LegacyStatistics ()
+		{
+			modeCount = new uint32_t[PIXSTAT_BINS];
+			reset ();
+		}
+
+		~LegacyStatistics () { delete[] modeCount; }
+
+		void reset ()
+		{
+			memset (modeCount, 0, PIXSTAT_BINS * sizeof (uint32_t));
+			sum = 0;
+			min = INFINITY;
+			max = -INFINITY;
+		}
+
+		template <typename t> int updateStatistics (t *data, size_t dataSize)
+		{
+			long double tSum = 0;
+			double tMin = min;
+			double tMax = max;
+			int pixNum = 0;
+			t *tData = data;
+			while (((char *) tData) < ((char *) data) + dataSize)
+			{
+				t tD = *tData;
+				tSum += tD;
+				if (tD < tMin)
+					tMin = tD;
+				if (tD > tMax)
+				  	tMax = tD;
+				modeCount[((long) tD) & (PIXSTAT_BINS - 1)]++;
+				tData++;
+				pixNum++;
+			}
+			sum += tSum;
+			if (tMin < min)
+				min = tMin;
+			if (tMax > max)
+				max = tMax;
+			return pixNum;
+		}
+
+		long mode ()
+		{
+			long m = 0;
+			uint32_t modeNum = 0;
+			for (unsigned int i = 0; i < PIXSTAT_BINS; i++)
+			{
+				if (modeCount[i] > modeNum)
+				{
+					m = i;
+					modeNum = modeCount[i];
+				}
+			}
+			return m;
+		}
+
+		template <typename t> void updateCenter (t *data, int x, int y, int w, int h, double cut)
+		{
+			double center_max = cut;
+			t *tData = data + y * FRAME_W + x;
+			double sx[w];
+			for (int i = 0; i < w; i++)
+				sx[i] = 0;
+			sumsY.clear ();
+			for (int row = 0; row < h; row++)
+			{
+				double rs = 0;
+				for (int col = 0; col < w; col++, tData++)
+				{
+					if (*tData >= cut)
+					{
+						sx[col] += *tData;
+						rs += *tData;
+						if (std::isnan (center_max) || *tData > center_max)
+							center_max = *tData;
+					}
+				}
+				sumsY.push_back (rs);
+				tData += FRAME_W - w;
+			}
+			centerMax = center_max;
+		}
+
+		double sum;
+		double min;
+		double max;
+		double centerMax;
+		std::vector <double> sumsY;
+
+	private:
+		uint32_t *modeCount;
+};
+
+template <typename t> void fillFrame (t *data)
+{
+	srandom (1);
+	for (size_t i = 0; i < FRAME_W * FRAME_H; i++)
+		data[i] = 1000 + random () % 200;
+}
+
+template <typename t> void bench (const char *name, int repeats)
+{
+	t *data = new t[FRAME_W * FRAME_H];
+	fillFrame (data);
+
+	int chunks[] = {FRAME_H, 64, 0};
+	for (int *rows = chunks; *rows; rows++)
+	{
+		size_t chunkPix = (size_t) *rows * FRAME_W;
+		double tLegacy = 0, tNew = 0;
+		double lSum = 0, nSum = 0;
+		long lMode = 0, nMode = 0;
+
+		for (int r = 0; r < repeats; r++)
+		{
+			LegacyStatistics *legacy = new LegacyStatistics ();
+			double t0 = usecNow ();
+			for (size_t p = 0; p < FRAME_W * FRAME_H; p += chunkPix)
+			{
+				legacy->updateStatistics (data + p, chunkPix * sizeof (t));
+				// center box is evaluated on a full frame only
+				if (*rows == FRAME_H)
+					legacy->updateCenter (data + p, 1948, 1948, 200, 200, 1100);
+				// mode is calculated for every chunk
+				lMode = legacy->mode ();
+			}
+			tLegacy += usecNow () - t0;
+			lSum = legacy->sum;
+			delete legacy;
+
+			rts2camd::PixelStatistics *stat = new rts2camd::PixelStatistics ();
+			t0 = usecNow ();
+			for (size_t p = 0; p < FRAME_W * FRAME_H; p += chunkPix)
+			{
+				if (*rows == FRAME_H)
+					stat->setCenterBox (1948, 1948, 200, 200, FRAME_W, 1100);
+				else
+					stat->setCenterBox (0, 0, 0, 0, FRAME_W, 1100);
+				stat->update (data + p, chunkPix * sizeof (t), true);
+				nMode = stat->getMode ();
+			}
+			tNew += usecNow () - t0;
+			nSum = stat->getSum ();
+			delete stat;
+		}
+
+		printf ("%-10s %6d %14.2f %14.2f %8.2fx%s\n", name, *rows, tLegacy / repeats / 1000.0, tNew / repeats / 1000.0, tLegacy / tNew, (lSum != nSum || lMode != nMode) ? " MISMATCH" : "");
+	}
+
+	delete[] data;
+}
+
+int main (int argc, char **argv)
+{
+	int repeats = 5;
+	if (argc > 1)
+		repeats = atoi (argv[1]);
+
+	printf ("%-10s %6s %14s %14s %9s\n", "type", "rows", "legacy [ms]", "kernel [ms]", "speedup");
+	bench <uint16_t> ("uint16", repeats);
+	bench <int16_t> ("int16", repeats);
+	bench <float> ("float", repeats);
+	return 0;
+}
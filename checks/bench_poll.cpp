@@ -0,0 +1,123 @@
+/*
+ * Benchmark of Block event loop wakeup latency. Measures time needed by
+ * Block::oneRunLoop to deliver a single line to the connection, for increasing
+ * number of idle connections. Run it with ./bench_poll [repeats]; both ppoll
+ * and epoll backends are measured.
+ */
+
+#include "block.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+class BenchConn:public rts2core::Connection
+{
+	public:
+		BenchConn (int _sock, rts2core::Block *_master):rts2core::Connection (_sock, _master) { received = 0; }
+
+		virtual void processLine () { received++; }
+
+		int received;
+};
+
+class BenchBlock:public rts2core::Block
+{
+	public:
+		BenchBlock (int argc, char **argv, bool _usePoll):rts2core::Block (argc, argv)
+		{
+			setUsePoll (_usePoll);
+			setTimeout (USEC_SEC);
+		}
+
+		virtual int run () { return 0; }
+
+	protected:
+		virtual rts2core::Connection *createClientConnection (rts2core::NetworkAddress * in_addr) { return NULL; }
+};
+
+static double usecNow ()
+{
+	struct timeval tv;
+	gettimeofday (&tv, NULL);
+	return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+/**
+ * Returns average wakeup latency in microseconds.
+ */
+double benchLoop (int argc, char **argv, bool usePoll, int nconn, int repeats)
+{
+	BenchBlock *block = new BenchBlock (argc, argv, usePoll);
+	BenchConn **conns = new BenchConn*[nconn];
+	int *peers = new int[nconn];
+
+	for (int i = 0; i < nconn; i++)
+	{
+		int sv[2];
+		if (socketpair (AF_UNIX, SOCK_STREAM, 0, sv))
+		{
+			perror ("socketpair");
+			exit (EXIT_FAILURE);
+		}
+		conns[i] = new BenchConn (sv[0], block);
+		peers[i] = sv[1];
+		block->addConnection (conns[i]);
+	}
+	// move connections from added list to connection list
+	block->callIdle ();
+
+	double total = 0;
+	for (int r = 0; r < repeats; r++)
+	{
+		int c = random () % nconn;
+		int received = conns[c]->received;
+		double t0 = usecNow ();
+		if (write (peers[c], "T ready\n", 8) != 8)
+		{
+			perror ("write");
+			exit (EXIT_FAILURE);
+		}
+		while (conns[c]->received == received)
+			block->oneRunLoop ();
+		total += usecNow () - t0;
+	}
+
+	for (int i = 0; i < nconn; i++)
+		close (peers[i]);
+	delete[] peers;
+	delete[] conns;
+	// connections are deleted by block destructor
+	delete block;
+
+	return total / repeats;
+}
+
+int main (int argc, char **argv)
+{
+	int repeats = 1000;
+	if (argc > 1)
+		repeats = atoi (argv[1]);
+
+	// each connection needs two descriptors
+	struct rlimit rl;
+	getrlimit (RLIMIT_NOFILE, &rl);
+	rl.rlim_cur = rl.rlim_max;
+	setrlimit (RLIMIT_NOFILE, &rl);
+
+	int counts[] = {10, 50, 100, 200, 500, 1000, 2000, 0};
+
+	printf ("%12s %12s %12s\n", "connections", "ppoll [us]", "epoll [us]");
+	for (int *n = counts; *n; n++)
+	{
+		if ((rlim_t) (*n * 2 + 20) > rl.rlim_cur)
+			break;
+		double lpoll = benchLoop (argc, argv, true, *n, repeats);
+		double lepoll = benchLoop (argc, argv, false, *n, repeats);
+		printf ("%12d %12.2f %12.2f\n", *n, lpoll, lepoll);
+	}
+	return 0;
+}
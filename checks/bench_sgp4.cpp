@@ -0,0 +1,138 @@
+/*
+ * Benchmark of batch SGP4 propagation. Propagates satellites, derived from
+ * ISS and XMM TLEs used in check_tle and check_sgp4 by changing their node
+ * and mean anomaly, to a night of dates. Topocentric positions are
+ * calculated first with propagate and ln_get_satellite_ra_dec_delta for
+ * every satellite and date, then with SatelliteSet in a single pass.
+ * Run it with ./bench_sgp4 [satellites] [dates].
+ */
+
+#include "sgp4.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+static double usecNow ()
+{
+	struct timeval tv;
+	gettimeofday (&tv, NULL);
+	return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+int main (int argc, char **argv)
+{
+	size_t nSat = 200;
+	size_t nJD = 4320;
+	if (argc > 1)
+		nSat = atol (argv[1]);
+	if (argc > 2)
+		nJD = atol (argv[2]);
+
+	const char *iss1 = "1 25544U 98067A   16128.85424799  .00005564  00000-0  90091-4 0  9999";
+	const char *iss2 = "2 25544  51.6438 259.2325 0002021  92.7504  10.7493 15.54477273998701";
+	const char *xmm1 = "1 25989U 99066A   16126.72024749 -.00000083  00000-0  00000+0 0  9995";
+	const char *xmm2 = "2 25989  67.4812  25.2476 8203967  94.8547 359.5975  0.50170988 18843";
+
+	rts2sgp4::SatelliteSet sats;
+
+	for (size_t i = 0; i < nSat; i++)
+	{
+		// every 50th satellite is deep space
+		bool deep = (i % 50) == 49;
+		char tle2[70];
+		char f[10];
+		strcpy (tle2, deep ? xmm2 : iss2);
+		// node, columns 18-25, and mean anomaly, columns 44-51
+		snprintf (f, sizeof (f), "%8.4f", fmod (259.2325 + i * 7.1, 360));
+		memcpy (tle2 + 17, f, 8);
+		snprintf (f, sizeof (f), "%8.4f", fmod (10.7493 + i * 13.3, 360));
+		memcpy (tle2 + 43, f, 8);
+		if (sats.add (deep ? xmm1 : iss1, tle2) < 0)
+		{
+			fprintf (stderr, "cannot add satellite %lu\n", (unsigned long) i);
+			return 1;
+		}
+	}
+
+	double *JD = new double[nJD];
+	for (size_t j = 0; j < nJD; j++)
+		JD[j] = 2457518.8 + j * 10.0 / 86400.0;
+
+	struct ln_lnlat_posn observer;
+	observer.lng = -4.4643;
+	observer.lat = 40.4610;
+
+	size_t n = nSat * nJD;
+	double *ra = new double[n];
+	double *dec = new double[n];
+	double *delta = new double[n];
+	double *ref_ra = new double[n];
+	double *ref_dec = new double[n];
+	double *ref_delta = new double[n];
+
+	double t0 = usecNow ();
+	double rho_cos, rho_sin;
+	rts2sgp4::ln_lat_alt_to_parallax (&observer, 791, &rho_cos, &rho_sin);
+	for (size_t i = 0; i < nSat; i++)
+	{
+		for (size_t j = 0; j < nJD; j++)
+		{
+			struct ln_rect_posn pos, v, observer_loc;
+			struct ln_equ_posn radec;
+			size_t ri = i * nJD + j;
+			if (rts2sgp4::propagate (sats.getSatellite (i), JD[j], &pos, &v))
+			{
+				ref_ra[ri] = ref_dec[ri] = ref_delta[ri] = NAN;
+				continue;
+			}
+			rts2sgp4::ln_observer_cartesian_coords (&observer, rho_cos, rho_sin, JD[j], &observer_loc);
+			rts2sgp4::ln_get_satellite_ra_dec_delta (&observer_loc, &pos, &radec, ref_delta + ri);
+			ref_ra[ri] = radec.ra;
+			ref_dec[ri] = radec.dec;
+		}
+	}
+	double tLegacy = usecNow () - t0;
+
+	t0 = usecNow ();
+	int errors = sats.topocentric (JD, nJD, &observer, 791, ra, dec, delta);
+	double tBatch = usecNow () - t0;
+
+	double maxDiff = 0;
+	double maxDelta = 0;
+	for (size_t i = 0; i < n; i++)
+	{
+		if (isnan (ref_ra[i]) != isnan (ra[i]))
+		{
+			fprintf (stderr, "propagation results differ for satellite %lu\n", (unsigned long) (i / nJD));
+			return 1;
+		}
+		if (isnan (ra[i]))
+			continue;
+		double d = fabs (ra[i] - ref_ra[i]);
+		if (d > 180)
+			d = 360 - d;
+		d *= cos (ln_deg_to_rad (dec[i]));
+		if (d > maxDiff)
+			maxDiff = d;
+		if (fabs (dec[i] - ref_dec[i]) > maxDiff)
+			maxDiff = fabs (dec[i] - ref_dec[i]);
+		if (fabs (delta[i] - ref_delta[i]) > maxDelta)
+			maxDelta = fabs (delta[i] - ref_delta[i]);
+	}
+
+	printf ("%lu satellites x %lu dates: legacy %.0f ms, batch %.0f ms (%.2fx), %d failed propagations\n", (unsigned long) nSat, (unsigned long) nJD, tLegacy / 1000.0, tBatch / 1000.0, tLegacy / tBatch, errors);
+	printf ("maximal difference %.3g arcsec, %.3g m\n", maxDiff * 3600.0, maxDelta * 1000.0);
+
+	delete[] JD;
+	delete[] ra;
+	delete[] dec;
+	delete[] delta;
+	delete[] ref_ra;
+	delete[] ref_dec;
+	delete[] ref_delta;
+
+	return 0;
+}
@@ -0,0 +1,118 @@
+/*
+ * Benchmark of image statistics. For every RTS2_DATA type, compares the
+ * original two pass long double mean and standard deviation with one pass
+ * RunningStatistics, and median found by qsort with median found by
+ * selection.
+ * Run it with ./bench_statistics [pixels].
+ */
+
+#include "statistics.h"
+#include "imghdr.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+static double usecNow ()
+{
+	struct timeval tv;
+	gettimeofday (&tv, NULL);
+	return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+// original Channel statistics
+template <typename t> void legacyStatistics (t *data, long totalPixels, double &average, double &stdev)
+{
+	t *pixel = data;
+	t *fullTop = pixel + totalPixels;
+
+	long double pixelSum = 0;
+
+	while (pixel < fullTop)
+	{
+		pixelSum += *pixel;
+		pixel++;
+	}
+	average = pixelSum / totalPixels;
+	pixel = data;
+	stdev = 0;
+	while (pixel < fullTop)
+	{
+		long double tmp_s = *pixel - average;
+		long double tmp_ss = tmp_s * tmp_s;
+		stdev += tmp_ss;
+		pixel++;
+	}
+	stdev = sqrt (stdev / totalPixels);
+}
+
+template <typename t> int compare (const void *a, const void *b)
+{
+	return (*(t *) a < *(t *) b) ? -1 : ((*(t *) a == *(t *) b) ? 0 : 1);
+}
+
+// original median - sorted copy
+template <typename t> double legacyMedian (t *data, size_t n)
+{
+	t *f = (t *) malloc (n * sizeof (t));
+	memcpy (f, data, n * sizeof (t));
+	qsort (f, n, sizeof (t), compare<t>);
+	double ret = (n % 2) ? f[n / 2] : (f[n / 2 - 1] + (double) f[n / 2]) / 2.0;
+	free (f);
+	return ret;
+}
+
+template <typename t> void bench (const char *name, size_t n, double scale, double offset)
+{
+	t *data = new t[n];
+	srandom (1);
+	for (size_t i = 0; i < n; i++)
+		// sky background with a few bright pixels
+		data[i] = (t) (offset + scale * ((random () % 1000) + ((i % 1009) == 0 ? 20000 : 0)) / 25000.0);
+
+	double lAvg, lStdev;
+	double t0 = usecNow ();
+	legacyStatistics (data, n, lAvg, lStdev);
+	double tLegacy = usecNow () - t0;
+
+	t0 = usecNow ();
+	rts2core::RunningStatistics stat;
+	stat.add (data, n);
+	double tNew = usecNow () - t0;
+
+	t0 = usecNow ();
+	double lMedian = legacyMedian (data, n);
+	double tLegacyMedian = usecNow () - t0;
+
+	t0 = usecNow ();
+	double nMedian = rts2core::median (data, n);
+	double tNewMedian = usecNow () - t0;
+
+	bool match = fabs (stat.getMean () - lAvg) <= 1e-9 * fabs (lAvg) + 1e-9 && fabs (stat.getStdev () - lStdev) <= 1e-6 * lStdev + 1e-9 && lMedian == nMedian;
+
+	printf ("%-10s %12.0f %12.0f %8.2fx %12.0f %12.0f %8.2fx%s\n", name, tLegacy, tNew, tLegacy / tNew, tLegacyMedian, tNewMedian, tLegacyMedian / tNewMedian, match ? "" : " MISMATCH");
+
+	delete[] data;
+}
+
+int main (int argc, char **argv)
+{
+	size_t n = 4096 * 4096;
+	if (argc > 1)
+		n = atol (argv[1]);
+
+	printf ("%-10s %12s %12s %9s %12s %12s %9s\n", "type", "2pass [us]", "welford [us]", "speedup", "qsort [us]", "median [us]", "speedup");
+
+	bench <uint8_t> ("BYTE", n, 250, 0);
+	bench <int16_t> ("SHORT", n, 60000, -30000);
+	bench <int32_t> ("LONG", n, 2e9, -1e9);
+	bench <int64_t> ("LONGLONG", n, 1e15, -5e14);
+	bench <float> ("FLOAT", n, 60000, 0);
+	bench <double> ("DOUBLE", n, 1e6, 1e9);
+	bench <int8_t> ("SBYTE", n, 250, -125);
+	bench <uint16_t> ("USHORT", n, 65000, 0);
+	bench <uint32_t> ("ULONG", n, 4e9, 0);
+
+	return 0;
+}
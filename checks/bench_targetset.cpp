@@ -0,0 +1,117 @@
+/*
+ * Benchmark of target set loading. Loads synthetic constant targets from
+ * the database, first target by target with TargetSet::load (list), as
+ * TargetSet::load did before it selected all targets rows in a single
+ * query, then with TargetSet::load. Targets are created with the -c
+ * option, so the benchmark can be repeated on the same database; run it
+ * against a scratch database, not against the observatory one.
+ * Run it with ./bench_targetset [-c targets] [--database name].
+ */
+
+#include "rts2db/appdb.h"
+#include "rts2db/target.h"
+#include "rts2db/targetset.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+static double usecNow ()
+{
+	struct timeval tv;
+	gettimeofday (&tv, NULL);
+	return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+class BenchTargetSet:public rts2db::AppDb
+{
+	public:
+		BenchTargetSet (int argc, char **argv);
+
+	protected:
+		virtual int processOption (int in_opt);
+		virtual int doProcessing ();
+
+	private:
+		int create;
+};
+
+BenchTargetSet::BenchTargetSet (int argc, char **argv):rts2db::AppDb (argc, argv)
+{
+	create = 0;
+	addOption ('c', NULL, 1, "create given number of synthetic targets");
+}
+
+int BenchTargetSet::processOption (int in_opt)
+{
+	switch (in_opt)
+	{
+		case 'c':
+			create = atoi (optarg);
+			break;
+		default:
+			return rts2db::AppDb::processOption (in_opt);
+	}
+	return 0;
+}
+
+int BenchTargetSet::doProcessing ()
+{
+	if (create > 0)
+	{
+		double t0 = usecNow ();
+		srandom (1);
+		for (int i = 0; i < create; i++)
+		{
+			char name[50];
+			snprintf (name, 50, "bench_target_%d", i);
+
+			rts2db::ConstTarget tar;
+			tar.setTargetType (TYPE_OPORTUNITY);
+			tar.setTargetName (name);
+			tar.setPosition (360.0 * random () / RAND_MAX, -90 + 180.0 * random () / RAND_MAX);
+			if (tar.save (false))
+			{
+				fprintf (stderr, "cannot create target %s\n", name);
+				return -1;
+			}
+		}
+		printf ("created %d targets in %.0f ms\n", create, (usecNow () - t0) / 1000.0);
+	}
+
+	double t0 = usecNow ();
+	rts2db::TargetSet bulk;
+	bulk.loadByName ("bench_target_%", true);
+	double tBulk = usecNow () - t0;
+
+	std::list <int> ids;
+	for (rts2db::TargetSet::iterator iter = bulk.begin (); iter != bulk.end (); iter++)
+		ids.push_back (iter->first);
+
+	t0 = usecNow ();
+	rts2db::TargetSet single;
+	single.load (ids);
+	double tSingle = usecNow () - t0;
+
+	int diff = 0;
+	for (rts2db::TargetSet::iterator iter = single.begin (); iter != single.end (); iter++)
+	{
+		rts2db::TargetSet::iterator b = bulk.find (iter->first);
+		if (b == bulk.end ()
+			|| strcmp (b->second->getTargetName (), iter->second->getTargetName ())
+			|| b->second->getTargetType () != iter->second->getTargetType ()
+			|| b->second->getTargetEnabled () != iter->second->getTargetEnabled ())
+			diff++;
+	}
+
+	printf ("%lu targets: target by target %.0f ms, bulk %.0f ms (%.2fx), %d differences\n", (unsigned long) bulk.size (), tSingle / 1000.0, tBulk / 1000.0, tSingle / tBulk, diff);
+
+	return 0;
+}
+
+int main (int argc, char **argv)
+{
+	BenchTargetSet app (argc, argv);
+	return app.run ();
+}
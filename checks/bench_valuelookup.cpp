@@ -0,0 +1,150 @@
+/*
+ * Benchmark of value lookup by name. Replays protocol stream of a device
+ * with many values - metainfo followed by repeated info cycles updating all
+ * values - through Connection::processLine, and compares throughput of the
+ * original linear strcasecmp search with the hash index of ValueVector.
+ * Run it with ./bench_valuelookup [cycles].
+ */
+
+#include "block.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+static double usecNow ()
+{
+	struct timeval tv;
+	gettimeofday (&tv, NULL);
+	return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+class BenchBlock:public rts2core::Block
+{
+	public:
+		BenchBlock ():rts2core::Block (0, NULL) {}
+
+		virtual int run () { return 0; }
+
+	protected:
+		virtual rts2core::Connection *createClientConnection (rts2core::NetworkAddress * in_addr) { return NULL; }
+};
+
+/**
+ * Connection processing lines from memory. With legacy set, values are
+ * found by walking the vector, as the original code did.
+ */
+class BenchConnection:public rts2core::Connection
+{
+	public:
+		BenchConnection (rts2core::Block *_master, bool _legacy):rts2core::Connection (_master) { legacy = _legacy; }
+
+		void replay (const std::string &line)
+		{
+			strcpy (buf, line.c_str ());
+			command_start = buf;
+			command_buf_top = buf;
+			processLine ();
+		}
+
+		virtual int commandValue (const char *v_name)
+		{
+			if (!legacy)
+				return rts2core::Connection::commandValue (v_name);
+			for (rts2core::ValueVector::iterator iter = valueBegin (); iter != valueEnd (); iter++)
+			{
+				if ((*iter)->isValue (v_name))
+					return (*iter)->setValue (this);
+			}
+			return -2;
+		}
+
+	private:
+		bool legacy;
+};
+
+// value names similar to names used by devices, with common prefixes
+static std::string valueName (int i)
+{
+	const char *prefixes[] = {"TEL_", "MNT_", "CCD_", "FOC_", "ROT_", "AXIS_", "CORR_", "MODEL_"};
+	char name[50];
+	snprintf (name, sizeof (name), "%s%s%d", prefixes[i % 8], (i % 3) ? "VALUE_" : "", i);
+	return std::string (name);
+}
+
+static void createStream (int numval, int cycles, std::vector <std::string> &meta, std::vector <std::string> &stream)
+{
+	char line[200];
+	for (int i = 0; i < numval; i++)
+	{
+		int t = (i % 4 == 3) ? RTS2_VALUE_INTEGER : ((i % 4 == 2) ? RTS2_VALUE_STRING : RTS2_VALUE_DOUBLE);
+		snprintf (line, sizeof (line), PROTO_METAINFO " %d \"%s\" \"benchmark value %d\"", t | RTS2_VALUE_FITS, valueName (i).c_str (), i);
+		meta.push_back (line);
+	}
+	srandom (1);
+	for (int c = 0; c < cycles; c++)
+	{
+		for (int i = 0; i < numval; i++)
+		{
+			if (i % 4 == 2)
+				snprintf (line, sizeof (line), PROTO_VALUE " %s \"str%ld\"", valueName (i).c_str (), random () % 100);
+			else
+				snprintf (line, sizeof (line), PROTO_VALUE " %s %ld", valueName (i).c_str (), random () % 10000);
+			stream.push_back (line);
+		}
+	}
+}
+
+static double replay (rts2core::Block *block, bool legacy, std::vector <std::string> &meta, std::vector <std::string> &stream, double &check)
+{
+	BenchConnection *conn = new BenchConnection (block, legacy);
+	for (std::vector <std::string>::iterator iter = meta.begin (); iter != meta.end (); iter++)
+		conn->replay (*iter);
+
+	double t0 = usecNow ();
+	for (std::vector <std::string>::iterator iter = stream.begin (); iter != stream.end (); iter++)
+		conn->replay (*iter);
+	double t = usecNow () - t0;
+
+	check = 0;
+	for (int i = 0; i < conn->valueSize (); i++)
+	{
+		// string values are not numbers
+		double v = conn->valueAt (i)->getValueDouble ();
+		if (!std::isnan (v))
+			check += v;
+	}
+
+	delete conn;
+	return t;
+}
+
+int main (int argc, char **argv)
+{
+	int cycles = 200;
+	if (argc > 1)
+		cycles = atoi (argv[1]);
+
+	BenchBlock *block = new BenchBlock ();
+
+	printf ("%8s %10s %16s %16s %9s\n", "values", "lines", "linear [l/s]", "indexed [l/s]", "speedup");
+
+	int numvals[] = {20, 100, 300, 1000, 0};
+	for (int *n = numvals; *n; n++)
+	{
+		std::vector <std::string> meta;
+		std::vector <std::string> stream;
+		// keep number of replayed lines roughly constant
+		createStream (*n, cycles * 300 / *n + 1, meta, stream);
+
+		double lCheck, nCheck;
+		double tLegacy = replay (block, true, meta, stream, lCheck);
+		double tNew = replay (block, false, meta, stream, nCheck);
+
+		printf ("%8d %10lu %16.0f %16.0f %8.2fx%s\n", *n, (unsigned long) stream.size (), stream.size () / tLegacy * 1e6, stream.size () / tNew * 1e6, tLegacy / tNew, (lCheck == nCheck) ? "" : " MISMATCH");
+	}
+
+	delete block;
+	return 0;
+}
@@ -0,0 +1,176 @@
+/*
+ * Benchmark of value update transfer. Sends updates of telescope-like set
+ * of values (doubles, positions, integers and double arrays) over socket
+ * pair and measures how many value messages per second the receiving
+ * connection processes with text and binary value records.
+ * Run it with ./bench_valueproto [cycles].
+ */
+
+#include "block.h"
+#include "valuearray.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+
+static double usecNow ()
+{
+	struct timeval tv;
+	gettimeofday (&tv, NULL);
+	return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+class BenchBlock:public rts2core::Block
+{
+	public:
+		BenchBlock ():rts2core::Block (0, NULL) {}
+
+		virtual int run () { return 0; }
+
+	protected:
+		virtual rts2core::Connection *createClientConnection (rts2core::NetworkAddress * in_addr) { return NULL; }
+};
+
+static void createValues (std::vector <rts2core::Value *> &values)
+{
+	char name[50];
+	for (int i = 0; i < 20; i++)
+	{
+		snprintf (name, sizeof (name), "DOUBLE_%d", i);
+		values.push_back (new rts2core::ValueDouble (name, "double value", false));
+	}
+	for (int i = 0; i < 4; i++)
+	{
+		snprintf (name, sizeof (name), "RADEC_%d", i);
+		values.push_back (new rts2core::ValueRaDec (name, "RA DEC position", false));
+		snprintf (name, sizeof (name), "ALTAZ_%d", i);
+		values.push_back (new rts2core::ValueAltAz (name, "alt-az position", false));
+	}
+	for (int i = 0; i < 8; i++)
+	{
+		snprintf (name, sizeof (name), "INTEGER_%d", i);
+		values.push_back (new rts2core::ValueInteger (name, "integer value", false));
+	}
+	for (int i = 0; i < 2; i++)
+	{
+		snprintf (name, sizeof (name), "ARRAY_%d", i);
+		rts2core::DoubleArray *arr = new rts2core::DoubleArray (name, "sensor array", false);
+		for (int j = 0; j < 16; j++)
+			arr->addValue (j);
+		values.push_back (arr);
+	}
+}
+
+static void updateValues (std::vector <rts2core::Value *> &values, int cycle)
+{
+	for (std::vector <rts2core::Value *>::iterator iter = values.begin (); iter != values.end (); iter++)
+	{
+		double v = cycle * 0.001 + (iter - values.begin ()) / 7.0;
+		if ((*iter)->getValueExtType () == RTS2_VALUE_ARRAY)
+		{
+			std::vector <double> arr;
+			for (int j = 0; j < 16; j++)
+				arr.push_back (v + j * 0.125);
+			((rts2core::DoubleArray *) (*iter))->setValueArray (arr);
+			continue;
+		}
+		switch ((*iter)->getValueType ())
+		{
+			case RTS2_VALUE_DOUBLE:
+				((rts2core::ValueDouble *) (*iter))->setValueDouble (v);
+				break;
+			case RTS2_VALUE_RADEC:
+				((rts2core::ValueRaDec *) (*iter))->setValueRaDec (v, -v / 3.0);
+				break;
+			case RTS2_VALUE_ALTAZ:
+				((rts2core::ValueAltAz *) (*iter))->setValueAltAz (v / 5.0, v);
+				break;
+			case RTS2_VALUE_INTEGER:
+				((rts2core::ValueInteger *) (*iter))->setValueInteger (cycle + (iter - values.begin ()));
+				break;
+		}
+	}
+}
+
+static double transfer (bool binary, int cycles, std::vector <rts2core::Value *> &values, double &check)
+{
+	int sv[2];
+	if (socketpair (AF_UNIX, SOCK_STREAM, 0, sv))
+	{
+		perror ("socketpair");
+		exit (1);
+	}
+	BenchBlock *block = new BenchBlock ();
+	rts2core::Connection *sender = new rts2core::Connection (sv[0], block);
+	rts2core::Connection *receiver = new rts2core::Connection (sv[1], block);
+	block->addConnection (sender);
+	block->addConnection (receiver);
+	sender->setBinaryValues (binary);
+
+	rts2core::ValueInteger *counter = new rts2core::ValueInteger ("counter", "cycle counter", false);
+	counter->sendMetaInfo (sender);
+	for (std::vector <rts2core::Value *>::iterator iter = values.begin (); iter != values.end (); iter++)
+		(*iter)->sendMetaInfo (sender);
+
+	double t0 = usecNow ();
+	for (int c = 1; c <= cycles; c++)
+	{
+		updateValues (values, c);
+		for (std::vector <rts2core::Value *>::iterator iter = values.begin (); iter != values.end (); iter++)
+			(*iter)->send (sender);
+		counter->setValueInteger (c);
+		counter->send (sender);
+		// wait for the receiver to process all updates
+		while (receiver->getValue ("counter") == NULL || receiver->getValueInteger ("counter") != c)
+		{
+			block->setTimeout (1000);
+			block->oneRunLoop ();
+		}
+	}
+	double t = usecNow () - t0;
+
+	check = 0;
+	for (std::vector <rts2core::Value *>::iterator iter = values.begin (); iter != values.end (); iter++)
+	{
+		rts2core::Value *val = receiver->getValue ((*iter)->getName ().c_str ());
+		if (val->getValueExtType () == RTS2_VALUE_ARRAY)
+			check += (*((rts2core::DoubleArray *) val))[15];
+		else if (val->getValueType () == RTS2_VALUE_RADEC)
+			check += ((rts2core::ValueRaDec *) val)->getRa () + ((rts2core::ValueRaDec *) val)->getDec ();
+		else if (val->getValueType () == RTS2_VALUE_ALTAZ)
+			check += ((rts2core::ValueAltAz *) val)->getAlt () + ((rts2core::ValueAltAz *) val)->getAz ();
+		else
+			check += val->getValueDouble ();
+	}
+
+	delete counter;
+	// connections are deleted by block
+	delete block;
+	return t;
+}
+
+int main (int argc, char **argv)
+{
+	int cycles = 5000;
+	if (argc > 1)
+		cycles = atoi (argv[1]);
+
+	std::vector <rts2core::Value *> values;
+	createValues (values);
+
+	// text arrays are send with default stream precision, so checksums differ slightly
+	double tCheck, bCheck;
+	double tText = transfer (false, cycles, values, tCheck);
+	double tBinary = transfer (true, cycles, values, bCheck);
+
+	unsigned long msgs = (unsigned long) cycles * (values.size () + 1);
+
+	printf ("%10s %16s %16s %9s\n", "messages", "text [m/s]", "binary [m/s]", "speedup");
+	printf ("%10lu %16.0f %16.0f %8.2fx%s\n", msgs, msgs / tText * 1e6, msgs / tBinary * 1e6, tText / tBinary, (fabs (tCheck - bCheck) < 1e-6 * fabs (tCheck)) ? "" : " MISMATCH");
+
+	for (std::vector <rts2core::Value *>::iterator iter = values.begin (); iter != values.end (); iter++)
+		delete *iter;
+	return 0;
+}
@@ -0,0 +1,213 @@
+#include "app.h"
+#include "asynclog.h"
+
+#include <check.h>
+#include <check_utils.h>
+
+#include <fstream>
+#include <map>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define PRODUCERS     4
+#define MESSAGES      5000
+
+// timestamps are formatted by master application settings
+class TestApp:public rts2core::App
+{
+	public:
+		TestApp ():rts2core::App (0, NULL) {}
+
+		virtual int run () { return 0; }
+};
+
+TestApp *app = NULL;
+char logname[50];
+
+void setup_asynclog (void)
+{
+	app = new TestApp ();
+	strcpy (logname, "/tmp/check_asynclog_XXXXXX");
+	int fd = mkstemp (logname);
+	ck_assert_int_ge (fd, 0);
+	close (fd);
+}
+
+void teardown_asynclog (void)
+{
+	unlink (logname);
+	delete app;
+	app = NULL;
+}
+
+// returns lines of the log file
+static std::vector <std::string> readLog ()
+{
+	std::vector <std::string> ret;
+	std::ifstream ifs (logname);
+	std::string line;
+	while (std::getline (ifs, line))
+		ret.push_back (line);
+	return ret;
+}
+
+START_TEST(synchronous)
+{
+	rts2core::AsyncLog *alog = new rts2core::AsyncLog (16);
+	ck_assert_int_eq (alog->open (logname), 0);
+
+	// flusher thread is not running, messages are written immediately
+	rts2core::Message msg (1000000000.5, "C0", MESSAGE_INFO, "first message");
+	ck_assert_int_eq (alog->log (msg), 0);
+
+	std::vector <std::string> lines = readLog ();
+	ck_assert_int_eq (lines.size (), 1);
+	ck_assert (lines[0].find (" C0 4 first message") != std::string::npos);
+
+	// more messages than ring slots
+	for (int i = 0; i < 100; i++)
+		ck_assert_int_eq (alog->log (msg), 0);
+
+	delete alog;
+
+	ck_assert_int_eq (readLog ().size (), 101);
+}
+END_TEST
+
+struct producerArg
+{
+	rts2core::AsyncLog *alog;
+	int id;
+};
+
+static void *producer (void *arg)
+{
+	producerArg *pa = (producerArg *) arg;
+	char name[10];
+	char text[50];
+	snprintf (name, 10, "P%d", pa->id);
+	for (int i = 0; i < MESSAGES; i++)
+	{
+		snprintf (text, 50, "%d", i);
+		rts2core::Message msg (name, MESSAGE_DEBUG, text);
+		// do not drop messages in the test
+		while (pa->alog->log (msg))
+			usleep (100);
+	}
+	return NULL;
+}
+
+START_TEST(producers)
+{
+	rts2core::AsyncLog *alog = new rts2core::AsyncLog (256, 0.01);
+	ck_assert_int_eq (alog->open (logname), 0);
+	ck_assert_int_eq (alog->start (), 0);
+	ck_assert (alog->isRunning ());
+
+	pthread_t threads[PRODUCERS];
+	producerArg args[PRODUCERS];
+	for (int i = 0; i < PRODUCERS; i++)
+	{
+		args[i].alog = alog;
+		args[i].id = i;
+		ck_assert_int_eq (pthread_create (threads + i, NULL, producer, args + i), 0);
+	}
+	for (int i = 0; i < PRODUCERS; i++)
+		pthread_join (threads[i], NULL);
+
+	unsigned long dropped = alog->getDropped ();
+
+	delete alog;
+
+	// messages of each producer are in order, without gaps; drop messages are reported
+	std::map <std::string, int> next;
+	int reported = 0;
+	std::vector <std::string> lines = readLog ();
+	for (std::vector <std::string>::iterator iter = lines.begin (); iter != lines.end (); iter++)
+	{
+		if (iter->find ("asynclog") != std::string::npos)
+		{
+			reported++;
+			continue;
+		}
+		char name[10];
+		int type;
+		int n;
+		// timestamp is two words - date and time zone
+		size_t p = iter->find (" P");
+		ck_assert (p != std::string::npos);
+		ck_assert_int_eq (sscanf (iter->c_str () + p, " %9s %d %d", name, &type, &n), 3);
+		ck_assert_int_eq (type, MESSAGE_DEBUG);
+		ck_assert_int_eq (n, next[name]);
+		next[name] = n + 1;
+	}
+	ck_assert_int_eq (next.size (), PRODUCERS);
+	for (std::map <std::string, int>::iterator iter = next.begin (); iter != next.end (); iter++)
+		ck_assert_int_eq (iter->second, MESSAGES);
+	ck_assert (dropped == 0 || reported > 0);
+}
+END_TEST
+
+START_TEST(full_ring)
+{
+	rts2core::AsyncLog *alog = new rts2core::AsyncLog (8, 10);
+	ck_assert_int_eq (alog->open (logname), 0);
+	ck_assert_int_eq (alog->start (), 0);
+
+	// thread waits 10 seconds for messages, unless woken by the ring filling up
+	rts2core::Message msg ("C0", MESSAGE_INFO, "message");
+	int dropped = 0;
+	for (int i = 0; i < 1000; i++)
+	{
+		if (alog->log (msg))
+			dropped++;
+	}
+	ck_assert_int_eq (alog->getDropped (), dropped);
+
+	delete alog;
+
+	std::vector <std::string> lines = readLog ();
+	int written = 0;
+	for (std::vector <std::string>::iterator iter = lines.begin (); iter != lines.end (); iter++)
+	{
+		if (iter->find ("asynclog") == std::string::npos)
+			written++;
+	}
+	ck_assert_int_eq (written + dropped, 1000);
+}
+END_TEST
+
+Suite * asynclog_suite (void)
+{
+	Suite *s;
+	TCase *tc_asynclog;
+
+	s = suite_create ("Asynchronous log");
+	tc_asynclog = tcase_create ("Log ring and flusher thread");
+
+	tcase_add_checked_fixture (tc_asynclog, setup_asynclog, teardown_asynclog);
+	tcase_add_test (tc_asynclog, synchronous);
+	tcase_add_test (tc_asynclog, producers);
+	tcase_add_test (tc_asynclog, full_ring);
+
+	suite_add_tcase (s, tc_asynclog);
+
+	return s;
+}
+
+int main (void)
+{
+	int number_failed;
+	Suite *s;
+	SRunner *sr;
+
+	s = asynclog_suite ();
+	sr = srunner_create (s);
+	srunner_run_all (sr, CK_NORMAL);
+	number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
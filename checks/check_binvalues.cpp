@@ -0,0 +1,289 @@
+#include "block.h"
+#include "valuearray.h"
+
+#include <check.h>
+#include <check_utils.h>
+
+#include <math.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+class TestBlock:public rts2core::Block
+{
+	public:
+		TestBlock ():rts2core::Block (0, NULL) {}
+
+		virtual int run () { return 0; }
+
+	protected:
+		virtual rts2core::Connection *createClientConnection (rts2core::NetworkAddress * in_addr) { return NULL; }
+};
+
+TestBlock *block = NULL;
+rts2core::Connection *sender = NULL;
+rts2core::Connection *receiver = NULL;
+int senderSock = -1;
+
+rts2core::ValueDouble *vd = NULL;
+rts2core::ValueInteger *vi = NULL;
+rts2core::ValueLong *vl = NULL;
+rts2core::ValueRaDec *vradec = NULL;
+rts2core::ValueString *vs = NULL;
+rts2core::DoubleArray *varr = NULL;
+
+void setup_binvalues (void)
+{
+	int sv[2];
+	ck_assert_int_eq (socketpair (AF_UNIX, SOCK_STREAM, 0, sv), 0);
+
+	block = new TestBlock ();
+	senderSock = sv[0];
+	sender = new rts2core::Connection (sv[0], block);
+	receiver = new rts2core::Connection (sv[1], block);
+	block->addConnection (sender);
+	block->addConnection (receiver);
+
+	vd = new rts2core::ValueDouble ("DOUBLE", "double value", false);
+	vi = new rts2core::ValueInteger ("integer", "integer value", false);
+	vl = new rts2core::ValueLong ("LONG", "long value", false);
+	vradec = new rts2core::ValueRaDec ("TEL", "telescope position", false);
+	vs = new rts2core::ValueString ("string", "string value", false);
+	varr = new rts2core::DoubleArray ("array", "array value", false);
+
+	vd->sendMetaInfo (sender);
+	vi->sendMetaInfo (sender);
+	vl->sendMetaInfo (sender);
+	vradec->sendMetaInfo (sender);
+	vs->sendMetaInfo (sender);
+	varr->sendMetaInfo (sender);
+}
+
+void teardown_binvalues (void)
+{
+	delete vd;
+	delete vi;
+	delete vl;
+	delete vradec;
+	delete vs;
+	delete varr;
+	// connections are deleted by block
+	delete block;
+	block = NULL;
+}
+
+// run event loop until all data send by sender are processed by receiver
+static void processAll ()
+{
+	for (int i = 0; i < 10; i++)
+	{
+		block->setTimeout (1000);
+		block->oneRunLoop ();
+	}
+}
+
+START_TEST(binary_values)
+{
+	sender->setBinaryValues (true);
+
+	vd->setValueDouble (1.0 / 3.0);
+	vi->setValueInteger (-12345);
+	vl->setValueLong (1234567890123L);
+	vradec->setValueRaDec (123.456, -67.891);
+	vs->setValueString ("text value");
+	varr->addValue (1.5);
+	varr->addValue (-2.25);
+	varr->addValue (1e-300);
+
+	vd->send (sender);
+	vi->send (sender);
+	vl->send (sender);
+	vradec->send (sender);
+	vs->send (sender);
+	varr->send (sender);
+
+	// second update of the same value uses already assigned index
+	vi->setValueInteger (42);
+	vi->send (sender);
+
+	processAll ();
+
+	ck_assert (receiver->getValue ("double")->getValueDouble () == 1.0 / 3.0);
+	ck_assert_int_eq (receiver->getValueInteger ("INTEGER"), 42);
+	ck_assert (receiver->getValue ("long")->getValueLong () == 1234567890123L);
+	ck_assert_dbl_eq (((rts2core::ValueRaDec *) receiver->getValue ("TEL"))->getRa (), 123.456, 10e-15);
+	ck_assert_dbl_eq (((rts2core::ValueRaDec *) receiver->getValue ("TEL"))->getDec (), -67.891, 10e-15);
+	ck_assert_str_eq (receiver->getValueChar ("string"), "text value");
+
+	rts2core::DoubleArray *rarr = (rts2core::DoubleArray *) receiver->getValue ("array");
+	ck_assert_int_eq (rarr->size (), 3);
+	ck_assert ((*rarr)[0] == 1.5);
+	ck_assert ((*rarr)[1] == -2.25);
+	ck_assert ((*rarr)[2] == 1e-300);
+}
+END_TEST
+
+START_TEST(text_values)
+{
+	vd->setValueDouble (2.5);
+	vi->setValueInteger (7);
+	vd->send (sender);
+	vi->send (sender);
+
+	processAll ();
+
+	ck_assert_dbl_eq (receiver->getValueDouble ("DOUBLE"), 2.5, 10e-15);
+	ck_assert_int_eq (receiver->getValueInteger ("integer"), 7);
+}
+END_TEST
+
+START_TEST(wire_format)
+{
+	int sv[2];
+	ck_assert_int_eq (socketpair (AF_UNIX, SOCK_STREAM, 0, sv), 0);
+	rts2core::Connection *conn = new rts2core::Connection (sv[0], block);
+	block->addConnection (conn);
+	conn->setBinaryValues (true);
+
+	vd->setValueDouble (0.5);
+	vd->send (conn);
+	vd->send (conn);
+	// strings are always send as text
+	vs->setValueString ("a");
+	vs->send (conn);
+
+	char buf[200];
+	ssize_t r = read (sv[1], buf, sizeof (buf));
+	const char *idx = PROTO_VALUE_INDEX " 0 DOUBLE\n";
+	size_t rsize = 1 + 4 + 4 + sizeof (double);
+	const char *str = PROTO_VALUE " string \"a\"\n";
+	ck_assert_int_eq (r, strlen (idx) + 2 * rsize + strlen (str));
+	ck_assert (memcmp (buf, idx, strlen (idx)) == 0);
+
+	char *rec = buf + strlen (idx);
+	ck_assert_int_eq (rec[0], PROTO_BINARY_VALUE);
+	uint32_t rec_size;
+	memcpy (&rec_size, rec + 1, 4);
+	ck_assert_int_eq (rec_size, 4 + sizeof (double));
+	double v;
+	memcpy (&v, rec + 9, sizeof (v));
+	ck_assert (v == 0.5);
+	ck_assert (memcmp (rec, rec + rsize, rsize) == 0);
+	ck_assert (memcmp (rec + 2 * rsize, str, strlen (str)) == 0);
+
+	close (sv[1]);
+}
+END_TEST
+
+START_TEST(split_record)
+{
+	// make sure metainfo is processed
+	processAll ();
+
+	// index assignment and record split across two reads
+	int fd = senderSock;
+	const char *idx = PROTO_VALUE_INDEX " 0 DOUBLE\n";
+	ck_assert_int_eq (write (fd, idx, strlen (idx)), strlen (idx));
+
+	char rec[1 + 4 + 4 + sizeof (double)];
+	uint32_t rec_size = 4 + sizeof (double);
+	uint32_t index = 0;
+	double v = -0.125;
+	rec[0] = PROTO_BINARY_VALUE;
+	memcpy (rec + 1, &rec_size, 4);
+	memcpy (rec + 5, &index, 4);
+	memcpy (rec + 9, &v, sizeof (v));
+
+	ck_assert_int_eq (write (fd, rec, 7), 7);
+	processAll ();
+	ck_assert (std::isnan (receiver->getValueDouble ("DOUBLE")));
+
+	ck_assert_int_eq (write (fd, rec + 7, sizeof (rec) - 7), sizeof (rec) - 7);
+	// text message following binary record
+	const char *msg = PROTO_VALUE " integer 11\n";
+	ck_assert_int_eq (write (fd, msg, strlen (msg)), strlen (msg));
+	processAll ();
+
+	ck_assert (receiver->getValueDouble ("DOUBLE") == -0.125);
+	ck_assert_int_eq (receiver->getValueInteger ("integer"), 11);
+}
+END_TEST
+
+START_TEST(oversized_record)
+{
+	int sv[2];
+	ck_assert_int_eq (socketpair (AF_UNIX, SOCK_STREAM, 0, sv), 0);
+	rts2core::Connection *conn = new rts2core::Connection (sv[0], block);
+	block->addConnection (conn);
+
+	// corrupted record size closes the connection
+	char rec[1 + 4];
+	uint32_t rec_size = 0xffffffff;
+	rec[0] = PROTO_BINARY_VALUE;
+	memcpy (rec + 1, &rec_size, 4);
+	ck_assert_int_eq (write (sv[1], rec, sizeof (rec)), sizeof (rec));
+	processAll ();
+
+	char buf[10];
+	ck_assert_int_eq (recv (sv[1], buf, sizeof (buf), MSG_DONTWAIT), 0);
+
+	close (sv[1]);
+}
+END_TEST
+
+START_TEST(checked_values)
+{
+	int v = 1;
+	rts2core::ValueSelection sel ("selection", "selection value");
+	sel.addSelVal ("a");
+	sel.addSelVal ("b");
+	ck_assert_int_eq (sel.setBinaryValue ((char *) &v, sizeof (v)), 0);
+	ck_assert_int_eq (sel.getValueInteger (), 1);
+	v = 2;
+	ck_assert_int_eq (sel.setBinaryValue ((char *) &v, sizeof (v)), -2);
+	ck_assert_int_eq (sel.getValueInteger (), 1);
+
+	rts2core::ValueBool b ("bool", "boolean value");
+	v = 1;
+	ck_assert_int_eq (b.setBinaryValue ((char *) &v, sizeof (v)), 0);
+	ck_assert (b.getValueBool ());
+	v = 5;
+	ck_assert_int_eq (b.setBinaryValue ((char *) &v, sizeof (v)), -2);
+	ck_assert_int_eq (b.getValueInteger (), 1);
+}
+END_TEST
+
+Suite * binvalues_suite (void)
+{
+	Suite *s;
+	TCase *tc_binvalues;
+
+	s = suite_create ("Binary values");
+	tc_binvalues = tcase_create ("Binary value records");
+
+	tcase_add_checked_fixture (tc_binvalues, setup_binvalues, teardown_binvalues);
+	tcase_add_test (tc_binvalues, binary_values);
+	tcase_add_test (tc_binvalues, text_values);
+	tcase_add_test (tc_binvalues, wire_format);
+	tcase_add_test (tc_binvalues, split_record);
+	tcase_add_test (tc_binvalues, oversized_record);
+	tcase_add_test (tc_binvalues, checked_values);
+
+	suite_add_tcase (s, tc_binvalues);
+
+	return s;
+}
+
+int main (void)
+{
+	int number_failed;
+	Suite *s;
+	SRunner *sr;
+
+	s = binvalues_suite ();
+	sr = srunner_create (s);
+	srunner_run_all (sr, CK_NORMAL);
+	number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
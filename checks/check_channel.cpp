@@ -0,0 +1,158 @@
+#include "rts2fits/channel.h"
+#include "imghdr.h"
+
+#include <check.h>
+#include <check_utils.h>
+
+#include <limits.h>
+#include <stdlib.h>
+
+#define WIDTH     300
+#define HEIGHT    200
+
+rts2image::Channel *channel = NULL;
+uint16_t *data = NULL;
+
+void setup_channel (void)
+{
+	long sizes[2] = {WIDTH, HEIGHT};
+	data = new uint16_t[WIDTH * HEIGHT];
+	srandom (1);
+	for (int i = 0; i < WIDTH * HEIGHT; i++)
+		data[i] = 1000 + random () % 2000 + ((i % 500) == 0 ? 50000 : 0);
+	channel = new rts2image::Channel (0, (char *) data, 2, sizes, RTS2_DATA_USHORT, false);
+}
+
+void teardown_channel (void)
+{
+	delete channel;
+	channel = NULL;
+	delete[] data;
+	data = NULL;
+}
+
+// cuts calculated as Image::getChannelGrayscaleBuffer used to calculate them
+static void referenceCuts (float quantiles, long &low, long &high)
+{
+	long counts[65536];
+	memset (counts, 0, sizeof (counts));
+	for (int i = 0; i < WIDTH * HEIGHT; i++)
+		counts[data[i]]++;
+
+	long s = WIDTH * HEIGHT;
+	long psum = 0;
+	long i;
+	low = 0;
+	high = 0;
+	for (i = 0; i < USHRT_MAX; i++)
+	{
+		psum += counts[i];
+		if (psum > s * quantiles)
+		{
+			low = i;
+			break;
+		}
+	}
+	for (; i < USHRT_MAX; i++)
+	{
+		psum += counts[i];
+		if (psum > s * (1 - quantiles))
+		{
+			high = i;
+			break;
+		}
+	}
+}
+
+START_TEST(histogram)
+{
+	const long *hist = channel->getHistogram ();
+	long sum = 0;
+	for (int i = 0; i < 65536; i++)
+		sum += hist[i];
+	ck_assert_int_eq (sum, WIDTH * HEIGHT);
+	ck_assert_int_eq (hist[0], 0);
+	ck_assert_int_eq (hist[999], 0);
+	ck_assert_int_gt (hist[1000] + hist[1001] + hist[1002], 0);
+
+	// histogram is computed only once
+	ck_assert (channel->getHistogram () == hist);
+}
+END_TEST
+
+START_TEST(quantile_cuts)
+{
+	double low, high;
+	long rlow, rhigh;
+
+	channel->getQuantileCuts (0.005, 0, USHRT_MAX, low, high);
+	referenceCuts (0.005, rlow, rhigh);
+	ck_assert_int_eq (low, rlow);
+	ck_assert_int_eq (high, rhigh);
+	ck_assert_int_gt (low, 1000);
+	ck_assert_int_lt (high, 3000);
+
+	// cached values
+	double low2, high2;
+	channel->getQuantileCuts (0.005, 0, USHRT_MAX, low2, high2);
+	ck_assert (low == low2 && high == high2);
+
+	// outliers are included with smaller quantiles
+	channel->getQuantileCuts (0.001, 0, USHRT_MAX, low, high);
+	referenceCuts (0.001, rlow, rhigh);
+	ck_assert_int_eq (low, rlow);
+	ck_assert_int_eq (high, rhigh);
+	ck_assert_int_gt (high, 50000);
+}
+END_TEST
+
+START_TEST(empty_histogram)
+{
+	long sizes[2] = {10, 10};
+	int32_t idata[100];
+	for (int i = 0; i < 100; i++)
+		idata[i] = i * 1000;
+	rts2image::Channel *ich = new rts2image::Channel (0, (char *) idata, 2, sizes, RTS2_DATA_LONG, false);
+
+	// histogram is not calculated for long data, full range is used
+	double low, high;
+	ich->getQuantileCuts (0.005, INT_MIN, INT_MAX, low, high);
+	ck_assert (low == INT_MIN);
+	ck_assert (high == INT_MAX);
+
+	delete ich;
+}
+END_TEST
+
+Suite * channel_suite (void)
+{
+	Suite *s;
+	TCase *tc_channel;
+
+	s = suite_create ("Channel");
+	tc_channel = tcase_create ("Histogram and cut levels");
+
+	tcase_add_checked_fixture (tc_channel, setup_channel, teardown_channel);
+	tcase_add_test (tc_channel, histogram);
+	tcase_add_test (tc_channel, quantile_cuts);
+	tcase_add_test (tc_channel, empty_histogram);
+
+	suite_add_tcase (s, tc_channel);
+
+	return s;
+}
+
+int main (void)
+{
+	int number_failed;
+	Suite *s;
+	SRunner *sr;
+
+	s = channel_suite ();
+	sr = srunner_create (s);
+	srunner_run_all (sr, CK_NORMAL);
+	number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
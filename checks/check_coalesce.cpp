@@ -0,0 +1,180 @@
+#include "daemon.h"
+
+#include <check.h>
+#include <check_utils.h>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define EVENT_TEST_TIMER   RTS2_LOCAL_EVENT + 1
+
+class TestDaemon:public rts2core::Daemon
+{
+	public:
+		TestDaemon ():rts2core::Daemon (0, NULL)
+		{
+			createValue (dval, "DOUBLE", "double value", false);
+			createValue (ival, "integer", "integer value", false);
+		}
+
+		virtual int run () { return 0; }
+
+		virtual void postEvent (rts2core::Event *event)
+		{
+			if (event->getType () == EVENT_TEST_TIMER)
+			{
+				ival->setValueInteger (5);
+				sendValueAll (ival);
+			}
+			rts2core::Daemon::postEvent (event);
+		}
+
+		rts2core::ValueDouble *dval;
+		rts2core::ValueInteger *ival;
+
+	protected:
+		virtual bool isRunning (rts2core::Connection *conn) { return true; }
+		virtual rts2core::Connection *createClientConnection (rts2core::NetworkAddress * in_addr) { return NULL; }
+};
+
+TestDaemon *testDaemon = NULL;
+rts2core::Connection *conn = NULL;
+int peer = -1;
+
+void setup_coalesce (void)
+{
+	int sv[2];
+	ck_assert_int_eq (socketpair (AF_UNIX, SOCK_STREAM, 0, sv), 0);
+	fcntl (sv[1], F_SETFL, O_NONBLOCK);
+
+	testDaemon = new TestDaemon ();
+	conn = new rts2core::Connection (sv[0], testDaemon);
+	testDaemon->addConnection (conn);
+	testDaemon->callIdle ();
+	peer = sv[1];
+}
+
+void teardown_coalesce (void)
+{
+	close (peer);
+	// connection is deleted by daemon
+	delete testDaemon;
+	testDaemon = NULL;
+	conn = NULL;
+}
+
+static std::string readPeer ()
+{
+	std::string ret;
+	char buf[1000];
+	ssize_t r;
+	while ((r = read (peer, buf, sizeof (buf))) > 0)
+		ret.append (buf, r);
+	return ret;
+}
+
+START_TEST(last_value_wins)
+{
+	std::string rec;
+	for (int i = 1; i <= 10; i++)
+	{
+		testDaemon->ival->setValueInteger (i);
+		testDaemon->sendValueAll (testDaemon->ival);
+		testDaemon->dval->setValueDouble (i / 2.0);
+		testDaemon->sendValueAll (testDaemon->dval);
+	}
+	// nothing is send until end of the loop iteration
+	rec = readPeer ();
+	ck_assert_str_eq (rec.c_str (), "");
+	ck_assert_int_eq (testDaemon->getCoalescedValues (), 18);
+	// counter is available to clients as debug value
+	ck_assert_int_eq (testDaemon->getOwnValue ("coalesced_updates")->getValueLong (), 18);
+
+	testDaemon->callIdle ();
+	rec = readPeer ();
+	ck_assert_str_eq (rec.c_str (), "V integer 10\nV DOUBLE 5.00000000000000000000e+00\n");
+	ck_assert (!testDaemon->ival->needSend ());
+
+	// nothing changed, nothing is send
+	testDaemon->sendValueAll (testDaemon->ival);
+	testDaemon->callIdle ();
+	rec = readPeer ();
+	ck_assert_str_eq (rec.c_str (), "");
+}
+END_TEST
+
+START_TEST(message_order)
+{
+	std::string rec;
+	testDaemon->ival->setValueInteger (1);
+	testDaemon->sendValueAll (testDaemon->ival);
+	// other messages are not overtaking value updates
+	conn->sendMsg ("T test");
+	testDaemon->ival->setValueInteger (2);
+	testDaemon->sendValueAll (testDaemon->ival);
+	testDaemon->callIdle ();
+
+	rec = readPeer ();
+	ck_assert_str_eq (rec.c_str (), "V integer 1\nT test\nV integer 2\n");
+	ck_assert_int_eq (testDaemon->getCoalescedValues (), 0);
+}
+END_TEST
+
+START_TEST(send_all)
+{
+	std::string rec;
+	conn->setSendAll (false);
+	testDaemon->ival->setValueInteger (3);
+	testDaemon->sendValueAll (testDaemon->ival);
+	testDaemon->callIdle ();
+	rec = readPeer ();
+	ck_assert_str_eq (rec.c_str (), "");
+}
+END_TEST
+
+START_TEST(timer_value)
+{
+	std::string rec;
+	testDaemon->addTimer (-1, new rts2core::Event (EVENT_TEST_TIMER));
+	testDaemon->setTimeout (0);
+	// timer is fired in idle, value must be send in the same loop iteration
+	testDaemon->oneRunLoop ();
+	rec = readPeer ();
+	ck_assert_str_eq (rec.c_str (), "V integer 5\n");
+}
+END_TEST
+
+Suite * coalesce_suite (void)
+{
+	Suite *s;
+	TCase *tc_coalesce;
+
+	s = suite_create ("Value coalescing");
+	tc_coalesce = tcase_create ("Pending value updates");
+
+	tcase_add_checked_fixture (tc_coalesce, setup_coalesce, teardown_coalesce);
+	tcase_add_test (tc_coalesce, last_value_wins);
+	tcase_add_test (tc_coalesce, message_order);
+	tcase_add_test (tc_coalesce, send_all);
+	tcase_add_test (tc_coalesce, timer_value);
+
+	suite_add_tcase (s, tc_coalesce);
+
+	return s;
+}
+
+int main (void)
+{
+	int number_failed;
+	Suite *s;
+	SRunner *sr;
+
+	s = coalesce_suite ();
+	sr = srunner_create (s);
+	srunner_run_all (sr, CK_NORMAL);
+	number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,118 @@
+#include "rts2db/constraints.h"
+#include "rts2db/tletarget.h"
+#include "configuration.h"
+
+#include <check.h>
+#include <check_utils.h>
+
+#include <stdlib.h>
+
+// Molniya 1-80, highly eccentric 12 hours orbit
+#define MOLNIYA_TLE "1 21118U 91012A   16128.51284426  .00000072  00000-0  10000-3 0  9999|2 21118  62.7894 230.4529 7171287 282.6416  12.4063  2.00577017184736"
+
+// 2016-05-07 00:00 UT
+#define T_START  1462579200
+
+rts2db::TLETarget *molniya;
+
+void setup_constraints (void)
+{
+	// Ondrejov
+	struct ln_lnlat_posn *observer = rts2core::Configuration::instance ()->getObserver ();
+	observer->lng = 14.7833;
+	observer->lat = 49.9100;
+
+	molniya = new rts2db::TLETarget ();
+	molniya->orbitFromTLE (MOLNIYA_TLE);
+}
+
+void teardown_constraints (void)
+{
+	delete molniya;
+}
+
+/**
+ * Compare satisfied intervals with constraint state sampled every minute.
+ * Samples closer than CONSTRAINT_PRECISION to interval boundaries are
+ * not checked.
+ */
+static void checkIntervals (rts2db::Constraint *cons, rts2db::Target *tar, time_t from, time_t to)
+{
+	rts2db::interval_arr_t intervals;
+	cons->getSatisfiedIntervals (tar, from, to, 60, intervals);
+	ck_assert (intervals.size () > 0);
+
+	for (time_t t = from; t < to; t += 60)
+	{
+		bool inside = false;
+		bool border = false;
+		for (rts2db::interval_arr_t::iterator iter = intervals.begin (); iter != intervals.end (); iter++)
+		{
+			if (t >= iter->first && t < iter->second)
+				inside = true;
+			if (labs (t - iter->first) <= CONSTRAINT_PRECISION || labs (t - iter->second) <= CONSTRAINT_PRECISION)
+				border = true;
+		}
+		if (border)
+			continue;
+		double JD = ln_get_julian_from_timet (&t);
+		ck_assert_msg (cons->satisfy (tar, JD, NULL) == inside, "%s constraint at %ld is %d, intervals report %d", cons->getName (), (long) t, !inside, inside);
+	}
+}
+
+START_TEST(deep_space)
+{
+	// deep space orbit is cached, but still moves too fast for crossing hints
+	ck_assert (!std::isnan (molniya->getEphemerisStep ()));
+	ck_assert (!molniya->isSlowMoving ());
+}
+END_TEST
+
+START_TEST(molniya_airmass)
+{
+	rts2db::ConstraintAirmass airmass;
+	airmass.parse (":2");
+	checkIntervals (&airmass, molniya, T_START, T_START + 2 * 86400);
+}
+END_TEST
+
+START_TEST(molniya_ha)
+{
+	rts2db::ConstraintHA ha;
+	ha.parse ("-30:30");
+	checkIntervals (&ha, molniya, T_START, T_START + 2 * 86400);
+}
+END_TEST
+
+Suite * constraints_suite (void)
+{
+	Suite *s;
+	TCase *tc_constraints;
+
+	s = suite_create ("Constraints");
+	tc_constraints = tcase_create ("Satisfied intervals");
+
+	tcase_add_checked_fixture (tc_constraints, setup_constraints, teardown_constraints);
+	tcase_add_test (tc_constraints, deep_space);
+	tcase_add_test (tc_constraints, molniya_airmass);
+	tcase_add_test (tc_constraints, molniya_ha);
+
+	suite_add_tcase (s, tc_constraints);
+
+	return s;
+}
+
+int main (void)
+{
+	int number_failed;
+	Suite *s;
+	SRunner *sr;
+
+	s = constraints_suite ();
+	sr = srunner_create (s);
+	srunner_run_all (sr, CK_NORMAL);
+	number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,253 @@
+#include "connection.h"
+
+#include <check.h>
+#include <check_utils.h>
+
+#include <string.h>
+#include <sys/wait.h>
+
+#define SEGSIZE   100000
+
+rts2core::DataSharedWrite *shared = NULL;
+
+void setup_shared (void)
+{
+	shared = new rts2core::DataSharedWrite ();
+	ck_assert (shared->create (3, SEGSIZE) != NULL);
+	ck_assert_int_gt (shared->getShmId (), 0);
+}
+
+void teardown_shared (void)
+{
+	delete shared;
+	shared = NULL;
+}
+
+START_TEST(lowest_free)
+{
+	ck_assert_int_eq (shared->addClient (SEGSIZE, 0, 10), 0);
+	ck_assert_int_eq (shared->addClient (SEGSIZE, 0, 10), 1);
+	ck_assert_int_eq (shared->addClient (SEGSIZE, 0, 10), 2);
+	// all segments are used
+	ck_assert_int_eq (shared->addClient (SEGSIZE, 0, 10), -1);
+
+	ck_assert_int_eq (shared->removeClient (1, 10), 0);
+	ck_assert_int_eq (shared->removeClient (1, 10, false), -1);
+	ck_assert_int_eq (shared->addClient (SEGSIZE, 0, 11), 1);
+
+	ck_assert_int_eq (shared->removeClient (2, 10), 0);
+	ck_assert_int_eq (shared->removeClient (0, 10), 0);
+	// lowest free segment is reused first
+	ck_assert_int_eq (shared->addClient (SEGSIZE, 0, 11), 0);
+	ck_assert_int_eq (shared->addClient (SEGSIZE, 0, 11), 2);
+
+	ck_assert_int_eq (shared->getSequence (0), 2);
+	ck_assert_int_eq (shared->getSequence (1), 2);
+	ck_assert_int_eq (shared->getRefs (1), 1);
+}
+END_TEST
+
+START_TEST(reader_data)
+{
+	int seg = shared->addClient (1000, 0, 10);
+	ck_assert_int_eq (seg, 0);
+
+	rts2core::DataSharedRead *shm = new rts2core::DataSharedRead ();
+	ck_assert_int_eq (shm->attach (shared->getShmId ()), 0);
+	rts2core::DataSharedRead *chan = new rts2core::DataSharedRead (shm, seg);
+	ck_assert_int_eq (chan->confirmClient (seg, 10), 0);
+	ck_assert_int_eq (chan->getRestSize (), 1000);
+
+	memset (shared->getChannelData (0), 0x5a, 600);
+	shared->dataWritten (0, 600);
+	ck_assert_int_eq (chan->getRestSize (), 400);
+	ck_assert_int_eq (chan->getDataTop () - chan->getDataBuff (), 600);
+	ck_assert_int_eq (chan->getDataBuff ()[599], 0x5a);
+
+	// data are visible in another process
+	pid_t child = fork ();
+	if (child == 0)
+	{
+		rts2core::DataSharedRead *other = new rts2core::DataSharedRead ();
+		if (other->attach (shared->getShmId ()))
+			_exit (1);
+		rts2core::DataSharedRead *ochan = new rts2core::DataSharedRead (other, seg);
+		if (ochan->getRestSize () != 400 || ochan->getDataBuff ()[0] != 0x5a)
+			_exit (2);
+		// reader releases the segment
+		if (ochan->removeActiveClient (10))
+			_exit (3);
+		delete ochan;
+		delete other;
+		_exit (0);
+	}
+	int status;
+	ck_assert_int_eq (waitpid (child, &status, 0), child);
+	ck_assert (WIFEXITED (status));
+	ck_assert_int_eq (WEXITSTATUS (status), 0);
+	ck_assert_int_eq (shared->getRefs (seg), 0);
+
+	delete chan;
+	delete shm;
+}
+END_TEST
+
+START_TEST(additional_reader)
+{
+	int seg = shared->addClient (1000, 0, 10);
+
+	rts2core::DataSharedRead *shm = new rts2core::DataSharedRead ();
+	ck_assert_int_eq (shm->attach (shared->getShmId ()), 0);
+	rts2core::DataSharedRead *chan = new rts2core::DataSharedRead (shm, seg);
+
+	// reader keeps the frame after the primary client released it
+	ck_assert_int_eq (chan->addActiveClient (20), 0);
+	ck_assert_int_eq (shared->getRefs (seg), 2);
+	ck_assert_int_eq (chan->removeActiveClient (10), 0);
+	ck_assert_int_eq (shared->addClient (1000, 0, 10), 1);
+	ck_assert_int_eq (shared->addClient (1000, 0, 10), 2);
+	ck_assert_int_eq (shared->addClient (1000, 0, 10), -1);
+
+	ck_assert_int_eq (chan->removeActiveClient (20), 0);
+	ck_assert_int_eq (shared->addClient (1000, 0, 10), seg);
+
+	// frame was overwritten, it cannot be locked again
+	ck_assert_int_eq (chan->addActiveClient (20), -1);
+	ck_assert_int_eq (shared->getRefs (seg), 1);
+
+	delete chan;
+	delete shm;
+}
+END_TEST
+
+START_TEST(missing_shared)
+{
+	rts2core::DataSharedRead *shm = new rts2core::DataSharedRead ();
+	ck_assert_int_eq (shm->attach (shared->getShmId () + 1), -1);
+	delete shm;
+}
+END_TEST
+
+START_TEST(live_ids)
+{
+	rts2core::DataSharedWrite *others[15];
+	for (int i = 0; i < 15; i++)
+	{
+		others[i] = new rts2core::DataSharedWrite ();
+		ck_assert (others[i]->create (1, 1000) != NULL);
+		ck_assert_int_ne (others[i]->getShmId (), shared->getShmId ());
+	}
+	// all IDs are used, objects still in use must not be replaced
+	rts2core::DataSharedWrite *more = new rts2core::DataSharedWrite ();
+	ck_assert (more->create (1, 1000) == NULL);
+	delete more;
+
+	ck_assert_int_eq (shared->addClient (1000, 0, 10), 0);
+	rts2core::DataSharedRead *shm = new rts2core::DataSharedRead ();
+	ck_assert_int_eq (shm->attach (shared->getShmId ()), 0);
+	ck_assert_int_eq (shm->getRefs (0), 1);
+	delete shm;
+
+	// released ID can be used again
+	int id = others[7]->getShmId ();
+	delete others[7];
+	others[7] = new rts2core::DataSharedWrite ();
+	ck_assert (others[7]->create (1, 1000) != NULL);
+	ck_assert_int_eq (others[7]->getShmId (), id);
+
+	for (int i = 0; i < 15; i++)
+		delete others[i];
+}
+END_TEST
+
+START_TEST(stale_objects)
+{
+	int fds[2];
+	ck_assert_int_eq (pipe (fds), 0);
+
+	// writer crashes without removing its object
+	pid_t child = fork ();
+	if (child == 0)
+	{
+		rts2core::DataSharedWrite *crashed = new rts2core::DataSharedWrite ();
+		if (crashed->create (1, 1000) == NULL)
+			_exit (1);
+		int id = crashed->getShmId ();
+		if (write (fds[1], &id, sizeof (id)) != sizeof (id))
+			_exit (2);
+		_exit (0);
+	}
+	int status;
+	ck_assert_int_eq (waitpid (child, &status, 0), child);
+	ck_assert (WIFEXITED (status));
+	ck_assert_int_eq (WEXITSTATUS (status), 0);
+
+	int id;
+	ck_assert_int_eq (read (fds[0], &id, sizeof (id)), sizeof (id));
+	close (fds[0]);
+	close (fds[1]);
+
+	rts2core::DataSharedRead *shm = new rts2core::DataSharedRead ();
+	ck_assert_int_eq (shm->attach (id), 0);
+	delete shm;
+
+	// next writer process removes it
+	child = fork ();
+	if (child == 0)
+	{
+		rts2core::DataSharedWrite *next = new rts2core::DataSharedWrite ();
+		if (next->create (1, 1000) == NULL)
+			_exit (1);
+		delete next;
+		_exit (0);
+	}
+	ck_assert_int_eq (waitpid (child, &status, 0), child);
+	ck_assert (WIFEXITED (status));
+	ck_assert_int_eq (WEXITSTATUS (status), 0);
+
+	shm = new rts2core::DataSharedRead ();
+	ck_assert_int_eq (shm->attach (id), -1);
+	delete shm;
+
+	// object of the running process is kept
+	shm = new rts2core::DataSharedRead ();
+	ck_assert_int_eq (shm->attach (shared->getShmId ()), 0);
+	delete shm;
+}
+END_TEST
+
+Suite * datashared_suite (void)
+{
+	Suite *s;
+	TCase *tc_shared;
+
+	s = suite_create ("Shared data");
+	tc_shared = tcase_create ("Shared memory ring");
+
+	tcase_add_checked_fixture (tc_shared, setup_shared, teardown_shared);
+	tcase_add_test (tc_shared, lowest_free);
+	tcase_add_test (tc_shared, reader_data);
+	tcase_add_test (tc_shared, additional_reader);
+	tcase_add_test (tc_shared, missing_shared);
+	tcase_add_test (tc_shared, live_ids);
+	tcase_add_test (tc_shared, stale_objects);
+
+	suite_add_tcase (s, tc_shared);
+
+	return s;
+}
+
+int main (void)
+{
+	int number_failed;
+	Suite *s;
+	SRunner *sr;
+
+	s = datashared_suite ();
+	sr = srunner_create (s);
+	srunner_run_all (sr, CK_NORMAL);
+	number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
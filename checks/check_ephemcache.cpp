@@ -0,0 +1,272 @@
+#include "ephemcache.h"
+#include "configuration.h"
+
+#include <check.h>
+#include <check_utils.h>
+
+#include <stdlib.h>
+
+// 2015-03-20 00:00 UT
+#define JD_START    2457101.5
+
+class StarEphemeris:public rts2core::EphemerisCache
+{
+	public:
+		StarEphemeris (double ra, double dec):rts2core::EphemerisCache () { pos.ra = ra; pos.dec = dec; calls = 0; }
+
+		int calls;
+
+	protected:
+		virtual void computePosition (struct ln_equ_posn *_pos, double JD) { *_pos = pos; calls++; }
+
+	private:
+		struct ln_equ_posn pos;
+};
+
+class ExactSolar:public rts2core::SolarEphemeris
+{
+	public:
+		ExactSolar ():rts2core::SolarEphemeris () {}
+
+		void getExact (struct ln_equ_posn *pos, double JD) { computePosition (pos, JD); }
+};
+
+class ExactLunar:public rts2core::LunarEphemeris
+{
+	public:
+		ExactLunar ():rts2core::LunarEphemeris () {}
+
+		void getExact (struct ln_equ_posn *pos, double JD) { computePosition (pos, JD); }
+};
+
+struct ln_lnlat_posn observer;
+
+void setup_ephemcache (void)
+{
+	// Ondrejov
+	observer.lng = 14.7833;
+	observer.lat = 49.9100;
+}
+
+void teardown_ephemcache (void)
+{
+}
+
+// angular distance in arcsec
+static double arcsecDistance (struct ln_equ_posn *p1, struct ln_equ_posn *p2)
+{
+	return ln_get_angular_separation (p1, p2) * 3600.0;
+}
+
+START_TEST(fixed_altaz)
+{
+	// Vega passes near zenith at Ondrejov
+	StarEphemeris *vega = new StarEphemeris (279.2347, 38.7837);
+	StarEphemeris *polaris = new StarEphemeris (37.9529, 89.2642);
+	StarEphemeris *south = new StarEphemeris (359.9, -30);
+
+	for (double JD = JD_START; JD < JD_START + 1; JD += 0.0013)
+	{
+		StarEphemeris *stars[3] = {vega, polaris, south};
+		for (int i = 0; i < 3; i++)
+		{
+			struct ln_equ_posn pos;
+			struct ln_hrz_posn hrz, exact;
+			stars[i]->getHrzPosition (&hrz, JD, &observer);
+			stars[i]->getEquPosition (&pos, JD);
+			ln_get_hrz_from_equ (&pos, &observer, JD, &exact);
+			ck_assert_dbl_eq (hrz.alt, exact.alt, 5 / 3600.0);
+			// azimuth is compared on sky
+			double daz = fabs (ln_range_degrees (hrz.az - exact.az + 180) - 180) * cos (ln_deg_to_rad (exact.alt));
+			ck_assert_dbl_eq (daz, 0, 5 / 3600.0);
+		}
+	}
+
+	// 24 hours / (16 * 10 minutes) buckets, with 19 samples each
+	ck_assert_int_eq (vega->getMisses (), 10);
+	ck_assert_int_eq (vega->calls, 10 * (EPHEMCACHE_INTERVALS + 3));
+	ck_assert_int_gt (vega->getHits (), 1000);
+
+	delete south;
+	delete polaris;
+	delete vega;
+}
+END_TEST
+
+START_TEST(moving)
+{
+	ExactLunar *moon = new ExactLunar ();
+	ExactSolar *sun = new ExactSolar ();
+
+	double maxMoon = 0;
+	for (double JD = JD_START; JD < JD_START + 3; JD += 0.0017)
+	{
+		struct ln_equ_posn pos, exact;
+		moon->getEquPosition (&pos, JD);
+		moon->getExact (&exact, JD);
+		double d = arcsecDistance (&pos, &exact);
+		if (d > maxMoon)
+			maxMoon = d;
+
+		sun->getEquPosition (&pos, JD);
+		sun->getExact (&exact, JD);
+		ck_assert_dbl_eq (arcsecDistance (&pos, &exact), 0, 0.01);
+	}
+	ck_assert_dbl_eq (maxMoon, 0, 0.1);
+
+	delete sun;
+	delete moon;
+}
+END_TEST
+
+START_TEST(ra_wrap)
+{
+	// Moon crosses RA 0 during this night
+	ExactLunar *moon = new ExactLunar ();
+	bool crossed = false;
+	double lastRa = NAN;
+	for (double JD = JD_START; JD < JD_START + 30; JD += 0.01)
+	{
+		struct ln_equ_posn pos, exact;
+		moon->getEquPosition (&pos, JD);
+		moon->getExact (&exact, JD);
+		ck_assert (pos.ra >= 0 && pos.ra < 360);
+		ck_assert_dbl_eq (arcsecDistance (&pos, &exact), 0, 0.1);
+		if (lastRa > 350 && pos.ra < 10)
+			crossed = true;
+		lastRa = pos.ra;
+	}
+	ck_assert (crossed);
+	delete moon;
+}
+END_TEST
+
+START_TEST(disabled)
+{
+	StarEphemeris *star = new StarEphemeris (10, 20);
+	star->setEnabled (false);
+
+	struct ln_equ_posn pos;
+	struct ln_hrz_posn hrz, exact;
+	star->getEquPosition (&pos, JD_START);
+	star->getHrzPosition (&hrz, JD_START, &observer);
+	ln_get_hrz_from_equ (&pos, &observer, JD_START, &exact);
+
+	ck_assert_dbl_eq (pos.ra, 10, 10e-10);
+	ck_assert_dbl_eq (hrz.alt, exact.alt, 10e-10);
+	ck_assert_int_eq (star->calls, 2);
+	ck_assert_int_eq (star->getMisses (), 0);
+
+	// Sun and Moon caches follow configuration
+	rts2core::Configuration::instance ()->setEphemerisCache (false);
+	ck_assert (!rts2core::SolarEphemeris::instance ()->isEnabled ());
+	rts2core::Configuration::instance ()->setEphemerisCache (true);
+	ck_assert (rts2core::LunarEphemeris::instance ()->isEnabled ());
+
+	delete star;
+}
+END_TEST
+
+START_TEST(clear_observer)
+{
+	StarEphemeris *star = new StarEphemeris (100, 10);
+	struct ln_hrz_posn hrz1, hrz2;
+	star->getHrzPosition (&hrz1, JD_START + 0.3, &observer);
+	ck_assert_int_eq (star->getMisses (), 1);
+
+	// other observer, same equatorial samples
+	struct ln_lnlat_posn other;
+	other.lng = -70.7;
+	other.lat = -30.2;
+	star->getHrzPosition (&hrz2, JD_START + 0.3, &other);
+	ck_assert_int_eq (star->getMisses (), 1);
+	ck_assert (fabs (hrz1.alt - hrz2.alt) > 1);
+
+	struct ln_equ_posn pos;
+	struct ln_hrz_posn exact;
+	pos.ra = 100;
+	pos.dec = 10;
+	ln_get_hrz_from_equ (&pos, &other, JD_START + 0.3, &exact);
+	ck_assert_dbl_eq (hrz2.alt, exact.alt, 5 / 3600.0);
+
+	star->clear ();
+	star->getHrzPosition (&hrz1, JD_START + 0.3, &observer);
+	ck_assert_int_eq (star->getMisses (), 2);
+
+	// old buckets are dropped
+	for (int i = 0; i < 2 * EPHEMCACHE_BUCKETS; i++)
+		star->getEquPosition (&pos, JD_START + i);
+	ck_assert_int_eq (star->getMisses (), 2 + 2 * EPHEMCACHE_BUCKETS);
+
+	delete star;
+}
+END_TEST
+
+START_TEST(lunar_phase)
+{
+	ExactLunar *moon = new ExactLunar ();
+	ExactSolar *sun = new ExactSolar ();
+
+	rts2core::LunarEphemeris *lunar = rts2core::LunarEphemeris::instance ();
+
+	for (double JD = JD_START; JD < JD_START + 30; JD += 0.07)
+	{
+		struct ln_equ_posn m, s, cached;
+		moon->getExact (&m, JD);
+		sun->getExact (&s, JD);
+
+		// mean distances are used, so the phase differs from exact value
+		double phase = lunar->getPhase (JD);
+		ck_assert_dbl_eq (phase, ln_get_lunar_phase (JD), 0.02);
+		ck_assert (phase >= 0 && phase <= 180);
+
+		rts2core::LunarEphemeris::getEquCoords (JD, &cached);
+		ck_assert_dbl_eq (arcsecDistance (&cached, &m), 0, 0.1);
+		rts2core::SolarEphemeris::getEquCoords (JD, &cached);
+		ck_assert_dbl_eq (arcsecDistance (&cached, &s), 0, 0.01);
+	}
+
+	rts2core::Configuration::instance ()->setEphemerisCache (false);
+	ck_assert_dbl_eq (rts2core::LunarEphemeris::instance ()->getPhase (JD_START), ln_get_lunar_phase (JD_START), 10e-10);
+	rts2core::Configuration::instance ()->setEphemerisCache (true);
+
+	delete sun;
+	delete moon;
+}
+END_TEST
+
+Suite * ephemcache_suite (void)
+{
+	Suite *s;
+	TCase *tc_ephemcache;
+
+	s = suite_create ("Ephemeris cache");
+	tc_ephemcache = tcase_create ("Interpolated positions");
+
+	tcase_add_checked_fixture (tc_ephemcache, setup_ephemcache, teardown_ephemcache);
+	tcase_add_test (tc_ephemcache, fixed_altaz);
+	tcase_add_test (tc_ephemcache, moving);
+	tcase_add_test (tc_ephemcache, ra_wrap);
+	tcase_add_test (tc_ephemcache, disabled);
+	tcase_add_test (tc_ephemcache, clear_observer);
+	tcase_add_test (tc_ephemcache, lunar_phase);
+
+	suite_add_tcase (s, tc_ephemcache);
+
+	return s;
+}
+
+int main (void)
+{
+	int number_failed;
+	Suite *s;
+	SRunner *sr;
+
+	s = ephemcache_suite ();
+	sr = srunner_create (s);
+	srunner_run_all (sr, CK_NORMAL);
+	number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -1,4 +1,5 @@
 #include "gpointmodel.h"
+#include "gpointref.h"
 
 #include <check.h>
 #include <check_utils.h>
@@ -6,6 +7,8 @@
 rts2telmodel::GPointModel testGPoint_34 (34);
 rts2telmodel::GPointModel testGPoint_altaz_34 (34);
 rts2telmodel::GPointModel testGPoint_n32 (-32.53);
+rts2telmodel::GPointModel testGPoint_gem_extra (49.91);
+rts2telmodel::GPointModel testGPoint_altaz_extra (19.82);
 
 void setup_gpoint (void)
 {
@@ -18,6 +21,32 @@ void setup_gpoint (void)
 	std::istringstream iss3 ("RTS2_ALTAZ -32.9560351668\" -0.378603669032\" 3.69867556175\" -22.4029458503\" -6.3810740497\" -15.8279575851\" 9.97752718308\"\nAZ	6.52266606181\"	sincos	az;el	2.0;2.0\nAZ	2.86981868859\"	sincos	el;az	5.0;3.0\nEL	-0.142425289668\"	sincos	az;el	4.0;4.0\nEL	1.42907527224\"	sin	az	1.0");
 	testGPoint_n32.load (iss3);
 
+	std::istringstream iss4 ("RTS2_MODEL 10\" -5\" 3\" 2\" -8\" 4\" 1\" -2\" 6\"\nHA 5\" sin ha 2\nHA 3\" cos dec 1.5\nHA 2\" sincos ha;dec 3;1\nDEC 4\" coscos az;el 2;2\nDEC 1\" tanh dec 0.5\nDEC -2\" offset ha");
+	testGPoint_gem_extra.load (iss4);
+
+	std::istringstream iss5 ("RTS2_ALTAZ 12\" 3\" -4\" 5\" 2\" -7\" 9\"\nAZ 6\" abssin az 3\nAZ 2\" sec el 1\nAZ 1\" cosh ha 0.25\nEL 3\" sinsin az;zd 2;4\nEL -4\" tan zd 0.5\nEL 2\" cot el 1\nEL 5\" sin pd 1\nEL 1\" coth dec 2");
+	testGPoint_altaz_extra.load (iss5);
+}
+
+static void referenceReverse (rts2telmodel::GPointModel &model, double az, double alt, double &ha, double &dec)
+{
+	long double az_r = ln_deg_to_rad (az);
+	long double el_r = ln_deg_to_rad (alt);
+	long double ha_r = ln_deg_to_rad (ha);
+	long double dec_r = ln_deg_to_rad (dec);
+	long double lat_r = model.getLatitudeRadians ();
+
+	long double d_tar = dec_r + model.params[0] + model.params[1] * cosl (ha_r) + model.params[2] * sinl (ha_r) + model.params[3] * (cosl (lat_r) * sinl (dec_r) * cosl (ha_r) - sinl (lat_r) * cosl (dec_r)) + model.params[8] * cosl (ha_r);
+	long double r_tar = ha_r + model.params[4] + model.params[5] / cosl (dec_r) + model.params[6] * tanl (dec_r) + (model.params[1] * sinl (ha_r) - model.params[2] * cosl (ha_r)) * tanl (dec_r) + model.params[3] * cosl (lat_r) * sinl (ha_r) / cosl (dec_r) + model.params[7] * (sinl (lat_r) * tanl (dec_r) + cosl (lat_r) * cosl (ha_r));
+
+	std::list <rts2telmodel::ExtraParam *>::iterator it;
+	for (it = model.extraParamsHa.begin (); it != model.extraParamsHa.end (); it++)
+		r_tar += (*it)->getValue (az_r, el_r, ha_r, dec_r);
+	for (it = model.extraParamsDec.begin (); it != model.extraParamsDec.end (); it++)
+		d_tar += (*it)->getValue (az_r, el_r, ha_r, dec_r);
+
+	ha = ln_rad_to_deg (r_tar);
+	dec = ln_rad_to_deg (d_tar);
 }
 
 void teardown_gpoint (void)
@@ -2099,6 +2128,86 @@ START_TEST(model_n32)
 }
 END_TEST
 
+START_TEST(model_compiled)
+{
+	const size_t n = 500;
+	double az[n], alt[n], ha[n], dec[n], err_az[n], err_alt[n];
+
+	srandom (1);
+	for (size_t i = 0; i < n; i++)
+	{
+		az[i] = 360.0 * random () / RAND_MAX;
+		alt[i] = 5 + 84.0 * random () / RAND_MAX;
+		ha[i] = -180 + 360.0 * random () / RAND_MAX;
+		dec[i] = -85 + 170.0 * random () / RAND_MAX;
+	}
+
+	rts2telmodel::GPointModel *models[] = {&testGPoint_altaz_34, &testGPoint_n32, &testGPoint_altaz_extra};
+
+	for (int m = 0; m < 3; m++)
+	{
+		double b_az[n], b_alt[n];
+		memcpy (b_az, az, sizeof (az));
+		memcpy (b_alt, alt, sizeof (alt));
+		models[m]->getErrAltAz (n, b_az, b_alt, ha, dec, err_az, err_alt);
+
+		for (size_t i = 0; i < n; i++)
+		{
+			struct ln_hrz_posn hrz, err;
+			struct ln_equ_posn equ;
+			hrz.az = az[i];
+			hrz.alt = alt[i];
+			equ.ra = ha[i];
+			equ.dec = dec[i];
+			models[m]->getErrAltAz (&hrz, &equ, &err);
+
+			ck_assert_dbl_eq (hrz.az, b_az[i], 10e-12);
+			ck_assert_dbl_eq (hrz.alt, b_alt[i], 10e-12);
+			ck_assert_dbl_eq (err.az, err_az[i], 10e-12);
+			ck_assert_dbl_eq (err.alt, err_alt[i], 10e-12);
+
+			double r_az, r_alt;
+			referenceErrAltAz (*models[m], az[i], alt[i], ha[i], dec[i], r_az, r_alt);
+			ck_assert_dbl_eq (err.az, r_az, 10e-9);
+			ck_assert_dbl_eq (err.alt, r_alt, 10e-9);
+		}
+	}
+
+	double b_ha[n], b_dec[n];
+	memcpy (b_ha, ha, sizeof (ha));
+	memcpy (b_dec, dec, sizeof (dec));
+	testGPoint_gem_extra.reverse (n, b_ha, b_dec, az, alt);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		struct ln_hrz_posn hrz;
+		struct ln_equ_posn pos;
+		hrz.az = az[i];
+		hrz.alt = alt[i];
+		pos.ra = ha[i];
+		pos.dec = dec[i];
+		testGPoint_gem_extra.reverse (&pos, &hrz);
+
+		ck_assert_dbl_eq (pos.ra, b_ha[i], 10e-12);
+		ck_assert_dbl_eq (pos.dec, b_dec[i], 10e-12);
+
+		double r_ha = ha[i], r_dec = dec[i];
+		referenceReverse (testGPoint_gem_extra, az[i], alt[i], r_ha, r_dec);
+		ck_assert_dbl_eq (pos.ra, r_ha, 10e-9);
+		ck_assert_dbl_eq (pos.dec, r_dec, 10e-9);
+
+		// apply reverts model without extra terms
+		double a_ha = ha[i], a_dec = dec[i];
+		testGPoint_34.apply (1, &a_ha, &a_dec);
+		pos.ra = ha[i];
+		pos.dec = dec[i];
+		testGPoint_34.apply (&pos);
+		ck_assert_dbl_eq (pos.ra, a_ha, 10e-12);
+		ck_assert_dbl_eq (pos.dec, a_dec, 10e-12);
+	}
+}
+END_TEST
+
 Suite * gpoint_suite (void)
 {
 	Suite *s;
@@ -2110,6 +2219,7 @@ Suite * gpoint_suite (void)
 	tcase_add_checked_fixture (tc_gpoint, setup_gpoint, teardown_gpoint);
 	tcase_add_test (tc_gpoint, model_altaz_34);
 	tcase_add_test (tc_gpoint, model_n32);
+	tcase_add_test (tc_gpoint, model_compiled);
 	suite_add_tcase (s, tc_gpoint);
 
 	return s;
@@ -0,0 +1,144 @@
+#include "objectcheck.h"
+
+#include <check.h>
+#include <check_utils.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <libnova/libnova.h>
+
+static ObjectCheck *checker = NULL;
+
+// horizon entries, same as written to the horizon file
+static double hor_az[] = {5, 10, 10.02, 45.5, 90, 90.05, 180, 270.25, 300, 359.95};
+static double hor_alt[] = {10, 12, 15, 20, 5, 30, 0, 12, 25, 11};
+
+#define HOR_SIZE   (sizeof (hor_az) / sizeof (hor_az[0]))
+
+void setup_horizon (void)
+{
+	char fn[] = "/tmp/check_horizon_XXXXXX";
+	int fd = mkstemp (fn);
+	FILE *f = fdopen (fd, "w");
+	fprintf (f, "AZ-ALT\n");
+	// entries are sorted on load
+	for (int i = HOR_SIZE - 1; i >= 0; i--)
+		fprintf (f, "%f %+f\n", hor_az[i], hor_alt[i]);
+	fclose (f);
+
+	checker = new ObjectCheck (fn);
+	unlink (fn);
+}
+
+void teardown_horizon (void)
+{
+	delete checker;
+	checker = NULL;
+}
+
+// linear search of the horizon, as used before azimuth index
+static double linearHeight (double az)
+{
+	int i1, i2;
+	if (az < hor_az[0])
+	{
+		i1 = HOR_SIZE - 1;
+		i2 = 0;
+	}
+	else
+	{
+		i1 = 0;
+		for (i2 = 1; i2 < (int) HOR_SIZE; i2++)
+		{
+			if (hor_az[i2] > az)
+				break;
+			i1 = i2;
+		}
+		if (i2 == (int) HOR_SIZE)
+			i2 = 0;
+	}
+	double az1 = hor_az[i1] > hor_az[i2] ? hor_az[i1] - 360.0 : hor_az[i1];
+	return hor_alt[i1] + ln_range_degrees (az - az1) * (hor_alt[i2] - hor_alt[i1]) / (hor_az[i2] - az1);
+}
+
+START_TEST(horizon_height)
+{
+	double az[] = {0, 2.5, 5, 10, 10.05, 45.5, 89.99, 90, 90.04, 90.05, 179.99999, 270.25, 359.94, 359.95, 359.99, 360, 365, -0.01};
+	struct ln_hrz_posn hrz;
+	hrz.alt = 0;
+
+	for (size_t i = 0; i < sizeof (az) / sizeof (az[0]); i++)
+	{
+		hrz.az = az[i];
+		ck_assert_dbl_eq (checker->getHorizonHeight (&hrz, 0), linearHeight (az[i]), 10e-10);
+	}
+
+	srandom (1);
+	for (int i = 0; i < 10000; i++)
+	{
+		hrz.az = 360.0 * random () / RAND_MAX;
+		ck_assert_dbl_eq (checker->getHorizonHeight (&hrz, 0), linearHeight (hrz.az), 10e-10);
+	}
+}
+END_TEST
+
+START_TEST(horizon_batch)
+{
+	double az[1000];
+	double alt[1000];
+	double heights[1000];
+	int good[1000];
+
+	srandom (2);
+	for (int i = 0; i < 1000; i++)
+	{
+		az[i] = 360.0 * random () / RAND_MAX;
+		alt[i] = 40.0 * random () / RAND_MAX;
+	}
+
+	checker->getHorizonHeight (1000, az, heights, 0);
+	checker->is_good (1000, alt, az, good);
+
+	for (int i = 0; i < 1000; i++)
+	{
+		struct ln_hrz_posn hrz;
+		hrz.az = az[i];
+		hrz.alt = alt[i];
+		ck_assert_dbl_eq (heights[i], checker->getHorizonHeight (&hrz, 0), 10e-10);
+		ck_assert_int_eq (good[i], checker->is_good (&hrz));
+	}
+}
+END_TEST
+
+Suite * horizon_suite (void)
+{
+	Suite *s;
+	TCase *tc_horizon;
+
+	s = suite_create ("Horizon");
+	tc_horizon = tcase_create ("Horizon height");
+
+	tcase_add_checked_fixture (tc_horizon, setup_horizon, teardown_horizon);
+	tcase_add_test (tc_horizon, horizon_height);
+	tcase_add_test (tc_horizon, horizon_batch);
+	suite_add_tcase (s, tc_horizon);
+
+	return s;
+}
+
+int main (void)
+{
+	int number_failed;
+	Suite *s;
+	SRunner *sr;
+
+	s = horizon_suite ();
+	sr = srunner_create (s);
+	srunner_run_all (sr, CK_NORMAL);
+	number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,230 @@
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "pixelstat.h"
+
+#include <check.h>
+#include <check_utils.h>
+
+#include <map>
+
+rts2camd::PixelStatistics *pixstat = NULL;
+
+void setup_pixelstat (void)
+{
+	pixstat = new rts2camd::PixelStatistics ();
+}
+
+void teardown_pixelstat (void)
+{
+	delete pixstat;
+	pixstat = NULL;
+}
+
+// fills data with pseudo-random values
+template <typename t> void fill (t *data, size_t n, long low, long range)
+{
+	srandom (42);
+	// make distribution peaked, so mode is well defined
+	for (size_t i = 0; i < n; i++)
+		data[i] = low + (random () % range + random () % range) / 2;
+}
+
+// returns reference mode of values in [low, high)
+template <typename t> long referenceMode (t *data, size_t n, double low, double high)
+{
+	std::map <long, long> counts;
+	for (size_t i = 0; i < n; i++)
+	{
+		if (data[i] >= low && data[i] < high)
+			counts[(long) data[i]]++;
+	}
+	long mode = 0, modeCnt = 0;
+	for (std::map <long, long>::iterator iter = counts.begin (); iter != counts.end (); iter++)
+	{
+		if (iter->second > modeCnt)
+		{
+			mode = iter->first;
+			modeCnt = iter->second;
+		}
+	}
+	return mode;
+}
+
+template <typename t> void reference (t *data, size_t n, double &sum, double &min, double &max)
+{
+	sum = 0;
+	min = data[0];
+	max = data[0];
+	for (size_t i = 0; i < n; i++)
+	{
+		sum += data[i];
+		if (data[i] < min)
+			min = data[i];
+		if (data[i] > max)
+			max = data[i];
+	}
+}
+
+START_TEST(stat_ushort)
+{
+	size_t n = 512 * 1024 + 13;
+	uint16_t *data = new uint16_t[n];
+	fill (data, n, 1000, 2000);
+	long mode = referenceMode (data, n, 0, 65536);
+	double sum, min, max;
+	reference (data, n, sum, min, max);
+
+	// single large chunk uses blocked histogram
+	ck_assert_int_eq (pixstat->update (data, n * sizeof (uint16_t), true), n);
+	ck_assert_dbl_eq (pixstat->getSum (), sum, 0.5);
+	ck_assert_dbl_eq (pixstat->getMin (), min, 0.5);
+	ck_assert_dbl_eq (pixstat->getMax (), max, 0.5);
+	ck_assert (pixstat->haveMode ());
+	ck_assert_int_eq (pixstat->getMode (), mode);
+
+	// the same data in small chunks uses direct histogram
+	pixstat->resetStatistics ();
+	pixstat->resetMode ();
+	for (size_t i = 0; i < n; i += 1000)
+		pixstat->update (data + i, ((n - i) < 1000 ? (n - i) : 1000) * sizeof (uint16_t), true);
+	ck_assert_int_eq (pixstat->getPixels (), n);
+	ck_assert_dbl_eq (pixstat->getSum (), sum, 0.5);
+	ck_assert_int_eq (pixstat->getMode (), mode);
+
+	delete[] data;
+}
+END_TEST
+
+START_TEST(stat_signed)
+{
+	size_t n = 300000;
+	int16_t *data = new int16_t[n];
+	fill (data, n, -500, 800);
+	long mode = referenceMode (data, n, -32768, 32768);
+	double sum, min, max;
+	reference (data, n, sum, min, max);
+
+	pixstat->update (data, n * sizeof (int16_t), true);
+	ck_assert_dbl_eq (pixstat->getSum (), sum, 0.5);
+	ck_assert_dbl_eq (pixstat->getMin (), min, 0.5);
+	ck_assert_dbl_eq (pixstat->getMax (), max, 0.5);
+	ck_assert_int_eq (pixstat->getMode (), mode);
+
+	delete[] data;
+}
+END_TEST
+
+START_TEST(stat_float)
+{
+	size_t n = 300007;
+	float *data = new float[n];
+	fill (data, n, 100, 300);
+	// values outside of histogram are not counted for mode
+	data[7] = -20;
+	data[8] = 1e6;
+	long mode = referenceMode (data, n, 0, 65536);
+	double sum, min, max;
+	reference (data, n, sum, min, max);
+
+	pixstat->update (data, n * sizeof (float), true);
+	ck_assert_dbl_eq (pixstat->getSum (), sum, 1e-3);
+	ck_assert_dbl_eq (pixstat->getMin (), -20, 1e-6);
+	ck_assert_dbl_eq (pixstat->getMax (), 1e6, 1e-6);
+	ck_assert_int_eq (pixstat->getMode (), mode);
+
+	delete[] data;
+}
+END_TEST
+
+START_TEST(merge)
+{
+	size_t n = 400000;
+	uint16_t *data = new uint16_t[n];
+	fill (data, n, 2000, 500);
+	long mode = referenceMode (data, n, 0, 65536);
+	double sum, min, max;
+	reference (data, n, sum, min, max);
+
+	// chunks processed independently, as in readout pipeline
+	for (size_t i = 0; i < n; i += 100000)
+	{
+		rts2camd::PixelStatistics chunk;
+		chunk.update (data + i, 100000 * sizeof (uint16_t), true);
+		pixstat->merge (chunk);
+	}
+	ck_assert_int_eq (pixstat->getPixels (), n);
+	ck_assert_dbl_eq (pixstat->getSum (), sum, 0.5);
+	ck_assert_dbl_eq (pixstat->getMin (), min, 0.5);
+	ck_assert_dbl_eq (pixstat->getMax (), max, 0.5);
+	ck_assert_int_eq (pixstat->getMode (), mode);
+
+	delete[] data;
+}
+END_TEST
+
+START_TEST(center)
+{
+	int w = 100, h = 80;
+	uint16_t *data = new uint16_t[w * h];
+	for (int i = 0; i < w * h; i++)
+		data[i] = 10;
+	// star at 30,40
+	data[40 * w + 30] = 1000;
+	data[40 * w + 31] = 500;
+	data[41 * w + 30] = 500;
+
+	pixstat->setCenterBox (20, 30, 20, 20, w, 100);
+	pixstat->update (data, w * h * sizeof (uint16_t), false);
+	ck_assert (pixstat->isCenterCalculated ());
+	ck_assert (!pixstat->haveMode ());
+	ck_assert_int_eq (pixstat->getCenterSumsX ().size (), 20);
+	ck_assert_int_eq (pixstat->getCenterSumsY ().size (), 20);
+	ck_assert_dbl_eq (pixstat->getCenterSumsX ()[10], 1500, 1e-6);
+	ck_assert_dbl_eq (pixstat->getCenterSumsX ()[11], 500, 1e-6);
+	ck_assert_dbl_eq (pixstat->getCenterSumsY ()[10], 1500, 1e-6);
+	ck_assert_dbl_eq (pixstat->getCenterMax (), 1000, 1e-6);
+	ck_assert_dbl_eq (pixstat->getCenterAverage (), 2000 / 3.0, 1e-6);
+
+	// box outside of data
+	pixstat->setCenterBox (90, 30, 20, 20, w, 100);
+	pixstat->update (data, w * h * sizeof (uint16_t), false);
+	ck_assert (!pixstat->isCenterCalculated ());
+
+	delete[] data;
+}
+END_TEST
+
+Suite * pixelstat_suite (void)
+{
+	Suite *s;
+	TCase *tc_pixelstat;
+
+	s = suite_create ("PixelStatistics");
+	tc_pixelstat = tcase_create ("Pixel statistics");
+
+	tcase_add_checked_fixture (tc_pixelstat, setup_pixelstat, teardown_pixelstat);
+	tcase_add_test (tc_pixelstat, stat_ushort);
+	tcase_add_test (tc_pixelstat, stat_signed);
+	tcase_add_test (tc_pixelstat, stat_float);
+	tcase_add_test (tc_pixelstat, merge);
+	tcase_add_test (tc_pixelstat, center);
+	suite_add_tcase (s, tc_pixelstat);
+
+	return s;
+}
+
+int main (void)
+{
+	int number_failed;
+	Suite *s;
+	SRunner *sr;
+
+	s = pixelstat_suite ();
+	sr = srunner_create (s);
+	srunner_run_all (sr, CK_NORMAL);
+	number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
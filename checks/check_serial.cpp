@@ -0,0 +1,295 @@
+#include "block.h"
+#include "connection/serial.h"
+
+#include <check.h>
+#include <check_utils.h>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+class TestBlock:public rts2core::Block
+{
+	public:
+		TestBlock ():rts2core::Block (0, NULL) {}
+
+		virtual int run () { return 0; }
+
+	protected:
+		virtual rts2core::Connection *createClientConnection (rts2core::NetworkAddress * in_addr) { return NULL; }
+};
+
+static std::vector <std::string> replies;
+
+class TestCommand:public rts2core::SerialCommand
+{
+	public:
+		TestCommand (const char *_cmd, const char *_endChar, int _replyLen = 0, double _timeout = 2):rts2core::SerialCommand (_cmd, strlen (_cmd), _endChar, _replyLen, _timeout) {}
+
+		virtual void replyReceived (const char *reply, int len) { replies.push_back (std::string (reply, len)); }
+		virtual void commandFailed (const char *reply, int len) { replies.push_back ("failed"); }
+};
+
+TestBlock *block = NULL;
+rts2core::ConnSerial *conn = NULL;
+
+// master side of the pty, where LX200-like device is emulated
+int ptm = -1;
+std::string emuIn;
+std::vector <std::string> pending;
+// device replies after it receives that many commands
+size_t emuBatch = 1;
+size_t emuMaxPending = 0;
+
+void setup_serial (void)
+{
+	ptm = posix_openpt (O_RDWR | O_NOCTTY);
+	ck_assert_int_ge (ptm, 0);
+	ck_assert_int_eq (grantpt (ptm), 0);
+	ck_assert_int_eq (unlockpt (ptm), 0);
+	fcntl (ptm, F_SETFL, O_NONBLOCK);
+
+	block = new TestBlock ();
+	conn = new rts2core::ConnSerial (ptsname (ptm), block, rts2core::BS9600, rts2core::C8, rts2core::NONE, 5);
+	ck_assert_int_eq (conn->init (), 0);
+
+	replies.clear ();
+	emuIn.clear ();
+	pending.clear ();
+	emuBatch = 1;
+	emuMaxPending = 0;
+}
+
+void teardown_serial (void)
+{
+	// connection is deleted by block
+	delete block;
+	block = NULL;
+	conn = NULL;
+	if (ptm >= 0)
+		close (ptm);
+}
+
+static void emulate ()
+{
+	char buf[100];
+	ssize_t r;
+	while ((r = read (ptm, buf, sizeof (buf))) > 0)
+		emuIn.append (buf, r);
+
+	size_t pos;
+	while ((pos = emuIn.find ('#')) != std::string::npos)
+	{
+		std::string cmd = emuIn.substr (0, pos + 1);
+		emuIn.erase (0, pos + 1);
+		// commands without reply
+		if (cmd == ":Q#" || cmd == ":S#")
+			continue;
+		pending.push_back (cmd);
+	}
+
+	if (pending.size () > emuMaxPending)
+		emuMaxPending = pending.size ();
+
+	if (pending.size () < emuBatch)
+		return;
+
+	std::string reply;
+	for (std::vector <std::string>::iterator iter = pending.begin (); iter != pending.end (); iter++)
+	{
+		if (*iter == ":GR#")
+			reply += "12:34:56#";
+		else if (*iter == ":GD#")
+			reply += "+45*30:00#";
+		else if (*iter == ":X#")
+			reply += "1";
+	}
+	pending.clear ();
+	ck_assert_int_eq (write (ptm, reply.data (), reply.length ()), reply.length ());
+}
+
+// run event loop until given number of replies is received
+static void runLoop (size_t nreplies)
+{
+	for (int i = 0; i < 1000 && replies.size () < nreplies; i++)
+	{
+		emulate ();
+		block->setTimeout (10000);
+		block->oneRunLoop ();
+	}
+}
+
+START_TEST(async_reply)
+{
+	ck_assert_int_eq (conn->setAsync (), 0);
+
+	conn->queSerialCommand (new TestCommand (":GR#", "#"));
+	conn->queSerialCommand (new TestCommand (":GD#", "#"));
+	ck_assert_int_eq (conn->getSerialQueueSize (), 2);
+
+	runLoop (2);
+
+	ck_assert_int_eq (replies.size (), 2);
+	ck_assert_str_eq (replies[0].c_str (), "12:34:56");
+	ck_assert_str_eq (replies[1].c_str (), "+45*30:00");
+	ck_assert_int_eq (conn->getSerialQueueSize (), 0);
+	// second command was written after reply to the first
+	ck_assert_int_eq (emuMaxPending, 1);
+}
+END_TEST
+
+START_TEST(pipelined)
+{
+	ck_assert_int_eq (conn->setAsync (3), 0);
+	emuBatch = 3;
+
+	conn->queSerialCommand (new TestCommand (":GR#", "#"));
+	conn->queSerialCommand (new TestCommand (":X#", NULL, 1));
+	conn->queSerialCommand (new TestCommand (":GD#", "#"));
+	conn->queSerialCommand (new TestCommand (":GR#", "#"));
+
+	runLoop (3);
+
+	ck_assert_int_eq (replies.size (), 3);
+	ck_assert_int_eq (emuMaxPending, 3);
+	ck_assert_str_eq (replies[0].c_str (), "12:34:56");
+	ck_assert_str_eq (replies[1].c_str (), "1");
+	ck_assert_str_eq (replies[2].c_str (), "+45*30:00");
+
+	// the last command is pending in the device
+	ck_assert_int_eq (conn->getSerialQueueSize (), 1);
+	emuBatch = 1;
+	runLoop (4);
+	ck_assert_int_eq (replies.size (), 4);
+	ck_assert_str_eq (replies[3].c_str (), "12:34:56");
+}
+END_TEST
+
+START_TEST(timeout)
+{
+	ck_assert_int_eq (conn->setAsync (), 0);
+
+	double t = getNow ();
+	conn->queSerialCommand (new TestCommand (":S#", "#", 0, 0.2));
+	conn->queSerialCommand (new TestCommand (":Q#", NULL));
+	conn->queSerialCommand (new TestCommand (":GR#", "#"));
+
+	runLoop (3);
+
+	ck_assert_int_eq (replies.size (), 3);
+	ck_assert_str_eq (replies[0].c_str (), "failed");
+	ck_assert_str_eq (replies[1].c_str (), "");
+	ck_assert_str_eq (replies[2].c_str (), "12:34:56");
+	// event loop was woken up by the timeout timer
+	ck_assert (getNow () - t < 1);
+}
+END_TEST
+
+START_TEST(hangup)
+{
+	ck_assert_int_eq (conn->setAsync (), 0);
+
+	conn->queSerialCommand (new TestCommand (":GR#", "#"));
+	// device disconnected
+	close (ptm);
+	ptm = -1;
+	for (int i = 0; i < 10 && replies.size () < 1; i++)
+	{
+		block->setTimeout (10000);
+		block->oneRunLoop ();
+	}
+	ck_assert_int_eq (replies.size (), 1);
+	ck_assert_str_eq (replies[0].c_str (), "failed");
+	ck_assert_int_eq (conn->getSerialQueueSize (), 0);
+
+	// commands on closed port fail in the next loop
+	conn->queSerialCommand (new TestCommand (":GD#", "#"));
+	ck_assert_int_eq (replies.size (), 1);
+	block->setTimeout (10000);
+	block->oneRunLoop ();
+	ck_assert_int_eq (replies.size (), 2);
+	ck_assert_str_eq (replies[1].c_str (), "failed");
+}
+END_TEST
+
+static int retryDepth = 0;
+static int retryMaxDepth = 0;
+
+// queue the same command again on failure, as drivers retrying commands do
+class RetryCommand:public TestCommand
+{
+	public:
+		RetryCommand (int _retries):TestCommand (":GR#", "#") { retries = _retries; }
+
+		virtual void commandFailed (const char *reply, int len)
+		{
+			retryDepth++;
+			if (retryDepth > retryMaxDepth)
+				retryMaxDepth = retryDepth;
+			TestCommand::commandFailed (reply, len);
+			if (retries > 0)
+				conn->queSerialCommand (new RetryCommand (retries - 1));
+			retryDepth--;
+		}
+
+	private:
+		int retries;
+};
+
+START_TEST(retry_closed)
+{
+	ck_assert_int_eq (conn->setAsync (), 0);
+
+	conn->queSerialCommand (new RetryCommand (5));
+	// device disconnected
+	close (ptm);
+	ptm = -1;
+	for (int i = 0; i < 20 && replies.size () < 6; i++)
+	{
+		block->setTimeout (10000);
+		block->oneRunLoop ();
+	}
+	ck_assert_int_eq (replies.size (), 6);
+	ck_assert_int_eq (conn->getSerialQueueSize (), 0);
+	// retries are not called from callbacks of the failed commands
+	ck_assert_int_eq (retryMaxDepth, 1);
+}
+END_TEST
+
+Suite * serial_suite (void)
+{
+	Suite *s;
+	TCase *tc_serial;
+
+	s = suite_create ("Serial");
+	tc_serial = tcase_create ("Asynchronous serial commands");
+
+	tcase_add_checked_fixture (tc_serial, setup_serial, teardown_serial);
+	tcase_add_test (tc_serial, async_reply);
+	tcase_add_test (tc_serial, pipelined);
+	tcase_add_test (tc_serial, timeout);
+	tcase_add_test (tc_serial, hangup);
+	tcase_add_test (tc_serial, retry_closed);
+
+	suite_add_tcase (s, tc_serial);
+
+	return s;
+}
+
+int main (void)
+{
+	int number_failed;
+	Suite *s;
+	SRunner *sr;
+
+	s = serial_suite ();
+	sr = srunner_create (s);
+	srunner_run_all (sr, CK_NORMAL);
+	number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -1,3 +1,4 @@
+#include <math.h>
 #include <stdlib.h>
 #include <check.h>
 #include <check_utils.h>
@@ -171,6 +172,69 @@ Zapadá	19:55:46	0°	95° (V)	16 852	9,7	14,5° */
 }
 END_TEST
 
+START_TEST(BATCH)
+{
+	const char *tles[][2] = {
+		{"1 25544U 98067A   16128.85424799  .00005564  00000-0  90091-4 0  9999", "2 25544  51.6438 259.2325 0002021  92.7504  10.7493 15.54477273998701"},
+		{"1 25989U 99066A   16126.72024749 -.00000083  00000-0  00000+0 0  9995", "2 25989  67.4812  25.2476 8203967  94.8547 359.5975  0.50170988 18843"},
+		{"1 25544U 98067A   02256.70033192  .00045618  00000-0  57184-3 0  1499", "2 25544  51.6396 328.6851 0018421 253.2171 244.7656 15.59086742217834"}
+	};
+
+	rts2sgp4::SatelliteSet sats;
+	for (int i = 0; i < 3; i++)
+		ck_assert_int_eq (sats.add (tles[i][0], tles[i][1]), i);
+
+	double JD[20];
+	for (int j = 0; j < 20; j++)
+		JD[j] = 2457518.6 + j * 0.01;
+
+	struct ln_lnlat_posn observer;
+	observer.lng = -4.4643;
+	observer.lat = 40.4610;
+
+	double x[60], y[60], z[60];
+	double ra[60], dec[60], delta[60];
+
+	// 2002 TLE decayed long before 2016, its propagations fail
+	ck_assert_int_eq (sats.propagate (JD, 20, x, y, z), 20);
+	ck_assert_int_eq (sats.topocentric (JD, 20, &observer, 791, ra, dec, delta), 20);
+
+	double rho_cos;
+	double rho_sin;
+	rts2sgp4::ln_lat_alt_to_parallax (&observer, 791, &rho_cos, &rho_sin);
+
+	for (int j = 0; j < 20; j++)
+	{
+		struct ln_rect_posn sat_pos, v;
+		ck_assert_int_ne (rts2sgp4::propagate (sats.getSatellite (2), JD[j], &sat_pos, &v), 0);
+		ck_assert (isnan (x[40 + j]));
+		ck_assert (isnan (ra[40 + j]));
+	}
+
+	for (int i = 0; i < 2; i++)
+	{
+		for (int j = 0; j < 20; j++)
+		{
+			struct ln_rect_posn sat_pos, v, observer_loc;
+			struct ln_equ_posn radec;
+			double dist_to_satellite;
+
+			ck_assert_int_eq (rts2sgp4::propagate (sats.getSatellite (i), JD[j], &sat_pos, &v), 0);
+			rts2sgp4::ln_observer_cartesian_coords (&observer, rho_cos, rho_sin, JD[j], &observer_loc);
+			rts2sgp4::ln_get_satellite_ra_dec_delta (&observer_loc, &sat_pos, &radec, &dist_to_satellite);
+
+			ck_assert_dbl_eq (x[i * 20 + j], sat_pos.X, 1e-6);
+			ck_assert_dbl_eq (y[i * 20 + j], sat_pos.Y, 1e-6);
+			ck_assert_dbl_eq (z[i * 20 + j], sat_pos.Z, 1e-6);
+
+			ck_assert_dbl_eq (ra[i * 20 + j], radec.ra, 1e-8);
+			ck_assert_dbl_eq (dec[i * 20 + j], radec.dec, 1e-8);
+			ck_assert_dbl_eq (delta[i * 20 + j], dist_to_satellite, 1e-6);
+		}
+	}
+}
+END_TEST
+
 Suite * tle_suite (void)
 {
 	Suite *s;
@@ -182,6 +246,7 @@ Suite * tle_suite (void)
 	tcase_add_checked_fixture (tc_sgp4, setup_sgp4, teardown_sgp4);
 	tcase_add_test (tc_sgp4, PLUTO);
 	tcase_add_test (tc_sgp4, ISS);
+	tcase_add_test (tc_sgp4, BATCH);
 //	tcase_add_test (tc_sgp4, XMM);
 	suite_add_tcase (s, tc_sgp4);
 
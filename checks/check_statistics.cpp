@@ -0,0 +1,159 @@
+#include "statistics.h"
+#include "valuestat.h"
+
+#include <check.h>
+#include <check_utils.h>
+
+#include <stdlib.h>
+
+// reference two pass calculation
+template <typename t> void referenceStatistics (const t *data, size_t n, double &mean, double &stdev)
+{
+	long double sum = 0;
+	for (size_t i = 0; i < n; i++)
+		sum += data[i];
+	mean = sum / n;
+	long double s2 = 0;
+	for (size_t i = 0; i < n; i++)
+		s2 += (data[i] - (long double) mean) * (data[i] - (long double) mean);
+	stdev = sqrt (s2 / n);
+}
+
+template <typename t> double referenceMedian (const t *data, size_t n)
+{
+	std::vector <t> sorted (data, data + n);
+	std::sort (sorted.begin (), sorted.end ());
+	if (n % 2)
+		return sorted[n / 2];
+	return (sorted[n / 2 - 1] + (double) sorted[n / 2]) / 2.0;
+}
+
+START_TEST(welford)
+{
+	srandom (1);
+	std::vector <uint16_t> u16 (100003);
+	std::vector <double> dbl (100003);
+	for (size_t i = 0; i < u16.size (); i++)
+	{
+		u16[i] = random () % 65536;
+		// large offset - naive sum of squares looses precision
+		dbl[i] = 1e9 + (random () % 1000) / 100.0;
+	}
+
+	double mean, stdev;
+	rts2core::RunningStatistics stat;
+	stat.add (&u16[0], u16.size ());
+	referenceStatistics (&u16[0], u16.size (), mean, stdev);
+	ck_assert_int_eq (stat.getCount (), u16.size ());
+	ck_assert_dbl_eq (stat.getMean (), mean, 1e-9);
+	ck_assert_dbl_eq (stat.getStdev (), stdev, 1e-7);
+	ck_assert_dbl_eq (stat.getMin (), *std::min_element (u16.begin (), u16.end ()), 1e-9);
+	ck_assert_dbl_eq (stat.getMax (), *std::max_element (u16.begin (), u16.end ()), 1e-9);
+
+	rts2core::RunningStatistics dstat;
+	dstat.add (&dbl[0], dbl.size ());
+	referenceStatistics (&dbl[0], dbl.size (), mean, stdev);
+	ck_assert_dbl_eq (dstat.getMean (), mean, 1e-5);
+	ck_assert_dbl_eq (dstat.getStdev (), stdev, 1e-6);
+
+	// single values and merge give the same result
+	rts2core::RunningStatistics s1, s2;
+	for (size_t i = 0; i < 50000; i++)
+		s1.add (dbl[i]);
+	s2.add (&dbl[50000], dbl.size () - 50000);
+	s1.merge (s2);
+	ck_assert_int_eq (s1.getCount (), dbl.size ());
+	ck_assert_dbl_eq (s1.getMean (), mean, 1e-5);
+	ck_assert_dbl_eq (s1.getStdev (), stdev, 1e-6);
+	ck_assert_dbl_eq (s1.getSum (), dstat.getSum (), 1);
+
+	rts2core::RunningStatistics empty;
+	ck_assert (std::isnan (empty.getMean ()));
+	ck_assert (std::isnan (empty.getStdev ()));
+}
+END_TEST
+
+START_TEST(median)
+{
+	srandom (2);
+	for (size_t n = 1; n < 20000; n = n * 3 + 1)
+	{
+		std::vector <uint16_t> u16 (n);
+		std::vector <int16_t> i16 (n);
+		std::vector <int8_t> i8 (n);
+		std::vector <int32_t> i32 (n);
+		std::vector <double> dbl (n);
+		for (size_t i = 0; i < n; i++)
+		{
+			u16[i] = random () % 65536;
+			i16[i] = random () % 65536 - 32768;
+			i8[i] = random () % 256 - 128;
+			i32[i] = random () - RAND_MAX / 2;
+			dbl[i] = random () / 1000.0;
+		}
+		ck_assert_dbl_eq (rts2core::median (&u16[0], n), referenceMedian (&u16[0], n), 1e-9);
+		ck_assert_dbl_eq (rts2core::median (&i16[0], n), referenceMedian (&i16[0], n), 1e-9);
+		ck_assert_dbl_eq (rts2core::median (&i8[0], n), referenceMedian (&i8[0], n), 1e-9);
+		ck_assert_dbl_eq (rts2core::median (&i32[0], n), referenceMedian (&i32[0], n), 1e-9);
+		ck_assert_dbl_eq (rts2core::median (&dbl[0], n), referenceMedian (&dbl[0], n), 1e-9);
+	}
+
+	double even[] = {4, 1, 3, 2};
+	ck_assert_dbl_eq (rts2core::selectMedian (even, 4), 2.5, 1e-9);
+	ck_assert (std::isnan (rts2core::median ((double *) NULL, 0)));
+}
+END_TEST
+
+START_TEST(value_stat)
+{
+	rts2core::ValueDoubleStat *val = new rts2core::ValueDoubleStat ("stat");
+	double v[] = {5, 1, 4, 2, 3, 10};
+	for (int i = 0; i < 6; i++)
+		val->addValue (v[i]);
+	val->calculate ();
+
+	ck_assert_int_eq (val->getNumMes (), 6);
+	ck_assert_dbl_eq (val->getValueDouble (), 25 / 6.0, 1e-9);
+	ck_assert_dbl_eq (val->getMode (), 3.5, 1e-9);
+	ck_assert_dbl_eq (val->getMin (), 1, 1e-9);
+	ck_assert_dbl_eq (val->getMax (), 10, 1e-9);
+
+	double mean, stdev;
+	referenceStatistics (v, 6, mean, stdev);
+	ck_assert_dbl_eq (val->getStdev (), stdev, 1e-9);
+
+	delete val;
+}
+END_TEST
+
+Suite * statistics_suite (void)
+{
+	Suite *s;
+	TCase *tc_statistics;
+
+	s = suite_create ("Statistics");
+	tc_statistics = tcase_create ("Welford statistics and median");
+
+	tcase_add_test (tc_statistics, welford);
+	tcase_add_test (tc_statistics, median);
+	tcase_add_test (tc_statistics, value_stat);
+
+	suite_add_tcase (s, tc_statistics);
+
+	return s;
+}
+
+int main (void)
+{
+	int number_failed;
+	Suite *s;
+	SRunner *sr;
+
+	s = statistics_suite ();
+	sr = srunner_create (s);
+	srunner_run_all (sr, CK_NORMAL);
+	number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
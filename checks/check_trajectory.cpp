@@ -0,0 +1,118 @@
+#include <check.h>
+#include <check_utils.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "trajectory.h"
+
+// 2015-03-20 18:00 UT, as two part JD
+#define UTC1  2457102.0
+#define UTC2  0.25
+
+// smooth axis motion, in counts
+static double axisA (double t) { return 1e6 + 3000 * t + 2.5 * t * t; }
+static double axisD (double t) { return -2e5 + 5e4 * sin (t / 600.0); }
+
+static void fitAxes (rts2teld::Trajectory &tr, double span, double ra0)
+{
+	int32_t ac[3], dc[3];
+	double ra[3], dec[3];
+	for (int i = 0; i < 3; i++)
+	{
+		double t = i * span / 2.0;
+		ac[i] = (int32_t) round (axisA (t));
+		dc[i] = (int32_t) round (axisD (t));
+		ra[i] = fmod (ra0 + t * 15.0 / 3600.0, 360);
+		dec[i] = 20 + t / 3600.0;
+	}
+	tr.fit (UTC1, UTC2, span, ac, dc, ra, dec);
+}
+
+START_TEST(trajectory)
+{
+	rts2teld::Trajectory tr;
+	ck_assert_int_eq (tr.isValid (), false);
+
+	fitAxes (tr, 10, 120);
+	ck_assert_int_eq (tr.isValid (), true);
+
+	ck_assert_int_eq (tr.covers (UTC1, UTC2), true);
+	ck_assert_int_eq (tr.covers (UTC1, UTC2 + 10 / 86400.0), true);
+	ck_assert_int_eq (tr.covers (UTC1, UTC2 + 11 / 86400.0), false);
+	ck_assert_int_eq (tr.covers (UTC1, UTC2 - 1 / 86400.0), false);
+
+	for (double t = 0; t <= 10; t += 0.25)
+	{
+		int32_t ac, dc;
+		tr.getCounts (UTC1, UTC2 + t / 86400.0, ac, dc);
+		ck_assert (fabs (ac - axisA (t)) <= 1);
+		ck_assert (fabs (dc - axisD (t)) <= 1);
+
+		double ac_speed, dc_speed;
+		tr.getSpeed (UTC1, UTC2 + t / 86400.0, ac_speed, dc_speed);
+		ck_assert_dbl_eq (ac_speed, 3000 + 5 * t, 0.5);
+		ck_assert_dbl_eq (dc_speed, 5e4 / 600.0 * cos (t / 600.0), 0.5);
+
+		ck_assert_dbl_eq (tr.getDifference (UTC1, UTC2 + t / 86400.0, (int32_t) round (axisA (t)), (int32_t) round (axisD (t))), 0, 1);
+	}
+
+	ck_assert_dbl_eq (tr.getDifference (UTC1, UTC2 + 5 / 86400.0, (int32_t) axisA (5) + 100, (int32_t) axisD (5)), 100, 1);
+	ck_assert_dbl_eq (tr.getDifference (UTC1, UTC2 + 5 / 86400.0, (int32_t) axisA (5), (int32_t) axisD (5) - 50), 50, 1);
+
+	double ra, dec;
+	tr.getRaDec (UTC1, UTC2 + 4 / 86400.0, ra, dec);
+	ck_assert_dbl_eq (ra, 120 + 60 / 3600.0, 1e-9);
+	ck_assert_dbl_eq (dec, 20 + 4 / 3600.0, 1e-9);
+
+	tr.invalidate ();
+	ck_assert_int_eq (tr.isValid (), false);
+	ck_assert_int_eq (tr.covers (UTC1, UTC2), false);
+}
+END_TEST
+
+START_TEST(trajectory_ra_wrap)
+{
+	rts2teld::Trajectory tr;
+	// RA crosses 0 in the middle of the trajectory
+	fitAxes (tr, 60, 360 - 0.1);
+
+	double ra, dec;
+	tr.getRaDec (UTC1, UTC2, ra, dec);
+	ck_assert_dbl_eq (ra, 359.9, 1e-9);
+
+	tr.getRaDec (UTC1, UTC2 + 24 / 86400.0, ra, dec);
+	ck_assert_dbl_eq (ra, 0, 1e-9);
+
+	tr.getRaDec (UTC1, UTC2 + 60 / 86400.0, ra, dec);
+	ck_assert_dbl_eq (ra, 0.15, 1e-9);
+}
+END_TEST
+
+Suite * trajectory_suite (void)
+{
+	Suite *s;
+	TCase *tc_trajectory;
+
+	s = suite_create ("Trajectory");
+	tc_trajectory = tcase_create ("Tracking trajectory");
+
+	tcase_add_test (tc_trajectory, trajectory);
+	tcase_add_test (tc_trajectory, trajectory_ra_wrap);
+	suite_add_tcase (s, tc_trajectory);
+
+	return s;
+}
+
+int main (void)
+{
+	int number_failed;
+	Suite *s;
+	SRunner *sr;
+
+	s = trajectory_suite ();
+	sr = srunner_create (s);
+	srunner_run_all (sr, CK_NORMAL);
+	number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
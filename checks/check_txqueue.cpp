@@ -0,0 +1,170 @@
+#include "block.h"
+
+#include <check.h>
+#include <check_utils.h>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+class TestBlock:public rts2core::Block
+{
+	public:
+		TestBlock ():rts2core::Block (0, NULL) {}
+
+		virtual int run () { return 0; }
+
+	protected:
+		virtual rts2core::Connection *createClientConnection (rts2core::NetworkAddress * in_addr) { return NULL; }
+};
+
+TestBlock *block = NULL;
+rts2core::Connection *conn = NULL;
+int peer = -1;
+
+void setup_txqueue (void)
+{
+	int sv[2];
+	ck_assert_int_eq (socketpair (AF_UNIX, SOCK_STREAM, 0, sv), 0);
+	// small buffer, so slow receiver is simulated with a few kB of data
+	int bs = 4096;
+	setsockopt (sv[0], SOL_SOCKET, SO_SNDBUF, &bs, sizeof (bs));
+	setsockopt (sv[1], SOL_SOCKET, SO_RCVBUF, &bs, sizeof (bs));
+	fcntl (sv[1], F_SETFL, O_NONBLOCK);
+
+	block = new TestBlock ();
+	conn = new rts2core::Connection (sv[0], block);
+	block->addConnection (conn);
+	block->callIdle ();
+	peer = sv[1];
+}
+
+void teardown_txqueue (void)
+{
+	close (peer);
+	// connection is deleted by block
+	delete block;
+	block = NULL;
+	conn = NULL;
+}
+
+// reads all available data from the peer, running event loop to flush transmit queue
+static std::string drain ()
+{
+	std::string ret;
+	char buf[8192];
+	for (int i = 0; i < 1000; i++)
+	{
+		ssize_t r = read (peer, buf, sizeof (buf));
+		if (r > 0)
+			ret.append (buf, r);
+		else if (conn->getTxQueueSize () == 0)
+			break;
+		block->setTimeout (1000);
+		block->oneRunLoop ();
+	}
+	return ret;
+}
+
+START_TEST(nonblocking_send)
+{
+	size_t size = 1024 * 1024;
+	size_t chansize[1] = { size };
+	int dc = conn->startBinaryData (16, 1, chansize);
+	ck_assert_int_gt (dc, 0);
+
+	char *data = new char[size];
+	for (size_t i = 0; i < size; i++)
+		data[i] = i % 251;
+
+	// peer does not read, call must return with data queued
+	ck_assert_int_eq (conn->sendBinaryData (dc, 0, data, size / 2), 0);
+	ck_assert_int_gt (conn->getTxQueueSize (), 0);
+	ck_assert_int_eq (conn->getWriteBinaryDataSize (dc), size / 2);
+
+	// text messages are queued after binary data
+	ck_assert_int_eq (conn->sendMsg ("T test"), 0);
+	ck_assert_int_eq (conn->sendBinaryData (dc, 0, data + size / 2, size / 2), 0);
+	ck_assert_int_eq (conn->getWriteBinaryDataSize (dc), 0);
+
+	std::string rec = drain ();
+	ck_assert_int_eq (conn->getTxQueueSize (), 0);
+
+	std::string h1 = "C 1 16 1 1048576\nD 1 0 524288\n";
+	ck_assert (rec.compare (0, h1.length (), h1) == 0);
+	ck_assert (memcmp (rec.data () + h1.length (), data, size / 2) == 0);
+	size_t p = h1.length () + size / 2;
+	std::string h2 = "T test\nD 1 0 524288\n";
+	ck_assert (rec.compare (p, h2.length (), h2) == 0);
+	ck_assert (memcmp (rec.data () + p + h2.length (), data + size / 2, size / 2) == 0);
+	ck_assert_int_eq (rec.length (), p + h2.length () + size / 2);
+
+	delete[] data;
+}
+END_TEST
+
+START_TEST(drop_slow_receiver)
+{
+	size_t size = 64 * 1024;
+	size_t chansize[1] = { 4 * size };
+	conn->setTxQueueLimit (2 * size);
+	int dc = conn->startBinaryData (16, 1, chansize);
+
+	char *data = new char[size];
+	memset (data, 1, size);
+
+	ck_assert_int_eq (conn->sendBinaryData (dc, 0, data, size), 0);
+	ck_assert_int_eq (conn->sendBinaryData (dc, 0, data, size), 0);
+	size_t queued = conn->getTxQueueSize ();
+	// exceeds the limit - rest of the data are dropped
+	ck_assert_int_eq (conn->sendBinaryData (dc, 0, data, size), 0);
+	ck_assert_int_eq (conn->sendBinaryData (dc, 0, data, size), 0);
+	ck_assert_int_lt (conn->getTxQueueSize (), queued + 100);
+	ck_assert_int_eq (conn->getWriteBinaryDataSize (dc), 0);
+
+	std::string rec = drain ();
+	std::string killed = "H 1\n";
+	ck_assert (rec.compare (rec.length () - killed.length (), killed.length (), killed) == 0);
+
+	// next data connection is send again
+	chansize[0] = 10;
+	dc = conn->startBinaryData (16, 1, chansize);
+	ck_assert_int_eq (conn->sendBinaryData (dc, 0, data, 10), 0);
+	rec = drain ();
+	ck_assert (rec.compare (0, 16, "C 2 16 1 10\nD 2 ") == 0);
+
+	delete[] data;
+}
+END_TEST
+
+Suite * txqueue_suite (void)
+{
+	Suite *s;
+	TCase *tc_txqueue;
+
+	s = suite_create ("Transmit queue");
+	tc_txqueue = tcase_create ("Binary data transfer");
+
+	tcase_add_checked_fixture (tc_txqueue, setup_txqueue, teardown_txqueue);
+	tcase_add_test (tc_txqueue, nonblocking_send);
+	tcase_add_test (tc_txqueue, drop_slow_receiver);
+
+	suite_add_tcase (s, tc_txqueue);
+
+	return s;
+}
+
+int main (void)
+{
+	int number_failed;
+	Suite *s;
+	SRunner *sr;
+
+	s = txqueue_suite ();
+	sr = srunner_create (s);
+	srunner_run_all (sr, CK_NORMAL);
+	number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,106 @@
+#include "valuelist.h"
+
+#include <check.h>
+#include <check_utils.h>
+
+#include <stdio.h>
+
+rts2core::ValueVector *values = NULL;
+
+void setup_valuelist (void)
+{
+	values = new rts2core::ValueVector ();
+}
+
+void teardown_valuelist (void)
+{
+	delete values;
+	values = NULL;
+}
+
+START_TEST(lookup)
+{
+	char name[20];
+	for (int i = 0; i < 500; i++)
+	{
+		snprintf (name, sizeof (name), "VALUE_%d", i);
+		values->push_back (new rts2core::ValueInteger (name));
+	}
+	ck_assert_int_eq (values->size (), 500);
+
+	for (int i = 0; i < 500; i++)
+	{
+		snprintf (name, sizeof (name), "value_%d", i);
+		rts2core::Value *val = values->getValue (name);
+		ck_assert (val != NULL);
+		ck_assert (val == (*values)[i]);
+		ck_assert (values->getValueIterator (name) == values->begin () + i);
+	}
+
+	ck_assert (values->getValue ("VALUE_500") == NULL);
+	ck_assert (values->getValueIterator ("VALUE") == values->end ());
+}
+END_TEST
+
+START_TEST(insert_remove)
+{
+	values->push_back (new rts2core::ValueInteger ("a"));
+	values->push_back (new rts2core::ValueInteger ("b"));
+	rts2core::Value *dup = new rts2core::ValueInteger ("B");
+	values->push_back (dup);
+	// first value with the name is found
+	ck_assert (values->getValue ("b") == (*values)[1]);
+
+	// value inserted in front of the existing one
+	rts2core::Value *first = new rts2core::ValueInteger ("b");
+	values->insert (values->begin (), first);
+	ck_assert (values->getValue ("b") == first);
+
+	rts2core::ValueVector::iterator iter = values->removeValue ("b");
+	ck_assert (iter == values->begin ());
+	ck_assert_int_eq (values->size (), 3);
+	ck_assert (values->getValue ("b")->getName () == "b");
+
+	values->removeValue ("b");
+	ck_assert (values->getValue ("b") == dup);
+	values->removeValue ("b");
+	ck_assert (values->getValue ("b") == NULL);
+	ck_assert (values->getValue ("a") != NULL);
+
+	delete values->getValue ("a");
+	values->clear ();
+	ck_assert (values->getValue ("a") == NULL);
+}
+END_TEST
+
+Suite * valuelist_suite (void)
+{
+	Suite *s;
+	TCase *tc_valuelist;
+
+	s = suite_create ("Value list");
+	tc_valuelist = tcase_create ("Value index");
+
+	tcase_add_checked_fixture (tc_valuelist, setup_valuelist, teardown_valuelist);
+	tcase_add_test (tc_valuelist, lookup);
+	tcase_add_test (tc_valuelist, insert_remove);
+
+	suite_add_tcase (s, tc_valuelist);
+
+	return s;
+}
+
+int main (void)
+{
+	int number_failed;
+	Suite *s;
+	SRunner *sr;
+
+	s = valuelist_suite ();
+	sr = srunner_create (s);
+	srunner_run_all (sr, CK_NORMAL);
+	number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,38 @@
+#ifndef __GPOINTREF__
+#define __GPOINTREF__
+
+#include "gpointmodel.h"
+
+#include <math.h>
+
+/**
+ * Reference alt-az model evaluation, with long double functions and extra
+ * parameters evaluated by ExtraParam::getValue, as model was evaluated before
+ * it was compiled. Used to check and benchmark the compiled model.
+ */
+static inline void referenceErrAltAz (rts2telmodel::GPointModel &model, double az, double alt, double ha, double dec, double &err_az, double &err_alt)
+{
+	long double az_r = ln_deg_to_rad (az);
+	long double el_r = ln_deg_to_rad (alt);
+	long double ha_r = ln_deg_to_rad (ha);
+	long double dec_r = ln_deg_to_rad (dec);
+
+	long double sin_az = sinl (az_r);
+	long double cos_az = cosl (az_r);
+	long double cos_el = cosl (el_r);
+	long double tan_el = tanl (el_r);
+
+	long double e_az = - model.params[0] + model.params[1] * sin_az * tan_el - model.params[2] * cos_az * tan_el - model.params[3] * tan_el + model.params[4] / cos_el;
+	long double e_alt = - model.params[5] + model.params[1] * cos_az + model.params[2] * sin_az + model.params[6] * cos_el;
+
+	std::list <rts2telmodel::ExtraParam *>::iterator it;
+	for (it = model.extraParamsAz.begin (); it != model.extraParamsAz.end (); it++)
+		e_az += (*it)->getValue (az_r, el_r, ha_r, dec_r);
+	for (it = model.extraParamsEl.begin (); it != model.extraParamsEl.end (); it++)
+		e_alt += (*it)->getValue (az_r, el_r, ha_r, dec_r);
+
+	err_az = ln_rad_to_deg (e_az);
+	err_alt = ln_rad_to_deg (e_alt);
+}
+
+#endif // !__GPOINTREF__
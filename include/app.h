@@ -191,6 +191,15 @@ class App:public Object
 
 		virtual LogStream logStream (messageType_t in_messageType);
 
+		/**
+		 * Returns true if message of the given type will be sent
+		 * anywhere. LogStream does not format messages which are not
+		 * logged.
+		 *
+		 * @param in_messageType   Message type.
+		 */
+		virtual bool isLogged (messageType_t in_messageType) { return debug != 0 || in_messageType != MESSAGE_DEBUG; }
+
 		/**
 		 * Called on SIGHUP signal.
 		 * This method is called from static signal routine.
@@ -0,0 +1,146 @@
+/*
+ * Asynchronous buffered message log.
+ * Copyright (C) 2026 Petr Kubanek <petr@kubanek.net>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef __RTS2_ASYNCLOG__
+#define __RTS2_ASYNCLOG__
+
+#include "message.h"
+
+#include <fstream>
+#include <string>
+#include <pthread.h>
+#include <sys/time.h>
+
+namespace rts2core
+{
+
+/**
+ * Slot of the log ring. Holds unformatted message; seq is used to
+ * synchronize producers with the consumer.
+ */
+struct AsyncLogSlot
+{
+	size_t seq;
+	struct timeval messageTime;
+	std::string messageOName;
+	messageType_t messageType;
+	std::string messageString;
+};
+
+/**
+ * Message log written by a background thread. Messages are put to a
+ * bounded lock-free ring, which can be filled from multiple threads. Lines
+ * are formatted by the flusher thread, which writes all queued messages and
+ * flushes the file once per batch, not once per line.
+ *
+ * If the ring is full, message is dropped and counted; number of dropped
+ * messages is written to the log. Before the flusher thread is started
+ * (it must be started after the daemon forked to background), messages are
+ * written synchronously by the caller of log ().
+ *
+ * @author Petr Kubanek <petr@kubanek.net>
+ */
+class AsyncLog
+{
+	public:
+		/**
+		 * @param _size           ring size, rounded up to power of 2
+		 * @param _flushInterval  maximal time (in seconds) message waits in the ring
+		 */
+		AsyncLog (size_t _size = 8192, double _flushInterval = 0.1);
+
+		/**
+		 * Stops the thread, writes all queued messages and closes the file.
+		 */
+		~AsyncLog ();
+
+		/**
+		 * Open log file for appending. Previously opened file is closed.
+		 * Can be called while the flusher thread runs.
+		 *
+		 * @return -1 on error, 0 on success
+		 */
+		int open (const char *filename);
+
+		/**
+		 * Start flusher thread. If the thread cannot be started,
+		 * messages are written synchronously.
+		 *
+		 * @return -1 on error, 0 on success
+		 */
+		int start ();
+
+		bool isRunning () { return running; }
+
+		/**
+		 * True if start was called and the thread was not started.
+		 */
+		bool startFailed () { return failed; }
+
+		/**
+		 * Queue message to log.
+		 *
+		 * @return -1 if the ring is full and the message was dropped
+		 */
+		int log (Message &msg);
+
+		/**
+		 * Returns number of dropped messages.
+		 */
+		unsigned long getDropped () { return __atomic_load_n (&dropped, __ATOMIC_RELAXED); }
+
+	private:
+		AsyncLogSlot *slots;
+		size_t mask;
+
+		// next slot to fill, shared by producers
+		size_t tail;
+		// next slot to write, used only by the consumer
+		size_t head;
+
+		unsigned long dropped;
+		unsigned long reportedDropped;
+
+		double flushInterval;
+
+		std::ofstream file;
+		// protects file
+		pthread_mutex_t fileMutex;
+
+		pthread_t thread;
+		pthread_mutex_t mutex;
+		pthread_cond_t cond;
+		bool running;
+		bool failed;
+		bool stop;
+
+		static void *runThread (void *arg);
+		void run ();
+
+		/**
+		 * Write all queued messages and flush the file.
+		 *
+		 * @return number of written lines
+		 */
+		size_t writeQueued ();
+};
+
+}
+
+#endif // !__RTS2_ASYNCLOG__
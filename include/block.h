@@ -41,6 +41,11 @@
 #include <sys/inotify.h>
 #endif
 
+#ifdef RTS2_HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#include <set>
+#endif
+
 #include "event.h"
 #include "object.h"
 #include "connection.h"
@@ -87,6 +92,10 @@
 #define PROTO_SHARED_FULL      "J"
 /** Shared memory segment ends prematurely. @ingroup RTS2Protocol */
 #define PROTO_SHARED_KILLED    "K"
+/** Assign index to value, which is then used in binary value records. @ingroup RTS2Protocol */
+#define PROTO_VALUE_INDEX      "W"
+/** First byte of binary value record. Record is send only to peers which requested binary values. @ingroup RTS2Protocol */
+#define PROTO_BINARY_VALUE     '\001'
 
 
 class Rts2ClientTCPDataConn;
@@ -316,6 +325,13 @@ class Block: public App
 		 */
 		void sendValueAll (char *val_name, char *value);
 
+		/**
+		 * Send value updates postponed for coalescing. Called before
+		 * any other data are written to a connection, so updates do not
+		 * overtake messages send after them.
+		 */
+		virtual void flushPendingValues () {}
+
 		// only used in centrald!
 		void sendMessageAll (Message & msg);
 
@@ -664,6 +680,15 @@ class Block: public App
 		 */
 		void deleteTimers (int event_type);
 
+		/**
+		 * Remove timers with a given type and argument from the list
+		 * of timers.
+		 *
+		 * @param event_type Type of event.
+		 * @param arg        Event argument.
+		 */
+		void deleteTimers (int event_type, void *arg);
+
 		/**
 		 * Updates metainformation about given value.
 		 *
@@ -686,6 +711,35 @@ class Block: public App
 		 */
 		void addPollFD (int fd, short events);
 
+		/**
+		 * Remove descriptor from the block poll registrations. Must
+		 * be called when descriptor registered with addPollFD is
+		 * closed, so descriptor number reused by the next socket will
+		 * be properly registered with epoll.
+		 *
+		 * @param fd descriptor which is being closed
+		 */
+		void removePollFD (int fd);
+
+		/**
+		 * Notify block that descriptors or events polled by the
+		 * connection might change. With epoll, descriptors of the
+		 * connection are collected with Connection::add only after
+		 * this call, or after the connection was processed in
+		 * pollSuccess.
+		 *
+		 * @param conn connection which changed
+		 */
+		void pollChanged (Connection *conn);
+
+		/**
+		 * Remove all descriptors registered by the connection. Called
+		 * from connection destructor.
+		 *
+		 * @param conn connection which is being removed
+		 */
+		void removePollConnection (Connection *conn);
+
 		/**
 		 * Returns events associated with the given descriptor.
 		 */
@@ -706,8 +760,39 @@ class Block: public App
 		 */
 		bool isForWrite (int fd) { return getPollEvents (fd) & POLLOUT; }
 
+		/**
+		 * Force use of ppoll call in the event loop, even if epoll is available.
+		 *
+		 * @param _usePoll  if true, ppoll will be used
+		 */
+		void setUsePoll (bool _usePoll) { usePoll = _usePoll; }
+
+		/**
+		 * Returns true if binary value updates shall be requested from and send to peers.
+		 */
+		bool binaryValuesEnabled () { return !textValues; }
+
+		/**
+		 * Enable or disable binary value updates.
+		 */
+		void setBinaryValues (bool _binaryValues) { textValues = !_binaryValues; }
+
+		/**
+		 * Returns true if event loop is driven by epoll.
+		 */
+		bool isEpollActive ()
+		{
+#ifdef RTS2_HAVE_SYS_EPOLL_H
+			return epollfd >= 0;
+#else
+			return false;
+#endif
+		}
+
 	protected:
 
+		virtual int processOption (int in_opt);
+
 		virtual Connection *createClientConnection (NetworkAddress * in_addr) = 0;
 
 		virtual void childReturned (pid_t child_pid);
@@ -810,6 +895,99 @@ class Block: public App
 		nfds_t pollsize;
 		nfds_t npolls;
 
+		// use ppoll even if epoll is available
+		bool usePoll;
+
+		// do not use binary value updates
+		bool textValues;
+
+		/**
+		 * Called when connection is put to connection lists.
+		 */
+		void pollAdded (Connection *conn);
+
+#ifdef RTS2_HAVE_SYS_EPOLL_H
+		/**
+		 * Descriptor registration in epoll set. Indexed by descriptor.
+		 */
+		struct EPollReg
+		{
+			bool registered;     // true if descriptor is registered in kernel
+			short events;        // events registered in kernel
+			short revents;       // events reported by the last epoll_wait
+			Connection *owner;   // connection owning the descriptor, NULL for block descriptors
+		};
+
+		int epollfd;
+		std::vector <EPollReg> epollRegs;
+		// connections in connections and centraldConns lists
+		std::set <Connection *> polledConns;
+		// connections which descriptors or requested events might change since the last round
+		std::set <Connection *> pollChangedConns;
+
+		/**
+		 * Range of fds entries collected from a changed connection.
+		 */
+		struct PollRange
+		{
+			Connection *conn;
+			nfds_t start;
+			nfds_t end;
+		};
+
+		// connections collected by the last addPollSocks call
+		std::vector <PollRange> pollRanges;
+		// descriptors registered by connections
+		std::map <Connection *, std::vector <int> > pollConnFds;
+		// descriptors registered by the block in the last round
+		std::vector <int> pollBlockFds;
+		// connections processed in every pollSuccess call - without descriptor or marked for deletion
+		std::set <Connection *> alwaysReadyConns;
+		// descriptors with non-zero revents
+		std::vector <int> readyFds;
+		// connections with some ready descriptor
+		std::set <Connection *> readyConns;
+		// connections being processed in pollSuccess; deleted connections are set to NULL
+		std::vector <Connection *> pollDispatch;
+		std::vector <struct epoll_event> epollEvents;
+
+		/**
+		 * Synchronize epoll registrations of connections which
+		 * changed, and of block descriptors, and wait for events.
+		 *
+		 * @return number of ready descriptors, -1 on error
+		 */
+		int epollWait (struct timespec *read_tout);
+
+		/**
+		 * Update registrations of descriptors owned by the connection
+		 * (or block if owner is NULL) to descriptors collected in fds
+		 * entries between start and end. Descriptors not collected are
+		 * removed from the epoll set.
+		 *
+		 * @param owner   connection owning descriptors, NULL for block descriptors
+		 * @param regFds  descriptors registered in the previous round, will be updated
+		 * @param start   first fds entry
+		 * @param end     fds entry after the last one
+		 */
+		void epollSync (Connection *owner, std::vector <int> &regFds, nfds_t start, nfds_t end);
+
+		/**
+		 * Register descriptor with epoll, or modify its registration.
+		 */
+		void epollRegister (int fd, short events, Connection *owner);
+
+		/**
+		 * Remove descriptor from epoll set.
+		 */
+		void epollUnregister (int fd);
+
+		/**
+		 * Process connection with ready descriptor. Deletes the connection if it requested to be deleted.
+		 */
+		void pollConnection (Connection *conn);
+#endif
+
 		// timers - time when they should be executed, event which should be triggered
 		std::map <double, Event*> timers;
 
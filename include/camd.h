@@ -25,6 +25,8 @@
 
 #include "scriptdevice.h"
 #include "imghdr.h"
+#include "pixelstat.h"
+#include "readoutpipeline.h"
 
 #define MAX_CHIPS  3
 #define MAX_DATA_RETRY 100
@@ -305,6 +307,15 @@ class Camera:public rts2core::ScriptDevice
 
 		virtual void setFullBopState (rts2_status_t new_state);
 
+		/**
+		 * Called from the main thread when readout pipeline finished
+		 * processing of the data chunk. Updates statistics values and
+		 * sends data to the client.
+		 *
+		 * @return -1 on error, 0 otherwise.
+		 */
+		int readoutJobDone (ReadoutJob *job);
+
 	protected:
 		double pixelX;
 		double pixelY;
@@ -470,7 +481,7 @@ class Camera:public rts2core::ScriptDevice
 				// end bytes
 				return calculateDataSize;
 			if (exposureConn)
-				return exposureConn->getWriteBinaryDataSize (currentImageData);
+				return pendingDataSize (exposureConn->getWriteBinaryDataSize (currentImageData), readoutPipeline ? readoutPipeline->getPendingData () : 0);
 			return 0;
 		}
 
@@ -485,7 +496,7 @@ class Camera:public rts2core::ScriptDevice
 				// end bytes
 				return calculateDataSize;
 			if (exposureConn)
-				return exposureConn->getWriteBinaryDataSize (currentImageData, chan);
+				return pendingDataSize (exposureConn->getWriteBinaryDataSize (currentImageData, chan), readoutPipeline ? readoutPipeline->getPendingData (chan) : 0);
 			return 0;
 		}
 
@@ -1062,8 +1073,15 @@ class Camera:public rts2core::ScriptDevice
 		rts2core::ValueDouble *sum;
 		rts2core::ValueDouble *image_mode;
 
-		uint32_t *modeCount;
-		long long unsigned int modeCountSize;
+		// single pass statistics and center calculation
+		PixelStatistics pixelStat;
+
+		// number of readout pipeline worker threads, 0 when readout data are processed in the main thread
+		int readoutThreads;
+		ReadoutPipeline *readoutPipeline;
+
+		// size of data which remains to be send, minus data queued in pipeline
+		long pendingDataSize (size_t remains, size_t queued) { return remains > queued ? remains - queued : 0; }
 
 		rts2core::ValueLong *computedPix;
 
@@ -1110,140 +1128,31 @@ class Camera:public rts2core::ScriptDevice
 		rts2core::ValueDouble *centerAvg;
 		rts2core::ValueDoubleStat *centerAvgStat;
 
-		// update statistics
-		template <typename t> int updateStatistics (t *data, size_t dataSize)
-		{
-			long double tSum = 0;
-			double tMin = min->getValueDouble ();
-			double tMax = max->getValueDouble ();
-			int pixNum = 0;
-			t *tData = data;
-			if (modeCountSize < (((long long unsigned int) 1) << (sizeof (t) * 8)))
-			{
-				delete[] modeCount;
-				modeCountSize = ((long long unsigned int) 1) << (sizeof (t) * 8);
-				modeCount = new uint32_t[modeCountSize];
-				memset (modeCount, 0, modeCountSize * sizeof (uint32_t));
-			}
-			while (((char *) tData) < ((char *) data) + dataSize)
-			{
-				t tD = *tData;
-				tSum += tD;
-				if (tD < tMin)
-					tMin = tD;
-				if (tD > tMax)
-				  	tMax = tD;
-				modeCount[(long) tD]++;
-				tData++;
-				pixNum++;
-			}
-			sum->setValueDouble (sum->getValueDouble () + tSum);
-			if (tMin < min->getValueDouble ())
-				min->setValueDouble (tMin);
-			if (tMax > max->getValueDouble ())
-				max->setValueDouble (tMax);
-			return pixNum;
-		}
-
-		// update center box
-		template <typename t> int updateCenter (t *data, size_t dataSize)
-		{
-			// check if box is inside window
-			int x = centerBox->getXInt ();
-			if (x < 0)
-				x = getUsedX ();
-			int y = centerBox->getYInt ();
-			if (y < 0)
-				y = getUsedY ();
-			int w = centerBox->getWidthInt () / binningHorizontal ();
-			if (w < 0)
-				w = (getUsedWidth () - (x - getUsedX ())) / binningHorizontal ();
-			int h = centerBox->getHeightInt () / binningVertical ();
-			if (h < 0)
-				h = (getUsedHeight () - (y - getUsedY ())) / binningVertical ();
-
-			double center_max = centerCutLevel->getValueDouble ();
-			double center_avg = 0;
-			int center_npix = 0;
-			
-			x -= getUsedX ();
-			y -= getUsedY ();
-
-			if (x < 0 || y < 0 || (w + ceil ((double) x / binningHorizontal ())) > getUsedWidthBinned () || (h + ceil ((double) y / binningVertical ())) > getUsedHeightBinned ())
-				return -1;
-
-			t *tData = data;
-			// move to the first calculated pixel
-			tData += y * getUsedWidthBinned () + x;
-
-			int i;
-
-			double sx[w];
-			for (i = 0; i < w; i++)
-				sx[i] = 0;
-
-			sumsY->clear ();
-
-			for (int row = 0; row < h; row++)
-			{
-				double rs = 0;
-				for (int col = 0; col < w; col++, tData++)
-				{
-					if (*tData >= centerCutLevel->getValueDouble ())
-					{
-						sx[col] += *tData;
-						rs += *tData;
-						center_npix++;
-						if (std::isnan (center_max) || *tData > center_max)
-							center_max = *tData;
-					}
-				}
-
-				sumsY->addValue (rs);
-				center_avg += rs;
-			}
-
-			sumsX->clear ();
-
-			for (i = 0; i < w; i++)
-				sumsX->addValue (sx[i]);
-
-			sendValueAll (sumsX);
-			sendValueAll (sumsY);
-
-			centerX->setValueDouble (sumsX->calculateMedianIndex ());
-			centerY->setValueDouble (sumsY->calculateMedianIndex ());
-
-			centerMax->setValueDouble (center_max);
-
-			centerStat->addValue (center_max, centerSums->getValueInteger ());
-
-			if (center_npix > 0)
-			{
-				center_avg /= center_npix;
-				centerAvg->setValueDouble (center_avg);
-				centerAvgStat->addValue (center_avg, centerSums->getValueInteger ());
-			}
-			else
-			{
-				centerAvg->setValueDouble (0);
-				centerAvgStat->addValue (0, centerSums->getValueInteger ());
-			}
-
-			sendValueAll (centerX);
-			sendValueAll (centerY);
-
-			sendValueAll (centerMax);
+		/**
+		 * Calculate center box in binned pixels relative to readout
+		 * start. Returns false if the box is outside of the readout
+		 * window.
+		 */
+		bool getCenterBox (int &x, int &y, int &w, int &h);
 
-			centerStat->calculate ();
-			sendValueAll (centerStat);
+		/**
+		 * Set center box of the statistics, or disable center calculation.
+		 */
+		void prepareCenterBox (PixelStatistics &stat, bool calcCenter);
 
-			sendValueAll (centerAvg);
-			centerAvgStat->calculate ();
-			sendValueAll (centerAvgStat);
+		/**
+		 * Update and send statistics values from pixelStat.
+		 *
+		 * @param calcStat   true if statistics was calculated
+		 * @param totPix     number of pixels in the chunk
+		 * @param dataSize   chunk size in bytes
+		 */
+		void sendStatistics (bool calcStat, size_t totPix, size_t dataSize);
 
-			return 0;
-		}
+		/**
+		 * Update and send center values calculated from the chunk.
+		 */
+		void sendCenter (PixelStatistics &stat);
 
 		char multi_wcs;
 
@@ -47,6 +47,13 @@
  */
 #define COMMAND_INFO            "info"
 
+/**
+ * Request binary value updates. Parameter is tag returned by
+ * Connection::binaryValuesTag, so peers with different byte order or
+ * record format will not use binary values.
+ */
+#define COMMAND_BINARY_VALUES   "binval"
+
 
 /**
  * Move command. @ingroup RTS2Command
@@ -421,11 +428,7 @@ class CommandSendKey:public Command
 		CommandSendKey (Block * _master, int _centrald_id, int _centrald_num, int _key);
 		virtual int send ();
 
-		virtual int commandReturnOK (Connection * conn)
-		{
-			connection->setConnState (CONN_AUTH_OK);
-			return -1;
-		}
+		virtual int commandReturnOK (Connection * conn);
 		virtual int commandReturnFailed (int status, Connection * conn)
 		{
 			connection->setConnState (CONN_AUTH_FAILED);
@@ -860,6 +863,20 @@ class CommandMessageMask:public Command
 		CommandMessageMask (Block * _master, int _mask);
 };
 
+/**
+ * Ask device to send value updates as binary records. Devices which
+ * do not support binary values return error, and values are then send
+ * as text.
+ *
+ * @ingroup RTS2Command
+ */
+class CommandBinaryValues:public Command
+{
+	public:
+		CommandBinaryValues (Block * _master);
+		virtual int commandReturnFailed (int status, Connection * conn) { return -1; }
+};
+
 /**
  * Send info command to central server.
  *
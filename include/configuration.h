@@ -358,6 +358,18 @@ class Configuration:public IniParser
 
 		bool getTargetConstraintsWithName () { return targetConstraintsWithName; }
 
+		/**
+		 * If true, target positions are interpolated from cached samples.
+		 */
+		bool getEphemerisCache () { return ephemerisCache; }
+
+		/**
+		 * Enable or disable position caches. Process wide Sun and
+		 * Moon caches are switched only here, so they can be used
+		 * from worker threads.
+		 */
+		void setEphemerisCache (bool cache);
+
 		const char *getNightDir () { return nightDir.c_str (); }
 
 		const char *getMasterConstraintFile () { return masterConsFile.c_str (); }
@@ -417,6 +429,7 @@ class Configuration:public IniParser
 
 		std::string targetDir;
 		bool targetConstraintsWithName;
+		bool ephemerisCache;
 		std::string nightDir;
 		std::string masterConsFile;
 
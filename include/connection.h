@@ -26,11 +26,13 @@
 
 #include <algorithm>
 #include <map>
+#include <set>
 #include <string>
 #include <string.h>
 #include <time.h>
 #include <list>
 #include <netinet/in.h>
+#include <sys/uio.h>
 
 #include <status.h>
 
@@ -44,6 +46,23 @@
 
 #define MAX_DATA    2000
 
+/**
+ * Default limit of the transmit queue. Binary data for receivers which have
+ * more data waiting are dropped.
+ */
+#define RTS2_TX_QUEUE_LIMIT    (128 * 1024 * 1024)
+
+/**
+ * Maximal size of received binary value record. Connection sending larger
+ * record is closed, as its data stream cannot be trusted.
+ */
+#define RTS2_BINARY_VALUE_LIMIT    (16 * 1024 * 1024)
+
+/**
+ * Transmit queue buffers larger than that are released when the queue is emptied.
+ */
+#define RTS2_TX_KEEP           (1024 * 1024)
+
 /**
  * Identifier of shared data connection.
  */
@@ -256,6 +275,31 @@ class Connection:public Object
 
 		void endBinaryData (int data_conn);
 
+		/**
+		 * Returns number of bytes waiting in transmit queue.
+		 */
+		size_t getTxQueueSize () { return txBuf.size () - txOffset; }
+
+		/**
+		 * Set maximal size of transmit queue. If binary data would
+		 * exceed this limit, the rest of the binary data connection is
+		 * dropped for this receiver. 0 means unlimited queue.
+		 */
+		void setTxQueueLimit (size_t _limit) { txQueueLimit = _limit; }
+
+		/**
+		 * Hold all outgoing data in memory until uncorkTx is called, so
+		 * multiple messages are written in one send call.
+		 */
+		void corkTx () { txCorked = true; }
+
+		/**
+		 * Write data collected since corkTx call.
+		 *
+		 * @return -1 on error, 0 on success
+		 */
+		int uncorkTx ();
+
 		/**
 		 * Image data will be transfered in shared memory, attachable by key.
 		 * Those functions are called by client. The receiving side can check in 
@@ -278,6 +322,29 @@ class Connection:public Object
 		int sendValue (char *val_name, int val1, int val2, double val3, double val4, double val5, double val6);
 		int sendValueTime (std::string val_name, time_t * value);
 
+		/**
+		 * Send value as binary record. First record of the value is preceded
+		 * by PROTO_VALUE_INDEX message, which assigns index to the value
+		 * name.
+		 *
+		 * @param val  value which will be send
+		 *
+		 * @return 1 if binary values are not enabled on connection or value cannot be send as binary record, -1 on error, 0 on success
+		 */
+		int sendBinaryValue (Value *val);
+
+		/**
+		 * Send values updates as binary records. Called when peer requested binary values.
+		 */
+		void setBinaryValues (bool _binaryValues);
+
+		bool getBinaryValues () { return binaryValues; }
+
+		/**
+		 * Tag identifying format of binary value records and byte order of the host.
+		 */
+		static int binaryValuesTag ();
+
 		int sendProgress (double start, double end);
 
 		/**
@@ -677,6 +744,14 @@ class Connection:public Object
 		 * Pointer to master object.
 		 */
 		Block *master;
+
+		/**
+		 * Notify master that descriptors or events polled by the
+		 * connection changed. Must be called when descendant changes
+		 * descriptors or events registered in add outside of
+		 * receive and writable calls.
+		 */
+		void pollChanged ();
 		char *command_start;
 
 		/**
@@ -810,6 +885,54 @@ class Connection:public Object
 		// ID of outgoing data connection
 		int dataConn;
 
+		// binary data connections dropped because receiver was too slow
+		std::set <int> droppedData;
+
+		// data waiting for socket to become writable
+		std::string txBuf;
+		size_t txOffset;
+		size_t txQueueLimit;
+
+		// data collected while transmission is corked
+		std::string txCork;
+		bool txCorked;
+
+		// send values as binary records
+		bool binaryValues;
+		// indices of values send as binary records
+		std::map <std::string, uint32_t> txValueIndex;
+		// names of values received as binary records
+		std::vector <std::string> rxValueIndex;
+		// buffer for binary value record
+		std::string txValueBuf;
+
+		int valueIndex ();
+
+		/**
+		 * Process binary value record.
+		 *
+		 * @param rec     record data, without record header
+		 * @param size    record size
+		 */
+		void binaryValue (const char *rec, size_t size);
+
+		/**
+		 * Write data to socket without blocking. Data which cannot be
+		 * written are appended to the transmit queue.
+		 *
+		 * @return -1 on error, 0 on success
+		 */
+		int writeTx (struct iovec *iov, int iovcnt);
+
+		/**
+		 * Write data from transmit queue.
+		 *
+		 * @return -1 on error, 0 on success
+		 */
+		int flushTx ();
+
+		void binaryDataWritten (int data_conn, int chan, size_t dataSize);
+
 		// connectionTimeout in seconds
 		int connectionTimeout;
 		conn_state_t conn_state;
@@ -23,6 +23,9 @@
 #include "connnosend.h"
 #include <termios.h>
 
+#include <deque>
+#include <string>
+
 namespace rts2core
 {
 
@@ -41,6 +44,68 @@ typedef enum {C7, C8} cSizeT;
  */
 typedef enum {NONE, ODD, EVEN} parityT;
 
+/**
+ * Request/response transaction on serial port, processed asynchronously
+ * by ConnSerial event loop. Reply is complete when terminator string is
+ * received, or when expected number of bytes is received for commands
+ * without terminator. Commands with neither terminator nor reply length do
+ * not expect any reply, and are completed as soon as they are written.
+ *
+ * Drivers subclass it and process reply in replyReceived.
+ *
+ * @author Petr Kubanek <petr@kubanek.net>
+ */
+class SerialCommand
+{
+	public:
+		/**
+		 * Create serial command.
+		 *
+		 * @param _cmd       command bytes
+		 * @param _cmdLen    command length
+		 * @param _endChar   reply terminator, NULL if reply is not terminated
+		 * @param _replyLen  expected reply length for replies without terminator, maximal reply length for terminated replies (0 for unlimited)
+		 * @param _timeout   reply timeout in seconds
+		 */
+		SerialCommand (const char *_cmd, int _cmdLen, const char *_endChar, int _replyLen = 0, double _timeout = 4);
+		virtual ~SerialCommand () {}
+
+		/**
+		 * Called when reply was received.
+		 *
+		 * @param reply  reply, without terminator
+		 * @param len    reply length
+		 */
+		virtual void replyReceived (const char *reply, int len) {}
+
+		/**
+		 * Called when command failed - when reply was not received in
+		 * timeout, was longer than maximal length, or when port
+		 * cannot be written or read.
+		 *
+		 * @param reply  partial reply received before the failure
+		 * @param len    partial reply length
+		 */
+		virtual void commandFailed (const char *reply, int len) {}
+
+		const std::string & getCommand () { return cmd; }
+
+		bool expectReply () { return endChar.length () > 0 || replyLen > 0; }
+
+	private:
+		std::string cmd;
+		std::string endChar;
+		int replyLen;
+		double timeout;
+
+		// time when reply must be received
+		double deadline;
+		// position of command end in the port output stream
+		unsigned long long txEnd;
+
+		friend class ConnSerial;
+};
+
 /**
  * Serial connection class.
  *
@@ -205,6 +270,47 @@ class ConnSerial: public ConnNoSend
 
 		int writeRead (const char* wbuf, int wlen, char *rbuf, int rlen, const char *endChar);
 
+		/**
+		 * Switch port to asynchronous mode. In asynchronous mode, port
+		 * is registered in Block poll set and commands queued with
+		 * queSerialCommand are written and their replies read without
+		 * blocking the event loop. Blocking calls (readPort,
+		 * writeRead,..) must not be used while asynchronous commands
+		 * are pending.
+		 *
+		 * @param _maxInFlight   number of commands written before
+		 *   reply to the first of them is received. Values above 1
+		 *   can be used only with protocols which reply to every
+		 *   command in order.
+		 *
+		 * @return -1 on error, 0 on success.
+		 */
+		int setAsync (int _maxInFlight = 1);
+
+		/**
+		 * Queue asynchronous command. Connection takes ownership of
+		 * the command, and deletes it after its replyReceived or
+		 * commandFailed is called. Commands queued to the closed port
+		 * or from commandFailed of failed commands are processed from
+		 * the event loop, so drivers which queue the command again on
+		 * failure do not recurse.
+		 */
+		void queSerialCommand (SerialCommand *cmd);
+
+		/**
+		 * Returns number of asynchronous commands, which were not yet
+		 * completed.
+		 */
+		size_t getSerialQueueSize () { return serialQueue.size () + inFlight.size (); }
+
+		virtual int add (Block *block);
+		virtual int receive (Block *block);
+		virtual int writable (Block *block);
+		virtual int idle ();
+		virtual void postEvent (Event *event);
+
+		virtual ~ConnSerial ();
+
 	private:
 		struct termios s_termios;
 
@@ -239,6 +345,53 @@ class ConnSerial: public ConnNoSend
 
 		void flushError ();
 
+		// asynchronous mode
+		bool async;
+		int maxInFlight;
+		std::deque <SerialCommand *> serialQueue;
+		std::deque <SerialCommand *> inFlight;
+		// data waiting to be written, and data received for the first in-flight command
+		std::string txBuf;
+		std::string rxBuf;
+		// number of bytes written to the port
+		unsigned long long txPos;
+		// true while failAll calls command callbacks
+		bool failing;
+
+		/**
+		 * Start queued commands, while there are less than maxInFlight commands in flight.
+		 */
+		void startCommands ();
+
+		/**
+		 * Write as much of txBuf as port accepts.
+		 */
+		int writeAsync ();
+
+		/**
+		 * Match received data and written bytes to in-flight commands.
+		 */
+		void processReplies ();
+
+		void checkTimeouts ();
+
+		/**
+		 * Wake up event loop at deadline of the first in-flight command.
+		 */
+		void setTimeoutTimer ();
+
+		/**
+		 * Complete the first in-flight command.
+		 */
+		void completeCommand (bool ok, size_t len, size_t consumed);
+
+		void failAll ();
+
+		/**
+		 * Close port after read error, fail all commands.
+		 */
+		void closePort (Block *block);
+
 };
 
 }
@@ -95,6 +95,8 @@ class Daemon:public Block
 
 		virtual void forkedInstance ();
 		virtual void sendMessage (messageType_t in_messageType, const char *in_messageString);
+		// daemonized messages are sent to syslog or centrald
+		virtual bool isLogged (messageType_t in_messageType) { return daemonize != DONT_DAEMONIZE || App::isLogged (in_messageType); }
 		virtual void centraldConnRunning (Connection *conn);
 		virtual void centraldConnBroken (Connection *conn);
 
@@ -190,10 +192,24 @@ class Daemon:public Block
 		}
 
 		/**
-		 * Send new value over the wire to all connections.
+		 * Send new value over the wire to all connections. Update is
+		 * postponed until the end of the current loop iteration; when
+		 * the value is changed again before that, only the last value
+		 * is send.
 		 */
 		void sendValueAll (Value * value);
 
+		/**
+		 * Send all postponed value updates, one write per connection.
+		 */
+		virtual void flushPendingValues ();
+
+		/**
+		 * Returns number of value updates which were not send, as they
+		 * were replaced by newer update before being send.
+		 */
+		long getCoalescedValues () { return coalescedValues->getValueLong (); }
+
 		/**
 		 * Send progress to newly created connections.
 		 */
@@ -684,6 +700,10 @@ class Daemon:public Block
 		ValueTime *info_time;
 		ValueTime *uptime;
 
+		// values waiting to be send to all connections
+		std::vector <Value *> pendingValues;
+		ValueLong *coalescedValues;
+
 		double idleInfoInterval;
 
 		bool doHupIdleLoop;
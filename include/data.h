@@ -21,12 +21,18 @@
 #define __RTS2_DATA__
 
 #include <errno.h>
+#include <stdint.h>
 #include <unistd.h>
+#include <map>
+#include <string>
 #include <vector>
 
 // maximal number of shared clients
 #define MAX_SHARED_CLIENTS       10
 
+// maximal number of shared data segments created with automatic size
+#define SHARED_AUTO_SEGMENTS     16
+
 namespace rts2core
 {
 
@@ -167,7 +173,8 @@ class DataRead:public DataAbstractRead
 };
 
 /**
- * Shared data header structure.
+ * Shared data header structure. Shared memory holds nseg frame slots
+ * (segments), the writer allocates the lowest free one.
  *
  * @author Petr Kubanek <petr@kubanek.net>
  */
@@ -175,55 +182,86 @@ struct SharedDataHeader
 {
 	// number of data buffers.
 	int nseg;
-	// semaphore associated with data; it has nbuffers values, each associated with a single buffer
-	int shared_sem;
 	// shared client IDs, segment sizes - SharedData - follows immediately this field
 };
 
 /**
  * Shared data segment header. Described segments of shared data.
  *
+ * Segment state is kept in a single word, updated with atomic operations, so
+ * neither writer nor readers need any lock. Upper 32 bits hold frame sequence
+ * number, incremented each time the writer allocates segment for a new frame,
+ * lower 32 bits hold number of clients reading the segment.
+ *
  * @author Petr Kubanek <petr@kubanek.net>
  */
 struct SharedDataSegment
 {
 	// ID of client connection reading data. Data cannot be reused if this field is non-empty.
 	int client_ids[MAX_SHARED_CLIENTS];
+	// frame sequence number and reference count
+	volatile uint64_t state;
 	// segment size
 	size_t size;
 	// size of written data (so far; process can update this as new data arrives
-	size_t bytesSoFar;
+	volatile size_t bytesSoFar;
 	// segment offset
 	size_t offset;
 };
 
+#define SHARED_SEQUENCE(state)    ((uint32_t) ((state) >> 32))
+#define SHARED_REFS(state)        ((uint32_t) ((state) & 0xffffffff))
+
 /**
  * Encampulates basic shared data management functions.
  *
+ * Data are stored in POSIX shared memory object, which name is derived from
+ * the ID send in PROTO_SHARED command, so any local process can map it.
+ *
  * @author Petr Kubanek <petr@kubanek.net>
  */
 class DataAbstractShared
 {
 	public:
-		DataAbstractShared () { data = NULL; shm_id = -1; }
-		DataAbstractShared (DataAbstractShared *d) { data = d->data; shm_id = -1; }
+		DataAbstractShared () { data = NULL; shm_id = -1; mapSize = 0; }
+		DataAbstractShared (DataAbstractShared *d) { data = d->data; shm_id = -1; mapSize = 0; }
 
 		int getShmId () { return shm_id; }
 
+		/**
+		 * Returns name of the POSIX shared memory object with the given ID.
+		 */
+		static std::string getShmName (int _shm_id);
+
 		/**
 		 * Remove client from reader set.
 		 */
 		int removeClient (int segnum, int client_id, bool verbose = true);
 
+		/**
+		 * Returns current frame sequence number of the segment.
+		 */
+		uint32_t getSequence (int segnum) { return SHARED_SEQUENCE (getSegment (segnum)->state); }
+
+		/**
+		 * Returns number of clients reading the segment.
+		 */
+		uint32_t getRefs (int segnum) { return SHARED_REFS (getSegment (segnum)->state); }
+
 	protected:
 		struct SharedDataSegment *getSegment (int segnum) { return (struct SharedDataSegment *) (((char *) data) + sizeof (struct SharedDataHeader) + segnum * sizeof (struct SharedDataSegment)); }
 
-		// semaphore op
-		int lockSegment (int seg);
-		int unlockSegment (int seg);
+		/**
+		 * Record client ID in the first empty client slot.
+		 *
+		 * @return -1 if all client slots are used
+		 */
+		int addClientId (struct SharedDataSegment *sseg, int client_id);
 
 		struct SharedDataHeader *data;
 		int shm_id;
+		// size of mapped memory, 0 for shallow copies
+		size_t mapSize;
 };
 
 /**
@@ -237,7 +275,7 @@ class DataSharedRead: public DataAbstractRead, public DataAbstractShared
 		/**
 		 * Crate new DataSharedRead structure, prepare it for attach call.
 		 */
-		DataSharedRead () { data = NULL; segment = -1; activeSegment = NULL; shm_id = -1; }
+		DataSharedRead () { data = NULL; segment = -1; activeSegment = NULL; shm_id = -1; sequence = 0; }
 
 
 		/**
@@ -246,10 +284,15 @@ class DataSharedRead: public DataAbstractRead, public DataAbstractShared
 		 * @param _data   
 		 * @param _seg
 		 */
-		DataSharedRead (DataSharedRead *_data, int _seg) { data = _data->data; segment = _seg; activeSegment = getSegment (_seg); shm_id = -1; }
+		DataSharedRead (DataSharedRead *_data, int _seg) { data = _data->data; segment = _seg; activeSegment = getSegment (_seg); shm_id = -1; sequence = SHARED_SEQUENCE (activeSegment->state); }
 
 		virtual ~DataSharedRead ();
 
+		/**
+		 * Map shared memory with the given ID.
+		 *
+		 * @return -1 on error, 0 on success
+		 */
 		int attach (int _shm_id);
 
 		virtual int readDataSize (Connection *conn) { return 0; }
@@ -263,10 +306,23 @@ class DataSharedRead: public DataAbstractRead, public DataAbstractShared
 		int confirmClient (int segnum, int client_id);
 		int removeActiveClient (int client_id) { return removeClient (segment, client_id); }
 
+		/**
+		 * Add an additional reader of the active segment. Segment will not be
+		 * reused for a new frame until the reader calls removeActiveClient,
+		 * so the reader can process data after PROTO_SHARED_FULL was received.
+		 *
+		 * @param client_id  ID of the reader
+		 *
+		 * @return -1 if the frame was already released and its segment reused, 0 on success
+		 */
+		int addActiveClient (int client_id);
+
 	private:
 		// shared data segment
 		struct SharedDataSegment *activeSegment;
 		int segment;
+		// sequence number of the frame in activeSegment
+		uint32_t sequence;
 };
 
 /**
@@ -329,15 +385,29 @@ class DataSharedWrite:public DataAbstractWrite, public DataAbstractShared
 
 		/**
 		 * Create new shared data.
+		 *
+		 * @param numseg    number of segments
+		 * @param segsize   maximal size of data stored in a single segment
 		 */
 		struct SharedDataHeader *create (int numseg, size_t segsize);
 
+		/**
+		 * Returns size of memory needed for given number of segments.
+		 */
+		static size_t getSharedSize (int numseg, size_t segsize);
+
 		virtual size_t getDataSize ();
 		virtual size_t getChannelSize (int chan) { return chan2seg[chan]->size - chan2seg[chan]->bytesSoFar; }
-		virtual void dataWritten (int chan, size_t size) { chan2seg[chan]->bytesSoFar += size; }
+		virtual void dataWritten (int chan, size_t size)
+		{
+			// data must be visible before readers see new size
+			__sync_synchronize ();
+			chan2seg[chan]->bytesSoFar += size;
+		}
 
 		/**
-		 * Find unused segment, allocate it for a single client.
+		 * Find unused segment with the lowest index, allocate it for a
+		 * single client.
 		 *
 		 * @param segsize   segment size
 		 * @param chan      channel for which segment is allocated
@@ -243,6 +243,8 @@ class Device:public Daemon
 		// only devices can send messages
 		virtual void sendMessage (messageType_t in_messageType, const char *in_messageString);
 
+		virtual bool isLogged (messageType_t in_messageType) { return !getCentraldConns ()->empty () || Daemon::isLogged (in_messageType); }
+
 		/**
 		 * The interrupt call. This is called on every device on
 		 * interruption. The device shall react by switching back to
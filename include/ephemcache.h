@@ -0,0 +1,233 @@
+/*
+ * Cache of interpolated positions of moving and fixed objects.
+ * Copyright (C) 2026 Petr Kubanek <petr@kubanek.net>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef __RTS2_EPHEMCACHE__
+#define __RTS2_EPHEMCACHE__
+
+#include <libnova/libnova.h>
+#include <map>
+#include <pthread.h>
+
+/** Default distance of two samples, in days (10 minutes). */
+#define EPHEMCACHE_STEP        (10.0 / 1440.0)
+
+/** Number of sample intervals in a single bucket. */
+#define EPHEMCACHE_INTERVALS   16
+
+/** Maximal number of buckets held in the cache. */
+#define EPHEMCACHE_BUCKETS     64
+
+/** Above this altitude azimuth changes too fast to be interpolated. */
+#define EPHEMCACHE_ZENITH      80.0
+
+namespace rts2core
+{
+
+/**
+ * Samples of object position covering single bucket. Bucket holds
+ * EPHEMCACHE_INTERVALS intervals, and one extra sample before and two after
+ * the bucket, so cubic interpolation can be used for any date inside the
+ * bucket.
+ */
+class EphemerisBucket
+{
+	public:
+		EphemerisBucket () { hrzValid = false; }
+
+		// RA is unwrapped, so it can be interpolated across 0/360
+		double ra[EPHEMCACHE_INTERVALS + 3];
+		double dec[EPHEMCACHE_INTERVALS + 3];
+
+		// alt and unwrapped az, calculated on first request
+		double alt[EPHEMCACHE_INTERVALS + 3];
+		double az[EPHEMCACHE_INTERVALS + 3];
+		bool hrzValid;
+};
+
+/**
+ * Per object cache of equatorial and horizontal positions. Position is
+ * calculated at fixed steps, positions for dates between the steps are
+ * interpolated by cubic (four point Lagrange) polynomial. With the default
+ * 10 minutes step, error of interpolated equatorial coordinates of objects
+ * moving no faster than the Moon is below 0.1 arcsec. Error of horizontal
+ * coordinates is below 5 arcsec; above EPHEMCACHE_ZENITH altitude,
+ * horizontal coordinates are calculated from interpolated equatorial
+ * coordinates.
+ *
+ * Samples are grouped to buckets, indexed by JD. Buckets are created on
+ * demand, so cache of a night worth of queries contains only samples
+ * needed to answer them.
+ *
+ * Descendants provide computePosition method, which calculates exact
+ * position of the object. Cache can be queried from multiple threads,
+ * computePosition is always called with the cache lock held.
+ *
+ * @author Petr Kubanek <petr@kubanek.net>
+ */
+class EphemerisCache
+{
+	public:
+		/**
+		 * @param _step   distance between samples, in days
+		 */
+		EphemerisCache (double _step = EPHEMCACHE_STEP);
+		virtual ~EphemerisCache ();
+
+		/**
+		 * Returns interpolated equatorial position.
+		 *
+		 * @param pos   returned position
+		 * @param JD    Julian date
+		 */
+		void getEquPosition (struct ln_equ_posn *pos, double JD);
+
+		/**
+		 * Returns interpolated horizontal position. If the observer
+		 * differs from the observer used for cached samples, horizontal
+		 * samples are recalculated.
+		 *
+		 * @param hrz   returned position
+		 * @param JD    Julian date
+		 * @param obs   observer position
+		 */
+		void getHrzPosition (struct ln_hrz_posn *hrz, double JD, struct ln_lnlat_posn *obs);
+
+		/**
+		 * Drop all cached samples. Must be called when object position
+		 * (orbit, coordinates,..) changes.
+		 */
+		void clear ();
+
+		double getStep () { return step; }
+
+		/**
+		 * Disabled cache returns exact positions, calculated on every
+		 * call.
+		 */
+		void setEnabled (bool _enabled) { enabled = _enabled; }
+
+		bool isEnabled () { return enabled; }
+
+		/**
+		 * Number of queries answered from cached samples.
+		 */
+		long getHits () { return hits; }
+
+		/**
+		 * Number of buckets calculated.
+		 */
+		long getMisses () { return misses; }
+
+	protected:
+		/**
+		 * Calculate exact object position.
+		 */
+		virtual void computePosition (struct ln_equ_posn *pos, double JD) = 0;
+
+	private:
+		double step;
+		bool enabled;
+		std::map <long, EphemerisBucket> buckets;
+
+		pthread_mutex_t lock;
+
+		// last used bucket - queries are usually for close dates
+		long lastIndex;
+		EphemerisBucket *lastBucket;
+
+		struct ln_lnlat_posn observer;
+
+		long hits;
+		long misses;
+
+		/**
+		 * Find bucket for given date, calculate it if it is not cached.
+		 *
+		 * @param JD   Julian date
+		 * @param k    returned index of sample preceding JD
+		 * @param t    returned fraction of step between sample k and JD
+		 */
+		EphemerisBucket *getBucket (double JD, int &k, double &t);
+
+		void computeHrz (EphemerisBucket *b, long index);
+};
+
+/**
+ * Cached position of the Sun.
+ */
+class SolarEphemeris:public EphemerisCache
+{
+	public:
+		SolarEphemeris ();
+
+		/**
+		 * Returns process wide cache of solar positions. Cache is
+		 * enabled by ephemeris_cache option of the observatory
+		 * section.
+		 */
+		static SolarEphemeris *instance ();
+
+		/**
+		 * Returns solar position from process wide cache. Can be
+		 * passed to libnova functions instead of
+		 * ln_get_solar_equ_coords.
+		 */
+		static void getEquCoords (double JD, struct ln_equ_posn *pos) { instance ()->getEquPosition (pos, JD); }
+
+	protected:
+		virtual void computePosition (struct ln_equ_posn *pos, double JD) { ln_get_solar_equ_coords (JD, pos); }
+};
+
+/**
+ * Cached position of the Moon.
+ */
+class LunarEphemeris:public EphemerisCache
+{
+	public:
+		LunarEphemeris ();
+
+		/**
+		 * Returns process wide cache of lunar positions. Cache is
+		 * enabled by ephemeris_cache option of the observatory
+		 * section.
+		 */
+		static LunarEphemeris *instance ();
+
+		/**
+		 * Returns lunar position from process wide cache. Can be
+		 * passed to libnova functions instead of
+		 * ln_get_lunar_equ_coords.
+		 */
+		static void getEquCoords (double JD, struct ln_equ_posn *pos) { instance ()->getEquPosition (pos, JD); }
+
+		/**
+		 * Returns lunar phase angle, as ln_get_lunar_phase does (0
+		 * for full Moon, 180 for new Moon). Phase is calculated from
+		 * cached lunar and solar positions and mean Earth - Moon and
+		 * Earth - Sun distances, its error is below 0.02 degree.
+		 */
+		double getPhase (double JD);
+
+	protected:
+		virtual void computePosition (struct ln_equ_posn *pos, double JD) { ln_get_lunar_equ_coords (JD, pos); }
+};
+
+}
+
+#endif // !__RTS2_EPHEMCACHE__
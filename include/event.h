@@ -99,6 +99,12 @@
 /** Timeout for closign sequence. */
 #define EVENT_CLOSE_TIMEOUT              27
 
+/** Timeout of asynchronous serial command. */
+#define EVENT_SERIAL_TIMEOUT             28
+
+/** Start asynchronous serial commands queued from failure callbacks or to the closed port. */
+#define EVENT_SERIAL_START               29
+
 // events number below that number shoudl be considered RTS2-reserved
 #define RTS2_LOCAL_EVENT         1000
 
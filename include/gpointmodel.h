@@ -29,6 +29,9 @@ namespace rts2telmodel
 //* maximal number of terms
 #define MAX_TERMS   4
 
+//* maximal multiple of angle which sine and cosine are calculated from angle sine and cosine
+#define MAX_HARMONIC   16
+
 typedef enum { GPOINT_OFFSET=0, GPOINT_SIN, GPOINT_COS, GPOINT_TAN, GPOINT_SINCOS, GPOINT_COSCOS, GPOINT_SINSIN, GPOINT_ABSSIN, GPOINT_ABSCOS, GPOINT_CSC, GPOINT_SEC, GPOINT_COT, GPOINT_SINH, GPOINT_COSH, GPOINT_TANH, GPOINT_SECH, GPOINT_CSCH, GPOINT_COTH, GPOINT_LASTFUN } function_t;
 typedef enum { GPOINT_AZ=0, GPOINT_EL, GPOINT_ZD, GPOINT_HA, GPOINT_DEC, GPOINT_PD, GPOINT_LASTTERM } terms_t;
 
@@ -58,6 +61,33 @@ class ExtraParam
 		double getParamValue (double az, double alt, double ha, double dec, int p);
 };
 
+/**
+ * Angles of a single position, with sines and cosines of their integer
+ * multiples. Calculated once per position and shared by all model terms.
+ */
+struct ModelArguments
+{
+	// indexed by terms_t, GPOINT_PD and GPOINT_LASTTERM are 0
+	double angle[GPOINT_LASTTERM + 1];
+	// sine and cosine of harmonic * angle, indexed [harmonic][term]
+	double sin[MAX_HARMONIC + 1][GPOINT_LASTTERM + 1];
+	double cos[MAX_HARMONIC + 1][GPOINT_LASTTERM + 1];
+};
+
+/**
+ * Extra parameter compiled for evaluation. Argument with integer constant
+ * is read from ModelArguments tables, other arguments are calculated.
+ */
+struct ModelTerm
+{
+	function_t function;
+	double param;
+	terms_t terms[2];
+	double consts[2];
+	// integer constant, 0 if argument is not in ModelArguments tables
+	int harmonics[2];
+};
+
 /**
  * Telescope pointing model. Based on the following article:
  *
@@ -87,6 +117,48 @@ class GPointModel:public TelModel
 		 */
 		void getErrAltAz (struct ln_hrz_posn *hrz, struct ln_equ_posn *equ, struct ln_hrz_posn *err);
 
+		/**
+		 * Apply model to arrays of positions. All positions are in degrees.
+		 *
+		 * @param n     number of positions
+		 * @param ha    hour angles, replaced with corrected values
+		 * @param dec   declinations, replaced with corrected values
+		 */
+		void apply (size_t n, double *ha, double *dec);
+
+		/**
+		 * Reverse model for arrays of positions, as reverse does for
+		 * single position. All positions are in degrees.
+		 *
+		 * @param n     number of positions
+		 * @param ha    hour angles, replaced with corrected values
+		 * @param dec   declinations, replaced with corrected values
+		 * @param az    azimuths, used by extra parameters
+		 * @param alt   altitudes, used by extra parameters
+		 */
+		void reverse (size_t n, double *ha, double *dec, const double *az, const double *alt);
+
+		/**
+		 * Calculate errors of alt-az model for arrays of positions, as
+		 * getErrAltAz does for single position. All positions are in
+		 * degrees.
+		 *
+		 * @param n        number of positions
+		 * @param az       azimuths, errors are added to them
+		 * @param alt      altitudes, errors are added to them
+		 * @param ha       hour angles, used by extra parameters
+		 * @param dec      declinations, used by extra parameters
+		 * @param err_az   returned azimuth errors
+		 * @param err_alt  returned altitude errors
+		 */
+		void getErrAltAz (size_t n, double *az, double *alt, const double *ha, const double *dec, double *err_az, double *err_alt);
+
+		/**
+		 * Compile extra parameters for evaluation. Called after model
+		 * is loaded, must be called after extra parameters are changed.
+		 */
+		void compile ();
+
 		virtual std::istream & load (std::istream & is);
 		virtual std::ostream & print (std::ostream & os, char frmt = 'r');
 
@@ -99,6 +171,33 @@ class GPointModel:public TelModel
 		std::list <ExtraParam *> extraParamsDec;
 
 		bool altaz;
+
+	private:
+		// parameters and latitude trigonometric functions used by evaluation
+		double dparams[9];
+		double sinLat;
+		double cosLat;
+
+		std::vector <ModelTerm> termsAz;
+		std::vector <ModelTerm> termsEl;
+		std::vector <ModelTerm> termsHa;
+		std::vector <ModelTerm> termsDec;
+
+		// highest harmonic of the angle used by compiled terms
+		int maxHarmonic[GPOINT_LASTTERM + 1];
+
+		void compileTerms (std::list <ExtraParam *> &extra, std::vector <ModelTerm> &terms);
+
+		/**
+		 * Fill arguments for given position, in radians.
+		 */
+		void fillArguments (ModelArguments &args, double az, double el, double ha, double dec);
+
+		double getTermsValue (std::vector <ModelTerm> &terms, ModelArguments &args);
+
+		void applyPosition (double &ha, double &dec);
+		void reversePosition (double &ha, double &dec, double az, double el, ModelArguments &args);
+		void errAltAz (double &az, double &el, double ha, double dec, double &err_az, double &err_el, ModelArguments &args);
 };
 
 std::istream & operator >> (std::istream & is, GPointModel * model);
@@ -32,7 +32,8 @@ class App;
  * Class used for streaming log messages. This class provides operators which
  * sends through it various values. Once the message is completed by sending
  * sendLog manipulator to this class, it is passed to the system for
- * processing.
+ * processing. Messages which the application will not send anywhere (e.g.
+ * debug messages of a client without debugging enabled) are not formatted.
  *
  * @ingroup RTS2Block
  *
@@ -45,6 +46,7 @@ class LogStream
 		{
 			masterApp = in_master;
 			messageType = in_type;
+			enabled = isLogged (masterApp, messageType);
 			ls.setf (std::ios_base::fixed, std::ios_base::floatfield);
 			ls.precision (6);
 		}
@@ -53,6 +55,7 @@ class LogStream
 		{
 			masterApp = _logStream.masterApp;
 			messageType = _logStream.messageType;
+			enabled = _logStream.enabled;
 			ls.setf (std::ios_base::fixed, std::ios_base::floatfield);
 			ls.precision (6);
 		}
@@ -62,6 +65,7 @@ class LogStream
 		{
 			masterApp = _logStream.masterApp;
 			messageType = _logStream.messageType;
+			enabled = _logStream.enabled;
 			ls.setf (std::ios_base::fixed, std::ios_base::floatfield);
 			ls.precision (6);
 		}
@@ -73,7 +77,8 @@ class LogStream
 
 		template < typename _charT > LogStream & operator << (_charT value)
 		{
-			ls << value;
+			if (enabled)
+				ls << value;
 			return *this;
 		}
 
@@ -115,6 +120,11 @@ class LogStream
 		rts2core::App * masterApp;
 		messageType_t messageType;
 		std::ostringstream ls;
+
+		// false if the message will not be sent, so it is not formatted
+		bool enabled;
+
+		static bool isLogged (rts2core::App * app, messageType_t in_type);
 };
 
 }
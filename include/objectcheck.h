@@ -66,6 +66,27 @@ class ObjectCheck
 
 		double getHorizonHeight (const struct ln_hrz_posn *hrz, int hardness);
 
+		/**
+		 * Returns horizon heights for array of azimuths.
+		 *
+		 * @param n         number of positions
+		 * @param az        azimuths (in degrees)
+		 * @param heights   returned horizon heights (in degrees)
+		 * @param hardness  how many limits to ignore
+		 */
+		void getHorizonHeight (size_t n, const double *az, double *heights, int hardness);
+
+		/**
+		 * Check if positions are above horizon.
+		 *
+		 * @param n         number of positions
+		 * @param alt       altitudes (in degrees)
+		 * @param az        azimuths (in degrees)
+		 * @param good      returned 1 if position is above horizon, 0 otherwise
+		 * @param hardness  how many limits to ignore
+		 */
+		void is_good (size_t n, const double *alt, const double *az, int *good, int hardness = 0);
+
 		horizon_t::iterator begin ()
 		{
 			return horizon.begin ();
@@ -85,8 +106,23 @@ class ObjectCheck
 
 		horizon_t horizon;
 
+		// for every AZ_BINS azimuth bin, index of the first horizon entry with azimuth above bin start
+		std::vector <size_t> azIndex;
+
 		int load_horizon (const char *horizon_file);
 
+		/**
+		 * Fill azimuth index of the sorted horizon.
+		 */
+		void fillAzIndex ();
+
+		/**
+		 * Returns index of the first horizon entry with azimuth above az.
+		 */
+		size_t findAz (double az);
+
 		double getHorizonHeightAz (double az, horizon_t::iterator iter1, horizon_t::iterator iter2);
+
+		double getHorizonHeightAz (double az);
 };
 #endif							 /* ! __RTS2__OBJECTCHECK__ */
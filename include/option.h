@@ -58,6 +58,10 @@
 
 #define OPT_DEFAULTS        1015
 
+#define OPT_POLL            1016
+
+#define OPT_TEXT_VALUES     1017
+
 /**
  * Start of local option number playground.
  */
@@ -0,0 +1,581 @@
+/*
+ * Single pass pixel statistics.
+ * Copyright (C) 2026 Petr Kubanek <petr@kubanek.net>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef __RTS2_PIXELSTAT__
+#define __RTS2_PIXELSTAT__
+
+#include <cmath>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#include "imghdr.h"
+
+/** Number of pixels processed in a single block. Block shall fit into L1 cache. */
+#define PIXSTAT_BLOCK         4096
+
+/** Number of interleaved sub-histograms used for blocked histogram accumulation. */
+#define PIXSTAT_SUBHISTS      4
+
+/** Number of histogram bins. Pixels outside of the histogram range are not counted for mode. */
+#define PIXSTAT_BINS          65536
+
+/** Sub-histogram stride. Includes guard bin for values outside of the histogram range. */
+#define PIXSTAT_SUBSTRIDE     (PIXSTAT_BINS + 1)
+
+namespace rts2camd
+{
+
+/**
+ * Per-type parameters of the statistics kernel. Sum is accumulated in
+ * integer types where it cannot overflow for any reasonable image size, as
+ * this allows vectorization of the sum loop.
+ */
+template <typename t> struct PixelTraits
+{
+	typedef double sum_t;
+	// offset added to pixel value to get histogram bin
+	static const long offset = 0;
+	// true if all pixel values fall into histogram
+	static const bool direct = false;
+};
+
+template <> struct PixelTraits <uint8_t> { typedef int64_t sum_t; static const long offset = 0; static const bool direct = true; };
+template <> struct PixelTraits <int8_t> { typedef int64_t sum_t; static const long offset = 128; static const bool direct = true; };
+template <> struct PixelTraits <uint16_t> { typedef int64_t sum_t; static const long offset = 0; static const bool direct = true; };
+template <> struct PixelTraits <int16_t> { typedef int64_t sum_t; static const long offset = 32768; static const bool direct = true; };
+template <> struct PixelTraits <uint32_t> { typedef int64_t sum_t; static const long offset = 0; static const bool direct = false; };
+template <> struct PixelTraits <int32_t> { typedef int64_t sum_t; static const long offset = 0; static const bool direct = false; };
+template <> struct PixelTraits <int64_t> { typedef long double sum_t; static const long offset = 0; static const bool direct = false; };
+
+/**
+ * Calculates sum, minimum, maximum and mode of image data, together with
+ * center box sums, in a single pass over readout chunk.
+ *
+ * Data are processed in blocks which fit into L1 cache. Sum, minimum and
+ * maximum are calculated in independent lanes, so compiler can vectorize the
+ * loop. Mode histogram of large chunks is accumulated into interleaved
+ * sub-histograms, which are folded into the main histogram at the end of the
+ * chunk only over the range of values found in the chunk. Mode is tracked
+ * incrementally, so the full histogram is never scanned.
+ *
+ * Histogram has PIXSTAT_BINS bins. Signed 8 and 16 bit types are offset so
+ * all values fit; for wider and floating point types only values in
+ * [0, PIXSTAT_BINS) are counted for mode.
+ *
+ * @author Petr Kubanek <petr@kubanek.net>
+ */
+class PixelStatistics
+{
+	public:
+		PixelStatistics ()
+		{
+			hist = NULL;
+			subHists = NULL;
+			blockedHist = false;
+			histOffset = -1;
+			centerW = 0;
+			resetStatistics ();
+			histLow = PIXSTAT_BINS;
+			histHigh = -1;
+			modeBin = -1;
+			modeCnt = 0;
+		}
+
+		~PixelStatistics ()
+		{
+			delete[] hist;
+			delete[] subHists;
+		}
+
+		/**
+		 * Reset sum, minimum and maximum.
+		 */
+		void resetStatistics ()
+		{
+			pixels = 0;
+			sum = 0;
+			min = INFINITY;
+			max = -INFINITY;
+		}
+
+		/**
+		 * Clear mode histogram. Only part of the histogram touched since the last reset is cleared.
+		 */
+		void resetMode ()
+		{
+			if (hist != NULL && histHigh >= histLow)
+				memset (hist + histLow, 0, (histHigh - histLow + 1) * sizeof (uint32_t));
+			histLow = PIXSTAT_BINS;
+			histHigh = -1;
+			modeBin = -1;
+			modeCnt = 0;
+		}
+
+		/**
+		 * Set center box. Box coordinates are in binned pixels, relative to the start of data.
+		 *
+		 * @param x         box start column
+		 * @param y         box start row
+		 * @param w         box width; 0 disables center calculation
+		 * @param h         box height
+		 * @param width     width of the image row
+		 * @param cutLevel  only pixels with value equal or above cut level are considered
+		 */
+		void setCenterBox (int x, int y, int w, int h, int width, double cutLevel)
+		{
+			centerX = x;
+			centerY = y;
+			centerW = w;
+			centerH = h;
+			rowWidth = width;
+			centerCut = cutLevel;
+		}
+
+		/**
+		 * Update statistics with a chunk of data.
+		 *
+		 * @param data        pixel data
+		 * @param dataSize    data size in bytes
+		 * @param calcMode    if true, mode histogram is updated
+		 *
+		 * @return number of pixels processed
+		 */
+		template <typename t> size_t update (const t *data, size_t dataSize, bool calcMode)
+		{
+			size_t n = dataSize / sizeof (t);
+			centerDone = false;
+
+			if (calcMode)
+				prepareHistogram (PixelTraits<t>::offset, n >= 4 * PIXSTAT_BINS);
+
+			typename PixelTraits<t>::sum_t tSum = 0;
+			t tMin = 0, tMax = 0;
+			if (n > 0)
+				tMin = tMax = data[0];
+
+			int cRows = 0;
+			if (centerW > 0)
+			{
+				// calculate center only if the box is inside data
+				if (centerX >= 0 && centerY >= 0 && rowWidth > 0 && centerX + centerW <= rowWidth && (size_t) (centerY + centerH) * rowWidth <= n)
+				{
+					cRows = centerH;
+					centerSumsX.assign (centerW, 0);
+					centerSumsY.assign (centerH, 0);
+					centerMax = centerCut;
+					centerTotal = 0;
+					centerPixels = 0;
+				}
+			}
+
+			const t *p = data;
+			const t *end = data + n;
+			long chunkLow = PIXSTAT_BINS, chunkHigh = -1;
+
+			// process rows when center is calculated, so the center box is evaluated while data are in cache
+			size_t block = cRows > 0 ? rowWidth : PIXSTAT_BLOCK;
+			int row = 0;
+
+			while (p < end)
+			{
+				size_t bn = end - p;
+				if (bn > block)
+					bn = block;
+				t bMin, bMax;
+				typename PixelTraits<t>::sum_t bSum = blockStatistics (p, bn, bMin, bMax);
+				tSum += bSum;
+				if (bMin < tMin)
+					tMin = bMin;
+				if (bMax > tMax)
+					tMax = bMax;
+				if (calcMode)
+				{
+					if (blockedHist)
+						// block sum is NaN if block contains NaN
+						accumulateBlocked (p, bn, bMin >= 0 && bMax < PIXSTAT_BINS && bSum == bSum);
+					else
+						accumulateDirect (p, bn);
+					long l = binLow (bMin);
+					long h = binHigh (bMax);
+					if (l < chunkLow)
+						chunkLow = l;
+					if (h > chunkHigh)
+						chunkHigh = h;
+				}
+				if (cRows > 0 && row >= centerY && row < centerY + centerH)
+					centerRow (p + centerX, row - centerY);
+				p += bn;
+				row++;
+			}
+
+			if (calcMode && blockedHist)
+				foldHistogram (chunkLow, chunkHigh);
+
+			if (n > 0)
+			{
+				sum += tSum;
+				if (tMin < min)
+					min = tMin;
+				if (tMax > max)
+					max = tMax;
+			}
+			pixels += n;
+			centerDone = cRows > 0;
+			return n;
+		}
+
+		/**
+		 * Update statistics with a chunk of data of given RTS2 data type.
+		 *
+		 * @param dataType    RTS2_DATA_xxx data type
+		 * @param data        pixel data
+		 * @param dataSize    data size in bytes
+		 * @param calcMode    if true, mode histogram is updated
+		 *
+		 * @return number of pixels processed, 0 for unknown data type
+		 */
+		size_t update (int dataType, const char *data, size_t dataSize, bool calcMode)
+		{
+			switch (dataType)
+			{
+				case RTS2_DATA_BYTE:
+					return update ((const uint8_t *) data, dataSize, calcMode);
+				case RTS2_DATA_SHORT:
+					return update ((const int16_t *) data, dataSize, calcMode);
+				case RTS2_DATA_LONG:
+					return update ((const int32_t *) data, dataSize, calcMode);
+				case RTS2_DATA_LONGLONG:
+					return update ((const int64_t *) data, dataSize, calcMode);
+				case RTS2_DATA_FLOAT:
+					return update ((const float *) data, dataSize, calcMode);
+				case RTS2_DATA_DOUBLE:
+					return update ((const double *) data, dataSize, calcMode);
+				case RTS2_DATA_SBYTE:
+					return update ((const int8_t *) data, dataSize, calcMode);
+				case RTS2_DATA_USHORT:
+					return update ((const uint16_t *) data, dataSize, calcMode);
+				case RTS2_DATA_ULONG:
+					return update ((const uint32_t *) data, dataSize, calcMode);
+			}
+			return 0;
+		}
+
+		/**
+		 * Add statistics calculated from other chunk. Only histogram
+		 * range touched by the other statistics is visited. Center
+		 * values are not merged.
+		 */
+		void merge (const PixelStatistics &other)
+		{
+			if (other.pixels == 0)
+				return;
+			pixels += other.pixels;
+			sum += other.sum;
+			if (other.min < min)
+				min = other.min;
+			if (other.max > max)
+				max = other.max;
+
+			if (other.hist == NULL || other.histHigh < other.histLow)
+				return;
+			prepareHistogram (other.histOffset, false);
+			for (long b = other.histLow; b <= other.histHigh; b++)
+			{
+				if (other.hist[b] == 0)
+					continue;
+				uint32_t c = (hist[b] += other.hist[b]);
+				if (c >= modeCnt)
+					countBin (b, c);
+			}
+			if (other.histLow < histLow)
+				histLow = other.histLow;
+			if (other.histHigh > histHigh)
+				histHigh = other.histHigh;
+		}
+
+		size_t getPixels () { return pixels; }
+		double getSum () { return sum; }
+		double getMin () { return min; }
+		double getMax () { return max; }
+		double getAverage () { return pixels > 0 ? sum / pixels : NAN; }
+
+		/**
+		 * Returns true if some pixels were counted for mode.
+		 */
+		bool haveMode () { return modeBin >= 0; }
+
+		/**
+		 * Returns image mode. If more values have the same count, the lowest one is returned.
+		 */
+		long getMode () { return modeBin - histOffset; }
+
+		/**
+		 * Returns true if center box was calculated from the last chunk.
+		 */
+		bool isCenterCalculated () { return centerDone; }
+
+		const std::vector <double> & getCenterSumsX () { return centerSumsX; }
+		const std::vector <double> & getCenterSumsY () { return centerSumsY; }
+		double getCenterMax () { return centerMax; }
+		double getCenterAverage () { return centerPixels > 0 ? centerTotal / centerPixels : 0; }
+
+	private:
+		size_t pixels;
+		double sum;
+		double min;
+		double max;
+
+		uint32_t *hist;
+		uint32_t *subHists;
+		// true if the current chunk is accumulated to sub-histograms
+		bool blockedHist;
+		long histOffset;
+		// range of bins touched since the last resetMode call
+		long histLow;
+		long histHigh;
+		long modeBin;
+		uint32_t modeCnt;
+
+		int centerX;
+		int centerY;
+		int centerW;
+		int centerH;
+		int rowWidth;
+		double centerCut;
+
+		bool centerDone;
+		std::vector <double> centerSumsX;
+		std::vector <double> centerSumsY;
+		double centerMax;
+		double centerTotal;
+		long centerPixels;
+
+		void prepareHistogram (long offset, bool blocked)
+		{
+			if (hist == NULL)
+			{
+				hist = new uint32_t[PIXSTAT_BINS];
+				memset (hist, 0, PIXSTAT_BINS * sizeof (uint32_t));
+			}
+			// data type changed
+			if (offset != histOffset)
+			{
+				resetMode ();
+				histOffset = offset;
+			}
+			if (blocked && subHists == NULL)
+			{
+				subHists = new uint32_t[PIXSTAT_SUBHISTS * PIXSTAT_SUBSTRIDE];
+				memset (subHists, 0, PIXSTAT_SUBHISTS * PIXSTAT_SUBSTRIDE * sizeof (uint32_t));
+			}
+			blockedHist = blocked;
+		}
+
+		template <typename t> static typename PixelTraits<t>::sum_t blockStatistics (const t *p, size_t n, t &bMin, t &bMax)
+		{
+			typename PixelTraits<t>::sum_t s[8];
+			t lMin[8], lMax[8];
+			size_t i, l;
+			for (l = 0; l < 8; l++)
+			{
+				s[l] = 0;
+				lMin[l] = lMax[l] = p[0];
+			}
+			size_t n8 = n & ~((size_t) 7);
+			for (i = 0; i < n8; i += 8)
+			{
+				for (l = 0; l < 8; l++)
+				{
+					t v = p[i + l];
+					s[l] += v;
+					lMin[l] = v < lMin[l] ? v : lMin[l];
+					lMax[l] = v > lMax[l] ? v : lMax[l];
+				}
+			}
+			for (; i < n; i++)
+			{
+				t v = p[i];
+				s[0] += v;
+				lMin[0] = v < lMin[0] ? v : lMin[0];
+				lMax[0] = v > lMax[0] ? v : lMax[0];
+			}
+			for (l = 1; l < 8; l++)
+			{
+				s[0] += s[l];
+				if (lMin[l] < lMin[0])
+					lMin[0] = lMin[l];
+				if (lMax[l] > lMax[0])
+					lMax[0] = lMax[l];
+			}
+			bMin = lMin[0];
+			bMax = lMax[0];
+			return s[0];
+		}
+
+		// returns histogram bin, or -1 if value does not fall into histogram
+		template <typename t> long bin (t v)
+		{
+			if (PixelTraits<t>::direct)
+				return (long) v + PixelTraits<t>::offset;
+			if (!(v >= 0 && v < PIXSTAT_BINS))
+				return -1;
+			return (long) v;
+		}
+
+		// branchless bin for blocked accumulation, returns PIXSTAT_BINS guard bin for out of range values
+		template <typename t> static long guardBin (t v)
+		{
+			return (v >= 0 && v < PIXSTAT_BINS) ? (long) v : PIXSTAT_BINS;
+		}
+
+		template <typename t> long binLow (t v)
+		{
+			if (PixelTraits<t>::direct)
+				return (long) v + PixelTraits<t>::offset;
+			if (!(v >= 0))
+				return 0;
+			if (v >= PIXSTAT_BINS)
+				return PIXSTAT_BINS;
+			return (long) v;
+		}
+
+		template <typename t> long binHigh (t v)
+		{
+			if (PixelTraits<t>::direct)
+				return (long) v + PixelTraits<t>::offset;
+			if (!(v >= 0))
+				return -1;
+			if (v >= PIXSTAT_BINS)
+				return PIXSTAT_BINS - 1;
+			return (long) v;
+		}
+
+		void countBin (long b, uint32_t c)
+		{
+			if (c > modeCnt || (c == modeCnt && b < modeBin))
+			{
+				modeCnt = c;
+				modeBin = b;
+			}
+		}
+
+		// small chunks - update main histogram and mode directly
+		template <typename t> void accumulateDirect (const t *p, size_t n)
+		{
+			for (size_t i = 0; i < n; i++)
+			{
+				long b = bin (p[i]);
+				if (b < 0)
+					continue;
+				uint32_t c = ++hist[b];
+				if (c >= modeCnt)
+					countBin (b, c);
+				if (b < histLow)
+					histLow = b;
+				if (b > histHigh)
+					histHigh = b;
+			}
+		}
+
+		// large chunks - accumulate into interleaved sub-histograms, to avoid store-to-load dependencies on repeated values
+		// inRange is true if all block values fall into histogram, so range checks can be skipped
+		template <typename t> void accumulateBlocked (const t *p, size_t n, bool inRange)
+		{
+			uint32_t *h0 = subHists;
+			uint32_t *h1 = subHists + PIXSTAT_SUBSTRIDE;
+			uint32_t *h2 = subHists + 2 * PIXSTAT_SUBSTRIDE;
+			uint32_t *h3 = subHists + 3 * PIXSTAT_SUBSTRIDE;
+			size_t i = 0;
+			size_t n4 = n & ~((size_t) 3);
+			if (PixelTraits<t>::direct || inRange)
+			{
+				for (; i < n4; i += 4)
+				{
+					h0[(long) p[i] + PixelTraits<t>::offset]++;
+					h1[(long) p[i + 1] + PixelTraits<t>::offset]++;
+					h2[(long) p[i + 2] + PixelTraits<t>::offset]++;
+					h3[(long) p[i + 3] + PixelTraits<t>::offset]++;
+				}
+			}
+			else
+			{
+				// out of range values are counted to the guard bin past the end of each sub-histogram
+				for (; i < n4; i += 4)
+				{
+					h0[guardBin (p[i])]++;
+					h1[guardBin (p[i + 1])]++;
+					h2[guardBin (p[i + 2])]++;
+					h3[guardBin (p[i + 3])]++;
+				}
+			}
+			for (; i < n; i++)
+			{
+				long b = bin (p[i]);
+				if (b >= 0)
+					subHists[(i & 3) * PIXSTAT_SUBSTRIDE + b]++;
+			}
+		}
+
+		void foldHistogram (long low, long high)
+		{
+			uint32_t *h0 = subHists;
+			uint32_t *h1 = subHists + PIXSTAT_SUBSTRIDE;
+			uint32_t *h2 = subHists + 2 * PIXSTAT_SUBSTRIDE;
+			uint32_t *h3 = subHists + 3 * PIXSTAT_SUBSTRIDE;
+			for (long b = low; b <= high; b++)
+			{
+				uint32_t a = h0[b] + h1[b] + h2[b] + h3[b];
+				if (a == 0)
+					continue;
+				h0[b] = h1[b] = h2[b] = h3[b] = 0;
+				uint32_t c = (hist[b] += a);
+				// counts only increase, so only updated bins can become new mode
+				if (c >= modeCnt)
+					countBin (b, c);
+			}
+			if (low < histLow)
+				histLow = low;
+			if (high > histHigh)
+				histHigh = high;
+		}
+
+		template <typename t> void centerRow (const t *p, int crow)
+		{
+			double rs = 0;
+			for (int col = 0; col < centerW; col++)
+			{
+				t v = p[col];
+				if (v >= centerCut)
+				{
+					centerSumsX[col] += v;
+					rs += v;
+					centerPixels++;
+					if (std::isnan (centerMax) || v > centerMax)
+						centerMax = v;
+				}
+			}
+			centerSumsY[crow] = rs;
+			centerTotal += rs;
+		}
+};
+
+}
+
+#endif // !__RTS2_PIXELSTAT__
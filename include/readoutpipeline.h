@@ -0,0 +1,207 @@
+/*
+ * Multi-threaded processing of camera readout data.
+ * Copyright (C) 2026 Petr Kubanek <petr@kubanek.net>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef __RTS2_READOUTPIPELINE__
+#define __RTS2_READOUTPIPELINE__
+
+#include "connnosend.h"
+#include "pixelstat.h"
+#include "tsqueue.h"
+
+#include <list>
+#include <pthread.h>
+
+namespace rts2camd
+{
+
+class Camera;
+class ReadoutPipeline;
+
+/**
+ * Single chunk of readout data, queued for processing by pipeline worker.
+ * Job holds copy of the data, so camera driver can reuse its readout buffer
+ * as soon as Camera::sendReadoutData returns.
+ *
+ * @author Petr Kubanek <petr@kubanek.net>
+ */
+class ReadoutJob
+{
+	public:
+		ReadoutJob ()
+		{
+			data = NULL;
+			dataSize = 0;
+			capacity = 0;
+		}
+
+		~ReadoutJob () { delete[] data; }
+
+		char *data;
+		size_t dataSize;
+		size_t capacity;
+
+		int chan;
+		int dataType;
+
+		bool calcStat;
+		bool calcMode;
+		bool calcCenter;
+
+		// true if data shall be send over TCP/IP when the job is completed
+		bool sendData;
+
+		// statistics of the chunk
+		PixelStatistics stat;
+};
+
+/**
+ * Connection waking up the main event loop when pipeline workers finish
+ * processing of a readout chunk.
+ */
+class ConnReadoutNotify:public rts2core::ConnNoSend
+{
+	public:
+		ConnReadoutNotify (int _sock, rts2core::Block *_master, ReadoutPipeline *_pipeline):rts2core::ConnNoSend (_sock, _master) { pipeline = _pipeline; }
+
+		virtual int receive (rts2core::Block *block);
+
+	private:
+		ReadoutPipeline *pipeline;
+};
+
+/**
+ * Pool of worker threads processing readout chunks. Statistics, center
+ * and other per-chunk calculations run on the workers, so they overlap with
+ * hardware readout of the next chunk. Completed jobs are handed back to the
+ * main thread through notification pipe, and Camera::readoutJobDone is
+ * called from the main event loop, where values are updated and data are
+ * send to the client.
+ *
+ * Chunks of a single channel are always processed by the same worker, so
+ * their data are delivered in the order they were read out.
+ *
+ * SEP star finding (Camera::findSepStars) needs the whole frame and is
+ * called by drivers after the readout, so it is not run by the pipeline.
+ *
+ * @author Petr Kubanek <petr@kubanek.net>
+ */
+class ReadoutPipeline
+{
+	public:
+		/**
+		 * @param _camera    camera which data are processed
+		 * @param _threads   number of worker threads
+		 */
+		ReadoutPipeline (Camera *_camera, int _threads);
+		~ReadoutPipeline ();
+
+		/**
+		 * Start worker threads and create notification connection.
+		 * Connection must be added to the camera connections.
+		 *
+		 * @return notification connection, NULL on error
+		 */
+		ConnReadoutNotify *start ();
+
+		/**
+		 * Returns job holding copy of the data.
+		 */
+		ReadoutJob *getJob (const char *data, size_t dataSize, int chan);
+
+		/**
+		 * Queue job for processing. Blocks if too many jobs are waiting for processing.
+		 *
+		 * @return -1 if sending of some previous data failed, otherwise 0
+		 */
+		int queue (ReadoutJob *job);
+
+		/**
+		 * Wait for all queued jobs to finish.
+		 *
+		 * @param process  if false, completed jobs are discarded, their data are not send
+		 *
+		 * @return -1 if sending of some data failed since the last queue or flush call, otherwise 0
+		 */
+		int flush (bool process = true);
+
+		/**
+		 * Process jobs completed by workers. Must be called from the main
+		 * thread. Sending failure is logged when it happens.
+		 *
+		 * @return -1 if sending of some data failed since the last queue or flush call, otherwise 0
+		 */
+		int processCompleted ();
+
+		/**
+		 * Returns number of bytes queued for sending on the given channel.
+		 */
+		size_t getPendingData (int chan);
+
+		/**
+		 * Returns number of bytes queued for sending.
+		 */
+		size_t getPendingData ();
+
+	private:
+		Camera *camera;
+		int threads;
+
+		pthread_t *workers;
+		TSQueue <ReadoutJob *> *jobQueues;
+		TSQueue <ReadoutJob *> done;
+
+		// jobs available for reuse
+		std::list <ReadoutJob *> freeJobs;
+
+		// bytes not yet send, per channel
+		std::vector <size_t> pending;
+
+		pthread_mutex_t outstandingMutex;
+		pthread_cond_t outstandingCond;
+		int outstanding;
+
+		int notifyPipe[2];
+		// errno of failed notification, set by workers
+		volatile int notifyErrno;
+
+		int lastError;
+
+		struct WorkerArg
+		{
+			ReadoutPipeline *pipeline;
+			int num;
+		};
+
+		WorkerArg *workerArgs;
+
+		static void *runWorker (void *arg);
+
+		/**
+		 * Returns and clears error of data sending.
+		 */
+		int getError ();
+
+		void processJob (ReadoutJob *job);
+
+		void jobDone (ReadoutJob *job, bool process);
+};
+
+}
+
+#endif // !__RTS2_READOUTPIPELINE__
@@ -41,6 +41,12 @@ static const char* CONSTRAINT_SDISTANCE    = "solarDistance";
 static const char* CONSTRAINT_SALTITUDE    = "sunAltitude";
 static const char* CONSTRAINT_MAXREPEATS   = "maxRepeats";
 
+/** Step (in seconds) of coarse scan of slowly changing constraints. */
+#define CONSTRAINT_SCAN_STEP   900
+
+/** Precision (in seconds) of constraint change times. */
+#define CONSTRAINT_PRECISION   1
+
 namespace rts2db
 {
 
@@ -99,7 +105,7 @@ class Constraint
 		 *
 		 * @param tar  target which is checked for constraint
 		 * @param JD   date (Julian Day) checked
-		 * @param nextJD  returned hint about next time a change in satisfy/violated might occur; nan if the hint is not available, 0 if it cannot be computed
+		 * @param nextJD  returned hint about next time a change in satisfy/violated might occur; nan if the constraint will not change, 0 if the hint cannot be computed
 		 *
 		 * @return true if constraint is satisfied
 		 *
@@ -123,16 +129,33 @@ class Constraint
 		virtual const char* getName () = 0;
 
 		/**
-		 * Return array with intervals when constraint for given target is satisfied.
+		 * Return array with intervals when constraint for given target
+		 * is satisfied. Intervals are ordered. Default implementation
+		 * jumps to the next change hinted by satisfy, or scans by
+		 * getScanStep without a hint, and bisects changes of the
+		 * constraint state to CONSTRAINT_PRECISION.
 		 *
 		 * @param tar
 		 * @param from
 		 * @param to
 		 * @param step
-		 * @param ret   returned array of violated time intervals
+		 * @param ret   returned array of satisfied time intervals
 		 */
 		virtual void getSatisfiedIntervals (Target *tar, time_t from, time_t to, int step, interval_arr_t &ret);
 
+		/**
+		 * Find first change of the constraint state.
+		 *
+		 * @param tar    target which is checked for constraint
+		 * @param JD     start date (Julian Day)
+		 * @param to_JD  end date (Julian Day)
+		 * @param step   scan step (in seconds), used when satisfy does not provide hint
+		 * @param sat    returned state of the constraint at JD
+		 *
+		 * @return first date when constraint state differs from sat, to_JD if the state does not change before to_JD
+		 */
+		double getNextChange (Target *tar, double JD, double to_JD, int step, bool &sat);
+
 		/**
 		 * Return array with intervals when constraint for given target is violated.
 		 *
@@ -152,6 +175,26 @@ class Constraint
 		virtual void getAltitudeIntervals (std::vector <ConstraintDoubleInterval> &ac) { throw rts2core::Error ("getAltitudeIntervals is not supported"); }
 
 		void getAltitudeViolatedIntervals (std::vector <ConstraintDoubleInterval> &ac);
+
+	protected:
+		/**
+		 * Step of the scan for constraint changes. Constraints which
+		 * change slowly can scan with step longer than requested.
+		 *
+		 * @param tar    target which is checked for constraint
+		 * @param step   requested step (in seconds)
+		 */
+		virtual int getScanStep (Target *tar, int step) { return step; }
+
+	private:
+		/**
+		 * Bisect change of the constraint state between two dates.
+		 *
+		 * @param sat   state of the constraint at t1
+		 *
+		 * @return first date (with CONSTRAINT_PRECISION) with the changed state
+		 */
+		double bisectChange (Target *tar, double t1, double t2, bool sat);
 };
 
 /**
@@ -195,6 +238,11 @@ class ConstraintInterval: public Constraint
 		void clearIntervals () { intervals.clear (); }
 		void add (const ConstraintDoubleInterval &inte) { intervals.push_back (inte); }
 		void addInterval (double lower, double upper) { intervals.push_back (ConstraintDoubleInterval (lower, upper)); }
+
+		/**
+		 * Return all bounds (lower and upper values) of constraint intervals.
+		 */
+		void getBounds (std::vector <double> &bounds);
 		virtual bool isBetween (double JD);
 
 		std::list <ConstraintDoubleInterval> intervals;
@@ -250,6 +298,9 @@ class ConstraintDec:public ConstraintInterval
 		virtual bool satisfy (Target *tar, double JD, double *nextJD);
 
 		virtual const char* getName () { return CONSTRAINT_DEC; }
+
+	protected:
+		virtual int getScanStep (Target *tar, int step);
 };
 
 class ConstraintLunarDistance:public ConstraintInterval
@@ -259,7 +310,8 @@ class ConstraintLunarDistance:public ConstraintInterval
 
 		virtual const char* getName () { return CONSTRAINT_LDISTANCE; }
 
-		virtual void getSatisfiedIntervals (Target *tar, time_t from, time_t to, int step, interval_arr_t &ret);
+	protected:
+		virtual int getScanStep (Target *tar, int step);
 };
 
 class ConstraintLunarAltitude:public ConstraintInterval
@@ -268,6 +320,9 @@ class ConstraintLunarAltitude:public ConstraintInterval
 		virtual bool satisfy (Target *tar, double JD, double *nextJD);
 
 		virtual const char* getName () { return CONSTRAINT_LALTITUDE; }
+
+	protected:
+		virtual int getScanStep (Target *tar, int step);
 };
 
 class ConstraintLunarPhase:public ConstraintInterval
@@ -276,6 +331,9 @@ class ConstraintLunarPhase:public ConstraintInterval
 		virtual bool satisfy (Target *tar, double JD, double *nextJD);
 
 		virtual const char* getName () { return CONSTRAINT_LPHASE; }
+
+	protected:
+		virtual int getScanStep (Target *tar, int step);
 };
 
 class ConstraintSolarDistance:public ConstraintInterval
@@ -284,6 +342,9 @@ class ConstraintSolarDistance:public ConstraintInterval
 		virtual bool satisfy (Target *tar, double JD, double *nextJD);
 
 		virtual const char* getName () { return CONSTRAINT_SDISTANCE; }
+
+	protected:
+		virtual int getScanStep (Target *tar, int step);
 };
 
 class ConstraintSunAltitude:public ConstraintInterval
@@ -292,6 +353,9 @@ class ConstraintSunAltitude:public ConstraintInterval
 		virtual bool satisfy (Target *tar, double JD, double *nextJD);
 
 		virtual const char* getName () { return CONSTRAINT_SALTITUDE; }
+
+	protected:
+		virtual int getScanStep (Target *tar, int step);
 };
 
 class ConstraintMaxRepeat:public Constraint
@@ -421,7 +485,12 @@ class Constraints:public std::map <std::string, ConstraintPtr >
 		/**
 		 * Return time until when constraints are satisfied.
 		 *
-		 * @return   time when constraints will not be satisfied
+		 * @param from    start time (ctime)
+		 * @param to      end time (ctime)
+		 * @param length  constraints are checked from from + length
+		 * @param step    scan step (in seconds)
+		 *
+		 * @return   time when constraints will not be satisfied, NAN if they are not satisfied at from + length, INFINITY if they are satisfied until to
 		 */
 		double getSatisfiedDuration (Target *tar, double from, double to, double length, double step);
 
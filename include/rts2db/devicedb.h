@@ -54,6 +54,16 @@ class DeviceDb:public rts2core::Device
 		 */
 		int initDB (const char *conn_name);
 
+		/**
+		 * Open database connection, without loading any data. Can be
+		 * called from other thread to create its own connection.
+		 *
+		 * @param conn_name   connection name
+		 *
+		 * @return -1 on error, 0 on sucess, 1 if device runs without database.
+		 */
+		int connectDB (const char *conn_name);
+
 	protected:
 		virtual int willConnect (rts2core::NetworkAddress * in_addr);
 		virtual int processOption (int in_opt);
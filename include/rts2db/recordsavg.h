@@ -19,6 +19,7 @@
 
 #include <list>
 #include <string>
+#include <math.h>
 
 namespace rts2db
 {
@@ -47,16 +48,29 @@ class RecordAvg
 		}
 
 		double getRecTime () { return rectime; };
+		double getValue () { return avg; };
 		double getAverage () { return avg; };
 		double getMinimum () { return min; };
 		double getMaximum () { return max; };
 		int getRecCout ()    { return rcount; };
 };
 
-typedef enum {DAY, HOUR} cadence_t;
+/**
+ * Levels of downsampled double records.
+ */
+typedef enum {DAY, HOUR, MINUTES10, MINUTE} cadence_t;
+
+/**
+ * Returns length of the cadence bucket in seconds.
+ */
+int getCadenceLength (cadence_t cadence);
 
 /**
- * Class with value average records.
+ * Class with value average records. Averages are loaded from
+ * records_double_buckets table, which holds minimum, maximum and sum of
+ * double records for minute, 10 minutes, hour and day buckets. Hourly
+ * averages are loaded from mv_records_double_hour if the database does not
+ * have records_double_buckets table.
  *
  * @author Petr Kubanek <petr@kubanek.net>
  */
@@ -65,14 +79,60 @@ class RecordAvgSet: public std::list <RecordAvg>
 	private:
 		int recval_id;
 		cadence_t cadence;
+
+		double min;
+		double max;
 	public:
 		RecordAvgSet (int _recval_id, cadence_t _cadence)
 		{
 			recval_id = _recval_id;
 			cadence = _cadence;
+
+			min = max = NAN;
 		}
 
+		/**
+		 * @throw SqlError on errror.
+		 */
 		void load (double t_from, double t_to);
+
+		/**
+		 * Returns true if the database has records_double_buckets
+		 * table. Only HOUR cadence can be loaded without it.
+		 *
+		 * @throw SqlError on errror.
+		 */
+		static bool haveBuckets ();
+
+		/**
+		 * Minimal value of the loaded buckets.
+		 */
+		double getMin () { return min; };
+
+		/**
+		 * Maximal value of the loaded buckets.
+		 */
+		double getMax () { return max; };
+
+		/**
+		 * Select the finest cadence which does not provide more than
+		 * given number of buckets for the interval.
+		 *
+		 * @param t_from   interval start
+		 * @param t_to     interval end
+		 * @param points   maximal number of buckets (e.g. plot width in pixels)
+		 * @param cadence  selected cadence
+		 *
+		 * @return false if the interval is shorter than points minutes, so
+		 * raw records should be used
+		 */
+		static bool selectCadence (double t_from, double t_to, int points, cadence_t &cadence);
+
+	private:
+		/**
+		 * Load hourly averages from mv_records_double_hour.
+		 */
+		void loadHours (double t_from, double t_to);
 };
 
 
@@ -0,0 +1,201 @@
+/*
+ * Background writer of value, state and message records.
+ * Copyright (C) 2026 Petr Kubanek <petr@kubanek.net>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef __RTS2_RECORDWRITER__
+#define __RTS2_RECORDWRITER__
+
+#include "rts2db/devicedb.h"
+#include "message.h"
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+namespace rts2db
+{
+
+/**
+ * Types of records written by RecordWriter.
+ */
+typedef enum {RECORD_INTEGER, RECORD_DOUBLE, RECORD_BOOLEAN, RECORD_STATE, RECORD_MESSAGE} recordType_t;
+
+/**
+ * Single queued record.
+ */
+struct WriterRecord
+{
+	recordType_t type;
+	// device name, message originator for messages
+	std::string device;
+	std::string value_name;
+	std::string message;
+	// recval type, message type for messages
+	int recval_type;
+	double rectime;
+	double value;
+};
+
+/**
+ * Writes value changes, state changes and messages to the database from a
+ * background thread. Records are queued by the main thread, and written in
+ * batches - one multi-row INSERT per table and a single COMMIT per batch.
+ * The thread uses its own database connection. IDs of recorded values are
+ * cached, so recvals table is queried only for a value seen for the first
+ * time.
+ *
+ * Double records are also aggregated to minute, 10 minutes, hour and day
+ * buckets of records_double_buckets table, which is used to plot long
+ * intervals. If the buckets cannot be updated (database was not updated
+ * to include the table), only raw records are written. If update of the
+ * buckets fails for other reason, raw records of the batch are still written,
+ * but its aggregates are not retried, so the buckets miss those records;
+ * buckets can be rebuilt from records_double with the query used in
+ * rel_1_0_1.sql update script.
+ *
+ * Queue is bounded. When it is full, the oldest record is dropped and
+ * counted, so the history keeps the most recent records after a database
+ * outage. Records of a batch which failed to be written are dropped as
+ * well.
+ *
+ * @author Petr Kubanek <petr@kubanek.net>
+ */
+class RecordWriter
+{
+	public:
+		/**
+		 * @param _master         device which provides database connection parameters
+		 * @param _maxQueue       maximal number of queued records
+		 * @param _batchSize      maximal number of records written in a single transaction
+		 * @param _flushInterval  time (in seconds) the thread waits for a full batch
+		 */
+		RecordWriter (DeviceDb *_master, size_t _maxQueue, size_t _batchSize, double _flushInterval);
+
+		/**
+		 * Writes all queued records and stops the thread.
+		 */
+		~RecordWriter ();
+
+		/**
+		 * Start writer thread. Returns after the thread connected to
+		 * the database. Must be called after the process forked to
+		 * background, records queued before are kept in the queue.
+		 *
+		 * @return -1 on error, 0 on success
+		 */
+		int start ();
+
+		bool isRunning () { return running; }
+
+		/**
+		 * Queue value change.
+		 *
+		 * @param device       device name
+		 * @param value_name   value name
+		 * @param recval_type  type of value record (RTS2_VALUE type and display type)
+		 * @param type         table of the record (RECORD_INTEGER, RECORD_DOUBLE or RECORD_BOOLEAN)
+		 * @param value        recorded value
+		 * @param rectime      value time
+		 */
+		void recordValue (const std::string &device, const std::string &value_name, int recval_type, recordType_t type, double value, double rectime);
+
+		/**
+		 * Queue device state change.
+		 */
+		void recordState (const char *device, int state, double rectime);
+
+		/**
+		 * Queue message.
+		 */
+		void recordMessage (rts2core::Message &msg);
+
+		/**
+		 * Returns writer counters.
+		 *
+		 * @param queued     number of records waiting in the queue
+		 * @param flushTime  duration (in seconds) of the last batch write
+		 * @param dropped    number of records dropped due to full queue or write error
+		 */
+		void getStats (size_t &queued, double &flushTime, unsigned long &dropped);
+
+		/**
+		 * Log errors reported by the writer thread. Must be called
+		 * from the main thread.
+		 */
+		void logErrors ();
+
+	private:
+		DeviceDb *master;
+
+		size_t maxQueue;
+		size_t batchSize;
+		double flushInterval;
+
+		pthread_t thread;
+		pthread_mutex_t mutex;
+		pthread_cond_t cond;
+
+		// -1 when the thread failed to connect, 1 after it connected
+		int connected;
+		bool running;
+		bool stop;
+
+		std::deque <WriterRecord> queue;
+
+		double lastFlush;
+		unsigned long dropped;
+
+		// recval IDs indexed by device and value name, used only by the thread
+		std::map <std::pair <std::string, std::string>, int> recvalIds;
+
+		// false when records_double_buckets table does not exist
+		bool writeBuckets;
+
+		// errors waiting to be logged by the main thread
+		std::vector <std::string> errors;
+
+		void queueRecord (WriterRecord &rec);
+
+		/**
+		 * Queue error message for logErrors. Called from the writer thread.
+		 */
+		void reportError (const std::string &err);
+
+		static void *runThread (void *arg);
+		void run ();
+
+		/**
+		 * Write batch in a single transaction.
+		 *
+		 * @return number of records which were not written
+		 */
+		size_t writeBatch (std::vector <WriterRecord> &batch);
+
+		/**
+		 * Returns recval ID, inserts new recvals entry for a new value.
+		 *
+		 * @return -1 on error
+		 */
+		int getRecvalId (const std::string &device, const std::string &value_name, int recval_type);
+};
+
+}
+
+#endif // !__RTS2_RECORDWRITER__
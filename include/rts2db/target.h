@@ -32,6 +32,7 @@
 #include "infoval.h"
 #include "objectcheck.h"
 #include "device.h"
+#include "ephemcache.h"
 #include "rts2target.h"
 #include "counted_ptr.h"
 
@@ -79,11 +80,54 @@ class Observation;
 
 class ConstraintsList;
 class ConstraintDoubleInterval;
+class Target;
 
 typedef counted_ptr <Constraint> ConstraintPtr;
 
 typedef std::vector < std::pair < time_t, time_t > > interval_arr_t;
 
+/**
+ * Cache of target positions. Samples are calculated by target getPosition
+ * method.
+ *
+ * @author Petr Kubanek <petr@kubanek.net>
+ */
+class TargetEphemeris:public rts2core::EphemerisCache
+{
+	public:
+		TargetEphemeris (Target *_target, double _step):rts2core::EphemerisCache (_step) { target = _target; }
+
+	protected:
+		virtual void computePosition (struct ln_equ_posn *pos, double JD);
+
+	private:
+		Target *target;
+};
+
+/**
+ * Values of a targets table row. TargetSet fills rows of all selected
+ * targets from a single query, and construct targets from them without
+ * selecting every target separately.
+ *
+ * @author Petr Kubanek <petr@kubanek.net>
+ */
+struct TargetRow
+{
+	int tar_id;
+	char type_id;
+	std::string tar_name;
+	std::string tar_info;
+	float tar_priority;
+	float tar_bonus;
+	time_t tar_bonus_time;
+	time_t tar_next_observable;
+	bool tar_enabled;
+	int tar_telescope_mode;
+	// NAN if not set
+	struct ln_equ_posn position;
+	struct ln_equ_posn proper_motion;
+};
+
 /**
  * Execption raised when target name cannot be resolved.
  *
@@ -182,6 +226,15 @@ class Target:public Rts2Target
 		// load target data from give target id
 		void loadTarget (int in_tar_id);
 
+		/**
+		 * Fill target from already selected targets table row. Must
+		 * be called only for targets which load () does not need
+		 * anything else than values from targets table.
+		 *
+		 * @param row   targets table row
+		 */
+		virtual void loadRow (const TargetRow &row);
+
 		virtual int save (bool overwrite);
 		virtual int saveWithID (bool overwrite, int tar_id);
 
@@ -280,6 +333,32 @@ class Target:public Rts2Target
 		 */
 		virtual void getAltAz (struct ln_hrz_posn *hrz, double JD, struct ln_lnlat_posn *obs);
 
+		/**
+		 * Return target position, interpolated from cached samples if
+		 * the target position can be cached. Should be used by
+		 * methods which query target position for many dates.
+		 *
+		 * @param pos returned position
+		 * @param JD  Julian date
+		 */
+		void getCachedPosition (struct ln_equ_posn *pos, double JD);
+
+		/**
+		 * Returns distance of samples of cached target position, in
+		 * days. NAN, which is returned by default, disables position
+		 * caching. Targets which provide step must call
+		 * clearEphemeris when their position changes.
+		 */
+		virtual double getEphemerisStep () { return NAN; }
+
+		/**
+		 * Returns true if target moves on the sky slowly compared
+		 * to the sidereal rotation, so times of altitude and hour
+		 * angle crossings can be predicted from its current position.
+		 * Defaults to targets with cached position.
+		 */
+		virtual bool isSlowMoving () { return !std::isnan (getEphemerisStep ()); }
+
 		/**
 		 * Returns target minimal and maximal altitude during
 		 * given time period. This method may return negative values
@@ -847,10 +926,25 @@ class Target:public Rts2Target
 		// get called when target was selected to update bonuses etc..
 		virtual int selectedAsGood ();
 
+		/**
+		 * Drop cached target positions.
+		 */
+		void clearEphemeris ();
+
+		/**
+		 * Set values loaded from targets table.
+		 */
+		void setTargetRow (const TargetRow &row);
+
 	private:
 		// holds current target observation
 		Observation * observation;
 
+		// cached positions, created on first request
+		TargetEphemeris *ephemeris;
+
+		TargetEphemeris *getEphemeris ();
+
 		std::vector <int> watchIDs;		// 
 
 		void addWatch (const char *filename);
@@ -901,6 +995,7 @@ class ConstTarget:public Target
 		ConstTarget (int in_tar_id, struct ln_lnlat_posn *in_obs, double in_altitude);
 		ConstTarget (int in_tar_id, struct ln_lnlat_posn *in_obs, double in_altitude, struct ln_equ_posn *pos);
 		virtual void load ();
+		virtual void loadRow (const TargetRow &row);
 		virtual int saveWithID (bool overwrite, int tar_id);
 		virtual void getPosition (struct ln_equ_posn *pos, double JD);
 
@@ -920,9 +1015,11 @@ class ConstTarget:public Target
 		virtual int compareWithTarget (Target * in_target, double grb_sep_limit);
 		virtual void printExtra (Rts2InfoValStream & _os, double JD);
 
-		void setPosition (double ra, double dec) { position.ra = ra; position.dec = dec; }
-		void setProperMotion (double pm_ra, double pm_dec) { proper_motion.ra = pm_ra; proper_motion.dec = pm_dec; }
-		void setProperMotion (struct ln_equ_posn *pm) { proper_motion.ra = pm->ra; proper_motion.dec = pm->dec; }
+		virtual double getEphemerisStep () { return hasNaNPosition () ? NAN : EPHEMCACHE_STEP; }
+
+		void setPosition (double ra, double dec) { position.ra = ra; position.dec = dec; clearEphemeris (); }
+		void setProperMotion (double pm_ra, double pm_dec) { proper_motion.ra = pm_ra; proper_motion.dec = pm_dec; clearEphemeris (); }
+		void setProperMotion (struct ln_equ_posn *pm) { proper_motion.ra = pm->ra; proper_motion.dec = pm->dec; clearEphemeris (); }
 
 	protected:
 		// get called when target was selected to update bonuses, target position etc..
@@ -958,6 +1055,7 @@ class FlatTarget:public ConstTarget
 		virtual bool getScript (const char *deviceName, std::string & buf);
 		virtual void load ();
 		virtual void getPosition (struct ln_equ_posn *pos, double JD);
+		virtual double getEphemerisStep () { return NAN; }
 		virtual int considerForObserving (double JD);
 		virtual int isContinues () { return 1; }
 		virtual void printExtra (Rts2InfoValStream & _os, double JD);
@@ -1012,6 +1110,7 @@ class CalibrationTarget:public ConstTarget
 		virtual int beforeMove ();
 		virtual int endObservation (int in_next_id);
 		virtual void getPosition (struct ln_equ_posn *pos, double JD);
+		virtual double getEphemerisStep () { return NAN; }
 		virtual int considerForObserving (double JD);
 		virtual int changePriority (int pri_change, time_t * time_ch) { return 0; }
 		virtual float getBonus (double JD);
@@ -1048,6 +1147,9 @@ class ModelTarget:public ConstTarget
 
 		int modelStepType;
 
+		// protects position, which is converted to RA DEC at the first getPosition call
+		pthread_mutex_t positionMutex;
+
 		int writeStep ();
 		int getNextPosition ();
 		int calPosition ();
@@ -1059,6 +1161,7 @@ class ModelTarget:public ConstTarget
 		virtual moveType afterSlewProcessed ();
 		virtual int endObservation (int in_next_id);
 		virtual void getPosition (struct ln_equ_posn *pos, double JD);
+		virtual double getEphemerisStep () { return NAN; }
 
 		/**
 	         * Returns minimal target altitude.
@@ -1226,6 +1329,18 @@ Rts2InfoValStream & operator << (Rts2InfoValStream & _os, rts2db::Target & targe
  */
 rts2db::Target *createTarget (int tar_id, struct ln_lnlat_posn *obs, double altitude);
 
+/**
+ * Create target from already selected targets table row. Targets which
+ * need more than the row are loaded from the database.
+ *
+ * @param row         targets table row
+ * @param obs         observer position
+ * @param altitude    observator altitude
+ *
+ * @throw rts2core::Error when target cannot be loaded
+ */
+rts2db::Target *createTarget (const rts2db::TargetRow &row, struct ln_lnlat_posn *obs, double altitude);
+
 /**
  * Create target by name.
  *
@@ -46,6 +46,8 @@ class TargetAuger:public rts2db::ConstTarget
 
 		virtual void load ();
 		virtual void getPosition (struct ln_equ_posn *pos, double JD);
+		// position is fixed in horizontal coordinates
+		virtual double getEphemerisStep () { return NAN; }
 
 		/**
 		 * Load target from given auger_id.
@@ -48,6 +48,7 @@ class EllTarget:public Target
 		int orbitFromMPC (const char *mpc);
 
 		virtual void getPosition (struct ln_equ_posn *pos, double JD);
+		virtual double getEphemerisStep () { return EPHEMCACHE_STEP; }
 		virtual int getRST (struct ln_rst_time *rst, double jd, double horizon);
 
 		virtual moveType startSlew (struct ln_equ_posn *position, std::string &p1, std::string &p2, bool update_position, int plan_id = -1);
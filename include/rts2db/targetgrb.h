@@ -33,6 +33,8 @@ class TargetGRB:public ConstTarget
 		TargetGRB (int in_tar_id, struct ln_lnlat_posn *in_obs, double _altitude, int in_maxBonusTimeout, int in_dayBonusTimeout, int in_fiveBonusTimeout);
 		virtual void load ();
 		virtual void getPosition (struct ln_equ_posn *pos, double JD);
+		// Swift position is clamped to minimal altitude, which cannot be interpolated
+		virtual double getEphemerisStep () { return NAN; }
 		virtual int compareWithTarget (Target * in_target, double grb_sep_limit);
 		virtual bool getScript (const char *deviceName, std::string & buf);
 		virtual int beforeMove ();
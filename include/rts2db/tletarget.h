@@ -48,6 +48,19 @@ class TLETarget:public Target
 		void orbitFromTLE (std::string tle);
 
 		virtual void getPosition (struct ln_equ_posn *pos, double JD);
+
+		/**
+		 * Only deep space orbits are cached. Satellites on low orbits
+		 * move too fast on the sky to be interpolated.
+		 */
+		virtual double getEphemerisStep ();
+
+		/**
+		 * Even deep space satellites move too fast for crossing
+		 * predictions from sidereal motion.
+		 */
+		virtual bool isSlowMoving () { return false; }
+
 		virtual int getRST (struct ln_rst_time *rst, double jd, double horizon);
 
 		virtual moveType startSlew (struct ln_equ_posn *position, std::string &p1, std::string &p2, bool update_position, int plan_id = -1);
@@ -92,6 +92,27 @@ class Channel
 
 		void computeStatistics (size_t _from = 0, size_t _dataSize = 0);
 
+		/**
+		 * Returns channel histogram with 65536 bins, one for each
+		 * 16 bit pixel value. Histogram is computed on the first call
+		 * and cached. Only unsigned short and float data are binned,
+		 * histogram of other data types is empty.
+		 */
+		const long *getHistogram ();
+
+		/**
+		 * Find quantile cut levels for image scaling from the
+		 * histogram. The last result is cached, so repeated calls with
+		 * the same parameters do not search the histogram.
+		 *
+		 * @param quantiles  fraction of pixels below low and above high cut
+		 * @param minval     minimal value of the scaling range
+		 * @param mval       maximal value of the scaling range
+		 * @param low        returned low cut
+		 * @param high       returned high cut
+		 */
+		void getQuantileCuts (float quantiles, double minval, double mval, double &low, double &high);
+
 	private:
 		char *data;
 		int naxis;
@@ -104,6 +125,15 @@ class Channel
 		double average;
 		double stdev;
 
+		long *histogram;
+
+		// cached quantile cuts
+		float cutQuantiles;
+		double cutMin;
+		double cutMax;
+		double cutLow;
+		double cutHigh;
+
 		// channel number
 		int channelnum;
 };
@@ -285,6 +285,18 @@ class Image:public FitsFile
 		 */
 		void getChannelHistogram (int chan, long *histogram, long nbins);
 
+		/**
+		 * Returns quantile cut levels for scaling of channel data.
+		 * Histogram and cut levels are cached in the channel.
+		 *
+		 * @param chan       channel number
+		 * @param minval     minimal value of the scaling range
+		 * @param mval       maximal value of the scaling range
+		 * @param quantiles  quantiles in 0-1 range for image scaling
+		 * @param low        returned low cut
+		 * @param high       returned high cut
+		 */
+		template <typename dt> void getChannelCuts (int chan, dt minval, dt mval, float quantiles, dt &low, dt &high);
 
 		template <typename bt, typename dt> void getChannelGrayscaleByteBuffer (int chan, bt * &buf, bt black, dt low, dt high, long s, size_t offset, bool invert_y);
 
@@ -0,0 +1,102 @@
+/*
+ * Pool of threads evaluating schedules.
+ * Copyright (C) 2026 Petr Kubanek <petr@kubanek.net>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef __RTS2SCHED_EVALPOOL__
+#define __RTS2SCHED_EVALPOOL__
+
+#include "schedule.h"
+
+#include <list>
+#include <vector>
+#include <pthread.h>
+
+namespace rts2sched
+{
+
+/**
+ * Pool of worker threads calculating objectives and constraints of
+ * schedules. Schedules keep calculated values, so GA operators which
+ * follow the evaluation use the values without calculating them again.
+ *
+ * Evaluation does not draw random numbers, so results of a GA run do not
+ * depend on number of threads.
+ *
+ * @author Petr Kubanek <petr@kubanek.net>
+ */
+class EvaluationPool
+{
+	public:
+		/**
+		 * Start worker threads. Calling thread evaluates schedules as
+		 * well, so pool with a single thread does not start any worker.
+		 *
+		 * @param _threads   number of threads evaluating schedules
+		 */
+		EvaluationPool (int _threads);
+		~EvaluationPool ();
+
+		/**
+		 * Calculate objectives and constraints of all schedules.
+		 * Returns after all schedules are evaluated.
+		 *
+		 * @param _schedules    schedules to evaluate
+		 * @param _objectives   objectives which will be calculated
+		 * @param _constraints  constraints which will be calculated
+		 */
+		void evaluate (std::vector <Rts2Schedule *> &_schedules, std::list <objFunc> &_objectives, std::list <constraintFunc> &_constraints);
+
+		/**
+		 * Returns number of threads evaluating schedules, including
+		 * the calling thread.
+		 */
+		int getThreads () { return threads + 1; }
+
+	private:
+		int threads;
+		pthread_t *workers;
+
+		pthread_mutex_t mutex;
+		pthread_cond_t jobCond;
+		pthread_cond_t doneCond;
+
+		// evaluated job
+		std::vector <Rts2Schedule *> *schedules;
+		std::list <objFunc> *objectives;
+		std::list <constraintFunc> *constraints;
+
+		// index of the next schedule to evaluate
+		size_t next;
+		// number of threads evaluating schedules
+		int busy;
+		// job sequence, workers are woken up when it changes
+		unsigned long job;
+		bool stop;
+
+		static void *runWorker (void *arg);
+
+		/**
+		 * Evaluate schedules until the job is finished. Must be called
+		 * with mutex locked.
+		 */
+		void evaluateJob ();
+};
+
+}
+
+#endif // !__RTS2SCHED_EVALPOOL__
@@ -18,6 +18,7 @@
  */
 
 #include "schedule.h"
+#include "evalpool.h"
 #include "rts2db/accountset.h"
 
 #include <vector>
@@ -47,6 +48,14 @@ class Rts2SchedBag:public std::vector <Rts2Schedule *>
 		 */
 		unsigned int getEliteSize () { return eliteSize; }
 
+		/**
+		 * Set number of threads evaluating schedules. Default is
+		 * to evaluate schedules in the calling thread.
+		 *
+		 * @param _threads  Number of threads.
+		 */
+		void setThreads (int _threads);
+
 		/**
 		 * Construct schedules and add them to schedule bag.
 		 *
@@ -109,7 +118,10 @@ class Rts2SchedBag:public std::vector <Rts2Schedule *>
 
 		/**
 		 * Calculate ranks of the entire population. Ranks are assigned to schedule
-		 * with setNSGARank function.
+		 * with setNSGARank function. Uses efficient non-dominated sort (ENS) with
+		 * binary search of the front - schedules are sorted, so a schedule
+		 * can be dominated only by schedules preceding it, and are put to
+		 * the first front which does not dominate them.
 		 */
 		void calculateNSGARanks ();
 
@@ -152,6 +164,23 @@ class Rts2SchedBag:public std::vector <Rts2Schedule *>
 		rts2sched::TicketSet *ticketSet;
 		rts2db::TargetSet *tarSet;
 
+		rts2sched::EvaluationPool *evalPool;
+
+		/**
+		 * Initialize lazy state of targets and accounts, so they can
+		 * be used from evaluation threads.
+		 */
+		void prepareEvaluation ();
+
+		/**
+		 * Calculate objectives and constraints of the whole
+		 * population. Does nothing if evaluation threads are not
+		 * used, values are then calculated on demand.
+		 *
+		 * @param _objectives   Objectives which will be calculated.
+		 */
+		void evaluate (std::list <objFunc> &_objectives);
+
 		/**
 		 * The algorithm replace randomly selected observation with randomly picked new
 		 * one.
@@ -222,16 +251,6 @@ class Rts2SchedBag:public std::vector <Rts2Schedule *>
 		// vector holding size of individual fronts
 		std::vector <int> NSGAfrontsSize;
 
-		/**
-		 * Dominance operator.
-		 *
-		 * @param sched_1  First schedule which will be compared.
-		 * @param sched_2  Second schedule which will be compared.
-		 *
-		 * @return <ul><li>-1 if first schedule dominates second</li><li>1 if second schedule dominates first</li><li>0 if schedules are equal</li>
-		 */
-		int dominatesNSGA (Rts2Schedule *sched_1, Rts2Schedule *sched_2);
-
 		/** 
 		 * Calculates crowding distance of each member in
 		 * the set and sort NSGAfronts by crowding distance.
@@ -38,6 +38,16 @@ class Rts2SchedObs
 {
 	public:
 		Rts2SchedObs (Ticket *_ticket, double _startJD, double _duration);
+
+		/**
+		 * Create copy of an observation starting at different time. Merit
+		 * contributions calculated for the parent are kept if they are
+		 * still valid for the new observation.
+		 *
+		 * @param _parent   observation which will be copied
+		 * @param _startJD  start of the new observation
+		 */
+		Rts2SchedObs (Rts2SchedObs *_parent, double _startJD);
 		virtual ~Rts2SchedObs (void);
 
 		/**
@@ -143,14 +153,10 @@ class Rts2SchedObs
 		 */
 		bool isVisible ()
 		{
-			// determine if target is visible during whole period
-			if (getTarget()->isAboveHorizon (getJDStart ()) == false
-				|| getTarget ()->isAboveHorizon (getJDMid ()) == false
-				|| getTarget ()->isAboveHorizon (getJDEnd ()) == false)
-				return false;
-			double minA, maxA;
-			getTarget ()->getMinMaxAlt (getJDStart (), getJDEnd (), minA, maxA);
-			return minA > 0;
+			checkCache ();
+			if (visible < 0)
+				visible = calculateVisible () ? 1 : 0;
+			return visible == 1;
 		}
 
 		/**
@@ -163,14 +169,32 @@ class Rts2SchedObs
 		 *
 		 * @param _pos Returned position.
 		 */
-		void getStartPosition (struct ln_equ_posn &_pos) { getTarget ()->getPosition (&_pos, getJDStart ()); }
+		void getStartPosition (struct ln_equ_posn &_pos)
+		{
+			checkCache ();
+			if (!startPosValid)
+			{
+				getTarget ()->getPosition (&startPos, getJDStart ());
+				startPosValid = true;
+			}
+			_pos = startPos;
+		}
 
 		/**
 		 * Get equatiorial position of the target at the end of the observation.
 		 *
 		 * @param _pos Returned position.
 		 */
-		void getEndPosition (struct ln_equ_posn &_pos) { getTarget ()->getPosition (&_pos, getJDEnd ()); }
+		void getEndPosition (struct ln_equ_posn &_pos)
+		{
+			checkCache ();
+			if (!endPosValid)
+			{
+				getTarget ()->getPosition (&endPos, getJDEnd ());
+				endPosValid = true;
+			}
+			_pos = endPos;
+		}
 
 		/**
 		 * Returns schedule position at give julian date.
@@ -180,7 +204,13 @@ class Rts2SchedObs
 		/**
 		 * Return true if schedule for given ticket is violated.
 		 */
-		bool violateSchedule () { return ticket->violateSchedule (getJDStart (), getJDEnd ()); }
+		bool violateSchedule ()
+		{
+			checkCache ();
+			if (violated < 0)
+				violated = ticket->violateSchedule (getJDStart (), getJDEnd ()) ? 1 : 0;
+			return violated == 1;
+		}
 
 	private:
 		Ticket *ticket;
@@ -188,6 +218,47 @@ class Rts2SchedObs
 		double startJD;
 		// duration in seconds
 		double duration;
+
+		// merit contributions of the observation, calculated on first request.
+		// They are valid for observation start and duration recorded in cacheJD
+		// and cacheDuration, so observations not touched by schedule change keep them
+		double cacheJD;
+		double cacheDuration;
+
+		// -1 when not calculated, 0 for false, 1 for true
+		int visible;
+		int violated;
+
+		double altMerit;
+		// period for which altMerit was calculated
+		double altMeritStart;
+		double altMeritEnd;
+
+		struct ln_equ_posn startPos;
+		struct ln_equ_posn endPos;
+		bool startPosValid;
+		bool endPosValid;
+
+		/**
+		 * Drop cached merit contributions if observation start or duration
+		 * changed since they were calculated.
+		 */
+		void checkCache ()
+		{
+			if (cacheJD == startJD && cacheDuration == duration)
+				return;
+			cacheJD = startJD;
+			cacheDuration = duration;
+			visible = -1;
+			violated = -1;
+			altMerit = NAN;
+			startPosValid = false;
+			endPosValid = false;
+		}
+
+		bool calculateVisible ();
+
+		double calculateAltitudeMerit (double _start, double _end);
 };
 
 std::ostream & operator << (std::ostream & _os, Rts2SchedObs & schedobs);
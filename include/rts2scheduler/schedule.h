@@ -23,6 +23,7 @@
 #include "schedobs.h"
 #include "ticketset.h"
 
+#include <list>
 #include <vector>
 
 typedef enum
@@ -413,6 +414,15 @@ class Rts2Schedule: public std::vector <Rts2SchedObs*>
 			}
 			return singleOptimum ();
 		}
+
+		/**
+		 * Calculate given objectives and constraints. Values are kept
+		 * until the schedule is changed.
+		 *
+		 * @param _objectives   objectives which will be calculated
+		 * @param _constraints  constraints which will be calculated
+		 */
+		void evaluate (std::list <objFunc> &_objectives, std::list <constraintFunc> &_constraints);
 };
 
 std::ostream & operator << (std::ostream & _os, Rts2Schedule & schedule);
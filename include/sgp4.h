@@ -21,6 +21,7 @@
 #define __RTS2_SGP4__
 
 #include <libnova/libnova.h>
+#include <vector>
 
 namespace rts2sgp4
 {
@@ -72,6 +73,89 @@ void ln_observer_cartesian_coords (struct ln_lnlat_posn *observer, double rho_co
 
 void ln_get_satellite_ra_dec_delta (struct ln_rect_posn *observer_loc, struct ln_rect_posn *satellite_loc, struct ln_equ_posn *equ, double *delta);
 
+/**
+ * Set of satellites propagated together to many dates. Constants of near
+ * Earth satellites are kept in structure of arrays, and all near Earth
+ * satellites are propagated to a date in a single loop over the arrays.
+ * Deep space satellites are propagated by propagate function.
+ *
+ * Results are indexed by satellite and date, result for satellite i at
+ * date j is stored at index i * nJD + j. Results of failed propagations
+ * are NAN.
+ *
+ * @author Petr Kubanek <petr@kubanek.net>
+ */
+class SatelliteSet
+{
+	public:
+		SatelliteSet ();
+
+		/**
+		 * Add satellite to the set.
+		 *
+		 * @return index of the satellite, -1 on error
+		 */
+		int add (const char *tle1, const char *tle2);
+
+		size_t size () { return satrecs.size (); }
+
+		elsetrec *getSatellite (size_t i) { return &(satrecs[i]); }
+
+		/**
+		 * Propagate all satellites to given dates.
+		 *
+		 * @param JD     dates
+		 * @param nJD    number of dates
+		 * @param x      returned satellite X coordinates (in km)
+		 * @param y      returned satellite Y coordinates (in km)
+		 * @param z      returned satellite Z coordinates (in km)
+		 *
+		 * @return number of failed propagations
+		 */
+		int propagate (const double *JD, size_t nJD, double *x, double *y, double *z);
+
+		/**
+		 * Propagate all satellites to given dates, and calculate their
+		 * topocentric positions, as ln_get_satellite_ra_dec_delta does.
+		 *
+		 * @param JD         dates
+		 * @param nJD        number of dates
+		 * @param observer   observer position
+		 * @param altitude   observer altitude (in meters)
+		 * @param ra         returned satellite RA (in degrees)
+		 * @param dec        returned satellite DEC (in degrees)
+		 * @param delta      returned distance to satellite (in km)
+		 *
+		 * @return number of failed propagations
+		 */
+		int topocentric (const double *JD, size_t nJD, struct ln_lnlat_posn *observer, double altitude, double *ra, double *dec, double *delta);
+
+	private:
+		std::vector <elsetrec> satrecs;
+
+		// indices of near Earth and deep space satellites
+		std::vector <size_t> nearSats;
+		std::vector <size_t> deepSats;
+
+		// constants of near Earth satellites, NEAR_CONSTS arrays of nearSats.size () values
+		std::vector <double> nearConsts;
+		bool constsValid;
+
+		double radiusearthkm;
+		double xke;
+		double j2;
+
+		void fillConstants ();
+
+		/**
+		 * Propagate satellites. If obs is not NULL, it contains
+		 * observer X, Y and Z for every date, and topocentric RA, DEC and
+		 * distance are returned in r1, r2 and r3. Otherwise satellite
+		 * X, Y and Z are returned.
+		 */
+		int run (const double *JD, size_t nJD, const double *obs, double *r1, double *r2, double *r3);
+};
+
 }
 
 #endif // !__RTS2_SGP4__
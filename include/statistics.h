@@ -0,0 +1,210 @@
+/*
+ * One pass statistics and median selection.
+ * Copyright (C) 2026 Petr Kubanek <petr@kubanek.net>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef __RTS2_STATISTICS__
+#define __RTS2_STATISTICS__
+
+#include <algorithm>
+#include <cmath>
+#include <stdint.h>
+#include <vector>
+
+/** Number of values processed in a single block. Block shall fit into L1 cache. */
+#define STATISTICS_BLOCK      4096
+
+namespace rts2core
+{
+
+/**
+ * Mean, variance, minimum and maximum calculated in a single pass over
+ * data, using Welford's algorithm. Arrays are processed in blocks which
+ * fit into cache; mean and squared deviations of each block are merged
+ * into the running values, so data are read from memory only once and
+ * the result does not suffer from cancellation of the naive sum of
+ * squares formula.
+ *
+ * @author Petr Kubanek <petr@kubanek.net>
+ */
+class RunningStatistics
+{
+	public:
+		RunningStatistics () { reset (); }
+
+		void reset ()
+		{
+			count = 0;
+			mean = 0;
+			m2 = 0;
+			sum = 0;
+			min = INFINITY;
+			max = -INFINITY;
+		}
+
+		/**
+		 * Add single value.
+		 */
+		void add (double v)
+		{
+			count++;
+			double d = v - mean;
+			mean += d / count;
+			m2 += d * (v - mean);
+			sum += v;
+			if (v < min)
+				min = v;
+			if (v > max)
+				max = v;
+		}
+
+		/**
+		 * Add array of values.
+		 *
+		 * @param data   values
+		 * @param n      number of values
+		 */
+		template <typename t> void add (const t *data, size_t n)
+		{
+			while (n > 0)
+			{
+				size_t bn = n > STATISTICS_BLOCK ? STATISTICS_BLOCK : n;
+				double bSum = 0;
+				t bMin = data[0];
+				t bMax = data[0];
+				for (size_t i = 0; i < bn; i++)
+				{
+					bSum += data[i];
+					bMin = data[i] < bMin ? data[i] : bMin;
+					bMax = data[i] > bMax ? data[i] : bMax;
+				}
+				double bMean = bSum / bn;
+				double bM2 = 0;
+				for (size_t i = 0; i < bn; i++)
+				{
+					double d = data[i] - bMean;
+					bM2 += d * d;
+				}
+				merge (bn, bMean, bM2);
+				sum += bSum;
+				if (bMin < min)
+					min = bMin;
+				if (bMax > max)
+					max = bMax;
+				data += bn;
+				n -= bn;
+			}
+		}
+
+		/**
+		 * Add statistics calculated from other data.
+		 */
+		void merge (const RunningStatistics &other)
+		{
+			merge (other.count, other.mean, other.m2);
+			sum += other.sum;
+			if (other.min < min)
+				min = other.min;
+			if (other.max > max)
+				max = other.max;
+		}
+
+		size_t getCount () { return count; }
+		double getSum () { return sum; }
+		double getMean () { return count > 0 ? mean : NAN; }
+
+		/**
+		 * Returns population variance.
+		 */
+		double getVariance () { return count > 0 ? m2 / count : NAN; }
+
+		/**
+		 * Returns population standard deviation.
+		 */
+		double getStdev () { return sqrt (getVariance ()); }
+
+		double getMin () { return count > 0 ? min : NAN; }
+		double getMax () { return count > 0 ? max : NAN; }
+
+	private:
+		size_t count;
+		double mean;
+		// sum of squared deviations from the mean
+		double m2;
+		double sum;
+		double min;
+		double max;
+
+		void merge (size_t bCount, double bMean, double bM2)
+		{
+			if (bCount == 0)
+				return;
+			if (count == 0)
+			{
+				count = bCount;
+				mean = bMean;
+				m2 = bM2;
+				return;
+			}
+			size_t total = count + bCount;
+			double d = bMean - mean;
+			mean += d * bCount / total;
+			m2 += bM2 + d * d * ((double) count * bCount / total);
+			count = total;
+		}
+};
+
+/**
+ * Find median by selection. Data are reordered. For even number of values,
+ * average of the two central values is returned.
+ *
+ * @param data   values, will be reordered
+ * @param n      number of values
+ *
+ * @return median, NAN if n is 0
+ */
+template <typename t> double selectMedian (t *data, size_t n)
+{
+	if (n == 0)
+		return NAN;
+	std::nth_element (data, data + n / 2, data + n);
+	double m = data[n / 2];
+	if (n % 2)
+		return m;
+	// lower central value is the largest value of the lower half
+	return (*std::max_element (data, data + n / 2) + m) / 2.0;
+}
+
+/**
+ * Returns median of the data, found by selection on copy of the data.
+ *
+ * @param data   values
+ * @param n      number of values
+ *
+ * @return median, NAN if n is 0
+ */
+template <typename t> double median (const t *data, size_t n)
+{
+	if (n == 0)
+		return NAN;
+	std::vector <t> copy (data, data + n);
+	return selectMedian (&copy[0], n);
+}
+
+}
+
+#endif // !__RTS2_STATISTICS__
@@ -27,6 +27,7 @@
 
 #include "device.h"
 #include "objectcheck.h"
+#include "trajectory.h"
 
 // pointing models
 #define POINTING_RADEC          0
@@ -50,6 +51,8 @@ namespace rts2telmodel
 namespace rts2teld
 {
 
+class AstromCache;
+
 /**
  * Basic class for telescope drivers.
  *
@@ -611,6 +614,10 @@ class Telescope:public rts2core::Device
 		 * Calculate speed vector from arc of given duration.
 		 *
 		 * This method calculates position in time JD and JD + sec_step / 86400.0.
+		 * Position at JD is always calculated. Position at JD + sec_step is
+		 * taken from tracking trajectory, if the trajectory is enabled and
+		 * position at JD does not differ from trajectory by more than
+		 * trajectory_error counts.
 		 *
 		 * @param JD             start Julian date
 		 * @param sec_step       lenght of arc in seconds
@@ -1233,6 +1240,23 @@ class Telescope:public rts2core::Device
 		 */
 		rts2core::ValueRaDec *skyVect;
 
+		rts2core::ValueDouble *trajectorySpan;
+		rts2core::ValueDouble *trajectoryError;
+		rts2core::ValueDouble *trajectoryEstimate;
+
+		Trajectory trajectory;
+
+		/**
+		 * Calculate tracking trajectory starting at utc1 + utc2. Trajectory
+		 * span is shortened if trajectory error exceeds trajectory_error.
+		 *
+		 * @return true if trajectory was calculated
+		 */
+		bool buildTrajectory (const double utc1, const double utc2, double sec_step, int32_t c_ac, int32_t c_dc, struct ln_equ_posn *eqpos);
+
+		// star independent astrometry parameters, used by applyCorrections
+		AstromCache *astromCache;
+
 		/**
 		 * If this value is true, any software move of the telescope is blocked.
 		 */
@@ -0,0 +1,127 @@
+/*
+ * Tracking trajectory of telescope axes.
+ * Copyright (C) 2026 Petr Kubanek <petr@kubanek.net>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef __RTS2_TRAJECTORY__
+#define __RTS2_TRAJECTORY__
+
+#include <stdint.h>
+
+namespace rts2teld
+{
+
+/**
+ * Short look-ahead trajectory of axis counts and target RA/DEC. Trajectory
+ * is a quadratic polynomial through positions calculated at beginning,
+ * middle and end of its span. Before it is used, trajectory is checked
+ * against an exactly calculated position, and the difference is kept as
+ * estimated trajectory error.
+ *
+ * Times are passed as two part UTC Julian dates, as in Telescope tracking
+ * calls, so resolution of times inside trajectory span is not limited by
+ * precision of a single double JD.
+ *
+ * @author Petr Kubanek <petr@kubanek.net>
+ */
+class Trajectory
+{
+	public:
+		Trajectory () { invalidate (); }
+
+		/**
+		 * Fit trajectory through three positions, calculated at
+		 * start, start + span / 2 and start + span.
+		 *
+		 * @param utc1   first part of trajectory start date
+		 * @param utc2   second part of trajectory start date
+		 * @param _span  trajectory span in seconds
+		 * @param ac     axis counts of the first axis
+		 * @param dc     axis counts of the second axis
+		 * @param ra     target RA, in degrees
+		 * @param dec    target DEC, in degrees
+		 */
+		void fit (double utc1, double utc2, double _span, const int32_t ac[3], const int32_t dc[3], const double ra[3], const double dec[3]);
+
+		/**
+		 * Returns true if trajectory covers given date.
+		 */
+		bool covers (double utc1, double utc2) { double t = getOffset (utc1, utc2); return valid && t >= 0 && t <= span; }
+
+		/**
+		 * Returns axis counts at given date.
+		 */
+		void getCounts (double utc1, double utc2, int32_t &ac, int32_t &dc);
+
+		/**
+		 * Returns axis speeds at given date, in counts per second.
+		 */
+		void getSpeed (double utc1, double utc2, double &ac_speed, double &dc_speed);
+
+		/**
+		 * Returns target position at given date.
+		 */
+		void getRaDec (double utc1, double utc2, double &ra, double &dec);
+
+		/**
+		 * Returns difference of trajectory axis counts from given
+		 * counts, in counts. Larger of both axes differences is
+		 * returned.
+		 */
+		double getDifference (double utc1, double utc2, int32_t ac, int32_t dc);
+
+		/**
+		 * Set estimated trajectory error.
+		 */
+		void setError (double _error) { error = _error; }
+
+		/**
+		 * Estimated trajectory error in axis counts.
+		 */
+		double getError () { return error; }
+
+		double getSpan () { return span; }
+
+		void invalidate () { valid = false; error = 0; }
+
+		bool isValid () { return valid; }
+
+	private:
+		bool valid;
+
+		double start1;
+		double start2;
+		// span in seconds
+		double span;
+
+		double error;
+
+		// polynomial coefficients for fraction of the span
+		double acc[3];
+		double dcc[3];
+		double rac[3];
+		double decc[3];
+
+		double getOffset (double utc1, double utc2) { return ((utc1 - start1) + (utc2 - start2)) * 86400.0; }
+
+		static void fitPoly (double c[3], double y0, double y1, double y2);
+		static double evalPoly (double c[3], double u) { return c[0] + u * (c[1] + u * c[2]); }
+};
+
+}
+
+#endif // !__RTS2_TRAJECTORY__
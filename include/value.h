@@ -411,6 +411,26 @@ class Value
 		 */
 		virtual const char *getDisplayValue () { return getValue (); }
 
+		/**
+		 * Append binary representation of the value, in host byte order, to the buffer.
+		 * Used for binary value records.
+		 *
+		 * @param out  buffer where value will be appended
+		 *
+		 * @return false if the value does not have binary representation
+		 */
+		virtual bool getBinaryValue (std::string &out) { return false; }
+
+		/**
+		 * Set value from binary representation.
+		 *
+		 * @param data  binary data, as written by getBinaryValue; it does not need to be aligned
+		 * @param size  size of the data
+		 *
+		 * @return -2 on error, 0 on success
+		 */
+		virtual int setBinaryValue (const char *data, size_t size) { return -2; }
+
 		/**
 		 * Returns part value as string.
 		 * Use to expand subvalues, like RA/DEC for ValueRaDec.
@@ -516,6 +536,13 @@ class Value
 		 */
 		void changed () { rts2Type |= RTS2_VALUE_CHANGED | RTS2_VALUE_NEED_SEND; }
 
+		/**
+		 * True if value update is queued in daemon for sending at the end of the loop iteration.
+		 */
+		bool isPendingSend () { return pendingSend; }
+
+		void setPendingSend (bool _pending) { pendingSend = _pending; }
+
 		int getWriteGroup () { return ((rts2Type & RTS2_WR_GROUP_NR_MASK) >> 16) - 0x20; }
 
 		void maskError (int32_t err) { rts2Type = ( rts2Type & ~RTS2_VALUE_ERRORMASK ) | err; }
@@ -543,6 +570,7 @@ class Value
 	private:
 		std::string valueName;
 		std::string description;
+		bool pendingSend;
 };
 
 /**
@@ -612,6 +640,8 @@ class ValueInteger:public Value
 		virtual void setFromValue (Value * newValue);
 		virtual bool isEqual (Value *other_value);
 		virtual int checkNotNull ();
+		virtual bool getBinaryValue (std::string &out) { out.append ((char *) &value, sizeof (value)); return true; }
+		virtual int setBinaryValue (const char *data, size_t size);
 	private:
 		int value;
 };
@@ -650,6 +680,8 @@ class ValueDouble:public Value
 		virtual void setFromValue (Value * newValue);
 		virtual bool isEqual (Value *other_value);
 		virtual int checkNotNull ();
+		virtual bool getBinaryValue (std::string &out) { out.append ((char *) &value, sizeof (value)); return true; }
+		virtual int setBinaryValue (const char *data, size_t size);
 	protected:
 		double value;
 };
@@ -733,6 +765,8 @@ class ValueFloat:public Value
 		}
 		virtual void setFromValue (Value * newValue);
 		virtual bool isEqual (Value *other_value);
+		virtual bool getBinaryValue (std::string &out) { out.append ((char *) &value, sizeof (value)); return true; }
+		virtual int setBinaryValue (const char *data, size_t size);
 };
 
 /**
@@ -748,6 +782,7 @@ class ValueBool:public ValueInteger
 		ValueBool (std::string in_val_name, std::string in_description, bool writeToFits = true, int32_t flags = 0);
 		virtual int setValue (Connection * connection);
 		virtual int setValueCharArr (const char *in_value);
+		virtual int setBinaryValue (const char *data, size_t size);
 
 		void setValueBool (bool in_bool)
 		{
@@ -959,6 +994,8 @@ class ValueLong:public Value
 		}
 		virtual void setFromValue (Value * newValue);
 		virtual bool isEqual (Value *other_value);
+		virtual bool getBinaryValue (std::string &out);
+		virtual int setBinaryValue (const char *data, size_t size);
 	private:
 		long int value;
 };
@@ -1051,6 +1088,8 @@ class ValueRaDec: public Value
 
 		virtual void setFromValue (Value * newValue);
 		virtual bool isEqual (Value *other_value);
+		virtual bool getBinaryValue (std::string &out);
+		virtual int setBinaryValue (const char *data, size_t size);
 
 	private:
 		double ra;
@@ -1144,6 +1183,8 @@ class ValueAltAz: public Value
 
 		virtual void setFromValue (Value * newValue);
 		virtual bool isEqual (Value *other_value);
+		virtual bool getBinaryValue (std::string &out);
+		virtual int setBinaryValue (const char *data, size_t size);
 
 	private:
 		double alt;
@@ -138,6 +138,8 @@ class DoubleArray: public ValueArray
 		virtual const char *getValue ();
 		virtual void setFromValue (rts2core::Value *newValue);
 		virtual bool isEqual (rts2core::Value *other_val);
+		virtual bool getBinaryValue (std::string &out);
+		virtual int setBinaryValue (const char *data, size_t size);
 
 		void setValueArray (std::vector <double> _arr);
 
@@ -214,6 +216,8 @@ class IntegerArray: public ValueArray
 		virtual const char *getValue ();
 		virtual void setFromValue (rts2core::Value *newValue);
 		virtual bool isEqual (rts2core::Value *other_val);
+		virtual bool getBinaryValue (std::string &out);
+		virtual int setBinaryValue (const char *data, size_t size);
 
 		void setValueInteger (int i, int v) { value[i] = v; }
 
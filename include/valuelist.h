@@ -20,6 +20,8 @@
 #ifndef __RTS2_VALUELIST__
 #define __RTS2_VALUELIST__
 
+#include <algorithm>
+#include <ctype.h>
 #include <vector>
 
 #include "value.h"
@@ -28,26 +30,137 @@
 namespace rts2core
 {
 
+class CondValue;
+
+/**
+ * Case insensitive hash index of values names. Open addressing table with
+ * linear probing, used by value vectors to find value by its name in
+ * constant time. When there are more values with the same name, index
+ * points to the first one.
+ *
+ * @ingroup RTS2Value
+ *
+ * @author Petr Kubanek <petr@kubanek.net>
+ */
+template <typename T> class ValueNameIndex
+{
+	public:
+		ValueNameIndex () { used = 0; }
+
+		/**
+		 * Find entry by value name.
+		 *
+		 * @return entry with the given name, NULL if it is not indexed
+		 */
+		T find (const char *value_name)
+		{
+			if (slots.empty ())
+				return NULL;
+			size_t mask = slots.size () - 1;
+			for (size_t i = hashName (value_name) & mask; slots[i] != NULL; i = (i + 1) & mask)
+			{
+				if (indexedValue (slots[i])->isValue (value_name))
+					return slots[i];
+			}
+			return NULL;
+		}
+
+		/**
+		 * Add entry appended to the vector.
+		 *
+		 * @return false if index must be rebuild from the vector
+		 */
+		bool add (T entry)
+		{
+			if ((used + 1) * 2 > slots.size ())
+				return false;
+			return insert (entry);
+		}
+
+		/**
+		 * Rebuild index from vector entries.
+		 */
+		template <typename I> void rebuild (I first, I last)
+		{
+			size_t s = 64;
+			while (s < 2 * (size_t) (last - first) + 2)
+				s *= 2;
+			slots.assign (s, (T) NULL);
+			used = 0;
+			for (; first != last; first++)
+				insert (*first);
+		}
+
+	private:
+		std::vector <T> slots;
+		size_t used;
+
+		static Value *indexedValue (Value *val) { return val; }
+		static Value *indexedValue (CondValue *val);
+
+		static size_t hashName (const char *name)
+		{
+			// FNV-1a of lowercase name
+			size_t h = 2166136261u;
+			for (; *name; name++)
+			{
+				h ^= (unsigned char) tolower (*name);
+				h *= 16777619u;
+			}
+			return h;
+		}
+
+		// returns false if entry with the same name is already indexed
+		bool insert (T entry)
+		{
+			std::string name = indexedValue (entry)->getName ();
+			size_t mask = slots.size () - 1;
+			size_t i;
+			for (i = hashName (name.c_str ()) & mask; slots[i] != NULL; i = (i + 1) & mask)
+			{
+				if (indexedValue (slots[i])->isValue (name.c_str ()))
+					return false;
+			}
+			slots[i] = entry;
+			used++;
+			return true;
+		}
+};
+
 /**
  * Represent set of Values. It's used to store values which shall
  * be reseted when new script starts etc..
  *
+ * Values are indexed by name. Vector is accessible only through methods
+ * maintaining the index; iterators do not allow to replace values.
+ *
  * @ingroup RTS2Value
  *
  * @author Petr Kubanek <petr@kubanek.net>
  */
-class ValueVector:public std::vector < Value * >
+class ValueVector
 {
 	public:
+		typedef std::vector <Value *>::const_iterator iterator;
+
 		ValueVector ()
 		{
+			index.rebuild (values.begin (), values.end ());
 		}
 		~ValueVector (void)
 		{
-			for (ValueVector::iterator iter = begin (); iter != end (); iter++)
+			for (iterator iter = begin (); iter != end (); iter++)
 				delete *iter;
 		}
 
+		iterator begin () { return values.begin (); }
+		iterator end () { return values.end (); }
+
+		size_t size () { return values.size (); }
+		bool empty () { return values.empty (); }
+
+		Value *operator[] (size_t i) { return values[i]; }
+
 		/**
 		 * Returns iterator reference for value with given name.
 		 *
@@ -55,17 +168,12 @@ class ValueVector:public std::vector < Value * >
 		 *
 		 * @return Interator reference of the value with given name.
 		 */
-		ValueVector::iterator getValueIterator (const char *value_name)
+		iterator getValueIterator (const char *value_name)
 		{
-			ValueVector::iterator val_iter;
-			for (val_iter = begin (); val_iter != end (); val_iter++)
-			{
-				Value *val;
-				val = (*val_iter);
-				if (val->isValue (value_name))
-					return val_iter;
-			}
-			return val_iter;
+			Value *val = index.find (value_name);
+			if (val == NULL)
+				return end ();
+			return std::find (begin (), end (), val);
 		}
 
 		/**
@@ -77,10 +185,7 @@ class ValueVector:public std::vector < Value * >
 		 */
 		Value *getValue (const char *value_name)
 		{
-			ValueVector::iterator val_iter = getValueIterator (value_name);
-			if (val_iter == end ())
-				return NULL;
-			return (*val_iter);
+			return index.find (value_name);
 		}
 
 		/**
@@ -88,15 +193,51 @@ class ValueVector:public std::vector < Value * >
 		 *
 		 * @param value_name  Name of the value.
 		 */
-		ValueVector::iterator removeValue (const char *value_name)
+		iterator removeValue (const char *value_name)
 		{
-			ValueVector::iterator val_iter = getValueIterator (value_name);
+			iterator val_iter = getValueIterator (value_name);
 			if (val_iter == end ())
 				return val_iter;
 			delete (*val_iter);
-			val_iter = erase (val_iter);
-			return val_iter;
+			return erase (val_iter);
+		}
+
+		void push_back (Value *val)
+		{
+			values.push_back (val);
+			if (!index.add (val))
+				index.rebuild (values.begin (), values.end ());
 		}
+
+		iterator insert (iterator pos, Value *val)
+		{
+			// value inserted in the middle can precede value with the same name
+			bool tail = (pos == end ());
+			iterator ret = values.insert (values.begin () + (pos - begin ()), val);
+			if (!tail || !index.add (val))
+				index.rebuild (values.begin (), values.end ());
+			return ret;
+		}
+
+		iterator erase (iterator pos)
+		{
+			iterator ret = values.erase (values.begin () + (pos - begin ()));
+			index.rebuild (values.begin (), values.end ());
+			return ret;
+		}
+
+		/**
+		 * Remove all values from the list. Values are not deleted.
+		 */
+		void clear ()
+		{
+			values.clear ();
+			index.rebuild (values.begin (), values.end ());
+		}
+
+	private:
+		std::vector <Value *> values;
+		ValueNameIndex <Value *> index;
 };
 
 /**
@@ -135,24 +276,71 @@ class CondValue
 };
 
 /**
- * Holds cond values.
+ * Holds cond values. Values are indexed by name, the same way as in ValueVector.
  *
  * @ingroup RTS2Value
  *
  * @author Petr Kubanek <petr@kubanek.net>
  */
-class CondValueVector:public std::vector < CondValue * >
+class CondValueVector
 {
 	public:
-		CondValueVector () {}
+		typedef std::vector <CondValue *>::const_iterator iterator;
+
+		CondValueVector ()
+		{
+			index.rebuild (values.begin (), values.end ());
+		}
 
 		~CondValueVector (void)
 		{
-			for (CondValueVector::iterator iter = begin (); iter != end (); iter++)
+			for (iterator iter = begin (); iter != end (); iter++)
 				delete *iter;
 		}
+
+		iterator begin () { return values.begin (); }
+		iterator end () { return values.end (); }
+
+		size_t size () { return values.size (); }
+		bool empty () { return values.empty (); }
+
+		/**
+		 * Search for cond value by value name.
+		 *
+		 * @return CondValue with the given name, NULL if it does not exists
+		 */
+		CondValue *getCondValue (const char *value_name) { return index.find (value_name); }
+
+		void push_back (CondValue *val)
+		{
+			values.push_back (val);
+			if (!index.add (val))
+				index.rebuild (values.begin (), values.end ());
+		}
+
+		iterator erase (iterator pos)
+		{
+			iterator ret = values.erase (values.begin () + (pos - begin ()));
+			index.rebuild (values.begin (), values.end ());
+			return ret;
+		}
+
+		/**
+		 * Remove all values from the list. Values are not deleted.
+		 */
+		void clear ()
+		{
+			values.clear ();
+			index.rebuild (values.begin (), values.end ());
+		}
+
+	private:
+		std::vector <CondValue *> values;
+		ValueNameIndex <CondValue *> index;
 };
 
+template <typename T> Value *ValueNameIndex <T>::indexedValue (CondValue *val) { return val->getValue (); }
+
 /**
  * Holds value changes which cannot be handled by device immediately.
  *
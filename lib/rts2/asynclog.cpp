@@ -0,0 +1,217 @@
+/*
+ * Asynchronous buffered message log.
+ * Copyright (C) 2026 Petr Kubanek <petr@kubanek.net>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "asynclog.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+using namespace rts2core;
+
+AsyncLog::AsyncLog (size_t _size, double _flushInterval)
+{
+	size_t s = 2;
+	while (s < _size)
+		s <<= 1;
+
+	slots = new AsyncLogSlot[s];
+	mask = s - 1;
+	for (size_t i = 0; i < s; i++)
+		slots[i].seq = i;
+
+	tail = 0;
+	head = 0;
+
+	dropped = 0;
+	reportedDropped = 0;
+
+	flushInterval = _flushInterval;
+
+	pthread_mutex_init (&fileMutex, NULL);
+	pthread_mutex_init (&mutex, NULL);
+	pthread_cond_init (&cond, NULL);
+
+	running = false;
+	failed = false;
+	stop = false;
+}
+
+AsyncLog::~AsyncLog ()
+{
+	if (running)
+	{
+		pthread_mutex_lock (&mutex);
+		stop = true;
+		pthread_cond_signal (&cond);
+		pthread_mutex_unlock (&mutex);
+
+		pthread_join (thread, NULL);
+	}
+
+	writeQueued ();
+
+	if (file.is_open ())
+		file.close ();
+
+	delete[] slots;
+
+	pthread_mutex_destroy (&fileMutex);
+	pthread_mutex_destroy (&mutex);
+	pthread_cond_destroy (&cond);
+}
+
+int AsyncLog::open (const char *filename)
+{
+	pthread_mutex_lock (&fileMutex);
+	if (file.is_open ())
+		file.close ();
+	file.clear ();
+	file.open (filename, std::ios_base::out | std::ios_base::app);
+	int ret = file.fail () ? -1 : 0;
+	pthread_mutex_unlock (&fileMutex);
+	return ret;
+}
+
+int AsyncLog::start ()
+{
+	int ret = pthread_create (&thread, NULL, runThread, this);
+	if (ret)
+	{
+		errno = ret;
+		failed = true;
+		return -1;
+	}
+	running = true;
+	return 0;
+}
+
+int AsyncLog::log (Message &msg)
+{
+	AsyncLogSlot *slot;
+	size_t pos = __atomic_load_n (&tail, __ATOMIC_RELAXED);
+	while (true)
+	{
+		slot = slots + (pos & mask);
+		size_t seq = __atomic_load_n (&slot->seq, __ATOMIC_ACQUIRE);
+		long dif = (long) seq - (long) pos;
+		if (dif == 0)
+		{
+			if (__atomic_compare_exchange_n (&tail, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+				break;
+		}
+		else if (dif < 0)
+		{
+			// ring is full
+			__atomic_fetch_add (&dropped, 1, __ATOMIC_RELAXED);
+			if (running)
+				pthread_cond_signal (&cond);
+			return -1;
+		}
+		else
+		{
+			pos = __atomic_load_n (&tail, __ATOMIC_RELAXED);
+		}
+	}
+
+	slot->messageTime.tv_sec = msg.getMessageTimeSec ();
+	slot->messageTime.tv_usec = msg.getMessageTimeUSec ();
+	slot->messageOName = msg.getMessageOName ();
+	slot->messageType = msg.getType ();
+	slot->messageString = msg.getMessageString ();
+
+	__atomic_store_n (&slot->seq, pos + 1, __ATOMIC_RELEASE);
+
+	if (!running)
+		writeQueued ();
+	// wake the flusher before the ring fills, otherwise it writes on the next flush interval
+	else if ((pos & (mask >> 1)) == 0)
+		pthread_cond_signal (&cond);
+
+	return 0;
+}
+
+void *AsyncLog::runThread (void *arg)
+{
+	((AsyncLog *) arg)->run ();
+	return NULL;
+}
+
+void AsyncLog::run ()
+{
+	pthread_mutex_lock (&mutex);
+	while (!stop)
+	{
+		pthread_mutex_unlock (&mutex);
+		size_t n = writeQueued ();
+		pthread_mutex_lock (&mutex);
+		if (n > 0 || stop)
+			continue;
+
+		struct timespec ts;
+		clock_gettime (CLOCK_REALTIME, &ts);
+		double until = ts.tv_sec + ts.tv_nsec / 1e9 + flushInterval;
+		ts.tv_sec = (time_t) until;
+		ts.tv_nsec = (long) ((until - ts.tv_sec) * 1e9);
+
+		pthread_cond_timedwait (&cond, &mutex, &ts);
+	}
+	pthread_mutex_unlock (&mutex);
+}
+
+size_t AsyncLog::writeQueued ()
+{
+	size_t n = 0;
+
+	pthread_mutex_lock (&fileMutex);
+	while (true)
+	{
+		AsyncLogSlot *slot = slots + (head & mask);
+		size_t seq = __atomic_load_n (&slot->seq, __ATOMIC_ACQUIRE);
+		if (seq != head + 1)
+			break;
+
+		Message msg (slot->messageTime, slot->messageOName, slot->messageType, slot->messageString);
+		if (file.is_open ())
+			file << msg << '\n';
+
+		__atomic_store_n (&slot->seq, head + mask + 1, __ATOMIC_RELEASE);
+		head++;
+		n++;
+	}
+
+	unsigned long d = __atomic_load_n (&dropped, __ATOMIC_RELAXED);
+	if (d != reportedDropped)
+	{
+		char buf[100];
+		snprintf (buf, 100, "dropped %lu messages, log ring was full", d - reportedDropped);
+		Message msg ("asynclog", MESSAGE_WARNING, buf);
+		if (file.is_open ())
+			file << msg << '\n';
+		reportedDropped = d;
+		n++;
+	}
+
+	if (n > 0 && file.is_open ())
+		file.flush ();
+	pthread_mutex_unlock (&fileMutex);
+
+	return n;
+}
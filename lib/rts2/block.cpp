@@ -22,6 +22,7 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <iostream>
+#include <limits.h>
 #include <netinet/in.h>
 #include <poll.h>
 #include <signal.h>
@@ -51,6 +52,9 @@ const char *type_names[] =
 //* Size of pollfd descriptors allocated
 #define POLLS_SIZE    200
 
+//* Maximal number of events returned by single epoll_wait call
+#define EPOLL_EVENTS  200
+
 using namespace rts2core;
 
 Block::Block (int in_argc, char **in_argv):App (in_argc, in_argv)
@@ -61,6 +65,17 @@ Block::Block (int in_argc, char **in_argv):App (in_argc, in_argv)
 	fds = new struct pollfd[pollsize];
 	npolls = 0;
 
+	usePoll = false;
+
+	textValues = false;
+	addOption (OPT_TEXT_VALUES, "text-values", 0, "send and request value updates as text, do not use binary value records");
+
+#ifdef RTS2_HAVE_SYS_EPOLL_H
+	// epoll set is created on the first oneRunLoop call, so --poll option can be processed
+	epollfd = -1;
+	addOption (OPT_POLL, "poll", 0, "use ppoll instead of epoll in the event loop");
+#endif
+
 	signal (SIGPIPE, SIG_IGN);
 
 	masterState = SERVERD_HARD_OFF;
@@ -92,6 +107,26 @@ Block::~Block (void)
 		delete *iu;
 	delete[] fds;
 	blockUsers.clear ();
+#ifdef RTS2_HAVE_SYS_EPOLL_H
+	if (epollfd >= 0)
+		close (epollfd);
+#endif
+}
+
+int Block::processOption (int in_opt)
+{
+	switch (in_opt)
+	{
+		case OPT_POLL:
+			usePoll = true;
+			break;
+		case OPT_TEXT_VALUES:
+			textValues = true;
+			break;
+		default:
+			return App::processOption (in_opt);
+	}
+	return 0;
 }
 
 void Block::setPort (int in_port)
@@ -108,6 +143,24 @@ void Block::addPollSocks ()
 {
 	connections_t::iterator iter;
 	npolls = 0;
+#ifdef RTS2_HAVE_SYS_EPOLL_H
+	if (epollfd >= 0)
+	{
+		// descriptors of other connections stay registered from previous rounds
+		pollRanges.clear ();
+		for (std::set <Connection *>::iterator ic = pollChangedConns.begin (); ic != pollChangedConns.end (); ic++)
+		{
+			PollRange range;
+			range.conn = *ic;
+			range.start = npolls;
+			(*ic)->add (this);
+			range.end = npolls;
+			pollRanges.push_back (range);
+		}
+		pollChangedConns.clear ();
+		return;
+	}
+#endif
 	for (iter = connections.begin (); iter != connections.end (); iter++)
 		(*iter)->add (this);
 	for (iter = centraldConns.begin (); iter != centraldConns.end (); iter++)
@@ -169,12 +222,17 @@ void Block::removeConnection (Connection *_conn)
 		else
 			iter++;
 	}
+
+	removePollConnection (_conn);
 }
 
 void Block::addCentraldConnection (Connection *_conn, bool added)
 {
 	if (added)
+	{
 	  	centraldConns.push_back (_conn);
+		pollAdded (_conn);
+	}
 	else
 		centraldConns_added.push_back (_conn);
 }
@@ -277,11 +335,13 @@ int Block::idle ()
 	for (iter = connections_added.begin (); iter != connections_added.end (); iter = connections_added.erase (iter))
 	{
 		connections.push_back (*iter);
+		pollAdded (*iter);
 	}
 
 	for (iter = centraldConns_added.begin (); iter != centraldConns_added.end (); iter = centraldConns_added.erase (iter))
 	{
 		centraldConns.push_back (*iter);
+		pollAdded (*iter);
 	}
 
 	// test for any pending timers..
@@ -315,6 +375,21 @@ void Block::pollSuccess ()
 
 	connections_t::iterator iter;
 
+#ifdef RTS2_HAVE_SYS_EPOLL_H
+	if (epollfd >= 0)
+	{
+		// process only connections with ready descriptors
+		pollDispatch.assign (readyConns.begin (), readyConns.end ());
+		for (std::vector <Connection *>::iterator ic = pollDispatch.begin (); ic != pollDispatch.end (); ic++)
+		{
+			if (*ic != NULL)
+				pollConnection (*ic);
+		}
+		pollDispatch.clear ();
+		return;
+	}
+#endif
+
 	for (iter = connections.begin (); iter != connections.end ();)
 	{
 		conn = *iter;
@@ -406,7 +481,36 @@ void Block::oneRunLoop ()
 		}
 	}
 
+#ifdef RTS2_HAVE_SYS_EPOLL_H
+	if (epollfd < 0 && usePoll == false)
+	{
+		epollfd = epoll_create1 (EPOLL_CLOEXEC);
+		if (epollfd < 0)
+		{
+			logStream (MESSAGE_WARNING) << "cannot create epoll descriptor, falling back to ppoll: " << strerror (errno) << sendLog;
+			usePoll = true;
+		}
+		else
+		{
+			connections_t::iterator iter;
+			for (iter = connections.begin (); iter != connections.end (); iter++)
+				pollChanged (*iter);
+			for (iter = centraldConns.begin (); iter != centraldConns.end (); iter++)
+				pollChanged (*iter);
+		}
+	}
+#endif
+	// values changed after the previous idle call must not wait for the poll timeout
+	flushPendingValues ();
 	addPollSocks ();
+#ifdef RTS2_HAVE_SYS_EPOLL_H
+	if (epollfd >= 0)
+	{
+		if (epollWait (&read_tout) > 0)
+			pollSuccess ();
+	}
+	else
+#endif
 	if (ppoll (fds, npolls, &read_tout, NULL) > 0)
 		pollSuccess ();
 	ret = idle ();
@@ -507,7 +611,8 @@ void Block::addPollFD (int fd, short events)
 	if (npolls == pollsize)
 	{
 		struct pollfd *npollfds;
-		npollfds = new struct pollfd[npolls + POLLS_SIZE];
+		pollsize = npolls + POLLS_SIZE;
+		npollfds = new struct pollfd[pollsize];
 		memcpy ((void *) npollfds, (void *) fds, sizeof (struct pollfd) * npolls);
 		delete[] fds;
 		fds = npollfds;
@@ -518,8 +623,88 @@ void Block::addPollFD (int fd, short events)
 	npolls++;
 }
 
+void Block::removePollFD (int fd)
+{
+#ifdef RTS2_HAVE_SYS_EPOLL_H
+	if (fd < 0 || (size_t) fd >= epollRegs.size ())
+		return;
+	EPollReg &reg = epollRegs[fd];
+	if (reg.registered)
+	{
+		std::vector <int> *regFds = &pollBlockFds;
+		if (reg.owner)
+		{
+			std::map <Connection *, std::vector <int> >::iterator ic = pollConnFds.find (reg.owner);
+			regFds = (ic == pollConnFds.end ()) ? NULL : &(ic->second);
+		}
+		if (regFds)
+		{
+			std::vector <int>::iterator iter = std::find (regFds->begin (), regFds->end (), fd);
+			if (iter != regFds->end ())
+			{
+				*iter = regFds->back ();
+				regFds->pop_back ();
+			}
+		}
+		// descriptor might be already closed, so ignore errors
+		epollUnregister (fd);
+	}
+	reg.revents = 0;
+	reg.owner = NULL;
+#endif
+}
+
+void Block::pollChanged (Connection *conn)
+{
+#ifdef RTS2_HAVE_SYS_EPOLL_H
+	// connections which are not in connection lists (e.g. connections used synchronously) are not polled
+	if (epollfd >= 0 && polledConns.find (conn) != polledConns.end ())
+		pollChangedConns.insert (conn);
+#endif
+}
+
+void Block::pollAdded (Connection *conn)
+{
+#ifdef RTS2_HAVE_SYS_EPOLL_H
+	polledConns.insert (conn);
+	pollChanged (conn);
+#endif
+}
+
+void Block::removePollConnection (Connection *conn)
+{
+#ifdef RTS2_HAVE_SYS_EPOLL_H
+	polledConns.erase (conn);
+	pollChangedConns.erase (conn);
+	alwaysReadyConns.erase (conn);
+	readyConns.erase (conn);
+	std::replace (pollDispatch.begin (), pollDispatch.end (), conn, (Connection *) NULL);
+	std::map <Connection *, std::vector <int> >::iterator iter = pollConnFds.find (conn);
+	if (iter == pollConnFds.end ())
+		return;
+	for (std::vector <int>::iterator fi = iter->second.begin (); fi != iter->second.end (); fi++)
+	{
+		// descriptor might be already reused by other connection
+		if (epollRegs[*fi].owner == conn)
+		{
+			epollUnregister (*fi);
+			epollRegs[*fi].owner = NULL;
+		}
+	}
+	pollConnFds.erase (iter);
+#endif
+}
+
 short Block::getPollEvents (int fd)
 {
+#ifdef RTS2_HAVE_SYS_EPOLL_H
+	if (epollfd >= 0)
+	{
+		if (fd < 0 || (size_t) fd >= epollRegs.size ())
+			return 0;
+		return epollRegs[fd].revents;
+	}
+#endif
 	for (nfds_t i = 0; i < npolls; i++)
 	{
 		if (fds[i].fd == fd)
@@ -528,6 +713,188 @@ short Block::getPollEvents (int fd)
 	return 0;
 }
 
+#ifdef RTS2_HAVE_SYS_EPOLL_H
+void Block::pollConnection (Connection *conn)
+{
+	if (conn->receive (this) == -1 || conn->writable (this) == -1)
+	{
+		#ifdef DEBUG_EXTRA
+		logStream (MESSAGE_DEBUG) << "Will delete connection " << " name: " << conn->getName () << sendLog;
+		#endif
+		// delete connection only when it really requested to be deleted..
+		if (deleteConnection (conn) == 0)
+		{
+			connections_t::iterator iter = std::find (connections.begin (), connections.end (), conn);
+			if (iter != connections.end ())
+			{
+				connections.erase (iter);
+			}
+			else
+			{
+				iter = std::find (centraldConns.begin (), centraldConns.end (), conn);
+				if (iter != centraldConns.end ())
+					centraldConns.erase (iter);
+			}
+			connectionRemoved (conn);
+			delete conn;
+			return;
+		}
+	}
+	// receive and writable might change connection state or its transmit queue
+	pollChanged (conn);
+}
+
+void Block::epollRegister (int fd, short events, Connection *owner)
+{
+	EPollReg &reg = epollRegs[fd];
+
+	struct epoll_event ev;
+	memset (&ev, 0, sizeof (ev));
+	// on Linux, EPOLLIN, EPOLLPRI and EPOLLOUT have the same values as their POLL counterparts
+	ev.events = events & (POLLIN | POLLPRI | POLLOUT);
+	ev.data.fd = fd;
+
+	int ret;
+	if (reg.registered)
+	{
+		ret = epoll_ctl (epollfd, EPOLL_CTL_MOD, fd, &ev);
+		// descriptor was closed and its number reused
+		if (ret && errno == ENOENT)
+			ret = epoll_ctl (epollfd, EPOLL_CTL_ADD, fd, &ev);
+	}
+	else
+	{
+		ret = epoll_ctl (epollfd, EPOLL_CTL_ADD, fd, &ev);
+		if (ret && errno == EEXIST)
+			ret = epoll_ctl (epollfd, EPOLL_CTL_MOD, fd, &ev);
+	}
+	if (ret)
+	{
+		logStream (MESSAGE_ERROR) << "cannot register descriptor " << fd << " with epoll: " << strerror (errno) << sendLog;
+		reg.registered = false;
+		return;
+	}
+	reg.registered = true;
+	reg.events = events;
+	reg.owner = owner;
+}
+
+void Block::epollUnregister (int fd)
+{
+	EPollReg &reg = epollRegs[fd];
+	if (reg.registered)
+		epoll_ctl (epollfd, EPOLL_CTL_DEL, fd, NULL);
+	reg.registered = false;
+}
+
+void Block::epollSync (Connection *owner, std::vector <int> &regFds, nfds_t start, nfds_t end)
+{
+	// merge multiple requests for the same descriptor
+	std::map <int, short> wanted;
+	for (nfds_t i = start; i < end; i++)
+	{
+		if (fds[i].fd >= 0)
+			wanted[fds[i].fd] |= fds[i].events;
+	}
+
+	// remove descriptors which are no longer requested
+	for (std::vector <int>::iterator iter = regFds.begin (); iter != regFds.end (); iter++)
+	{
+		if (wanted.find (*iter) == wanted.end () && epollRegs[*iter].owner == owner)
+		{
+			epollUnregister (*iter);
+			epollRegs[*iter].owner = NULL;
+		}
+	}
+
+	// register only changed descriptors
+	regFds.clear ();
+	for (std::map <int, short>::iterator iter = wanted.begin (); iter != wanted.end (); iter++)
+	{
+		int fd = iter->first;
+		if ((size_t) fd >= epollRegs.size ())
+		{
+			EPollReg empty;
+			memset (&empty, 0, sizeof (empty));
+			epollRegs.resize (fd + 1, empty);
+		}
+		EPollReg &reg = epollRegs[fd];
+		if (reg.registered == false || reg.owner != owner || reg.events != iter->second)
+			epollRegister (fd, iter->second, owner);
+		regFds.push_back (fd);
+	}
+}
+
+int Block::epollWait (struct timespec *read_tout)
+{
+	// clear events from previous call
+	for (std::vector <int>::iterator iter = readyFds.begin (); iter != readyFds.end (); iter++)
+	{
+		if ((size_t) *iter < epollRegs.size ())
+			epollRegs[*iter].revents = 0;
+	}
+	readyFds.clear ();
+	readyConns.clear ();
+
+	// synchronize registrations of connections which changed
+	nfds_t blockStart = 0;
+	for (std::vector <PollRange>::iterator iter = pollRanges.begin (); iter != pollRanges.end (); iter++)
+	{
+		Connection *conn = iter->conn;
+		if (iter->end > blockStart)
+			blockStart = iter->end;
+		std::vector <int> &regFds = pollConnFds[conn];
+		epollSync (conn, regFds, iter->start, iter->end);
+		// connections without any descriptor, or marked for deletion, are processed in every pollSuccess call, as with ppoll
+		if (regFds.empty () || conn->isConnState (CONN_DELETE))
+			alwaysReadyConns.insert (conn);
+		else
+			alwaysReadyConns.erase (conn);
+		if (regFds.empty ())
+			pollConnFds.erase (conn);
+	}
+	pollRanges.clear ();
+
+	// descriptors added by block (and its descendants) after connections are requested in every round
+	epollSync (NULL, pollBlockFds, blockStart, npolls);
+
+	if (epollEvents.size () == 0)
+		epollEvents.resize (EPOLL_EVENTS);
+
+	// epoll_wait does not accept timespec; round timeout up, so timers will not be triggered too soon
+	long long tout_ms = (long long) read_tout->tv_sec * 1000 + (read_tout->tv_nsec + 999999) / 1000000;
+	if (tout_ms > INT_MAX)
+		tout_ms = INT_MAX;
+
+	int ret = epoll_wait (epollfd, &(epollEvents[0]), epollEvents.size (), (int) tout_ms);
+	if (ret < 0)
+	{
+		if (errno != EINTR)
+			logStream (MESSAGE_ERROR) << "epoll_wait error: " << strerror (errno) << sendLog;
+		return ret;
+	}
+
+	for (int j = 0; j < ret; j++)
+	{
+		int fd = epollEvents[j].data.fd;
+		EPollReg &reg = epollRegs[fd];
+		// on Linux, EPOLL* have the same values as POLL* constants
+		reg.revents = epollEvents[j].events & (POLLIN | POLLPRI | POLLOUT | POLLERR | POLLHUP);
+		readyFds.push_back (fd);
+		if (reg.owner)
+			readyConns.insert (reg.owner);
+	}
+
+	readyConns.insert (alwaysReadyConns.begin (), alwaysReadyConns.end ());
+
+	// ready events were cut by the size of events buffer, enlarge it for the next call
+	if ((size_t) ret == epollEvents.size ())
+		epollEvents.resize (epollEvents.size () * 2);
+
+	return ret;
+}
+#endif
+
 bool Block::centralServerInState (rts2_status_t state)
 {
 	for (connections_t::iterator iter = centraldConns.begin (); iter != centraldConns.end (); iter++)
@@ -1001,6 +1368,19 @@ void Block::deleteTimers (int event_type)
 	}
 }
 
+void Block::deleteTimers (int event_type, void *arg)
+{
+	for (std::map <double, Event *>::iterator iter = timers.begin (); iter != timers.end (); )
+	{
+		if (iter->second->getType () == event_type && iter->second->getArg () == arg)
+		{
+			if (pushToDelete (iter))
+				delete (iter->second);
+		}
+		iter++;
+	}
+}
+
 void Block::valueMaskError (Value *val, int32_t err)
 {
   	if ((val->getFlags () & RTS2_VALUE_ERRORMASK) != err)
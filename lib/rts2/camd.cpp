@@ -21,8 +21,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <strings.h>
-#include <sys/ipc.h>
-#include <sys/shm.h>
+#include <sys/statvfs.h>
 #include <sys/time.h>
 #include <fcntl.h>
 #include <time.h>
@@ -51,6 +50,7 @@
 #define OPT_COMMENTS          OPT_LOCAL + 421
 #define OPT_HISTORIES         OPT_LOCAL + 422
 #define OPT_RTS2_COOLING      OPT_LOCAL + 423
+#define OPT_READOUT_THREADS   OPT_LOCAL + 424
 
 #define EVENT_TEMP_CHECK      RTS2_LOCAL_EVENT + 676
 
@@ -165,8 +165,7 @@ long Camera::isExposing ()
 
 int Camera::endExposure (int ret)
 {
-	if (modeCount)
-		memset (modeCount, 0, modeCountSize * sizeof (uint32_t));
+	pixelStat.resetMode ();
 	if (exposureConn)
 	{
 		logStream (MESSAGE_INFO) << "end exposure for " << exposureConn->getName () << sendLog;
@@ -226,6 +225,10 @@ int Camera::deleteConnection (rts2core::Connection * conn)
 
 int Camera::endReadout ()
 {
+	// finish processing of readout data before image is closed
+	if (readoutPipeline)
+		readoutPipeline->flush ();
+
 	// that will do anything only if the end was not marked
 	updateReadoutSpeed (readoutPixels);
 
@@ -353,11 +356,16 @@ int Camera::sendFirstLine (int chan, int pchan)
 
 	focusingHeader->channel = htons (pchan);
 
+	// statistics of the previous image must be finished before they are reset
+	if (readoutPipeline)
+		readoutPipeline->flush ();
+
 	sum->setValueDouble (0);
 	average->setValueDouble (0);
 	max->setValueDouble (-LONG_MAX);
 	min->setValueDouble (LONG_MAX);
 	computedPix->setValueLong (0);
+	pixelStat.resetStatistics ();
 
 	switch (currentImageTransfer)
 	{
@@ -429,6 +437,9 @@ Camera::Camera (int in_argc, char **in_argv, rounding_t binning_rounding):rts2co
 	dataBuffers = NULL;
 	dataWritten = NULL;
 
+	readoutThreads = 0;
+	readoutPipeline = NULL;
+
 	histories = 0;
 	comments = 0;
 
@@ -469,10 +480,6 @@ Camera::Camera (int in_argc, char **in_argv, rounding_t binning_rounding):rts2co
 	createValue (sum, "sum", "sum of pixels readed out", false);
 	createValue (image_mode, "image_mode", "mode (most often pixel value)", false);
 
-	// mode histogram
-	modeCount = NULL;
-	modeCountSize = 0;
-
 	createValue (computedPix, "computed", "number of pixels so far computed", false);
 
 	createValue (calculateCenter, "center_cal", "calculate center box statistics", false, RTS2_VALUE_WRITABLE | RTS2_DT_ONOFF);
@@ -569,6 +576,7 @@ Camera::Camera (int in_argc, char **in_argv, rounding_t binning_rounding):rts2co
 	addOption (OPT_RTS2_COOLING, "no-autocooling", 0, "when set, RTS2 did not switch cooling off at the end of night");
 	addOption (OPT_COMMENTS, "add-comments", 1, "add given number of comment fields");
 	addOption (OPT_HISTORIES, "add-history", 1, "add given number of history fields");
+	addOption (OPT_READOUT_THREADS, "readout-threads", 1, "number of threads processing readout data; 0 (default) processes data in the main thread");
 	addOption (OPT_FOCUS, "focdev", 1, "name of focuser device, which will be granted to do exposures without priority");
 	addOption (OPT_WHEEL, "wheeldev", 1, "name of device which is used as filter wheel; - for internal wheel device");
 	addOption (OPT_FILTER_OFFSETS, "filter-offsets", 1, "camera filter offsets, separated with :");
@@ -589,13 +597,12 @@ Camera::Camera (int in_argc, char **in_argv, rounding_t binning_rounding):rts2co
 
 Camera::~Camera ()
 {
+	delete readoutPipeline;
 	delete sharedData;
 	delete fhd;
 
 	delete[] dataBuffers;
 	delete[] dataWritten;
-	
-	delete[] modeCount;
 }
 
 int Camera::willConnect (rts2core::NetworkAddress * in_addr)
@@ -687,6 +694,10 @@ int Camera::killAll (bool callScriptEnds)
 	}
 
 
+	// drop data queued for processing
+	if (readoutPipeline)
+		readoutPipeline->flush (false);
+
 	if (exposureConn && currentImageData >= 0)
 	{
 		// end actual data connections
@@ -793,6 +804,14 @@ int Camera::processOption (int in_opt)
 		case OPT_COMMENTS:
 			comments = atoi (optarg);
 			break;
+		case OPT_READOUT_THREADS:
+			readoutThreads = atoi (optarg);
+			if (readoutThreads < 0)
+			{
+				std::cerr << "invalid number of readout threads: " << optarg << std::endl;
+				return -1;
+			}
+			break;
 		case OPT_RTS2_COOLING:
 			if (rts2ControlCooling != NULL)
 				rts2ControlCooling->setValueBool (false);
@@ -971,56 +990,93 @@ int Camera::sendImage (char *data, size_t dataSize)
 int Camera::sendReadoutData (char *data, size_t dataSize, int chan)
 {
 	std::cerr << "Camera::sendReadoutData " << dataSize << " chan " << chan << " exposureConn " << exposureConn << std::endl;
-	// calculated..
-	if (calculateStatistics->getValueInteger () != STATISTIC_NO)
+	bool calcStat = calculateStatistics->getValueInteger () != STATISTIC_NO;
+	bool calcCenter = calculateCenter->getValueBool ();
+	bool calcMode = calcStat && calculateStatistics->getValueInteger () != STATISTIC_NOMODE;
+
+	if (calculateStatistics->getValueInteger () == STATISTIC_ONLY)
+		calculateDataSize -= dataSize;
+
+	if (currentImageTransfer == SHARED)
+		sharedData->dataWritten (chan, dataSize);
+	
+	dataWritten[chan] += dataSize;
+
+	if (readoutPipeline)
 	{
-		int totPix;
-		// update sum. min and max
-		switch (getDataType ())
-		{
-			case RTS2_DATA_BYTE:
-				totPix = updateStatistics ((uint8_t *) data, dataSize);
-				break;
-			case RTS2_DATA_SHORT:
-				totPix = updateStatistics ((int16_t *) data, dataSize);
-				break;
-			case RTS2_DATA_LONG:
-				totPix = updateStatistics ((int32_t *) data, dataSize);
-				break;
-			case RTS2_DATA_LONGLONG:
-				totPix = updateStatistics ((int64_t *) data, dataSize);
-				break;
-			case RTS2_DATA_FLOAT:
-				totPix = updateStatistics ((float *) data, dataSize);
-				break;
-			case RTS2_DATA_DOUBLE:
-				totPix = updateStatistics ((double *) data, dataSize);
-				break;
-			case RTS2_DATA_SBYTE:
-				totPix = updateStatistics ((int8_t *) data, dataSize);
-				break;
-			case RTS2_DATA_USHORT:
-				totPix = updateStatistics ((uint16_t *) data, dataSize);
-				break;
-			case RTS2_DATA_ULONG:
-				totPix = updateStatistics ((uint32_t *) data, dataSize);
-				break;
-		}
+		// statistics are calculated by pipeline worker, values and data are send in readoutJobDone
+		ReadoutJob *job = readoutPipeline->getJob (data, dataSize, chan);
+		job->dataType = getDataType ();
+		job->calcStat = calcStat;
+		job->calcMode = calcMode;
+		job->calcCenter = calcCenter;
+		job->sendData = exposureConn && currentImageTransfer == TCPIP;
+		prepareCenterBox (job->stat, calcCenter);
+		return readoutPipeline->queue (job);
+	}
+
+	size_t totPix = 0;
+
+	if (calcStat || calcCenter)
+	{
+		prepareCenterBox (pixelStat, calcCenter);
+		// update sum, min, max, mode and center box in single pass
+		totPix = pixelStat.update (getDataType (), data, dataSize, calcMode);
+	}
+
+	sendStatistics (calcStat, totPix, dataSize);
+
+	if (calcCenter && pixelStat.isCenterCalculated ())
+		sendCenter (pixelStat);
+
+	if (exposureConn && currentImageTransfer == TCPIP)
+		return exposureConn->sendBinaryData (currentImageData, chan, data, dataSize);
+	return 0;
+}
+
+int Camera::readoutJobDone (ReadoutJob *job)
+{
+	size_t totPix = 0;
+	if (job->calcStat || job->calcCenter)
+	{
+		pixelStat.merge (job->stat);
+		totPix = job->stat.getPixels ();
+	}
+
+	sendStatistics (job->calcStat, totPix, job->dataSize);
+
+	if (job->calcCenter && job->stat.isCenterCalculated ())
+		sendCenter (job->stat);
+
+	if (job->sendData && exposureConn && currentImageTransfer == TCPIP)
+		return exposureConn->sendBinaryData (currentImageData, job->chan, job->data, job->dataSize);
+	return 0;
+}
+
+void Camera::prepareCenterBox (PixelStatistics &stat, bool calcCenter)
+{
+	int x, y, w, h;
+	if (calcCenter && getCenterBox (x, y, w, h))
+		stat.setCenterBox (x, y, w, h, getUsedWidthBinned (), centerCutLevel->getValueDouble ());
+	else
+		stat.setCenterBox (0, 0, 0, 0, 0, 0);
+}
+
+void Camera::sendStatistics (bool calcStat, size_t totPix, size_t dataSize)
+{
+	if (calcStat)
+	{
+		sum->setValueDouble (pixelStat.getSum ());
+		if (pixelStat.getMin () < min->getValueDouble ())
+			min->setValueDouble (pixelStat.getMin ());
+		if (pixelStat.getMax () > max->getValueDouble ())
+			max->setValueDouble (pixelStat.getMax ());
 		computedPix->setValueLong (computedPix->getValueLong () + totPix);
 		average->setValueDouble (sum->getValueDouble () / computedPix->getValueLong ());
 
-		// find maximal mode value
-		if (modeCount != NULL)
+		if (pixelStat.haveMode ())
 		{
-			uint32_t modeNum = 0;
-			for (unsigned int i = 0; i < modeCountSize; i++)
-			{
-				if (modeCount[i] > modeNum)
-				{
-					image_mode->setValueInteger (i);
-					modeNum = modeCount[i];
-				}
-			}
+			image_mode->setValueInteger (pixelStat.getMode ());
 			sendValueAll (image_mode);
 		}
 
@@ -1038,52 +1094,66 @@ int Camera::sendReadoutData (char *data, size_t dataSize, int chan)
 
 	// will update only if some data still need to be transfered
 	updateReadoutSpeed (computedPix->getValueLong ());
+}
 
-	if (calculateStatistics->getValueInteger () == STATISTIC_ONLY)
-		calculateDataSize -= dataSize;
+bool Camera::getCenterBox (int &x, int &y, int &w, int &h)
+{
+	// check if box is inside window
+	x = centerBox->getXInt ();
+	if (x < 0)
+		x = getUsedX ();
+	y = centerBox->getYInt ();
+	if (y < 0)
+		y = getUsedY ();
+	w = centerBox->getWidthInt () / binningHorizontal ();
+	if (w < 0)
+		w = (getUsedWidth () - (x - getUsedX ())) / binningHorizontal ();
+	h = centerBox->getHeightInt () / binningVertical ();
+	if (h < 0)
+		h = (getUsedHeight () - (y - getUsedY ())) / binningVertical ();
 
-	if (calculateCenter->getValueBool ())
-	{
-		switch (getDataType ())
-		{
-			case RTS2_DATA_BYTE:
-				updateCenter ((uint8_t *) data, dataSize);
-				break;
-			case RTS2_DATA_SHORT:
-				updateCenter ((int16_t *) data, dataSize);
-				break;
-			case RTS2_DATA_LONG:
-				updateCenter ((int32_t *) data, dataSize);
-				break;
-			case RTS2_DATA_LONGLONG:
-				updateCenter ((int64_t *) data, dataSize);
-				break;
-			case RTS2_DATA_FLOAT:
-				updateCenter ((float *) data, dataSize);
-				break;
-			case RTS2_DATA_DOUBLE:
-				updateCenter ((double *) data, dataSize);
-				break;
-			case RTS2_DATA_SBYTE:
-				updateCenter ((int8_t *) data, dataSize);
-				break;
-			case RTS2_DATA_USHORT:
-				updateCenter ((uint16_t *) data, dataSize);
-				break;
-			case RTS2_DATA_ULONG:
-				updateCenter ((uint32_t *) data, dataSize);
-				break;
-		}
-	}
+	x -= getUsedX ();
+	y -= getUsedY ();
 
-	if (currentImageTransfer == SHARED)
-		sharedData->dataWritten (chan, dataSize);
-	
-	dataWritten[chan] += dataSize;
+	if (x < 0 || y < 0 || (w + ceil ((double) x / binningHorizontal ())) > getUsedWidthBinned () || (h + ceil ((double) y / binningVertical ())) > getUsedHeightBinned ())
+		return false;
+	return true;
+}
 
-	if (exposureConn && currentImageTransfer == TCPIP)
-		return exposureConn->sendBinaryData (currentImageData, chan, data, dataSize);
-	return 0;
+void Camera::sendCenter (PixelStatistics &stat)
+{
+	sumsX->clear ();
+	for (std::vector <double>::const_iterator iter = stat.getCenterSumsX ().begin (); iter != stat.getCenterSumsX ().end (); iter++)
+		sumsX->addValue (*iter);
+
+	sumsY->clear ();
+	for (std::vector <double>::const_iterator iter = stat.getCenterSumsY ().begin (); iter != stat.getCenterSumsY ().end (); iter++)
+		sumsY->addValue (*iter);
+
+	sendValueAll (sumsX);
+	sendValueAll (sumsY);
+
+	centerX->setValueDouble (sumsX->calculateMedianIndex ());
+	centerY->setValueDouble (sumsY->calculateMedianIndex ());
+
+	centerMax->setValueDouble (stat.getCenterMax ());
+
+	centerStat->addValue (stat.getCenterMax (), centerSums->getValueInteger ());
+
+	centerAvg->setValueDouble (stat.getCenterAverage ());
+	centerAvgStat->addValue (stat.getCenterAverage (), centerSums->getValueInteger ());
+
+	sendValueAll (centerX);
+	sendValueAll (centerY);
+
+	sendValueAll (centerMax);
+
+	centerStat->calculate ();
+	sendValueAll (centerStat);
+
+	sendValueAll (centerAvg);
+	centerAvgStat->calculate ();
+	sendValueAll (centerAvgStat);
 }
 
 void Camera::addBinning2D (int bin_v, int bin_h)
@@ -1207,38 +1277,28 @@ int Camera::initValues ()
 		if (sharedMemNum == 0)
 		{
 #ifdef __linux__
-			// read limit
-			std::ifstream ifs ("/proc/sys/kernel/shmmax");
-			long long shmax;
-			ifs >> shmax;
-			ifs.close ();
-			if (ifs.fail ())
+			// POSIX shared memory lives in /dev/shm, use up to half of its free space,
+			// but not more than SHARED_AUTO_SEGMENTS segments
+			struct statvfs svfs;
+			if (statvfs ("/dev/shm", &svfs))
 			{
-				logStream (MESSAGE_ERROR) << "cannot read maximal shared memory size from /proc/sys/kernel/shmmax" << sendLog;
+				logStream (MESSAGE_ERROR) << "cannot get free space of /dev/shm: " << strerror (errno) << sendLog;
 				sharedMemNum = 10;
 			}
 			else
 			{
-				double d = sizeof (struct rts2core::SharedDataHeader);
-				d *= d;
-				size_t a = sizeof (struct rts2core::SharedDataSegment) + dataBufferSize;
-				d += 4 * a * shmax;
-				d = (sqrt (d) - sizeof (struct rts2core::SharedDataHeader)) / (2 * a);
-				if (d > 1000)
+				double avail = (double) svfs.f_bavail * svfs.f_frsize / 2.0;
+				double d = avail / (rts2core::DataSharedWrite::getSharedSize (1, dataBufferSize));
+				if (d > SHARED_AUTO_SEGMENTS)
 				{
-					sharedMemNum = 1000;
-				}
-				else if (d < 0)
-				{
-					logStream (MESSAGE_ERROR) << "invalid root of quadratic equation for maximal shared memory size " << d << sendLog;
-					return -1;
+					sharedMemNum = SHARED_AUTO_SEGMENTS;
 				}
 				else
 				{
 					sharedMemNum = d;
 					if (sharedMemNum == 0)
 					{
-						logStream (MESSAGE_ERROR) << "shared memory maximal size is insuficient for a single image. Please increase the memory limit - see man shmget for details" << sendLog;
+						logStream (MESSAGE_ERROR) << "free space in /dev/shm is insuficient for a single image. Please increase size of /dev/shm" << sendLog;
 						return -1;
 					}
 				}
@@ -1269,6 +1329,15 @@ int Camera::initValues ()
 	dataWritten = new size_t[getNumChannels ()];
 	memset (dataWritten, 0, getNumChannels () * sizeof (size_t));
 
+	if (readoutThreads > 0)
+	{
+		readoutPipeline = new ReadoutPipeline (this, readoutThreads);
+		ConnReadoutNotify *notifyConn = readoutPipeline->start ();
+		if (notifyConn == NULL)
+			return -1;
+		addConnection (notifyConn);
+	}
+
 	return rts2core::ScriptDevice::initValues ();
 }
 
@@ -134,6 +134,14 @@ CommandSendKey::CommandSendKey (Block * _master, int _centrald_id, int _centrald
 	key = _key;
 }
 
+int CommandSendKey::commandReturnOK (Connection * conn)
+{
+	connection->setConnState (CONN_AUTH_OK);
+	if (owner->binaryValuesEnabled ())
+		connection->queCommand (new CommandBinaryValues (owner));
+	return -1;
+}
+
 int CommandSendKey::send ()
 {
 	std::ostringstream _os;
@@ -663,6 +671,13 @@ CommandMessageMask::CommandMessageMask (Block * _master, int _mask):Command (_ma
 	setCommand (_os);
 }
 
+CommandBinaryValues::CommandBinaryValues (Block * _master):Command (_master)
+{
+	std::ostringstream _os;
+	_os << COMMAND_BINARY_VALUES " " << Connection::binaryValuesTag ();
+	setCommand (_os);
+}
+
 CommandInfo::CommandInfo (Block * _master):Command (_master)
 {
 	setCommand (COMMAND_INFO);
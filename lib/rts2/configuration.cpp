@@ -21,6 +21,7 @@
 #include <string.h>
 
 #include "configuration.h"
+#include "ephemcache.h"
 
 using namespace rts2core;
 
@@ -63,6 +64,8 @@ int Configuration::getSpecialValues ()
 
 	targetConstraintsWithName = getBoolean ("observatory", "target_constraints_with_name", targetConstraintsWithName);
 
+	setEphemerisCache (getBoolean ("observatory", "ephemeris_cache", ephemerisCache));
+
 	getString ("observatory", "nightlogs", nightDir, RTS2_CONFDIR "/rts2/nights/%N.fits");
 
 	minFlatHeigh = getDoubleDefault ("observatory", "min_flat_heigh", 10);
@@ -98,6 +101,7 @@ Configuration::Configuration (bool defaultSection):IniParser (defaultSection)
 	// default to 120 seconds
 	astrometryTimeout = 120;
 	targetConstraintsWithName = false;
+	ephemerisCache = true;
 	showMilliseconds = true;
 	azShow = AZ_SOUTH_ZERO;
 }
@@ -107,6 +111,16 @@ Configuration::~Configuration (void)
 	delete checker;
 }
 
+void Configuration::setEphemerisCache (bool cache)
+{
+	ephemerisCache = cache;
+	if (this == pInstance)
+	{
+		SolarEphemeris::instance ()->setEnabled (cache);
+		LunarEphemeris::instance ()->setEnabled (cache);
+	}
+}
+
 Configuration * Configuration::instance ()
 {
 	if (!pInstance)
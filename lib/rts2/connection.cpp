@@ -95,6 +95,11 @@ Connection::Connection (Block * in_master):Object ()
 	activeReadData = -1;
 	dataConn = 0;
 
+	txOffset = 0;
+	txQueueLimit = RTS2_TX_QUEUE_LIMIT;
+	txCorked = false;
+	binaryValues = false;
+
 	sharedReadMemory = NULL;
 }
 
@@ -137,13 +142,24 @@ Connection::Connection (int in_sock, Block * in_master):Object ()
 	activeReadData = -1;
 	dataConn = 0;
 
+	txOffset = 0;
+	txQueueLimit = RTS2_TX_QUEUE_LIMIT;
+	txCorked = false;
+	binaryValues = false;
+
 	sharedReadMemory = NULL;
 }
 
 Connection::~Connection (void)
 {
 	if (sock >= 0)
+	{
+		if (master)
+			master->removePollFD (sock);
 		close (sock);
+	}
+	if (master)
+		master->removePollConnection (this);
 	delete serverState;
 	delete bopState;
 	queClear ();
@@ -152,12 +168,18 @@ Connection::~Connection (void)
 	delete otherDevice;
 }
 
+void Connection::pollChanged ()
+{
+	if (master)
+		master->pollChanged (this);
+}
+
 int Connection::add (Block *block)
 {
 	if (sock >= 0)
 	{
 		short events = POLLIN | POLLPRI;
-		if (isConnState (CONN_INPROGRESS))
+		if (isConnState (CONN_INPROGRESS) || getTxQueueSize () > 0)
 			events |= POLLOUT;
 		block->addPollFD (sock, events);
 	}
@@ -609,6 +631,8 @@ int Connection::acceptConn ()
 	}
 	else
 	{
+		if (master)
+			master->removePollFD (sock);
 		close (sock);
 		sock = new_sock;
 		#ifdef DEBUG_EXTRA
@@ -761,6 +785,10 @@ void Connection::processLine ()
 			ret = -1;
 		}
 	}
+	else if (isCommand (PROTO_VALUE_INDEX))
+	{
+		ret = valueIndex ();
+	}
 	else if (isCommand (PROTO_SELMETAINFO))
 	{
 		char *m_name;
@@ -968,11 +996,43 @@ void Connection::processBuffer ()
 	full_data_end = buf_top;
 	buf_top = buf;
 	command_start = buf;
-	while (*buf_top)
+	while (buf_top < full_data_end)
 	{
 		while (isspace (*buf_top) || (*buf_top && *buf_top == '\n'))
 			buf_top++;
 		command_start = buf_top;
+		// binary value record - marker, record size, record
+		if (*buf_top == PROTO_BINARY_VALUE)
+		{
+			uint32_t rec_size;
+			if (full_data_end - buf_top < (long) (1 + sizeof (rec_size)))
+			{
+				buf_top = full_data_end;
+				break;
+			}
+			memcpy (&rec_size, buf_top + 1, sizeof (rec_size));
+			// corrupted header would grow the buffer without limit
+			if (rec_size > RTS2_BINARY_VALUE_LIMIT)
+			{
+				logStream (MESSAGE_ERROR) << "binary value record of " << rec_size << " bytes from " << getName () << " exceeds limit, closing connection" << sendLog;
+				connectionError (-1);
+				buf_top = full_data_end;
+				command_start = full_data_end;
+				break;
+			}
+			if ((size_t) (full_data_end - buf_top) < 1 + sizeof (rec_size) + rec_size)
+			{
+				// wait for rest of the record
+				buf_top = full_data_end;
+				break;
+			}
+			binaryValue (buf_top + 1 + sizeof (rec_size), rec_size);
+			buf_top += 1 + sizeof (rec_size) + rec_size;
+			command_start = buf_top;
+			continue;
+		}
+		if (*buf_top == '\0')
+			break;
 		// find command end..
 		while (*buf_top && *buf_top != '\n' && *buf_top != '\r')
 			buf_top++;
@@ -1102,6 +1162,10 @@ int Connection::writable (Block *block)
 			connConnected ();
 		}
 	}
+	else if (sock >= 0 && getTxQueueSize () > 0 && (block->getPollEvents (sock) & POLLOUT))
+	{
+		return flushTx ();
+	}
 	return 0;
 }
 
@@ -1497,7 +1561,6 @@ int Connection::commandReturn ()
 
 int Connection::sendMsg (const char *msg)
 {
-	int len;
 	int ret;
 	if (sock == -1)
 	{
@@ -1506,23 +1569,20 @@ int Connection::sendMsg (const char *msg)
 		#endif
 		return -1;
 	}
-	len = strlen (msg) + 1;
-	char *mbuf = new char[len + 1];
-	strcpy (mbuf, msg);
 	#ifdef DEBUG_ALL
 	std::cout << "Connection::sendMsg will send " << msg << std::endl;
 	#endif
-	strcat (mbuf, "\n");
-	// ignore EINTR
-	do
-	{
-		ret = write (sock, mbuf, len);
-	} while (ret == -1 && errno == EINTR);
+	struct iovec iov[2];
+	iov[0].iov_base = (void *) msg;
+	iov[0].iov_len = strlen (msg);
+	iov[1].iov_base = (void *) "\n";
+	iov[1].iov_len = 1;
 
-	if (ret != len)
+	ret = writeTx (iov, 2);
+	if (ret)
 	{
 		syslog (LOG_ERR, "Cannot send msg: %s to sock %i with len %i, ret %i errno %i message %m",
-			msg, sock, len, ret, errno);
+			msg, sock, (int) iov[0].iov_len + 1, ret, errno);
 		#ifdef DEBUG_EXTRA
 		logStream (MESSAGE_ERROR)
 			<< "Connection::sendMsg [" << getCentraldId () << ":" << conn_state << "] error "
@@ -1530,16 +1590,14 @@ int Connection::sendMsg (const char *msg)
 			<< sendLog;
 		#endif
 		connectionError (ret);
-		delete[] mbuf;
 		return -1;
 	}
 	#ifdef DEBUG_ALL
 	std::cout << "Connection::sendMsg " << getName ()
-		<< " [" << getCentraldId () << ":" << sock << "] send " << ret << ": " << msg
+		<< " [" << getCentraldId () << ":" << sock << "] send " << ": " << msg
 		<< std::endl;
 	#endif
 
-	delete[] mbuf;
 	successfullSend ();
 	return 0;
 }
@@ -1571,60 +1629,204 @@ int Connection::startBinaryData (int dataType, int channum, size_t *chansize)
 
 int Connection::sendBinaryData (int data_conn, int chan, char *data, size_t dataSize)
 {
-	char *binaryWriteTop, *binaryWriteBuff;
-	binaryWriteTop = binaryWriteBuff = data;
-	char *binaryEnd = data + dataSize;
+	if (dataSize > getWriteBinaryDataSize (data_conn))
+	{
+		logStream (MESSAGE_ERROR) << "Attemp to send too much data on channel " << chan << " - "
+			<< dataSize << " bytes, but there are only " << getWriteBinaryDataSize (data_conn) << " bytes remain to be send" << sendLog;
+		dataSize = getWriteBinaryDataSize (data_conn);
+	}
+
+	// data connection was dropped, as receiver cannot keep up
+	if (droppedData.find (data_conn) != droppedData.end ())
+	{
+		binaryDataWritten (data_conn, chan, dataSize);
+		return 0;
+	}
+
+	if (txQueueLimit > 0 && getTxQueueSize () + dataSize > txQueueLimit)
+	{
+		logStream (MESSAGE_WARNING) << "receiver " << getName () << " is too slow, " << getTxQueueSize () << " bytes are waiting to be send; dropping binary data " << data_conn << sendLog;
+		droppedData.insert (data_conn);
+		std::ostringstream _os;
+		_os << PROTO_BINARY_KILLED " " << data_conn;
+		binaryDataWritten (data_conn, chan, dataSize);
+		return sendMsg (_os);
+	}
+
+	char header[100];
+	struct iovec iov[2];
+	iov[0].iov_base = header;
+	iov[0].iov_len = snprintf (header, sizeof (header), PROTO_DATA " %d %d %lu\n", data_conn, chan, (unsigned long) dataSize);
+	iov[1].iov_base = data;
+	iov[1].iov_len = dataSize;
 
+	int ret = writeTx (iov, 2);
+	if (ret)
+	{
+		connectionError (ret);
+		return -1;
+	}
+	successfullSend ();
+	binaryDataWritten (data_conn, chan, dataSize);
+	return 0;
+}
+
+void Connection::endBinaryData (int data_conn)
+{
 	std::ostringstream _os;
-	_os << PROTO_DATA " " << data_conn << " " << chan << " " << dataSize;
-	int ret;
-	ret = sendMsg (_os);
+	_os << PROTO_BINARY_KILLED " " << data_conn;
+	delete writeChannels[data_conn];
+	writeChannels.erase (data_conn);
+	// receiver was already notified when data were dropped
+	if (droppedData.erase (data_conn) > 0)
+		return;
+	sendMsg (_os);
+}
+
+void Connection::binaryDataWritten (int data_conn, int chan, size_t dataSize)
+{
+	std::map <int, DataAbstractWrite *>::iterator iter = writeChannels.find (data_conn);
+	if (iter == writeChannels.end ())
+		return;
+	((*iter).second)->dataWritten (chan, dataSize);
+	if (((*iter).second)->getDataSize () <= 0)
+	{
+		delete ((*iter).second);
+		writeChannels.erase (iter);
+		droppedData.erase (data_conn);
+	}
+}
+
+int Connection::uncorkTx ()
+{
+	txCorked = false;
+	if (txCork.empty ())
+		return 0;
+	// writeTx flushes pending values, which can cork the connection again
+	std::string data;
+	data.swap (txCork);
+	struct iovec iov;
+	iov.iov_base = (void *) data.data ();
+	iov.iov_len = data.size ();
+	int ret = writeTx (&iov, 1);
+	// keep allocated buffer
+	if (txCork.empty ())
+	{
+		data.clear ();
+		txCork.swap (data);
+	}
 	if (ret)
-		return ret;
+	{
+		connectionError (ret);
+		return -1;
+	}
+	return 0;
+}
 
-	while (binaryWriteTop < binaryEnd)
+int Connection::writeTx (struct iovec *iov, int iovcnt)
+{
+	ssize_t ret = 0;
+	if (txCorked)
 	{
-		if (dataSize > getWriteBinaryDataSize (data_conn))
+		for (int i = 0; i < iovcnt; i++)
+			txCork.append ((char *) iov[i].iov_base, iov[i].iov_len);
+		return 0;
+	}
+	// values waiting for send must be written before any other data
+	if (master)
+		master->flushPendingValues ();
+	// keep order of data already waiting in the queue
+	if (getTxQueueSize () == 0)
+	{
+		struct msghdr msg;
+		memset (&msg, 0, sizeof (msg));
+		msg.msg_iov = iov;
+		msg.msg_iovlen = iovcnt;
+		do
 		{
-			logStream (MESSAGE_ERROR) << "Attemp to send too much data on channel " << chan << " - "
-				<< dataSize << " bytes, but there are only " << getWriteBinaryDataSize (data_conn) << " bytes remain to be send" << sendLog;
-			dataSize = getWriteBinaryDataSize (data_conn);
-		}
-		ret = send (sock, binaryWriteTop, dataSize, 0);
+			ret = sendmsg (sock, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+		} while (ret == -1 && errno == EINTR);
+
 		if (ret == -1)
 		{
-			if (errno != EINTR)
-			{
-				connectionError (ret);
-				return -1;
-			}
-		}
-		else
-		{
-			binaryWriteTop += ret;
-			dataSize -= ret;
-			std::map <int, DataAbstractWrite *>::iterator iter = writeChannels.find (data_conn);
-			if (iter != writeChannels.end ())
+			if (errno == ENOTSOCK)
 			{
-				((*iter).second)->dataWritten (chan, ret);
-				if (((*iter).second)->getDataSize () <= 0)
+				// pipes and other descriptors - write everything in blocking mode
+				for (int i = 0; i < iovcnt; i++)
 				{
-					delete ((*iter).second);
-					writeChannels.erase (iter);
+					char *top = (char *) iov[i].iov_base;
+					char *end = top + iov[i].iov_len;
+					while (top < end)
+					{
+						ret = write (sock, top, end - top);
+						if (ret == -1)
+						{
+							if (errno == EINTR)
+								continue;
+							return -1;
+						}
+						top += ret;
+					}
 				}
+				return 0;
 			}
+			if (errno != EAGAIN && errno != EWOULDBLOCK)
+				return -1;
+			ret = 0;
 		}
 	}
+
+	// queue data which were not written, they will be send when socket becomes writable
+	size_t queued = getTxQueueSize ();
+	for (int i = 0; i < iovcnt; i++)
+	{
+		if ((size_t) ret >= iov[i].iov_len)
+		{
+			ret -= iov[i].iov_len;
+			continue;
+		}
+		txBuf.append (((char *) iov[i].iov_base) + ret, iov[i].iov_len - ret);
+		ret = 0;
+	}
+	// socket must be polled for write
+	if (queued == 0 && getTxQueueSize () > 0)
+		pollChanged ();
 	return 0;
 }
 
-void Connection::endBinaryData (int data_conn)
+int Connection::flushTx ()
 {
-	std::ostringstream _os;
-	_os << PROTO_BINARY_KILLED " " << data_conn;
-	delete writeChannels[data_conn];
-	writeChannels.erase (data_conn);
-	sendMsg (_os);
+	while (getTxQueueSize () > 0)
+	{
+		ssize_t ret = send (sock, txBuf.data () + txOffset, getTxQueueSize (), MSG_DONTWAIT | MSG_NOSIGNAL);
+		if (ret == -1)
+		{
+			if (errno == EINTR)
+				continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				break;
+			connectionError (-1);
+			return -1;
+		}
+		txOffset += ret;
+		successfullSend ();
+	}
+
+	if (getTxQueueSize () == 0)
+	{
+		// release memory used by large queues
+		if (txBuf.capacity () > RTS2_TX_KEEP)
+			std::string ().swap (txBuf);
+		else
+			txBuf.clear ();
+		txOffset = 0;
+	}
+	else if (txOffset > txBuf.size () / 2)
+	{
+		txBuf.erase (0, txOffset);
+		txOffset = 0;
+	}
+	return 0;
 }
 
 int Connection::startSharedData (DataSharedWrite *data, int channum, int *segnums)
@@ -1704,7 +1906,11 @@ void Connection::connectionError (int last_data_size)
 	else
 		setConnState (CONN_BROKEN);
 	if (sock >= 0)
+	{
+		if (master)
+			master->removePollFD (sock);
 		close (sock);
+	}
 	sock = -1;
 	if (strlen (getName ()) && master)
 		master->deleteAddress (getCentraldNum (), getName ());
@@ -1782,6 +1988,109 @@ int Connection::sendValue (char *val_name, int val1, int val2, double val3, doub
 	return sendMsg (_os);
 }
 
+int Connection::sendBinaryValue (Value *val)
+{
+	if (!binaryValues || sock == -1 || getConnState () == CONN_INPROGRESS)
+		return 1;
+	// values with extended type have different text representation
+	if (val->getValueExtType () != 0 && val->getValueExtType () != RTS2_VALUE_ARRAY)
+		return 1;
+
+	uint32_t rec_size;
+	uint32_t idx;
+	// space for header - marker, record size and value index
+	txValueBuf.assign (1 + sizeof (rec_size) + sizeof (idx), '\0');
+	if (!val->getBinaryValue (txValueBuf) || txValueBuf.size () - 1 - sizeof (rec_size) > RTS2_BINARY_VALUE_LIMIT)
+		return 1;
+
+	std::string v_name = val->getName ();
+	std::map <std::string, uint32_t>::iterator iter = txValueIndex.find (v_name);
+	if (iter == txValueIndex.end ())
+	{
+		idx = txValueIndex.size ();
+		std::ostringstream _os;
+		_os << PROTO_VALUE_INDEX " " << idx << " " << v_name;
+		if (sendMsg (_os))
+			return -1;
+		txValueIndex[v_name] = idx;
+	}
+	else
+	{
+		idx = iter->second;
+	}
+
+	rec_size = txValueBuf.size () - 1 - sizeof (rec_size);
+	txValueBuf[0] = PROTO_BINARY_VALUE;
+	memcpy (&txValueBuf[1], &rec_size, sizeof (rec_size));
+	memcpy (&txValueBuf[1 + sizeof (rec_size)], &idx, sizeof (idx));
+
+	struct iovec iov;
+	iov.iov_base = (void *) txValueBuf.data ();
+	iov.iov_len = txValueBuf.size ();
+	if (writeTx (&iov, 1))
+	{
+		connectionError (-1);
+		return -1;
+	}
+	successfullSend ();
+	return 0;
+}
+
+void Connection::setBinaryValues (bool _binaryValues)
+{
+	binaryValues = _binaryValues;
+	txValueIndex.clear ();
+}
+
+int Connection::binaryValuesTag ()
+{
+	// record format version and first byte of 0x01020304 in host byte order
+	uint32_t order = 0x01020304;
+	return 100 + ((unsigned char *) &order)[0];
+}
+
+int Connection::valueIndex ()
+{
+	int idx;
+	char *v_name;
+	if (paramNextInteger (&idx) || paramNextString (&v_name) || !paramEnd () || idx < 0)
+		return -2;
+	if ((size_t) idx >= rxValueIndex.size ())
+		rxValueIndex.resize (idx + 1);
+	rxValueIndex[idx] = std::string (v_name);
+	return -1;
+}
+
+void Connection::binaryValue (const char *rec, size_t size)
+{
+	uint32_t idx;
+	if (size < sizeof (idx))
+	{
+		logStream (MESSAGE_ERROR) << "too short binary value record from " << getName () << sendLog;
+		return;
+	}
+	memcpy (&idx, rec, sizeof (idx));
+	if (idx >= rxValueIndex.size ())
+	{
+		logStream (MESSAGE_ERROR) << "unknow binary value index " << idx << " from " << getName () << sendLog;
+		return;
+	}
+	// values are found by name, so index survives value redefinition by metainfo
+	Value *value = getValue (rxValueIndex[idx].c_str ());
+	if (value == NULL)
+	{
+		logStream (MESSAGE_ERROR) << "unknow value from connection '" << getName () << "' " << rxValueIndex[idx] << sendLog;
+		return;
+	}
+	if (value->setBinaryValue (rec + sizeof (idx), size - sizeof (idx)))
+	{
+		logStream (MESSAGE_ERROR) << "invalid binary record for value " << rxValueIndex[idx] << " from " << getName () << sendLog;
+		return;
+	}
+	if (getOtherDevClient ())
+		getOtherDevClient ()->valueChanged (value);
+}
+
 int Connection::sendValueTime (std::string val_name, time_t * value)
 {
 	std::ostringstream _os;
@@ -1827,6 +2136,7 @@ void Connection::setConnState (conn_state_t new_conn_state)
 		// state change finished..
 	}
 	conn_state = new_conn_state;
+	pollChanged ();
 	if (new_conn_state == CONN_AUTH_FAILED)
 	{
 		connectionError (-1);
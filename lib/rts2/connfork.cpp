@@ -52,9 +52,17 @@ ConnFork::~ConnFork ()
 	if (childPid > 0)
 		kill (-childPid, SIGINT);
 	if (sockerr > 0)
+	{
+		if (getMaster ())
+			getMaster ()->removePollFD (sockerr);
 		close (sockerr);
+	}
 	if (sockwrite > 0)
+	{
+		if (getMaster ())
+			getMaster ()->removePollFD (sockwrite);
 		close (sockwrite);
+	}
 	delete[]exePath;
 }
 
@@ -133,6 +141,7 @@ int ConnFork::receive (Block *block)
 			}
 			else if (data_size == 0)
 			{
+				block->removePollFD (sockerr);
 				close (sockerr);
 				sockerr = -1;
 				connectionError (0);
@@ -166,6 +175,7 @@ int ConnFork::writable (Block *block)
 				if (errno == EINTR)
 				{
 					logStream (MESSAGE_ERROR) << "rts2core::ConnFork while writing to sockwrite: " << strerror (errno) << sendLog;
+					block->removePollFD (sockwrite);
 					close (sockwrite);
 					sockwrite = -1;
 					return -1;
@@ -176,6 +186,7 @@ int ConnFork::writable (Block *block)
 			input = input.substr (write_size);
 			if (input.length () == 0)
 			{
+				block->removePollFD (sockwrite);
 				write_size = close (sockwrite);
 				if (write_size < 0)
 					logStream (MESSAGE_ERROR) << "rts2core::ConnFork error while closing write descriptor: " << strerror (errno) << sendLog;
@@ -338,6 +349,7 @@ int ConnFork::init ()
 		fcntl (sock, F_SETFL, O_NONBLOCK);
 		fcntl (sockerr, F_SETFL, O_NONBLOCK);
 
+		pollChanged ();
 		return 0;
 	}
 	// child
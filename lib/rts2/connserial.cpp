@@ -23,10 +23,21 @@
 #include "connection/serial.h"
 
 #include "block.h"
+#include "utilsfunc.h"
 #include <iomanip>
 
 using namespace rts2core;
 
+SerialCommand::SerialCommand (const char *_cmd, int _cmdLen, const char *_endChar, int _replyLen, double _timeout):cmd (_cmd, _cmdLen)
+{
+	if (_endChar)
+		endChar = std::string (_endChar);
+	replyLen = _replyLen;
+	timeout = _timeout;
+	deadline = NAN;
+	txEnd = 0;
+}
+
 int ConnSerial::setAttr ()
 {
 	if (tcsetattr (sock, TCSANOW, &s_termios) < 0)
@@ -66,6 +77,25 @@ ConnSerial::ConnSerial (const char *_devName, rts2core::Block * _master, bSpeedT
 
 	debugComm = false;
 	logTrafficAsHex = false;
+
+	async = false;
+	maxInFlight = 1;
+	txPos = 0;
+	failing = false;
+}
+
+ConnSerial::~ConnSerial ()
+{
+	if (async)
+	{
+		master->deleteTimers (EVENT_SERIAL_TIMEOUT, this);
+		master->deleteTimers (EVENT_SERIAL_START, this);
+		master->removeConnection (this);
+	}
+	for (std::deque <SerialCommand *>::iterator iter = inFlight.begin (); iter != inFlight.end (); iter++)
+		delete *iter;
+	for (std::deque <SerialCommand *>::iterator iter = serialQueue.begin (); iter != serialQueue.end (); iter++)
+		delete *iter;
 }
 
 const char * ConnSerial::getBaudSpeed ()
@@ -553,3 +583,333 @@ int ConnSerial::flushPortO ()
 {
 	return tcflush (sock, TCOFLUSH);
 }
+
+int ConnSerial::setAsync (int _maxInFlight)
+{
+	if (sock < 0)
+		return -1;
+
+	if (fcntl (sock, F_SETFL, O_NONBLOCK))
+	{
+		logStream (MESSAGE_ERROR) << "cannot set serial port to non-blocking mode: " << strerror (errno) << sendLog;
+		return -1;
+	}
+
+	maxInFlight = _maxInFlight > 0 ? _maxInFlight : 1;
+
+	if (!async)
+	{
+		async = true;
+		// port will be polled by master, and deleted by master if it is not deleted before
+		master->addConnection (this);
+	}
+	return 0;
+}
+
+void ConnSerial::queSerialCommand (SerialCommand *cmd)
+{
+	if (!async)
+	{
+		logStream (MESSAGE_ERROR) << "serial port is not in asynchronous mode, cannot queue command" << sendLog;
+		cmd->commandFailed ("", 0);
+		delete cmd;
+		return;
+	}
+	serialQueue.push_back (cmd);
+	// closed port fails commands, so start them from the event loop
+	if (failing || sock < 0)
+	{
+		master->deleteTimers (EVENT_SERIAL_START, this);
+		master->addTimer (0, new Event (EVENT_SERIAL_START, this));
+		return;
+	}
+	startCommands ();
+}
+
+int ConnSerial::add (Block *block)
+{
+	if (!async)
+		return ConnNoSend::add (block);
+	if (sock >= 0)
+	{
+		short events = POLLIN | POLLPRI;
+		if (txBuf.length () > 0)
+			events |= POLLOUT;
+		block->addPollFD (sock, events);
+	}
+	return 0;
+}
+
+int ConnSerial::receive (Block *block)
+{
+	if (!async)
+		return ConnNoSend::receive (block);
+	if (sock < 0 || !block->isForRead (sock))
+		return 0;
+
+	char rbuf[512];
+	bool readed = false;
+	while (true)
+	{
+		ssize_t ret = read (sock, rbuf, sizeof (rbuf));
+		if (ret < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				break;
+			logStream (MESSAGE_ERROR) << "cannot read from serial port " << strerror (errno) << sendLog;
+			closePort (block);
+			return 0;
+		}
+		if (ret == 0)
+		{
+			// with VMIN = 0, tty returns 0 when all data were read
+			if (readed)
+				break;
+			// port is readable, but no data - port was closed or device disconnected
+			logStream (MESSAGE_ERROR) << "serial port was closed" << sendLog;
+			closePort (block);
+			return 0;
+		}
+		if (debugComm)
+		{
+			LogStream ls = logStream (MESSAGE_DEBUG);
+			ls << "readed from port '";
+			logBuffer (ls, rbuf, ret);
+			ls << "'" << sendLog;
+		}
+		rxBuf.append (rbuf, ret);
+		readed = true;
+	}
+	processReplies ();
+	return 0;
+}
+
+int ConnSerial::writable (Block *block)
+{
+	if (!async)
+		return ConnNoSend::writable (block);
+	if (sock >= 0 && txBuf.length () > 0 && block->isForWrite (sock))
+	{
+		if (writeAsync ())
+			failAll ();
+		else
+			processReplies ();
+	}
+	return 0;
+}
+
+int ConnSerial::idle ()
+{
+	if (async)
+		checkTimeouts ();
+	return ConnNoSend::idle ();
+}
+
+void ConnSerial::postEvent (Event *event)
+{
+	if (event->getType () == EVENT_SERIAL_TIMEOUT)
+	{
+		checkTimeouts ();
+		setTimeoutTimer ();
+	}
+	else if (event->getType () == EVENT_SERIAL_START)
+	{
+		startCommands ();
+	}
+	ConnNoSend::postEvent (event);
+}
+
+void ConnSerial::startCommands ()
+{
+	if (sock < 0)
+	{
+		// port was closed
+		failAll ();
+		return;
+	}
+	while (!serialQueue.empty () && (int) inFlight.size () < maxInFlight)
+	{
+		SerialCommand *cmd = serialQueue.front ();
+		serialQueue.pop_front ();
+
+		if (debugComm)
+		{
+			LogStream ls = logStream (MESSAGE_DEBUG);
+			ls << "will write to port: '";
+			logBuffer (ls, cmd->cmd.data (), cmd->cmd.length ());
+			ls << "'" << sendLog;
+		}
+
+		txBuf += cmd->cmd;
+		cmd->txEnd = txPos + txBuf.length ();
+		cmd->deadline = getNow () + cmd->timeout;
+		inFlight.push_back (cmd);
+	}
+	setTimeoutTimer ();
+
+	if (txBuf.length () > 0 && writeAsync ())
+	{
+		failAll ();
+		return;
+	}
+	// remaining data will be written when port becomes writable
+	if (txBuf.length () > 0)
+		pollChanged ();
+	processReplies ();
+}
+
+int ConnSerial::writeAsync ()
+{
+	while (txBuf.length () > 0)
+	{
+		ssize_t ret = write (sock, txBuf.data (), txBuf.length ());
+		if (ret < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				return 0;
+			logStream (MESSAGE_ERROR) << "cannot write to serial port " << strerror (errno) << sendLog;
+			return -1;
+		}
+		txBuf.erase (0, ret);
+		txPos += ret;
+	}
+	return 0;
+}
+
+void ConnSerial::processReplies ()
+{
+	bool completed = false;
+	while (!inFlight.empty ())
+	{
+		SerialCommand *cmd = inFlight.front ();
+		if (!cmd->expectReply ())
+		{
+			if (txPos < cmd->txEnd)
+				break;
+			completeCommand (true, 0, 0);
+		}
+		else if (cmd->endChar.length () > 0)
+		{
+			size_t pos = rxBuf.find (cmd->endChar);
+			if (pos != std::string::npos && (cmd->replyLen <= 0 || pos <= (size_t) cmd->replyLen))
+			{
+				completeCommand (true, pos, pos + cmd->endChar.length ());
+			}
+			else if (cmd->replyLen > 0 && rxBuf.length () > (size_t) cmd->replyLen)
+			{
+				LogStream ls = logStream (MESSAGE_ERROR);
+				ls << "did not find end char, readed '";
+				logBuffer (ls, rxBuf.data (), rxBuf.length ());
+				ls << "'" << sendLog;
+				// rest of the data cannot be matched to commands
+				completeCommand (false, rxBuf.length (), rxBuf.length ());
+				tcflush (sock, TCIFLUSH);
+			}
+			else
+			{
+				break;
+			}
+		}
+		else if (rxBuf.length () >= (size_t) cmd->replyLen)
+		{
+			completeCommand (true, cmd->replyLen, cmd->replyLen);
+		}
+		else
+		{
+			break;
+		}
+		completed = true;
+	}
+
+	if (inFlight.empty () && rxBuf.length () > 0)
+	{
+		LogStream ls = logStream (MESSAGE_WARNING);
+		ls << "unexpected data from serial port '";
+		logBuffer (ls, rxBuf.data (), rxBuf.length ());
+		ls << "'" << sendLog;
+		rxBuf.clear ();
+	}
+
+	if (completed)
+		startCommands ();
+}
+
+void ConnSerial::checkTimeouts ()
+{
+	double now = getNow ();
+	bool completed = false;
+	while (!inFlight.empty () && inFlight.front ()->deadline <= now)
+	{
+		SerialCommand *cmd = inFlight.front ();
+		LogStream ls = logStream (MESSAGE_ERROR);
+		ls << "timeout waiting for reply to '";
+		logBuffer (ls, cmd->cmd.data (), cmd->cmd.length ());
+		ls << "', readed '";
+		logBuffer (ls, rxBuf.data (), rxBuf.length ());
+		ls << "'" << sendLog;
+
+		completeCommand (false, rxBuf.length (), rxBuf.length ());
+		tcflush (sock, TCIFLUSH);
+		completed = true;
+	}
+	if (completed)
+		startCommands ();
+}
+
+void ConnSerial::closePort (Block *block)
+{
+	// otherwise the port will be reported as readable in every loop
+	block->removePollFD (sock);
+	close (sock);
+	sock = -1;
+	failAll ();
+}
+
+void ConnSerial::setTimeoutTimer ()
+{
+	master->deleteTimers (EVENT_SERIAL_TIMEOUT, this);
+	// replies are received in order, only the first command can time out
+	if (!inFlight.empty ())
+		master->addTimer (inFlight.front ()->deadline - getNow (), new Event (EVENT_SERIAL_TIMEOUT, this));
+}
+
+void ConnSerial::completeCommand (bool ok, size_t len, size_t consumed)
+{
+	SerialCommand *cmd = inFlight.front ();
+	inFlight.pop_front ();
+
+	std::string reply = rxBuf.substr (0, len);
+	rxBuf.erase (0, consumed);
+
+	if (ok)
+		cmd->replyReceived (reply.data (), reply.length ());
+	else
+		cmd->commandFailed (reply.data (), reply.length ());
+	delete cmd;
+}
+
+void ConnSerial::failAll ()
+{
+	tcflush (sock, TCIOFLUSH);
+	txBuf.clear ();
+	rxBuf.clear ();
+
+	// commands queued from callbacks are started from the event loop
+	std::deque <SerialCommand *> failed;
+	failed.swap (inFlight);
+	failed.insert (failed.end (), serialQueue.begin (), serialQueue.end ());
+	serialQueue.clear ();
+	master->deleteTimers (EVENT_SERIAL_TIMEOUT, this);
+
+	failing = true;
+	for (std::deque <SerialCommand *>::iterator iter = failed.begin (); iter != failed.end (); iter++)
+	{
+		(*iter)->commandFailed ("", 0);
+		delete *iter;
+	}
+	failing = false;
+}
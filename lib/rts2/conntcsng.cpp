@@ -38,6 +38,8 @@ const char * ConnTCSNG::runCommand (const char *cmd, const char *req)
 	sendData (wbuf, wlen, false);
 	receiveTillEnd (ngbuf, NGMAXSIZE, 3);
 
+	if (getMaster ())
+		getMaster ()->removePollFD (sock);
 	close (sock);
 	sock = -1;
 
@@ -95,6 +95,8 @@ Daemon::Daemon (int _argc, char **_argv, int _init_state):rts2core::Block (_argc
 	uptime = new ValueTime ("uptime", "daemon uptime", false);
 	uptime->setNow ();
 
+	createValue (coalescedValues, "coalesced_updates", "value updates replaced by newer update before being send", false, RTS2_VALUE_DEBUG);
+
 	idleInfoInterval = -1;
 
 	addOption ('i', NULL, 0, "run in interactive mode, don't loose console");
@@ -504,7 +506,10 @@ int Daemon::idle ()
 		doHupIdleLoop = false;
 	}
 
-	return rts2core::Block::idle ();
+	int ret = rts2core::Block::idle ();
+	// send values changed by timer handlers in this loop iteration
+	flushPendingValues ();
+	return ret;
 }
 
 void Daemon::setInfoTime (struct tm *_date)
@@ -689,14 +694,7 @@ Value * Daemon::getOwnValue (const char *v_name)
 
 CondValue * Daemon::getCondValue (const char *v_name)
 {
-	CondValueVector::iterator iter;
-	for (iter = values.begin (); iter != values.end (); iter++)
-	{
-		CondValue *val = *iter;
-		if (val->getValue ()->isValue (v_name))
-			return val;
-	}
-	return NULL;
+	return values.getCondValue (v_name);
 }
 
 CondValue * Daemon::getCondValue (const Value *val)
@@ -1057,15 +1055,47 @@ void Daemon::sendValueAll (Value * value)
 {
 	if (value->needSend ())
 	{
-		connections_t::iterator iter;
-		for (iter = getConnections ()->begin (); iter != getConnections ()->end (); iter++)
-			if ((*iter)->getSendAll ())
-				value->send (*iter);
-		for (iter = getCentraldConns ()->begin (); iter != getCentraldConns ()->end (); iter++)
-			if ((*iter)->getSendAll ())
-				value->send (*iter);
-		value->resetNeedSend ();
+		if (value->isPendingSend ())
+		{
+			coalescedValues->inc ();
+		}
+		else
+		{
+			value->setPendingSend (true);
+			pendingValues.push_back (value);
+		}
+	}
+}
+
+void Daemon::flushPendingValues ()
+{
+	if (pendingValues.empty ())
+		return;
+	// sending can call this method again
+	std::vector <Value *> toSend;
+	toSend.swap (pendingValues);
+	for (std::vector <Value *>::iterator viter = toSend.begin (); viter != toSend.end (); viter++)
+		(*viter)->setPendingSend (false);
+
+	connections_t *conns[2] = { getConnections (), getCentraldConns () };
+	for (int i = 0; i < 2; i++)
+	{
+		for (connections_t::iterator iter = conns[i]->begin (); iter != conns[i]->end (); iter++)
+		{
+			if (!(*iter)->getSendAll ())
+				continue;
+			(*iter)->corkTx ();
+			for (std::vector <Value *>::iterator viter = toSend.begin (); viter != toSend.end (); viter++)
+			{
+				// value might be already send by infoAll
+				if ((*viter)->needSend ())
+					(*viter)->send (*iter);
+			}
+			(*iter)->uncorkTx ();
+		}
 	}
+	for (std::vector <Value *>::iterator viter = toSend.begin (); viter != toSend.end (); viter++)
+		(*viter)->resetNeedSend ();
 }
 
 void Daemon::sendProgressAll (double start, double end, Connection *except)
@@ -20,11 +20,15 @@
 #include "connection.h"
 #include "data.h"
 
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sstream>
+#include <stdio.h>
 #include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/types.h>
-#include <sys/ipc.h>
-#include <sys/shm.h>
-#include <sys/sem.h>
 
 using namespace rts2core;
 
@@ -33,90 +37,110 @@ int DataRead::readDataSize (Connection *conn)
 	return conn->paramNextSSizeT (&binaryReadChunkSize);
 }
 
+std::string DataAbstractShared::getShmName (int _shm_id)
+{
+	std::ostringstream _os;
+	_os << "/rts2-data-" << _shm_id;
+	return _os.str ();
+}
+
 int DataAbstractShared::removeClient (int segnum, int client_id, bool verbose)
 {
-	if (lockSegment (segnum))
-		return -1;
 	struct SharedDataSegment *sseg = getSegment (segnum);
 	for (int s = 0; s < MAX_SHARED_CLIENTS; s++)
 	{
-		if (sseg->client_ids[s] == client_id)
+		if (sseg->client_ids[s] == client_id && __sync_bool_compare_and_swap (sseg->client_ids + s, client_id, 0))
 		{
-			sseg->client_ids[s] = 0;
-			unlockSegment (segnum);
+			// releases reference; once it drops to 0, writer can reuse the segment
+			__sync_fetch_and_sub (&(sseg->state), 1);
 			return 0;
 		}
 	}
-	unlockSegment (segnum);
 	if (verbose)
 		logStream (MESSAGE_ERROR) << "cannot find locked client with ID " << client_id << " to remove segment " << segnum << sendLog;
 	return -1;
 }
 
-int DataAbstractShared::lockSegment (int segnum)
-{
-	struct sembuf so;
-	so.sem_num = segnum;
-	so.sem_op = -1;
-	so.sem_flg = SEM_UNDO;
-	if (semop (data->shared_sem, &so, 1))
-	{
-		logStream (MESSAGE_ERROR) << "cannot lock segment " << segnum << sendLog;
-		return -1;
-	}
-	return 0;
-}
-
-int DataAbstractShared::unlockSegment (int segnum)
+int DataAbstractShared::addClientId (struct SharedDataSegment *sseg, int client_id)
 {
-	struct sembuf so;
-	so.sem_num = segnum;
-	so.sem_op = 1;
-	so.sem_flg = SEM_UNDO;
-	if (semop (data->shared_sem, &so, 1))
+	for (int s = 0; s < MAX_SHARED_CLIENTS; s++)
 	{
-		logStream (MESSAGE_ERROR) << "cannot unlock segment " << segnum << sendLog;
-		return -1;
+		if (sseg->client_ids[s] == 0 && __sync_bool_compare_and_swap (sseg->client_ids + s, 0, client_id))
+			return 0;
 	}
-	return 0;
+	return -1;
 }
 
 DataSharedRead::~DataSharedRead ()
 {
+	if (mapSize > 0)
+		munmap (data, mapSize);
 }
 
 int DataSharedRead::attach (int _shm_id)
 {
-	data = (struct SharedDataHeader *) shmat (_shm_id, NULL, 0);
-	if (data == (void *) -1)
+	std::string name = getShmName (_shm_id);
+	int fd = shm_open (name.c_str (), O_RDWR, 0);
+	if (fd < 0)
+	{
+		logStream (MESSAGE_ERROR) << "cannot open shared memory " << name << ": " << strerror (errno) << sendLog;
+		return -1;
+	}
+	struct stat st;
+	if (fstat (fd, &st))
 	{
-		logStream (MESSAGE_ERROR) << "cannot attach to shared memory " << _shm_id << sendLog;
+		logStream (MESSAGE_ERROR) << "cannot get size of shared memory " << name << ": " << strerror (errno) << sendLog;
+		close (fd);
 		return -1;
 	}
+	void *m = mmap (NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close (fd);
+	if (m == MAP_FAILED)
+	{
+		logStream (MESSAGE_ERROR) << "cannot attach to shared memory " << name << ": " << strerror (errno) << sendLog;
+		return -1;
+	}
+	data = (struct SharedDataHeader *) m;
+	mapSize = st.st_size;
 	shm_id = _shm_id;
 	return 0;
 }
 
-
 int DataSharedRead::confirmClient (int segnum, int client_id)
 {
-	if (lockSegment (segnum))
-		return -1;
 	// confirm there is already allocated client
 	struct SharedDataSegment *sseg = getSegment (segnum);
 	for (int s = 0; s < MAX_SHARED_CLIENTS; s++)
 	{
 		if (sseg->client_ids[s] == client_id)
-		{
-			unlockSegment (segnum);
 			return 0;
-		}
 	}
-	unlockSegment (segnum);
 	logStream (MESSAGE_ERROR) << "cannot find empty client slot to lock segment " << segnum << sendLog;
 	return -1;
 }
 
+int DataSharedRead::addActiveClient (int client_id)
+{
+	uint64_t st = activeSegment->state;
+	while (true)
+	{
+		// frame was released by all readers, segment can be already overwritten
+		if (SHARED_SEQUENCE (st) != sequence || SHARED_REFS (st) == 0)
+			return -1;
+		uint64_t prev = __sync_val_compare_and_swap (&(activeSegment->state), st, st + 1);
+		if (prev == st)
+			break;
+		st = prev;
+	}
+	if (addClientId (activeSegment, client_id))
+	{
+		__sync_fetch_and_sub (&(activeSegment->state), 1);
+		logStream (MESSAGE_ERROR) << "cannot find empty client slot to lock segment " << segment << sendLog;
+		return -1;
+	}
+	return 0;
+}
+
 DataWrite::DataWrite (int _channum, size_t *chansizes):DataAbstractWrite ()
 {
 	channum = _channum;
@@ -138,52 +162,116 @@ size_t DataWrite::getDataSize ()
 	return ret;
 }
 
+// number of shared data objects created by this process
+static unsigned int sharedInstances = 0;
+
+// number of shared data object IDs available to a single process
+#define SHARED_IDS    16
+
+// PID for which objects left by not running processes were removed
+static pid_t sharedCleanedPid = 0;
+
+/**
+ * Remove shared data objects of processes which are not running, and of a
+ * crashed process with the given PID.
+ */
+static void removeStaleShared (pid_t pid)
+{
+#ifdef __linux__
+	// POSIX shared memory objects are files in /dev/shm
+	DIR *dir = opendir ("/dev/shm");
+	if (dir != NULL)
+	{
+		struct dirent *de;
+		while ((de = readdir (dir)) != NULL)
+		{
+			int _shm_id;
+			char rest;
+			if (sscanf (de->d_name, "rts2-data-%d%c", &_shm_id, &rest) != 1 || _shm_id < 0)
+				continue;
+			pid_t owner = _shm_id >> 4;
+			if (owner == pid || (kill (owner, 0) && errno == ESRCH))
+				shm_unlink (DataAbstractShared::getShmName (_shm_id).c_str ());
+		}
+		closedir (dir);
+		return;
+	}
+#endif
+	for (int i = 0; i < SHARED_IDS; i++)
+		shm_unlink (DataAbstractShared::getShmName ((pid << 4) | i).c_str ());
+}
+
+size_t DataSharedWrite::getSharedSize (int numseg, size_t segsize)
+{
+	size_t pagesize = sysconf (_SC_PAGESIZE);
+	// align segments on page boundary
+	size_t hdr = sizeof (struct SharedDataHeader) + numseg * sizeof (struct SharedDataSegment);
+	hdr = ((hdr + pagesize - 1) / pagesize) * pagesize;
+	segsize = ((segsize + pagesize - 1) / pagesize) * pagesize;
+	return hdr + numseg * segsize;
+}
+
 struct SharedDataHeader *DataSharedWrite::create (int numseg, size_t segsize)
 {
-	shm_id = shmget (IPC_PRIVATE, sizeof (struct SharedDataHeader) + numseg * (sizeof (struct SharedDataSegment) + segsize), 0666);
-	if (shm_id < 0)
+	// objects with our PID were left by a crashed process with the same PID;
+	// remove them only once, objects created later by this process can be
+	// still mapped or about to be opened by readers
+	pid_t pid = getpid ();
+	pid_t cleaned = sharedCleanedPid;
+	if (cleaned != pid && __sync_bool_compare_and_swap (&sharedCleanedPid, cleaned, pid))
+		removeStaleShared (pid);
+
+	// ID is unique among running processes; skip IDs of objects still used by this process
+	int _shm_id = -1;
+	std::string name;
+	int fd = -1;
+	for (int i = 0; i < SHARED_IDS && fd < 0; i++)
 	{
-		logStream (MESSAGE_ERROR) << "cannot create shared memory segment: " << strerror (errno) << sendLog;
-		return NULL;
+		_shm_id = (pid << 4) | (__sync_fetch_and_add (&sharedInstances, 1) % SHARED_IDS);
+		name = getShmName (_shm_id);
+		fd = shm_open (name.c_str (), O_RDWR | O_CREAT | O_EXCL, 0666);
+		if (fd < 0 && errno != EEXIST)
+			break;
 	}
-	data = (struct SharedDataHeader *) shmat (shm_id, NULL, 0);
-	if (data == (void *) -1)
+	if (fd < 0)
 	{
-		shm_id = -1;
-		logStream (MESSAGE_ERROR) << "cannot attach shared memory segment: " << strerror (errno) << sendLog;
+		logStream (MESSAGE_ERROR) << "cannot create shared memory " << name << ": " << strerror (errno) << sendLog;
 		return NULL;
 	}
-	struct shmid_ds ds;
-	if (shmctl (shm_id, IPC_STAT, &ds) < 0 || shmctl (shm_id, IPC_RMID, &ds) < 0)
+	// do not let umask restrict readers
+	fchmod (fd, 0666);
+	size_t totalSize = getSharedSize (numseg, segsize);
+	if (ftruncate (fd, totalSize))
 	{
-		shmdt (data);
-		shm_id = -1;
-		logStream (MESSAGE_ERROR) << "Cannot perform shmctl call: " << strerror (errno) << sendLog;
+		logStream (MESSAGE_ERROR) << "cannot set size of shared memory " << name << " to " << totalSize << " bytes: " << strerror (errno) << sendLog;
+		close (fd);
+		shm_unlink (name.c_str ());
 		return NULL;
 	}
-	// initalize shared data header
-	data->nseg = numseg;
-	// first set is for exclusive locks, second is to signal waiting locks
-	data->shared_sem = semget (IPC_PRIVATE, numseg, 0666);
-	if (data->shared_sem < 0)
+	void *m = mmap (NULL, totalSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close (fd);
+	if (m == MAP_FAILED)
 	{
-		logStream (MESSAGE_ERROR) << "cannot create shared semaphore " << strerror (errno) << sendLog;
-		shmdt ((void *) data);
+		logStream (MESSAGE_ERROR) << "cannot map shared memory " << name << ": " << strerror (errno) << sendLog;
+		shm_unlink (name.c_str ());
 		return NULL;
 	}
+	data = (struct SharedDataHeader *) m;
+	mapSize = totalSize;
+	shm_id = _shm_id;
 
+	// initalize shared data header
+	data->nseg = numseg;
+
+	size_t seg_stride = (totalSize - getSharedSize (numseg, 0)) / numseg;
 	struct SharedDataSegment *seg = getSegment (0);
 	for (int i = 0; i < numseg; i++, seg++)
 	{
 		memset (seg->client_ids, 0, sizeof (int) * MAX_SHARED_CLIENTS);
+		seg->state = 0;
 		seg->size = segsize;
 		seg->bytesSoFar = 0;
-		seg->offset = sizeof (struct SharedDataHeader) + sizeof (struct SharedDataSegment) * numseg + i * segsize;
-
-		struct sembuf so;
-		so.sem_num = i;
-		so.sem_op = 1;
-		semop (data->shared_sem, &so, 1);
+		seg->offset = getSharedSize (numseg, 0) + i * seg_stride;
 	}
 
 	return data;
@@ -191,10 +279,10 @@ struct SharedDataHeader *DataSharedWrite::create (int numseg, size_t segsize)
 
 DataSharedWrite::~DataSharedWrite ()
 {
-	if (shm_id > 0)
+	if (mapSize > 0)
 	{
-		semctl (data->shared_sem, IPC_RMID, 0);
-		shmdt (data);
+		munmap (data, mapSize);
+		shm_unlink (getShmName (shm_id).c_str ());
 	}
 }
 
@@ -208,26 +296,22 @@ size_t DataSharedWrite::getDataSize ()
 
 int DataSharedWrite::addClient (size_t segsize, int chan, int client)
 {
+	// reuse the lowest free segment, so only segments needed for frames
+	// kept by readers are ever touched
 	for (int i = 0; i < data->nseg; i++)
 	{
-		lockSegment (i);
 		struct SharedDataSegment *sseg = getSegment (i);
-		int s;
-		for (s = 0; s < MAX_SHARED_CLIENTS; s++)
-		{
-			if (sseg->client_ids[s] > 0)
-				break;
-		}
-		if (s == MAX_SHARED_CLIENTS)
-		{
-			sseg->bytesSoFar = 0;
-			sseg->size = segsize;
-			sseg->client_ids[0] = client;
-			chan2seg[chan] = sseg; 
-			unlockSegment (i);
-			return i;
-		}
-		unlockSegment (i);
+		uint64_t st = sseg->state;
+		if (SHARED_REFS (st) != 0)
+			continue;
+		// new frame with a single reference; fails if a reader still holds the segment
+		if (!__sync_bool_compare_and_swap (&(sseg->state), st, ((uint64_t) (SHARED_SEQUENCE (st) + 1) << 32) | 1))
+			continue;
+		sseg->bytesSoFar = 0;
+		sseg->size = segsize;
+		addClientId (sseg, client);
+		chan2seg[chan] = sseg;
+		return i;
 	}
 	return -1;
 }
@@ -69,6 +69,17 @@ int DevConnection::command ()
 		setCommandInProgress (false);
 		return -1;
 	}
+	if (isCommand (COMMAND_BINARY_VALUES))
+	{
+		int tag;
+		if (paramNextInteger (&tag) || !paramEnd ())
+			return -2;
+		// peer with different byte order or record format receives text values
+		if (tag != binaryValuesTag () || !master->binaryValuesEnabled ())
+			return -3;
+		setBinaryValues (true);
+		return 0;
+	}
 	return Connection::command ();
 }
 
@@ -283,6 +294,7 @@ void DevConnectionMaster::connectionError (int last_data_size)
 {
 	if (sock > 0)
 	{
+		master->removePollFD (sock);
 		close (sock);
 		sock = -1;
 	}
@@ -808,11 +820,11 @@ void Device::centraldConnRunning (Connection *conn)
 void Device::sendMessage (messageType_t in_messageType, const char *in_messageString)
 {
 	Daemon::sendMessage (in_messageType, in_messageString);
+	if (getCentraldConns ()->empty ())
+		return;
+	Message msg = Message (getDeviceName (), in_messageType, in_messageString);
 	for (connections_t::iterator iter = getCentraldConns ()->begin (); iter != getCentraldConns ()->end (); iter++)
-	{
-		Message msg = Message (getDeviceName (), in_messageType, in_messageString);
 		(*iter)->sendMessage (msg);
-	}
 }
 
 int Device::killAll (bool callScriptEnd)
@@ -0,0 +1,241 @@
+/*
+ * Cache of interpolated positions of moving and fixed objects.
+ * Copyright (C) 2026 Petr Kubanek <petr@kubanek.net>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "ephemcache.h"
+#include "configuration.h"
+
+#include <math.h>
+
+using namespace rts2core;
+
+/**
+ * Four point Lagrange interpolation on equally spaced samples. t is
+ * relative to y[1], interpolation is most precise for t in <0,1>.
+ */
+static inline double cubic (const double *y, double t)
+{
+	return (-t * (t - 1) * (t - 2) * y[0] + 3 * (t + 1) * (t - 1) * (t - 2) * y[1] - 3 * (t + 1) * t * (t - 2) * y[2] + (t + 1) * t * (t - 1) * y[3]) / 6.0;
+}
+
+// make angles continuous, so they can be interpolated
+static void unwrap (double *a, int n)
+{
+	for (int i = 1; i < n; i++)
+	{
+		while (a[i] - a[i - 1] > 180)
+			a[i] -= 360;
+		while (a[i] - a[i - 1] < -180)
+			a[i] += 360;
+	}
+}
+
+EphemerisCache::EphemerisCache (double _step)
+{
+	step = _step;
+	enabled = true;
+	lastIndex = 0;
+	lastBucket = NULL;
+	observer.lng = NAN;
+	observer.lat = NAN;
+	hits = 0;
+	misses = 0;
+	pthread_mutex_init (&lock, NULL);
+}
+
+EphemerisCache::~EphemerisCache ()
+{
+	pthread_mutex_destroy (&lock);
+}
+
+void EphemerisCache::getEquPosition (struct ln_equ_posn *pos, double JD)
+{
+	if (!enabled)
+	{
+		computePosition (pos, JD);
+		return;
+	}
+	int k;
+	double t;
+	pthread_mutex_lock (&lock);
+	EphemerisBucket *b = getBucket (JD, k, t);
+	pos->ra = ln_range_degrees (cubic (b->ra + k, t));
+	pos->dec = cubic (b->dec + k, t);
+	pthread_mutex_unlock (&lock);
+}
+
+void EphemerisCache::getHrzPosition (struct ln_hrz_posn *hrz, double JD, struct ln_lnlat_posn *obs)
+{
+	if (!enabled)
+	{
+		struct ln_equ_posn pos;
+		computePosition (&pos, JD);
+		ln_get_hrz_from_equ (&pos, obs, JD, hrz);
+		return;
+	}
+	pthread_mutex_lock (&lock);
+	if (obs->lng != observer.lng || obs->lat != observer.lat)
+	{
+		observer = *obs;
+		for (std::map <long, EphemerisBucket>::iterator iter = buckets.begin (); iter != buckets.end (); iter++)
+			iter->second.hrzValid = false;
+	}
+
+	int k;
+	double t;
+	EphemerisBucket *b = getBucket (JD, k, t);
+	if (!b->hrzValid)
+		computeHrz (b, lastIndex);
+
+	const double *alt = b->alt + k;
+	if (alt[0] > EPHEMCACHE_ZENITH || alt[1] > EPHEMCACHE_ZENITH || alt[2] > EPHEMCACHE_ZENITH || alt[3] > EPHEMCACHE_ZENITH)
+	{
+		// close to zenith, azimuth cannot be interpolated
+		struct ln_equ_posn pos;
+		pos.ra = ln_range_degrees (cubic (b->ra + k, t));
+		pos.dec = cubic (b->dec + k, t);
+		ln_get_hrz_from_equ (&pos, &observer, JD, hrz);
+	}
+	else
+	{
+		hrz->alt = cubic (alt, t);
+		hrz->az = ln_range_degrees (cubic (b->az + k, t));
+	}
+	pthread_mutex_unlock (&lock);
+}
+
+void EphemerisCache::clear ()
+{
+	pthread_mutex_lock (&lock);
+	buckets.clear ();
+	lastBucket = NULL;
+	pthread_mutex_unlock (&lock);
+}
+
+EphemerisBucket *EphemerisCache::getBucket (double JD, int &k, double &t)
+{
+	double bucketLength = step * EPHEMCACHE_INTERVALS;
+	long index = (long) floor (JD / bucketLength);
+
+	// first sample is one step before bucket start
+	double f = (JD - index * bucketLength) / step;
+	k = (int) floor (f);
+	if (k < 0)
+		k = 0;
+	else if (k >= EPHEMCACHE_INTERVALS)
+		k = EPHEMCACHE_INTERVALS - 1;
+	t = f - k;
+
+	if (lastBucket != NULL && index == lastIndex)
+	{
+		hits++;
+		return lastBucket;
+	}
+
+	std::map <long, EphemerisBucket>::iterator iter = buckets.find (index);
+	if (iter != buckets.end ())
+	{
+		hits++;
+		lastIndex = index;
+		lastBucket = &(iter->second);
+		return lastBucket;
+	}
+
+	misses++;
+
+	// drop bucket most distant from the requested one
+	if (buckets.size () >= EPHEMCACHE_BUCKETS)
+	{
+		if (index - buckets.begin ()->first > buckets.rbegin ()->first - index)
+			buckets.erase (buckets.begin ());
+		else
+			buckets.erase (--buckets.end ());
+	}
+
+	EphemerisBucket *b = &(buckets[index]);
+	double start = index * bucketLength - step;
+	for (int i = 0; i < EPHEMCACHE_INTERVALS + 3; i++)
+	{
+		struct ln_equ_posn pos;
+		computePosition (&pos, start + i * step);
+		b->ra[i] = pos.ra;
+		b->dec[i] = pos.dec;
+	}
+	unwrap (b->ra, EPHEMCACHE_INTERVALS + 3);
+
+	lastIndex = index;
+	lastBucket = b;
+	return b;
+}
+
+void EphemerisCache::computeHrz (EphemerisBucket *b, long index)
+{
+	double start = index * step * EPHEMCACHE_INTERVALS - step;
+	for (int i = 0; i < EPHEMCACHE_INTERVALS + 3; i++)
+	{
+		struct ln_equ_posn pos;
+		struct ln_hrz_posn hrz;
+		pos.ra = ln_range_degrees (b->ra[i]);
+		pos.dec = b->dec[i];
+		ln_get_hrz_from_equ (&pos, &observer, start + i * step, &hrz);
+		b->alt[i] = hrz.alt;
+		b->az[i] = hrz.az;
+	}
+	unwrap (b->az, EPHEMCACHE_INTERVALS + 3);
+	b->hrzValid = true;
+}
+
+SolarEphemeris::SolarEphemeris ():EphemerisCache ()
+{
+	setEnabled (Configuration::instance ()->getEphemerisCache ());
+}
+
+SolarEphemeris *SolarEphemeris::instance ()
+{
+	// static initialization is thread safe; cache is enabled or disabled by Configuration::setEphemerisCache
+	static SolarEphemeris *pInstance = new SolarEphemeris ();
+	return pInstance;
+}
+
+// mean Earth - Moon distance in AU
+#define LUNAR_DIST_AU    (384400.0 / 149597870.7)
+
+LunarEphemeris::LunarEphemeris ():EphemerisCache ()
+{
+	setEnabled (Configuration::instance ()->getEphemerisCache ());
+}
+
+double LunarEphemeris::getPhase (double JD)
+{
+	if (!isEnabled ())
+		return ln_get_lunar_phase (JD);
+
+	struct ln_equ_posn moon, sun;
+	getEquPosition (&moon, JD);
+	SolarEphemeris::instance ()->getEquPosition (&sun, JD);
+
+	// geocentric elongation, phase angle is then calculated as in Meeus, eq. 48.3
+	double elong = ln_deg_to_rad (ln_get_angular_separation (&moon, &sun));
+	return ln_rad_to_deg (atan2 (sin (elong), LUNAR_DIST_AU - cos (elong)));
+}
+
+LunarEphemeris *LunarEphemeris::instance ()
+{
+	static LunarEphemeris *pInstance = new LunarEphemeris ();
+	return pInstance;
+}
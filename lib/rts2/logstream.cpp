@@ -25,8 +25,15 @@
 
 using namespace rts2core;
 
+bool LogStream::isLogged (App * app, messageType_t in_type)
+{
+	return app == NULL || app->isLogged (in_type);
+}
+
 void LogStream::logArr (const char *arr, int len)
 {
+	if (!enabled)
+		return;
 	bool lastIsHex = false;
 	for (int i = 0; i < len; i++)
 	{
@@ -48,6 +55,8 @@ void LogStream::logArr (const char *arr, int len)
 
 void LogStream::logArrAsHex (const char *arr, int len)
 {
+	if (!enabled)
+		return;
 	for (int i = 0; i < len; i++)
 	{
 		int b = arr[i];
@@ -57,6 +66,8 @@ void LogStream::logArrAsHex (const char *arr, int len)
 
 void LogStream::sendLog ()
 {
+	if (!enabled)
+		return;
 	if (masterApp != NULL)
 		masterApp->sendMessage (messageType, ls.str ().c_str ());
 	else
@@ -65,6 +76,8 @@ void LogStream::sendLog ()
 
 void LogStream::sendLogNoEndl ()
 {
+	if (!enabled)
+		return;
 	if (masterApp != NULL)
 		masterApp->sendMessageNoEndl (messageType, ls.str ().c_str ());
 	else
@@ -63,6 +63,7 @@ void MultiDev::runLoop (float tmout)
 
 	for (iter = begin (); iter != end (); iter++)
 	{
+		(*iter)->flushPendingValues ();
 		(*iter)->addPollSocks ();
 		polls += (*iter)->npolls;
 	}
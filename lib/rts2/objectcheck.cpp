@@ -33,6 +33,9 @@
 #include "objectcheck.h"
 #include "libnova_cpp.h"
 
+// number of azimuth bins, horizon entries are indexed by 0.1 degree
+#define AZ_BINS    3600
+
 using namespace rts2core;
 
 ObjectCheck::ObjectCheck (const char *horizon_file)
@@ -157,9 +160,44 @@ int ObjectCheck::load_horizon (const char *horizon_file)
 	// sort horizon file
 	sort (horizon.begin (), horizon.end (), RAcomp);
 
+	fillAzIndex ();
+
 	return 0;
 }
 
+void ObjectCheck::fillAzIndex ()
+{
+	azIndex.resize (AZ_BINS + 1);
+
+	size_t i = 0;
+	for (size_t b = 0; b <= AZ_BINS; b++)
+	{
+		double az = b * 360.0 / AZ_BINS;
+		while (i < horizon.size () && horizon[i].hrz.az <= az)
+			i++;
+		azIndex[b] = i;
+	}
+}
+
+size_t ObjectCheck::findAz (double az)
+{
+	// azimuths outside 0 - 360 range (and NAN) are searched in the whole horizon
+	if (azIndex.empty () || !(az >= 0 && az < 360.0))
+		return std::upper_bound (horizon.begin (), horizon.end (), HorizonEntry (az, 0), RAcomp) - horizon.begin ();
+
+	size_t b = (size_t) (az * AZ_BINS / 360.0);
+	if (b >= AZ_BINS)
+		b = AZ_BINS - 1;
+
+	size_t i = azIndex[b];
+	// guard against rounding of the bin start
+	while (i > 0 && horizon[i - 1].hrz.az > az)
+		i--;
+	while (i < horizon.size () && horizon[i].hrz.az <= az)
+		i++;
+	return i;
+}
+
 int ObjectCheck::is_good (const struct ln_hrz_posn *hrz, int hardness)
 {
 	return hrz->alt > getHorizonHeight (hrz, hardness);
@@ -195,25 +233,47 @@ double ObjectCheck::getHorizonHeightAz (double az, horizon_t::iterator iter1, ho
 		((*iter2).hrz.az - az1);
 }
 
+double ObjectCheck::getHorizonHeightAz (double az)
+{
+	size_t i = findAz (az);
+
+	// before the first or after the last entry, interpolate between last and first entry
+	if (i == 0 || i == horizon.size ())
+		return getHorizonHeightAz (az, --horizon.end (), horizon.begin ());
+
+	return getHorizonHeightAz (az, horizon.begin () + (i - 1), horizon.begin () + i);
+}
+
 double ObjectCheck::getHorizonHeight (const struct ln_hrz_posn *hrz, int hardness)
 {
 	if (horizon.size () == 0)
 		return 0;
 
-	horizon_t::iterator iter = horizon.begin ();
-
-	if (hrz->az < (*iter).hrz.az)
-		return getHorizonHeightAz (hrz->az, iter, --horizon.end ());
+	return getHorizonHeightAz (hrz->az);
+}
 
-	horizon_t::iterator iter_last = iter;
+void ObjectCheck::getHorizonHeight (size_t n, const double *az, double *heights, int hardness)
+{
+	if (horizon.size () == 0)
+	{
+		for (size_t i = 0; i < n; i++)
+			heights[i] = 0;
+		return;
+	}
 
-	iter++;
+	for (size_t i = 0; i < n; i++)
+		heights[i] = getHorizonHeightAz (az[i]);
+}
 
-	for (; iter != horizon.end (); iter++)
+void ObjectCheck::is_good (size_t n, const double *alt, const double *az, int *good, int hardness)
+{
+	if (horizon.size () == 0)
 	{
-		if ((*iter).hrz.az > hrz->az)
-			return getHorizonHeightAz (hrz->az, iter_last, iter);
-		iter_last = iter;
+		for (size_t i = 0; i < n; i++)
+			good[i] = alt[i] > 0;
+		return;
 	}
-	return getHorizonHeightAz (hrz->az, iter_last, horizon.begin ());
+
+	for (size_t i = 0; i < n; i++)
+		good[i] = alt[i] > getHorizonHeightAz (az[i]);
 }
@@ -0,0 +1,286 @@
+/*
+ * Multi-threaded processing of camera readout data.
+ * Copyright (C) 2026 Petr Kubanek <petr@kubanek.net>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "readoutpipeline.h"
+#include "camd.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// maximal number of jobs per worker waiting for processing
+#define MAX_JOBS_PER_WORKER   4
+
+using namespace rts2camd;
+
+int ConnReadoutNotify::receive (rts2core::Block *block)
+{
+	if (sock >= 0 && block->isForRead (sock))
+	{
+		char drain[128];
+		// drain the pipe, completed jobs are kept in the done queue
+		while (read (sock, drain, sizeof (drain)) > 0)
+			;
+		pipeline->processCompleted ();
+	}
+	return 0;
+}
+
+ReadoutPipeline::ReadoutPipeline (Camera *_camera, int _threads)
+{
+	camera = _camera;
+	threads = _threads;
+
+	workers = NULL;
+	workerArgs = NULL;
+	jobQueues = new TSQueue <ReadoutJob *> [threads];
+
+	outstanding = 0;
+	pthread_mutex_init (&outstandingMutex, NULL);
+	pthread_cond_init (&outstandingCond, NULL);
+
+	notifyPipe[0] = notifyPipe[1] = -1;
+	notifyErrno = 0;
+
+	lastError = 0;
+}
+
+ReadoutPipeline::~ReadoutPipeline ()
+{
+	if (workers)
+	{
+		flush (false);
+		// NULL job terminates worker
+		for (int i = 0; i < threads; i++)
+			jobQueues[i].push (NULL);
+		for (int i = 0; i < threads; i++)
+			pthread_join (workers[i], NULL);
+	}
+
+	for (std::list <ReadoutJob *>::iterator iter = freeJobs.begin (); iter != freeJobs.end (); iter++)
+		delete *iter;
+
+	delete[] workers;
+	delete[] workerArgs;
+	delete[] jobQueues;
+
+	// read end is closed by notification connection
+	if (notifyPipe[1] >= 0)
+		close (notifyPipe[1]);
+
+	pthread_mutex_destroy (&outstandingMutex);
+	pthread_cond_destroy (&outstandingCond);
+}
+
+ConnReadoutNotify *ReadoutPipeline::start ()
+{
+	if (pipe (notifyPipe))
+	{
+		logStream (MESSAGE_ERROR) << "cannot create readout pipeline notification pipe: " << strerror (errno) << sendLog;
+		return NULL;
+	}
+	fcntl (notifyPipe[0], F_SETFL, O_NONBLOCK);
+	fcntl (notifyPipe[1], F_SETFL, O_NONBLOCK);
+	fcntl (notifyPipe[0], F_SETFD, FD_CLOEXEC);
+	fcntl (notifyPipe[1], F_SETFD, FD_CLOEXEC);
+
+	workers = new pthread_t[threads];
+	workerArgs = new WorkerArg[threads];
+
+	for (int i = 0; i < threads; i++)
+	{
+		workerArgs[i].pipeline = this;
+		workerArgs[i].num = i;
+		int ret = pthread_create (workers + i, NULL, runWorker, workerArgs + i);
+		if (ret)
+		{
+			logStream (MESSAGE_ERROR) << "cannot start readout worker thread: " << strerror (ret) << sendLog;
+			// run only started workers
+			threads = i;
+			if (threads == 0)
+			{
+				delete[] workers;
+				workers = NULL;
+				return NULL;
+			}
+			break;
+		}
+	}
+
+	logStream (MESSAGE_DEBUG) << "started " << threads << " readout worker threads" << sendLog;
+
+	return new ConnReadoutNotify (notifyPipe[0], camera, this);
+}
+
+ReadoutJob *ReadoutPipeline::getJob (const char *data, size_t dataSize, int chan)
+{
+	ReadoutJob *job = NULL;
+	// reuse first job with big enough buffer
+	for (std::list <ReadoutJob *>::iterator iter = freeJobs.begin (); iter != freeJobs.end (); iter++)
+	{
+		if ((*iter)->capacity >= dataSize)
+		{
+			job = *iter;
+			freeJobs.erase (iter);
+			break;
+		}
+	}
+	if (job == NULL)
+	{
+		if (freeJobs.empty ())
+		{
+			job = new ReadoutJob ();
+		}
+		else
+		{
+			job = freeJobs.front ();
+			freeJobs.pop_front ();
+		}
+		delete[] job->data;
+		job->data = new char[dataSize];
+		job->capacity = dataSize;
+	}
+	memcpy (job->data, data, dataSize);
+	job->dataSize = dataSize;
+	job->chan = chan;
+	return job;
+}
+
+int ReadoutPipeline::queue (ReadoutJob *job)
+{
+	if (job->sendData)
+	{
+		if ((size_t) job->chan >= pending.size ())
+			pending.resize (job->chan + 1, 0);
+		pending[job->chan] += job->dataSize;
+	}
+
+	pthread_mutex_lock (&outstandingMutex);
+	// limit memory used by queued data
+	while (outstanding >= threads * MAX_JOBS_PER_WORKER)
+		pthread_cond_wait (&outstandingCond, &outstandingMutex);
+	outstanding++;
+	pthread_mutex_unlock (&outstandingMutex);
+
+	jobQueues[job->chan % threads].push (job);
+
+	// deliver jobs which were finished
+	processCompleted ();
+
+	return getError ();
+}
+
+int ReadoutPipeline::flush (bool process)
+{
+	pthread_mutex_lock (&outstandingMutex);
+	while (outstanding > 0)
+		pthread_cond_wait (&outstandingCond, &outstandingMutex);
+	pthread_mutex_unlock (&outstandingMutex);
+
+	while (!done.empty ())
+		jobDone (done.pop (), process);
+
+	return getError ();
+}
+
+int ReadoutPipeline::processCompleted ()
+{
+	int err = notifyErrno;
+	if (err != 0 && __sync_bool_compare_and_swap (&notifyErrno, err, 0))
+		logStream (MESSAGE_ERROR) << "cannot notify main loop about completed readout job: " << strerror (err) << sendLog;
+
+	while (!done.empty ())
+		jobDone (done.pop (), true);
+	return lastError;
+}
+
+size_t ReadoutPipeline::getPendingData (int chan)
+{
+	if ((size_t) chan >= pending.size ())
+		return 0;
+	return pending[chan];
+}
+
+size_t ReadoutPipeline::getPendingData ()
+{
+	size_t ret = 0;
+	for (std::vector <size_t>::iterator iter = pending.begin (); iter != pending.end (); iter++)
+		ret += *iter;
+	return ret;
+}
+
+int ReadoutPipeline::getError ()
+{
+	int ret = lastError;
+	lastError = 0;
+	return ret;
+}
+
+void *ReadoutPipeline::runWorker (void *arg)
+{
+	ReadoutPipeline *pipeline = ((WorkerArg *) arg)->pipeline;
+	TSQueue <ReadoutJob *> *jobs = pipeline->jobQueues + ((WorkerArg *) arg)->num;
+
+	while (true)
+	{
+		ReadoutJob *job = jobs->pop (true);
+		if (job == NULL)
+			break;
+
+		pipeline->processJob (job);
+		pipeline->done.push (job);
+
+		pthread_mutex_lock (&(pipeline->outstandingMutex));
+		pipeline->outstanding--;
+		pthread_cond_broadcast (&(pipeline->outstandingCond));
+		pthread_mutex_unlock (&(pipeline->outstandingMutex));
+
+		// wake up main loop; if the pipe is full, main loop was already notified.
+		// Job was already counted as completed, so queue and flush deliver it
+		// even if the notification fails; error is logged by the main thread
+		char c = 0;
+		if (write (pipeline->notifyPipe[1], &c, 1) < 0 && errno != EAGAIN)
+			__sync_bool_compare_and_swap (&(pipeline->notifyErrno), 0, errno);
+	}
+	return NULL;
+}
+
+void ReadoutPipeline::processJob (ReadoutJob *job)
+{
+	job->stat.resetStatistics ();
+	job->stat.resetMode ();
+	if (job->calcStat || job->calcCenter)
+		job->stat.update (job->dataType, job->data, job->dataSize, job->calcMode);
+}
+
+void ReadoutPipeline::jobDone (ReadoutJob *job, bool process)
+{
+	if (process)
+	{
+		// report the first failure immediately, it is returned from the next queue or flush call
+		if (camera->readoutJobDone (job) && lastError == 0)
+		{
+			logStream (MESSAGE_ERROR) << "cannot send readout data of channel " << job->chan << sendLog;
+			lastError = -1;
+		}
+	}
+	if (job->sendData)
+		pending[job->chan] -= job->dataSize;
+	freeJobs.push_back (job);
+}
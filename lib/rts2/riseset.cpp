@@ -30,6 +30,7 @@
 
 #include "libnova_cpp.h"
 #include "riseset.h"
+#include "ephemcache.h"
 
 int next_naut (double jd, struct ln_lnlat_posn *observer, struct ln_rst_time *rst, struct ln_rst_time *rst_naut, int *sun_rs, double night_horizon, double day_horizon)
 {
@@ -48,7 +49,7 @@ int next_naut (double jd, struct ln_lnlat_posn *observer, struct ln_rst_time *rs
 	do
 	{
 		struct ln_rst_time t_rst;
-		sun_naut = ln_get_solar_rst_horizon (t_jd, observer, night_horizon, &t_rst);
+		sun_naut = ln_get_body_rst_horizon (t_jd, observer, rts2core::SolarEphemeris::getEquCoords, night_horizon, &t_rst);
 		if (!rst_naut->rise && jd < t_rst.rise)
 			rst_naut->rise = t_rst.rise;
 		if (last_naut.rise && (t_rst.rise - last_naut.rise) > 1.5)
@@ -74,7 +75,7 @@ int next_naut (double jd, struct ln_lnlat_posn *observer, struct ln_rst_time *rs
 				rst_naut->set = last_naut.set;
 		}
 		last_naut = t_rst;
-		if (!ln_get_solar_rst_horizon (t_jd, observer, day_horizon, &t_rst))
+		if (!ln_get_body_rst_horizon (t_jd, observer, rts2core::SolarEphemeris::getEquCoords, day_horizon, &t_rst))
 		{
 			*sun_rs = 1;
 			if (!rst->set && jd < t_rst.set)
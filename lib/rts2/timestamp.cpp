@@ -32,6 +32,7 @@ std::ostream & operator << (std::ostream & _os, Timestamp _ts)
 {
 	// convert timestamp to timeval
 	struct timeval tv;
+	struct tm _tm;
 	struct tm *tmval;
 	if (formatPureNumbers (_os))
 	{
@@ -51,10 +52,11 @@ std::ostream & operator << (std::ostream & _os, Timestamp _ts)
 	}
 	tv.tv_sec = (long) _ts.ts;
 	tv.tv_usec = (long) ((_ts.ts - floor (_ts.ts)) * USEC_SEC);
+	// reentrant versions, timestamps are formatted by the log flusher thread
 	if (formatLocalTime (_os))
-		tmval = localtime (&tv.tv_sec);
+		tmval = localtime_r (&tv.tv_sec, &_tm);
 	else
-		tmval = gmtime (&tv.tv_sec);
+		tmval = gmtime_r (&tv.tv_sec, &_tm);
 
 	std::ios_base::fmtflags old_settings = _os.flags ();
 	_os.setf (std::ios_base::fixed, std::ios_base::floatfield);
@@ -35,12 +35,14 @@ Value::Value (std::string _val_name)
 {
 	valueName = _val_name;
 	rts2Type = 0;
+	pendingSend = false;
 }
 
 Value::Value (std::string _val_name, std::string _description, bool writeToFits, int32_t flags)
 {
 	valueName = _val_name;
 	rts2Type = 0;
+	pendingSend = false;
 	description = _description;
 	if (writeToFits)
 		setWriteToFits ();
@@ -85,6 +87,9 @@ int Value::sendMetaInfo (Connection * connection)
 
 void Value::send (Connection * connection)
 {
+	// peers which requested binary values receive binary record
+	if (connection->getBinaryValues () && connection->sendBinaryValue (this) <= 0)
+		return;
 	connection->sendValueRaw (getName (), getValue ());
 }
 
@@ -187,6 +192,16 @@ int ValueInteger::setValue (Connection * connection)
 	return 0;
 }
 
+int ValueInteger::setBinaryValue (const char *data, size_t size)
+{
+	int new_value;
+	if (size != sizeof (new_value))
+		return -2;
+	memcpy (&new_value, data, sizeof (new_value));
+	// subclasses check range of the value
+	return setValueInteger (new_value) ? -2 : 0;
+}
+
 int ValueInteger::setValueCharArr (const char *in_value)
 {
 	return setValueInteger (atoi (in_value));
@@ -258,6 +273,18 @@ int ValueDouble::setValue (Connection * connection)
 	return 0;
 }
 
+int ValueDouble::setBinaryValue (const char *data, size_t size)
+{
+	double new_value;
+	if (size != sizeof (new_value))
+		return -2;
+	memcpy (&new_value, data, sizeof (new_value));
+	if (value != new_value)
+		changed ();
+	value = new_value;
+	return 0;
+}
+
 int ValueDouble::setValueCharArr (const char *in_value)
 {
 	setValueDouble (atof (in_value));
@@ -403,6 +430,18 @@ int ValueFloat::setValue (Connection * connection)
 	return 0;
 }
 
+int ValueFloat::setBinaryValue (const char *data, size_t size)
+{
+	float new_value;
+	if (size != sizeof (new_value))
+		return -2;
+	memcpy (&new_value, data, sizeof (new_value));
+	if (value != new_value)
+		changed ();
+	value = new_value;
+	return 0;
+}
+
 int ValueFloat::setValueCharArr (const char *in_value)
 {
 	setValueDouble (atof (in_value));
@@ -475,6 +514,18 @@ int ValueBool::setValueCharArr (const char *in_value)
 	return 0;
 }
 
+int ValueBool::setBinaryValue (const char *data, size_t size)
+{
+	int new_value;
+	if (size != sizeof (new_value))
+		return -2;
+	memcpy (&new_value, data, sizeof (new_value));
+	// 2 is send for unknown value
+	if (new_value < 0 || new_value > 2)
+		return -2;
+	return setValueInteger (new_value);
+}
+
 const char * ValueBool::getDisplayValue ()
 {
 	if (getValueDisplayType () & RTS2_DT_ONOFF)
@@ -645,6 +696,24 @@ int ValueLong::setValue (Connection * connection)
 	return 0;
 }
 
+bool ValueLong::getBinaryValue (std::string &out)
+{
+	// long size differs between architectures
+	int64_t v = value;
+	out.append ((char *) &v, sizeof (v));
+	return true;
+}
+
+int ValueLong::setBinaryValue (const char *data, size_t size)
+{
+	int64_t new_value;
+	if (size != sizeof (new_value))
+		return -2;
+	memcpy (&new_value, data, sizeof (new_value));
+	setValueLong (new_value);
+	return 0;
+}
+
 int ValueLong::setValueCharArr (const char *in_value)
 {
 	return setValueLong (atol (in_value));
@@ -709,6 +778,23 @@ int ValueRaDec::setValue (Connection * connection)
 	return 0;
 }
 
+bool ValueRaDec::getBinaryValue (std::string &out)
+{
+	out.append ((char *) &ra, sizeof (ra));
+	out.append ((char *) &decl, sizeof (decl));
+	return true;
+}
+
+int ValueRaDec::setBinaryValue (const char *data, size_t size)
+{
+	double v[2];
+	if (size != sizeof (v))
+		return -2;
+	memcpy (v, data, sizeof (v));
+	setValueRaDec (v[0], v[1]);
+	return 0;
+}
+
 int ValueRaDec::setValueCharArr (const char *in_value)
 {
 	double v_ra, v_dec;
@@ -858,6 +944,23 @@ int ValueAltAz::setValue (Connection * connection)
 	return 0;
 }
 
+bool ValueAltAz::getBinaryValue (std::string &out)
+{
+	out.append ((char *) &alt, sizeof (alt));
+	out.append ((char *) &az, sizeof (az));
+	return true;
+}
+
+int ValueAltAz::setBinaryValue (const char *data, size_t size)
+{
+	double v[2];
+	if (size != sizeof (v))
+		return -2;
+	memcpy (v, data, sizeof (v));
+	setValueAltAz (v[0], v[1]);
+	return 0;
+}
+
 int ValueAltAz::setValueCharArr (const char *in_value)
 {
 	double v_alt, v_az;
@@ -154,6 +154,24 @@ int DoubleArray::setValues (std::vector <int> &index, Connection *conn)
 	return 0;
 }
 
+bool DoubleArray::getBinaryValue (std::string &out)
+{
+	if (!value.empty ())
+		out.append ((char *) &(value[0]), value.size () * sizeof (double));
+	return true;
+}
+
+int DoubleArray::setBinaryValue (const char *data, size_t size)
+{
+	if (size % sizeof (double))
+		return -2;
+	value.resize (size / sizeof (double));
+	if (size > 0)
+		memcpy (&(value[0]), data, size);
+	changed ();
+	return 0;
+}
+
 int DoubleArray::setValueCharArr (const char *_value)
 {
 	std::vector <std::string> sv = SplitStr (std::string (_value), std::string (" "));
@@ -360,6 +378,24 @@ int IntegerArray::setValues (std::vector <int> &index, Connection *conn)
 	return 0;
 }
 
+bool IntegerArray::getBinaryValue (std::string &out)
+{
+	if (!value.empty ())
+		out.append ((char *) &(value[0]), value.size () * sizeof (int));
+	return true;
+}
+
+int IntegerArray::setBinaryValue (const char *data, size_t size)
+{
+	if (size % sizeof (int))
+		return -2;
+	value.resize (size / sizeof (int));
+	if (size > 0)
+		memcpy (&(value[0]), data, size);
+	changed ();
+	return 0;
+}
+
 int IntegerArray::setValueCharArr (const char *_value)
 {
 	std::vector <std::string> sv = SplitStr (std::string (_value), std::string (" "));
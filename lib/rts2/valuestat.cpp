@@ -22,6 +22,7 @@
 #include "valuestat.h"
 #include "connection.h"
 #include "libnova_cpp.h"
+#include "statistics.h"
 
 using namespace rts2core;
 
@@ -40,27 +41,15 @@ void ValueDoubleStat::calculate ()
 {
 	if (valueList.size () == 0)
 		return;
-	std::deque < double >sorted = valueList;
-	std::sort (sorted.begin (), sorted.end ());
-	min = *(sorted.begin ());
-	max = *(--sorted.end ());
-	numMes = valueList.size ();
-	double sum = 0;
-	stdev = 0;
-	double tmp_stdev;
-	for (std::deque < double >::iterator iter = sorted.begin (); iter != sorted.end (); iter++)
-	{
-		sum += (*iter);
-		tmp_stdev = *iter - getValueDouble ();
-		tmp_stdev *= tmp_stdev;
-		stdev += tmp_stdev;
-	}
-	setValueDouble (sum / numMes);
-	stdev = sqrt (stdev / numMes);
-	if ((numMes % 2) == 1)
-		mode = sorted[numMes / 2];
-	else
-		mode = (sorted[numMes / 2 - 1] + sorted[numMes / 2]) / 2.0;
+	RunningStatistics stat;
+	std::vector <double> values (valueList.begin (), valueList.end ());
+	stat.add (&values[0], values.size ());
+	numMes = values.size ();
+	min = stat.getMin ();
+	max = stat.getMax ();
+	setValueDouble (stat.getMean ());
+	stdev = stat.getStdev ();
+	mode = selectMedian (&values[0], values.size ());
 	changed ();
 }
 
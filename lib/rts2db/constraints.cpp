@@ -21,6 +21,8 @@
 #include "utilsfunc.h"
 #include "configuration.h"
 
+#include <algorithm>
+
 #ifndef RTS2_HAVE_DECL_LN_GET_ALT_FROM_AIRMASS
 double ln_get_alt_from_airmass (double X, double airmass_scale)
 {
@@ -205,6 +207,17 @@ bool ConstraintInterval::isBetween (double val)
 	return false;
 }
 
+void ConstraintInterval::getBounds (std::vector <double> &bounds)
+{
+	for (std::list <ConstraintDoubleInterval>::iterator iter = intervals.begin (); iter != intervals.end (); iter++)
+	{
+		if (!std::isnan (iter->getLower ()))
+			bounds.push_back (iter->getLower ());
+		if (!std::isnan (iter->getUpper ()))
+			bounds.push_back (iter->getUpper ());
+	}
+}
+
 // interval functions
 
 // reverse intervals. Intervals must be ordered
@@ -233,76 +246,125 @@ void reverseInterval (time_t from, time_t to, interval_arr_t &intervals)
 	intervals = ret;
 }
 
-// find first satisifing interval ending after first violation..
-void findFirst (interval_arr_t::const_iterator &si, const interval_arr_t::const_iterator &end, double t)
-{
-	while (si != end && si->second < t)
-		si++;
-}
-
 #define min(a,b) ((a < b) ? a : b)
 #define max(a,b) ((a > b) ? a : b)
 
-// merge two intervals, find their intersection
-void mergeIntervals (const interval_arr_t master, const interval_arr_t &add, interval_arr_t &ret)
+// hour angle change per day, in degrees
+#define SIDEREAL_RATE   360.98564736629
+
+// margin (in seconds) added to predicted crossing times
+#define HINT_MARGIN     60
+
+/**
+ * Returns hint when target hour angle reaches one of given hour angles,
+ * calculated from target position at JD. Crossings which passed less than
+ * two margins ago are considered imminent, so small difference between
+ * predicted and real crossing cannot skip the crossing. Hint is never
+ * further than half a day, so changes of position of moving targets are
+ * taken into account. Returns 0 for fast moving targets.
+ */
+static double hourAngleHint (Target *tar, double JD, const std::vector <double> &has)
 {
-	if (add.size () == 0 || master.size () == 0)
+	if (!tar->isSlowMoving ())
+		return 0;
+	double ha = tar->getHourAngle (JD);
+	double dt = 0.5;
+	for (std::vector <double>::const_iterator iter = has.begin (); iter != has.end (); iter++)
 	{
-		ret.clear ();
-		return;
+		double d = ln_range_degrees (*iter - ha) / SIDEREAL_RATE;
+		if (d > 360.0 / SIDEREAL_RATE - 2 * HINT_MARGIN / 86400.0)
+			d = 0;
+		if (d < dt)
+			dt = d;
 	}
-	for (interval_arr_t::const_iterator mi = master.begin (); mi != master.end (); mi++)
+	return JD + dt + HINT_MARGIN / 86400.0;
+}
+
+/**
+ * Returns hint when target crosses one of given altitudes. Hour angles of
+ * the crossings are calculated from rise/set equation.
+ */
+static double altitudeHint (Target *tar, double JD, const std::vector <double> &alts)
+{
+	if (!tar->isSlowMoving ())
+		return 0;
+	struct ln_equ_posn pos;
+	tar->getCachedPosition (&pos, JD);
+	double lat = ln_deg_to_rad (tar->getObserver ()->lat);
+	double dec = ln_deg_to_rad (pos.dec);
+
+	std::vector <double> has;
+	for (std::vector <double>::const_iterator iter = alts.begin (); iter != alts.end (); iter++)
 	{
-		interval_arr_t::const_iterator addi = add.begin ();
-		while (addi != add.end () && addi->first < mi->second)
-		{
-			findFirst (addi, add.end (), mi->first);
-			if (addi == add.end ())
-				break;
-			// intervals have empty intersection
-			if (addi->first > mi->second)
-				continue;
-			ret.push_back (std::pair <time_t, time_t> (max (mi->first, addi->first), min (mi->second, addi->second)));
-			addi++;
-		}
+		double cos_h = (sin (ln_deg_to_rad (*iter)) - sin (lat) * sin (dec)) / (cos (lat) * cos (dec));
+		// target is always above or bellow the altitude
+		if (std::isnan (cos_h) || fabs (cos_h) > 1)
+			continue;
+		double h = ln_rad_to_deg (acos (cos_h));
+		has.push_back (h);
+		has.push_back (-h);
 	}
+	return hourAngleHint (tar, JD, has);
 }
 
-void Constraint::getSatisfiedIntervals (Target *tar, time_t from, time_t to, int step, interval_arr_t &ret)
+// scan step of constraints which change slowly for slow moving targets
+static int slowScanStep (Target *tar, int step)
 {
-	double vf = NAN;
+	if (!tar->isSlowMoving ())
+		return step;
+	return max (step, CONSTRAINT_SCAN_STEP);
+}
 
+void Constraint::getSatisfiedIntervals (Target *tar, time_t from, time_t to, int step, interval_arr_t &ret)
+{
 	double to_JD = ln_get_julian_from_timet (&to);
 
-	double t;
-	for (t = ln_get_julian_from_timet (&from); t < to_JD;)
+	double t = ln_get_julian_from_timet (&from);
+	while (t < to_JD)
 	{
-		double nextJD;
-		if (satisfy (tar, t, &nextJD))
-		{
-			if (std::isnan (vf))
-				vf = t;
-		}
-		else if (!std::isnan (vf))
+		bool sat;
+		double change = getNextChange (tar, t, to_JD, step, sat);
+		if (sat)
 		{
-			ln_get_timet_from_julian (vf, &from);
-			ln_get_timet_from_julian (t, &to);
-			ret.push_back (std::pair <time_t, time_t> (from, to));
-			vf = NAN;
+			time_t s, e;
+			ln_get_timet_from_julian (t, &s);
+			ln_get_timet_from_julian (change, &e);
+			ret.push_back (std::pair <time_t, time_t> (s, e));
 		}
-		if (std::isnan (nextJD))
+		t = change;
+	}
+}
+
+double Constraint::getNextChange (Target *tar, double JD, double to_JD, int step, bool &sat)
+{
+	double nextJD;
+	sat = satisfy (tar, JD, &nextJD);
+
+	double scan = getScanStep (tar, step) / 86400.0;
+
+	while (JD < to_JD && !std::isnan (nextJD))
+	{
+		double t = nextJD > JD ? nextJD : JD + scan;
+		if (t > to_JD)
 			t = to_JD;
-		else if (nextJD > 0)
-			t = nextJD;
-		else
-			t += step / 86400.0;
+		if (satisfy (tar, t, &nextJD) != sat)
+			return bisectChange (tar, JD, t, sat);
+		JD = t;
 	}
-	if (!std::isnan (vf))
+	return to_JD;
+}
+
+double Constraint::bisectChange (Target *tar, double t1, double t2, bool sat)
+{
+	while ((t2 - t1) * 86400.0 > CONSTRAINT_PRECISION)
 	{
-		ln_get_timet_from_julian (vf, &from);
-		ln_get_timet_from_julian (t, &to);
-		ret.push_back (std::pair <time_t, time_t> (from, to));
+		double t = (t1 + t2) / 2.0;
+		if (satisfy (tar, t, NULL) == sat)
+			t1 = t;
+		else
+			t2 = t;
 	}
+	return t2;
 }
 
 void Constraint::getViolatedIntervals (Target *tar, time_t from, time_t to, int step, interval_arr_t &ret)
@@ -394,23 +456,51 @@ void ConstraintTime::load (xmlNodePtr cons)
 bool ConstraintTime::satisfy (Target *target, double JD, double *nextJD)
 {
 	if (nextJD)
-		*nextJD = 0;
+	{
+		// next interval boundary
+		std::vector <double> bounds;
+		getBounds (bounds);
+		*nextJD = NAN;
+		for (std::vector <double>::iterator iter = bounds.begin (); iter != bounds.end (); iter++)
+		{
+			if (*iter > JD && !(*iter >= *nextJD))
+				*nextJD = *iter;
+		}
+	}
 	return isBetween (JD);
 }
 
 void ConstraintTime::getSatisfiedIntervals (Target *tar, time_t from, time_t to, int step, interval_arr_t &ret)
 {
-	// get list of satisfied intervals
+	// intervals clipped to from - to
+	interval_arr_t si;
 	for (std::list <ConstraintDoubleInterval>::iterator iter = intervals.begin (); iter != intervals.end (); iter++)
 	{
-		double l = iter->getUpper ();
-		double u = iter->getLower ();
-		if (!std::isnan (l) && l >= from && !std::isnan (u) && u <= to)
-			ret.push_back (std::pair <time_t, time_t> (l, u));
-		if (std::isnan (l) && !std::isnan (u) && u <= to)
-			ret.push_back (std::pair <time_t, time_t> (from, u));
-		if (!std::isnan (l) && l >= from  && std::isnan (u))
-			ret.push_back (std::pair <time_t, time_t> (l, to));
+		time_t l = from;
+		time_t u = to;
+		time_t t;
+		if (!std::isnan (iter->getLower ()))
+		{
+			ln_get_timet_from_julian (iter->getLower (), &t);
+			l = max (l, t);
+		}
+		if (!std::isnan (iter->getUpper ()))
+		{
+			ln_get_timet_from_julian (iter->getUpper (), &t);
+			u = min (u, t);
+		}
+		if (l < u)
+			si.push_back (std::pair <time_t, time_t> (l, u));
+	}
+	// join overlapping intervals
+	std::sort (si.begin (), si.end ());
+	size_t first = ret.size ();
+	for (interval_arr_t::iterator iter = si.begin (); iter != si.end (); iter++)
+	{
+		if (ret.size () > first && ret.back ().second >= iter->first)
+			ret.back ().second = max (ret.back ().second, iter->second);
+		else
+			ret.push_back (*iter);
 	}
 }
 
@@ -424,7 +514,14 @@ bool ConstraintAirmass::satisfy (Target *tar, double JD, double *nextJD)
 		return true;
 	}
 	if (nextJD)
-		*nextJD = 0;
+	{
+		std::vector <double> bounds;
+		getBounds (bounds);
+		std::vector <double> alts;
+		for (std::vector <double>::iterator iter = bounds.begin (); iter != bounds.end (); iter++)
+			alts.push_back (ln_get_alt_from_airmass (*iter, tar->getAirmassScale ()));
+		*nextJD = altitudeHint (tar, JD, alts);
+	}
 	return isBetween (am);
 }
 
@@ -452,7 +549,14 @@ bool ConstraintZenithDistance::satisfy (Target *tar, double JD, double *nextJD)
 		return true;
 	}
 	if (nextJD)
-		*nextJD = 0;
+	{
+		std::vector <double> bounds;
+		getBounds (bounds);
+		std::vector <double> alts;
+		for (std::vector <double>::iterator iter = bounds.begin (); iter != bounds.end (); iter++)
+			alts.push_back (90 - *iter);
+		*nextJD = altitudeHint (tar, JD, alts);
+	}
 	return isBetween(zd);
 }
 
@@ -480,7 +584,13 @@ bool ConstraintHA::satisfy (Target *tar, double JD, double *nextJD)
 		return true;
 	}
 	if (nextJD)
-		*nextJD = 0;
+	{
+		std::vector <double> has;
+		getBounds (has);
+		// hour angle wraps at 180
+		has.push_back (180);
+		*nextJD = hourAngleHint (tar, JD, has);
+	}
 	return isBetween (ha);
 }
 
@@ -499,6 +609,11 @@ bool ConstraintDec::satisfy (Target *tar, double JD, double *nextJD)
 	return isBetween (pos.dec);
 }
 
+int ConstraintDec::getScanStep (Target *tar, int step)
+{
+	return slowScanStep (tar, step);
+}
+
 bool ConstraintLunarDistance::satisfy (Target *tar, double JD, double *nextJD)
 {
 	double ld = tar->getLunarDistance (JD);
@@ -513,35 +628,38 @@ bool ConstraintLunarDistance::satisfy (Target *tar, double JD, double *nextJD)
 	return isBetween (ld);
 }
 
-void ConstraintLunarDistance::getSatisfiedIntervals (Target *tar, time_t from, time_t to, int step, interval_arr_t &ret)
+int ConstraintLunarDistance::getScanStep (Target *tar, int step)
 {
 	// for fixed target coordinates, we assume  calculating constraint once an hour is enough
 	if (tar->hasConstantPosition ())
-	{
-		ConstraintInterval::getSatisfiedIntervals (tar, from, to, 3600, ret);
-	}
-	else
-	{
-		ConstraintInterval::getSatisfiedIntervals (tar, from, to, step, ret);
-	}
+		return max (step, 3600);
+	return slowScanStep (tar, step);
 }
 
 bool ConstraintLunarAltitude::satisfy (Target *tar, double JD, double *nextJD)
 {
-	struct ln_equ_posn eq_lun;
 	struct ln_hrz_posn hrz_lun;
-	ln_get_lunar_equ_coords (JD, &eq_lun);
-	ln_get_hrz_from_equ (&eq_lun, rts2core::Configuration::instance ()->getObserver (), JD, &hrz_lun);
+	rts2core::LunarEphemeris::instance ()->getHrzPosition (&hrz_lun, JD, rts2core::Configuration::instance ()->getObserver ());
 	if (nextJD)
 		*nextJD = 0;
 	return isBetween (hrz_lun.alt);
 }
 
+int ConstraintLunarAltitude::getScanStep (Target *tar, int step)
+{
+	return max (step, CONSTRAINT_SCAN_STEP);
+}
+
 bool ConstraintLunarPhase::satisfy (Target *tar, double JD, double *nextJD)
 {
 	if (nextJD)
 		*nextJD = 0;
-	return isBetween (ln_get_lunar_phase (JD));
+	return isBetween (rts2core::LunarEphemeris::instance ()->getPhase (JD));
+}
+
+int ConstraintLunarPhase::getScanStep (Target *tar, int step)
+{
+	return max (step, CONSTRAINT_SCAN_STEP);
 }
 
 bool ConstraintSolarDistance::satisfy (Target *tar, double JD, double *nextJD)
@@ -558,17 +676,25 @@ bool ConstraintSolarDistance::satisfy (Target *tar, double JD, double *nextJD)
 	return isBetween (sd);
 }
 
+int ConstraintSolarDistance::getScanStep (Target *tar, int step)
+{
+	return slowScanStep (tar, step);
+}
+
 bool ConstraintSunAltitude::satisfy (Target *tar, double JD, double *nextJD)
 {
-	struct ln_equ_posn eq_sun;
 	struct ln_hrz_posn hrz_sun;
-	ln_get_solar_equ_coords (JD, &eq_sun);
-	ln_get_hrz_from_equ (&eq_sun, rts2core::Configuration::instance ()->getObserver (), JD, &hrz_sun);
+	rts2core::SolarEphemeris::instance ()->getHrzPosition (&hrz_sun, JD, rts2core::Configuration::instance ()->getObserver ());
 	if (nextJD)
 		*nextJD = 0;
 	return isBetween (hrz_sun.alt);
 }
 
+int ConstraintSunAltitude::getScanStep (Target *tar, int step)
+{
+	return max (step, CONSTRAINT_SCAN_STEP);
+}
+
 void ConstraintMaxRepeat::load (xmlNodePtr cons)
 {
 	if (!cons->children || !cons->children->content)
@@ -742,14 +868,13 @@ void Constraints::getSatisfiedIntervals (Target *tar, time_t from, time_t to, in
 {
 	satisfiedIntervals.clear ();
 	satisfiedIntervals.push_back (std::pair <time_t, time_t> (from, to));
-	for (Constraints::iterator iter = begin (); iter != end (); iter++)
+	for (Constraints::iterator iter = begin (); iter != end () && !satisfiedIntervals.empty (); iter++)
 	{
+		// intersection - constraint is checked only inside intervals satisfying previous constraints
 		interval_arr_t intervals;
-		iter->second->getSatisfiedIntervals (tar, from, to, step, intervals);
-		// now look for join with current intervals..
-		interval_arr_t ret = satisfiedIntervals;
-		satisfiedIntervals.clear ();
-		mergeIntervals (ret, intervals, satisfiedIntervals);
+		for (interval_arr_t::iterator si = satisfiedIntervals.begin (); si != satisfiedIntervals.end (); si++)
+			iter->second->getSatisfiedIntervals (tar, si->first, si->second, step, intervals);
+		satisfiedIntervals = intervals;
 	}
 }
 
@@ -760,22 +885,26 @@ double Constraints::getSatisfiedDuration (Target *tar, double from, double to, d
 	double to_JD = ln_get_julian_from_timet (&fti);
 	fti = (time_t) (from + length);
 	
-	double t;
 	double from_JD = ln_get_julian_from_timet (&fti);
-	for (t = from_JD; t < to_JD; t += step / 86400.0)
+	if (from_JD >= to_JD)
+		return INFINITY;
+
+	// first change of any constraint
+	double end_JD = to_JD;
+	for (Constraints::iterator iter = begin (); iter != end (); iter++)
 	{
-		if (!satisfy (tar, t))
-		{
-			if (t == from_JD)
-			{
-				return NAN;
-			}
-			time_t ret;
-		  	ln_get_timet_from_julian (t, &ret);
-			return ret;
-		}
+		bool sat;
+		double change = iter->second->getNextChange (tar, from_JD, end_JD, (int) step, sat);
+		if (!sat)
+			return NAN;
+		end_JD = min (end_JD, change);
 	}
-	return INFINITY;
+	if (end_JD >= to_JD)
+		return INFINITY;
+
+	time_t ret;
+	ln_get_timet_from_julian (end_JD, &ret);
+	return ret;
 }
 
 void Constraints::getViolatedIntervals (Target *tar, time_t from, time_t to, int length, int step, interval_arr_t &violatedIntervals)
@@ -909,7 +1038,7 @@ Constraint *Constraints::createConstraint (const char *name)
 	else if (!strcmp (name, CONSTRAINT_LDISTANCE))
 		return new ConstraintLunarDistance ();
 	else if (!strcmp (name, CONSTRAINT_LALTITUDE))
-		return new ConstraintLunarDistance ();
+		return new ConstraintLunarAltitude ();
 	else if (!strcmp (name, CONSTRAINT_LPHASE))
 		return new ConstraintLunarPhase ();
 	else if (!strcmp (name, CONSTRAINT_SDISTANCE))
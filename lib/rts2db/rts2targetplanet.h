@@ -51,6 +51,7 @@ class TargetPlanet:public Target
 
 		virtual void load ();
 		virtual void getPosition (struct ln_equ_posn *pos, double JD);
+		virtual double getEphemerisStep () { return planet_info ? EPHEMCACHE_STEP : NAN; }
 		virtual int getRST (struct ln_rst_time *rst, double JD, double horizon);
 
 		virtual int isContinues ();
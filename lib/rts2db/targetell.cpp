@@ -57,6 +57,7 @@ int EllTarget::orbitFromMPC (const char *mpc)
 	setTargetName (designation.c_str ());
 	setTargetInfo (mpc);
 	setTargetType (TYPE_ELLIPTICAL);
+	clearEphemeris ();
 	return ret;
 }
 
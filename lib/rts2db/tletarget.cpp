@@ -62,6 +62,7 @@ void TLETarget::orbitFromTLE (std::string target_tle)
 		setTargetName (tle.intl_desig);
 		setTargetInfo (target_tle.c_str ());
 		setTargetType (TYPE_TLE);
+		clearEphemeris ();
 		return;
 	}
 	throw rts2core::Error ("cannot parse TLE " + target_tle);
@@ -112,6 +113,15 @@ void TLETarget::getPosition (struct ln_equ_posn *pos, double JD)
 	pos->dec = ln_rad_to_deg (pos->dec);
 }
 
+double TLETarget::getEphemerisStep ()
+{
+	if (tle1.size () == 0 || !is_deep)
+		return NAN;
+	// about 200 samples per orbit, xno is mean motion in radians per minute
+	double step = 2 * M_PI / tle.xno / 1440.0 / 200.0;
+	return step < EPHEMCACHE_STEP ? step : EPHEMCACHE_STEP;
+}
+
 int TLETarget::getRST (struct ln_rst_time *rst, double JD, double horizon)
 {
 	return 0;
@@ -21,6 +21,7 @@
 #include "error.h"
 #include "imghdr.h"
 #include "nan.h"
+#include "statistics.h"
 
 #include <malloc.h>
 #include <string.h>
@@ -41,6 +42,9 @@ Channel::Channel (int16_t _dataType)
 	sizes = NULL;
 
 	pixelSum = average = stdev = NAN;
+
+	histogram = NULL;
+	cutQuantiles = NAN;
 }
 
 Channel::Channel (int ch, char *_data, int _naxis, long *_sizes, int16_t _dataType, bool dealloc)
@@ -58,6 +62,9 @@ Channel::Channel (int ch, char *_data, int _naxis, long *_sizes, int16_t _dataTy
 	memcpy (sizes, _sizes, naxis * sizeof (long));
 
 	pixelSum = average = stdev = NAN;
+
+	histogram = NULL;
+	cutQuantiles = NAN;
 }
 
 
@@ -77,6 +84,9 @@ Channel::Channel (int ch, char *_data, long dataSize, int _naxis, long *_sizes,
 	memcpy (sizes, _sizes, naxis * sizeof (long));
 
 	pixelSum = average = stdev = NAN;
+
+	histogram = NULL;
+	cutQuantiles = NAN;
 }
 
 Channel::~Channel ()
@@ -84,35 +94,19 @@ Channel::~Channel ()
 	if (allocated)
 		delete[] data;
 	delete[] sizes;
+	delete[] histogram;
 }
 
 template <typename pixel_type> void computeDataStatistics (pixel_type *data, long totalPixels, long double &pixelSum, double &average, double &stdev)
 {
-	// calculate average of all channels..
-	pixel_type *pixel = data;
-	pixel_type *fullTop = pixel + totalPixels;
+	rts2core::RunningStatistics stat;
+	stat.add (data, totalPixels);
 
-	pixelSum = 0;
-
-	while (pixel < fullTop)
-	{
-		pixelSum += *pixel;
-		pixel++;
-	}
+	pixelSum = stat.getSum ();
 	if (totalPixels > 0)
 	{
-		average = pixelSum / totalPixels;
-		// calculate stdev
-		pixel = data;
-		stdev = 0;
-		while (pixel < fullTop)
-		{
-			long double tmp_s = *pixel - average;
-			long double tmp_ss = tmp_s * tmp_s;
-			stdev += tmp_ss;
-			pixel++;
-		}
-		stdev = sqrt (stdev / totalPixels);
+		average = stat.getMean ();
+		stdev = stat.getStdev ();
 	}
 	else
 	{
@@ -159,6 +153,84 @@ void Channel::computeStatistics (size_t _from, size_t _dataSize)
 	}
 }
 
+const long *Channel::getHistogram ()
+{
+	if (histogram != NULL)
+		return histogram;
+
+	histogram = new long[65536];
+	memset (histogram, 0, 65536 * sizeof (long));
+
+	switch (dataType)
+	{
+		case RTS2_DATA_USHORT:
+			for (uint16_t *d = (uint16_t *) data; d < ((uint16_t *) data) + getNPixels (); d++)
+				histogram[*d]++;
+			break;
+		case RTS2_DATA_FLOAT:
+			for (float *d = (float *) data; d < ((float *) data) + getNPixels (); d++)
+				histogram[(uint16_t) *d]++;
+			break;
+		default:
+			break;
+	}
+	return histogram;
+}
+
+void Channel::getQuantileCuts (float quantiles, double minval, double mval, double &low, double &high)
+{
+	if (quantiles == cutQuantiles && minval == cutMin && mval == cutMax)
+	{
+		low = cutLow;
+		high = cutHigh;
+		return;
+	}
+
+	const long *hist = getHistogram ();
+
+	long psum = 0;
+	long s = getNPixels ();
+	uint32_t i;
+
+	low = minval;
+	high = minval;
+
+	for (i = 0; i < 65536 && i < mval; i++)
+	{
+		psum += hist[i];
+		if (psum > s * quantiles)
+		{
+			low = i;
+			break;
+		}
+	}
+
+	if (low == minval)
+	{
+		high = mval;
+	}
+	else
+	{
+		for (; i < 65536 && i < mval; i++)
+		{
+			psum += hist[i];
+			if (psum > s * (1 - quantiles))
+			{
+				high = i;
+				break;
+			}
+		}
+		if (high == minval)
+			high = mval;
+	}
+
+	cutQuantiles = quantiles;
+	cutMin = minval;
+	cutMax = mval;
+	cutLow = low;
+	cutHigh = high;
+}
+
 Channels::Channels ()
 {
 }
@@ -28,6 +28,7 @@
 #include "rts2target.h"
 #include "valuestat.h"
 #include "valuerectangle.h"
+#include "statistics.h"
 
 #include "imgdisplay.h"
 
@@ -1102,67 +1103,94 @@ void Image::getImgHeader (struct imghdr *im_h, int chan)
 
 void Image::getHistogram (long *histogram, long nbins)
 {
-	memset (histogram, 0, nbins * sizeof(int));
-	int bins;
+	memset (histogram, 0, nbins * sizeof (long));
 	if (channels.size () == 0)
 		loadChannels ();
 
-	switch (dataType)
+	int bins = 65536 / nbins;
+	for (Channels::iterator iter = channels.begin (); iter != channels.end (); iter++)
 	{
-		case RTS2_DATA_USHORT:
-			bins = 65536 / nbins;
-			for (Channels::iterator iter = channels.begin (); iter != channels.end (); iter++)
-			{
-				for (uint16_t *d = (uint16_t *)((*iter)->getData ()); d < ((uint16_t *)((*iter)->getData ())) + ((*iter)->getNPixels ()); d++)
-				{
-					histogram[*d / bins]++;
-				}
-			}
-			break;
-		case RTS2_DATA_FLOAT:
-			bins = 65536 / nbins;
-			for (Channels::iterator iter = channels.begin (); iter != channels.end (); iter++)
-			{
-				for (float *d = (float *)((*iter)->getData ()); d < ((float *)((*iter)->getData ())) + ((*iter)->getNPixels ()); d++)
-				{
-					histogram[((uint16_t)*d) / bins]++;
-				}
-			}
-			break;
-		default:
-			break;
+		const long *hist = (*iter)->getHistogram ();
+		for (int i = 0; i < 65536; i++)
+			histogram[i / bins] += hist[i];
 	}
 }
 
 void Image::getChannelHistogram (int chan, long *histogram, long nbins)
 {
-	memset (histogram, 0, nbins * sizeof(int));
-	int bins;
+	memset (histogram, 0, nbins * sizeof (long));
 	if (channels.size () == 0)
 		loadChannels ();
 
-	switch (dataType)
+	int bins = 65536 / nbins;
+	const long *hist = channels[chan]->getHistogram ();
+	for (int i = 0; i < 65536; i++)
+		histogram[i / bins] += hist[i];
+}
+
+/**
+ * Lookup table parameters for pixel scaling. Tables are used for data
+ * types with at most 16 bits, size is 0 for other types.
+ */
+template <typename dt> struct PixelLUT
+{
+	enum { size = 0 };
+	static size_t index (dt pix) { return 0; }
+};
+
+template <> struct PixelLUT <signed char>
+{
+	enum { size = 256 };
+	static size_t index (signed char pix) { return (unsigned char) pix; }
+};
+
+template <> struct PixelLUT <unsigned char>
+{
+	enum { size = 256 };
+	static size_t index (unsigned char pix) { return pix; }
+};
+
+template <> struct PixelLUT <int16_t>
+{
+	enum { size = 65536 };
+	static size_t index (int16_t pix) { return (uint16_t) pix; }
+};
+
+template <> struct PixelLUT <uint16_t>
+{
+	enum { size = 65536 };
+	static size_t index (uint16_t pix) { return pix; }
+};
+
+template <typename bt, typename dt> bt grayscalePixel (dt pix, bt black, dt low, dt high)
+{
+	if (pix <= low)
+		return black;
+	if (pix >= high)
+		return 0;
+	// linear scaling
+	return black - black * ((double (pix - low)) / (high - low));
+}
+
+template <typename dt> void Image::getChannelCuts (int chan, dt minval, dt mval, float quantiles, dt &low, dt &high)
+{
+	if (channels.size () == 0)
+		loadChannels ();
+
+	double l, h;
+	channels[chan]->getQuantileCuts (quantiles, minval, mval, l, h);
+
+	// cuts are histogram bins, or full range when quantile was not found
+	low = minval;
+	high = mval;
+	if (l != (double) minval)
 	{
-		case RTS2_DATA_USHORT:
-			bins = 65536 / nbins;
-			for (uint16_t *d = (uint16_t *)(channels[chan]->getData ()); d < ((uint16_t *)(channels[chan]->getData ()) + channels[chan]->getNPixels ()); d++)
-			{
-				histogram[*d / bins]++;
-			}
-			break;
-		case RTS2_DATA_FLOAT:
-			bins = 65536 / nbins;
-			for (float *d = (float *)(channels[chan]->getData ()); d < ((float *)(channels[chan]->getData ()) + channels[chan]->getNPixels ()); d++)
-			{
-				histogram[((uint16_t)*d) / bins]++;
-			}
-			break;
-		default:
-			break;
+		low = l;
+		if (h != (double) mval)
+			high = h;
 	}
 }
 
-
 template <typename bt, typename dt> void Image::getChannelGrayscaleByteBuffer (int chan, bt * &buf, bt black, dt low, dt high, long s, size_t offset, bool invert_y)
 {
 	if (buf == NULL)
@@ -1178,24 +1206,22 @@ template <typename bt, typename dt> void Image::getChannelGrayscaleByteBuffer (i
 	int chw = getChannelWidth (chan);
 	int j = chw;
 
+	// precompute scaled values of all possible pixel values
+	bt *lut = NULL;
+	if (PixelLUT <dt>::size > 0)
+	{
+		lut = new bt[PixelLUT <dt>::size];
+		for (size_t u = 0; u < (size_t) PixelLUT <dt>::size; u++)
+			lut[u] = grayscalePixel ((dt) u, black, low, high);
+	}
+
 	for (int i = 0; (long) i < s; i++)
 	{
-		bt n;
 		dt pix = ((dt *)imageData)[i];
-		if (pix <= low)
-		{
-			n = black;
-		}
-		else if (pix >= high)
-		{
-			n = 0;
-		}
+		if (lut)
+			*k = lut[PixelLUT <dt>::index (pix)];
 		else
-		{
-			// linear scaling
-			n = black - black * ((double (pix - low)) / (high - low));
-		}
-		*k = n;
+			*k = grayscalePixel (pix, black, low, high);
 		k++;
 		if (offset != 0 || invert_y)
 		{
@@ -1210,56 +1236,15 @@ template <typename bt, typename dt> void Image::getChannelGrayscaleByteBuffer (i
 			}
 		}
 	}
+	delete[] lut;
 }
 
 
 template <typename bt, typename dt> void Image::getChannelGrayscaleBuffer (int chan, bt * &buf, bt black, dt minval, dt mval, float quantiles, size_t offset, bool invert_y)
 {
-	long hist[65536];
-	getChannelHistogram (chan, hist, 65536);
-
-	long psum = 0;
-	dt low = minval;
-	dt high = minval;
-
-	uint32_t i;
-
-	long s = getChannelNPixels (chan);
-
-	// find quantiles
-	for (i = 0; (dt) i < mval; i++)
-	{
-		psum += hist[i];
-		if (psum > s * quantiles)
-		{
-			low = i;
-			break;
-		}
-	}
-
-	if (low == minval)
-	{
-		low = minval;
-		high = mval;
-	}
-	else
-	{
-		for (; (dt) i < mval; i++)
-		{
-			psum += hist[i];
-			if (psum > s * (1 - quantiles))
-			{
-				high = i;
-				break;
-			}
-		}
-		if (high == minval)
-		{
-			high = mval;
-		}
-	}
-
-	getChannelGrayscaleByteBuffer (chan, buf, black, low, high, s, offset, invert_y);
+	dt low, high;
+	getChannelCuts (chan, minval, mval, quantiles, low, high);
+	getChannelGrayscaleByteBuffer (chan, buf, black, low, high, getChannelNPixels (chan), offset, invert_y);
 }
 
 void Image::getChannelGrayscaleImage (int _dataType, int chan, unsigned char * &buf, float quantiles, size_t offset)
@@ -1301,13 +1286,113 @@ void Image::getChannelGrayscaleImage (int _dataType, int chan, unsigned char * &
 
 
 
+template <typename bt, typename dt> void pseudocolourPixel (dt pix, dt low, dt high, int colourVariant, bt &nR, bt &nG, bt &nB)
+{
+	double n;
+
+	if ( pix < low )
+		pix = low;
+	if ( pix > high )
+		pix = high;
+
+	switch (colourVariant)
+	{
+		case PSEUDOCOLOUR_VARIANT_GREY:
+			n = 255.0 * double (pix - low) / double (high - low);
+			nR = n;
+			nG = nR;
+			nB = nR;
+			break;
+		case PSEUDOCOLOUR_VARIANT_GREY_INV:
+			n = 255.0 * ( 1.0 - double (pix - low) / double (high - low) );
+			nR = n;
+			nG = nR;
+			nB = nR;
+			break;
+		case PSEUDOCOLOUR_VARIANT_BLUE:
+			n = 511.0 * double (pix - low) / double (high - low);
+			nR = ((n - 256.0) > 0.0) ? n - 256.0 : 0;
+			nG = n / 2.0;
+			nB = (n < 256.0) ? n : 255;
+			break;
+		case PSEUDOCOLOUR_VARIANT_BLUE_INV:
+			n = 511.0 * ( 1.0 - double (pix - low) / double (high - low) );
+			nR = ((n - 256.0) > 0.0) ? n - 256.0 : 0;
+			nG = n / 2.0;
+			nB = (n < 256.0) ? n : 255;
+			break;
+		case PSEUDOCOLOUR_VARIANT_RED:
+			n = 511.0 * double (pix - low) / double (high - low);
+			nR = (n < 256.0) ? n : 255;
+			nG = n / 2.0;
+			nB = ((n - 256.0) > 0.0) ? n - 256.0 : 0;
+			break;
+		case PSEUDOCOLOUR_VARIANT_RED_INV:
+			n = 511.0 * ( 1.0 - double (pix - low) / double (high - low) );
+			nR = (n < 256.0) ? n : 255;
+			nG = n / 2.0;
+			nB = ((n - 256.0) > 0.0) ? n - 256.0 : 0;
+			break;
+		case PSEUDOCOLOUR_VARIANT_GREEN:
+			n = 511.0 * double (pix - low) / double (high - low);
+			nR = n / 2.0;
+			nG = (n < 256.0) ? n : 255;
+			nB = ((n - 256.0) > 0.0) ? n - 256.0 : 0;
+			break;
+		case PSEUDOCOLOUR_VARIANT_GREEN_INV:
+			n = 511.0 * ( 1.0 - double (pix - low) / double (high - low) );
+			nR = n / 2.0;
+			nG = (n < 256.0) ? n : 255;
+			nB = ((n - 256.0) > 0.0) ? n - 256.0 : 0;
+			break;
+		case PSEUDOCOLOUR_VARIANT_VIOLET:
+			n = 511.0 * double (pix - low) / double (high - low);
+			nR = n / 2.0;
+			nG = ((n - 256.0) > 0.0) ? n - 256.0 : 0;
+			nB = (n < 256.0) ? n : 255;
+			break;
+		case PSEUDOCOLOUR_VARIANT_VIOLET_INV:
+			n = 511.0 * ( 1.0 - double (pix - low) / double (high - low) );
+			nR = n / 2.0;
+			nG = ((n - 256.0) > 0.0) ? n - 256.0 : 0;
+			nB = (n < 256.0) ? n : 255;
+			break;
+		case PSEUDOCOLOUR_VARIANT_MAGENTA:
+			n = 511.0 * double (pix - low) / double (high - low);
+			nR = (n < 256.0) ? n : 255;
+			nG = ((n - 256.0) > 0.0) ? n - 256.0 : 0;
+			nB = n / 2.0;
+			break;
+		case PSEUDOCOLOUR_VARIANT_MAGENTA_INV:
+			n = 511.0 * ( 1.0 - double (pix - low) / double (high - low) );
+			nR = (n < 256.0) ? n : 255;
+			nG = ((n - 256.0) > 0.0) ? n - 256.0 : 0;
+			nB = n / 2.0;
+			break;
+		case PSEUDOCOLOUR_VARIANT_MALACHIT:
+			n = 511.0 * double (pix - low) / double (high - low);
+			nR = ((n - 256.0) > 0.0) ? n - 256.0 : 0;
+			nG = (n < 256.0) ? n : 255;
+			nB = n / 2.0;
+			break;
+		case PSEUDOCOLOUR_VARIANT_MALACHIT_INV:
+			n = 511.0 * ( 1.0 - double (pix - low) / double (high - low) );
+			nR = ((n - 256.0) > 0.0) ? n - 256.0 : 0;
+			nG = (n < 256.0) ? n : 255;
+			nB = n / 2.0;
+			break;
+		default:
+			nR = nG = nB = 0;
+	}
+}
+
 template <typename bt, typename dt> void Image::getChannelPseudocolourByteBuffer (int chan, bt * &buf, bt black, dt low, dt high, long s, size_t offset, bool invert_y, int colourVariant)
 {
 	if (buf == NULL)
 		buf = new bt[3 * s];
-	
-	double n;
-	bt nR, nG, nB;
+
+	if (colourVariant < PSEUDOCOLOUR_VARIANT_GREY || colourVariant > PSEUDOCOLOUR_VARIANT_MALACHIT_INV)
+		logStream (MESSAGE_ERROR) << "Unknown colourVariant" << colourVariant << sendLog;
 
 	bt *k = buf;
 
@@ -1319,111 +1404,31 @@ template <typename bt, typename dt> void Image::getChannelPseudocolourByteBuffer
 	int chw = getChannelWidth (chan);
 	int j = chw;
 
+	// precompute colours of all possible pixel values
+	bt *lut = NULL;
+	if (PixelLUT <dt>::size > 0)
+	{
+		lut = new bt[3 * PixelLUT <dt>::size];
+		for (size_t u = 0; u < (size_t) PixelLUT <dt>::size; u++)
+			pseudocolourPixel ((dt) u, low, high, colourVariant, lut[3 * u], lut[3 * u + 1], lut[3 * u + 2]);
+	}
+
 	for (int i = 0; (long) i < s; i++)
 	{
 		dt pix = ((dt *)imageData)[i];
 
-		if ( pix < low )
-			pix = low;
-		if ( pix > high )
-			pix = high;
-
-		switch (colourVariant)
+		if (lut)
 		{
-			case PSEUDOCOLOUR_VARIANT_GREY:
-				n = 255.0 * double (pix - low) / double (high - low);
-				nR = n;
-				nG = nR;
-				nB = nR;
-				break;
-			case PSEUDOCOLOUR_VARIANT_GREY_INV:
-				n = 255.0 * ( 1.0 - double (pix - low) / double (high - low) );
-				nR = n;
-				nG = nR;
-				nB = nR;
-				break;
-			case PSEUDOCOLOUR_VARIANT_BLUE:
-				n = 511.0 * double (pix - low) / double (high - low);
-				nR = ((n - 256.0) > 0.0) ? n - 256.0 : 0;
-				nG = n / 2.0;
-				nB = (n < 256.0) ? n : 255;
-				break;
-			case PSEUDOCOLOUR_VARIANT_BLUE_INV:
-				n = 511.0 * ( 1.0 - double (pix - low) / double (high - low) );
-				nR = ((n - 256.0) > 0.0) ? n - 256.0 : 0;
-				nG = n / 2.0;
-				nB = (n < 256.0) ? n : 255;
-				break;
-			case PSEUDOCOLOUR_VARIANT_RED:
-				n = 511.0 * double (pix - low) / double (high - low);
-				nR = (n < 256.0) ? n : 255;
-				nG = n / 2.0;
-				nB = ((n - 256.0) > 0.0) ? n - 256.0 : 0;
-				break;
-			case PSEUDOCOLOUR_VARIANT_RED_INV:
-				n = 511.0 * ( 1.0 - double (pix - low) / double (high - low) );
-				nR = (n < 256.0) ? n : 255;
-				nG = n / 2.0;
-				nB = ((n - 256.0) > 0.0) ? n - 256.0 : 0;
-				break;
-			case PSEUDOCOLOUR_VARIANT_GREEN:
-				n = 511.0 * double (pix - low) / double (high - low);
-				nR = n / 2.0;
-				nG = (n < 256.0) ? n : 255;
-				nB = ((n - 256.0) > 0.0) ? n - 256.0 : 0;
-				break;
-			case PSEUDOCOLOUR_VARIANT_GREEN_INV:
-				n = 511.0 * ( 1.0 - double (pix - low) / double (high - low) );
-				nR = n / 2.0;
-				nG = (n < 256.0) ? n : 255;
-				nB = ((n - 256.0) > 0.0) ? n - 256.0 : 0;
-				break;
-			case PSEUDOCOLOUR_VARIANT_VIOLET:
-				n = 511.0 * double (pix - low) / double (high - low);
-				nR = n / 2.0;
-				nG = ((n - 256.0) > 0.0) ? n - 256.0 : 0;
-				nB = (n < 256.0) ? n : 255;
-				break;
-			case PSEUDOCOLOUR_VARIANT_VIOLET_INV:
-				n = 511.0 * ( 1.0 - double (pix - low) / double (high - low) );
-				nR = n / 2.0;
-				nG = ((n - 256.0) > 0.0) ? n - 256.0 : 0;
-				nB = (n < 256.0) ? n : 255;
-				break;
-			case PSEUDOCOLOUR_VARIANT_MAGENTA:
-				n = 511.0 * double (pix - low) / double (high - low);
-				nR = (n < 256.0) ? n : 255;
-				nG = ((n - 256.0) > 0.0) ? n - 256.0 : 0;
-				nB = n / 2.0;
-				break;
-			case PSEUDOCOLOUR_VARIANT_MAGENTA_INV:
-				n = 511.0 * ( 1.0 - double (pix - low) / double (high - low) );
-				nR = (n < 256.0) ? n : 255;
-				nG = ((n - 256.0) > 0.0) ? n - 256.0 : 0;
-				nB = n / 2.0;
-				break;
-			case PSEUDOCOLOUR_VARIANT_MALACHIT:
-				n = 511.0 * double (pix - low) / double (high - low);
-				nR = ((n - 256.0) > 0.0) ? n - 256.0 : 0;
-				nG = (n < 256.0) ? n : 255;
-				nB = n / 2.0;
-				break;
-			case PSEUDOCOLOUR_VARIANT_MALACHIT_INV:
-				n = 511.0 * ( 1.0 - double (pix - low) / double (high - low) );
-				nR = ((n - 256.0) > 0.0) ? n - 256.0 : 0;
-				nG = (n < 256.0) ? n : 255;
-				nB = n / 2.0;
-				break;
-			default:
-				logStream (MESSAGE_ERROR) << "Unknown colourVariant" << colourVariant << sendLog;
+			bt *c = lut + 3 * PixelLUT <dt>::index (pix);
+			k[0] = c[0];
+			k[1] = c[1];
+			k[2] = c[2];
 		}
-
-		*k = nR;
-		k++;
-		*k = nG;
-		k++;
-		*k = nB;
-		k++;
+		else
+		{
+			pseudocolourPixel (pix, low, high, colourVariant, k[0], k[1], k[2]);
+		}
+		k += 3;
 		if (offset != 0 || invert_y)
 		{
 			j--;
@@ -1437,56 +1442,15 @@ template <typename bt, typename dt> void Image::getChannelPseudocolourByteBuffer
 			}
 		}
 	}
+	delete[] lut;
 }
 
 
 template <typename bt, typename dt> void Image::getChannelPseudocolourBuffer (int chan, bt * &buf, bt black, dt minval, dt mval, float quantiles, size_t offset, bool invert_y, int colourVariant)
 {
-	long hist[65536];
-	getChannelHistogram (chan, hist, 65536);
-
-	long psum = 0;
-	dt low = minval;
-	dt high = minval;
-
-	uint32_t i;
-
-	long s = getChannelNPixels (chan);
-
-	// find quantiles
-	for (i = 0; (dt) i < mval; i++)
-	{
-		psum += hist[i];
-		if (psum > s * quantiles)
-		{
-			low = i;
-			break;
-		}
-	}
-
-	if (low == minval)
-	{
-		low = minval;
-		high = mval;
-	}
-	else
-	{
-		for (; (dt) i < mval; i++)
-		{
-			psum += hist[i];
-			if (psum > s * (1 - quantiles))
-			{
-				high = i;
-				break;
-			}
-		}
-		if (high == minval)
-		{
-			high = mval;
-		}
-	}
-
-	getChannelPseudocolourByteBuffer (chan, buf, black, low, high, s, offset, invert_y, colourVariant);
+	dt low, high;
+	getChannelCuts (chan, minval, mval, quantiles, low, high);
+	getChannelPseudocolourByteBuffer (chan, buf, black, low, high, getChannelNPixels (chan), offset, invert_y, colourVariant);
 }
 
 
@@ -2161,18 +2125,9 @@ int Image::addStarData (struct stardata *sr)
 	return 0;
 }
 
-static int shortcompare (const void *val1, const void *val2)
-{
-	return (*(unsigned short *) val1 < *(unsigned short *) val2) ? -1 :
-	((*(unsigned short *) val1 == *(unsigned short *) val2) ? 0 : 1);
-}
-
 unsigned short getShortMean (unsigned short *averageData, int sub)
 {
-	qsort (averageData, sub, sizeof (unsigned short), shortcompare);
-	if (sub % 2)
-		return averageData[sub / 2];
-	return (averageData[(sub / 2) - 1] + averageData[(sub / 2)]) / 2;
+	return rts2core::selectMedian (averageData, sub);
 }
 
 long Image::getSumNPixels ()
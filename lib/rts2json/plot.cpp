@@ -27,6 +27,7 @@
 #include "expander.h"
 #include "libnova_cpp.h"
 #include "configuration.h"
+#include "ephemcache.h"
 
 using namespace rts2json;
 
@@ -211,10 +212,8 @@ void Plot::plotXSunAlt ()
 	for (unsigned int x = 0; x < size.width () - y_axis_width; x++)
 	{
 		double j = JD + (x * p_scale) / 86400;
-		struct ln_equ_posn pos;
 		struct ln_hrz_posn hrz;
-		ln_get_solar_equ_coords (j, &pos);
-		ln_get_hrz_from_equ (&pos, rts2core::Configuration::instance ()->getObserver (), j, &hrz);
+		rts2core::SolarEphemeris::instance ()->getHrzPosition (&hrz, j, rts2core::Configuration::instance ()->getObserver ());
 		double nh;
 		double dh;
 		rts2core::Configuration::instance ()->getDouble ("observatory", "night_horizon", nh, -10);
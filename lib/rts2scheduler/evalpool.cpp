@@ -0,0 +1,144 @@
+/*
+ * Pool of threads evaluating schedules.
+ * Copyright (C) 2026 Petr Kubanek <petr@kubanek.net>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "rts2scheduler/evalpool.h"
+
+#include <string.h>
+
+// number of schedules taken by a thread at once
+#define EVALPOOL_CHUNK    4
+
+using namespace rts2sched;
+
+EvaluationPool::EvaluationPool (int _threads)
+{
+	threads = 0;
+	workers = NULL;
+
+	schedules = NULL;
+	objectives = NULL;
+	constraints = NULL;
+
+	next = 0;
+	busy = 0;
+	job = 0;
+	stop = false;
+
+	pthread_mutex_init (&mutex, NULL);
+	pthread_cond_init (&jobCond, NULL);
+	pthread_cond_init (&doneCond, NULL);
+
+	if (_threads <= 1)
+		return;
+
+	workers = new pthread_t[_threads - 1];
+	for (int i = 0; i < _threads - 1; i++)
+	{
+		int ret = pthread_create (workers + i, NULL, runWorker, this);
+		if (ret)
+		{
+			logStream (MESSAGE_ERROR) << "cannot start schedule evaluation thread: " << strerror (ret) << sendLog;
+			break;
+		}
+		threads++;
+	}
+}
+
+EvaluationPool::~EvaluationPool ()
+{
+	pthread_mutex_lock (&mutex);
+	stop = true;
+	pthread_cond_broadcast (&jobCond);
+	pthread_mutex_unlock (&mutex);
+
+	for (int i = 0; i < threads; i++)
+		pthread_join (workers[i], NULL);
+	delete[] workers;
+
+	pthread_mutex_destroy (&mutex);
+	pthread_cond_destroy (&jobCond);
+	pthread_cond_destroy (&doneCond);
+}
+
+void EvaluationPool::evaluate (std::vector <Rts2Schedule *> &_schedules, std::list <objFunc> &_objectives, std::list <constraintFunc> &_constraints)
+{
+	if (threads == 0)
+	{
+		for (std::vector <Rts2Schedule *>::iterator iter = _schedules.begin (); iter != _schedules.end (); iter++)
+			(*iter)->evaluate (_objectives, _constraints);
+		return;
+	}
+
+	pthread_mutex_lock (&mutex);
+	schedules = &_schedules;
+	objectives = &_objectives;
+	constraints = &_constraints;
+	next = 0;
+	job++;
+	pthread_cond_broadcast (&jobCond);
+
+	evaluateJob ();
+
+	while (busy > 0)
+		pthread_cond_wait (&doneCond, &mutex);
+
+	schedules = NULL;
+	pthread_mutex_unlock (&mutex);
+}
+
+void *EvaluationPool::runWorker (void *arg)
+{
+	EvaluationPool *pool = (EvaluationPool *) arg;
+	unsigned long seen = 0;
+
+	pthread_mutex_lock (&(pool->mutex));
+	while (true)
+	{
+		while (!pool->stop && pool->job == seen)
+			pthread_cond_wait (&(pool->jobCond), &(pool->mutex));
+		if (pool->stop)
+			break;
+		seen = pool->job;
+		pool->evaluateJob ();
+		if (pool->busy == 0)
+			pthread_cond_broadcast (&(pool->doneCond));
+	}
+	pthread_mutex_unlock (&(pool->mutex));
+	return NULL;
+}
+
+void EvaluationPool::evaluateJob ()
+{
+	while (schedules != NULL && next < schedules->size ())
+	{
+		size_t i = next;
+		size_t end = next + EVALPOOL_CHUNK;
+		if (end > schedules->size ())
+			end = schedules->size ();
+		next = end;
+		busy++;
+
+		pthread_mutex_unlock (&mutex);
+		for (; i < end; i++)
+			(*schedules)[i]->evaluate (*objectives, *constraints);
+		pthread_mutex_lock (&mutex);
+
+		busy--;
+	}
+}
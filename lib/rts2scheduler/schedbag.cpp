@@ -212,6 +212,8 @@ Rts2SchedBag::Rts2SchedBag (double _JDstart, double _JDend)
 
 	ticketSet = new rts2sched::TicketSet ();
 
+	evalPool = NULL;
+
 	mutationNum = -1;
 	popSize = 0;
 
@@ -244,10 +246,37 @@ Rts2SchedBag::~Rts2SchedBag (void)
 	}
 	clear ();
 
+	delete evalPool;
 	delete ticketSet;
 	delete tarSet;
 }
 
+void Rts2SchedBag::setThreads (int _threads)
+{
+	delete evalPool;
+	evalPool = NULL;
+	if (_threads > 1)
+		evalPool = new rts2sched::EvaluationPool (_threads);
+}
+
+void Rts2SchedBag::prepareEvaluation ()
+{
+	rts2db::AccountSet::instance ();
+	// creates target position caches
+	for (rts2sched::TicketSet::iterator iter = ticketSet->begin (); iter != ticketSet->end (); iter++)
+	{
+		struct ln_hrz_posn hrz;
+		iter->second->getTarget ()->getAltAz (&hrz, JDstart);
+	}
+}
+
+void Rts2SchedBag::evaluate (std::list <objFunc> &_objectives)
+{
+	if (evalPool == NULL)
+		return;
+	evalPool->evaluate (*this, _objectives, constraints);
+}
+
 int Rts2SchedBag::constructSchedules (int num)
 {
 	struct ln_lnlat_posn *observer = rts2core::Configuration::instance ()->getObserver ();
@@ -259,6 +288,8 @@ int Rts2SchedBag::constructSchedules (int num)
 		return -1;
 	}
 
+	prepareEvaluation ();
+
 	for (int i = 0; i < num; i++)
 	{
 		Rts2Schedule *sched = new Rts2Schedule (JDstart, JDend, minObsDuration, observer);
@@ -307,6 +338,8 @@ int Rts2SchedBag::constructSchedulesFromObsSet (int num, struct ln_date *obsNigh
 		return -1;
 	}
 
+	prepareEvaluation ();
+
 	for (int i = 0; i < num; i++)
 	{
 		Rts2Schedule *sched = new Rts2Schedule (JDstart, JDend, minObsDuration, observer);
@@ -397,6 +430,9 @@ void Rts2SchedBag::doGAStep ()
 {
 	Rts2SchedBag::iterator iter;
 
+	std::list <objFunc> single (1, SINGLE);
+	evaluate (single);
+
 	// only the best..
 	pickElite (popSize / 2);
 
@@ -453,36 +489,52 @@ void Rts2SchedBag::doGAStep ()
 	}
 }
 
-int Rts2SchedBag::dominatesNSGA (Rts2Schedule *sched1, Rts2Schedule *sched2)
+/**
+ * Constraint violations and objectives of a schedule, used for
+ * non-dominated sorting.
+ */
+struct NSGACriteria
+{
+	Rts2Schedule *sched;
+	std::vector <double> cons;
+	// NaN objectives are replaced by -INFINITY
+	std::vector <double> obj;
+};
+
+/**
+ * Dominance operator. Schedule which does not violate a constraint
+ * violated by the other schedule dominates; constraints are checked in
+ * order. Otherwise violations of constraints violated by both schedules
+ * (lower is better) and objectives (higher is better) are compared.
+ *
+ * @return <ul><li>-1 if first schedule dominates second</li><li>1 if second schedule dominates first</li><li>0 if schedules are equal</li>
+ */
+static int dominatesNSGA (const NSGACriteria &c1, const NSGACriteria &c2)
 {
-	// check for constraints
 	bool dom1 = false;
 	bool dom2 = false;
-	for (std::list <constraintFunc>::iterator constIter  = constraints.begin (); constIter != constraints.end (); constIter++)
+	size_t i;
+	for (i = 0; i < c1.cons.size (); i++)
 	{
-		double cons1 = sched1->getConstraintFunction (*constIter);
-		double cons2 = sched2->getConstraintFunction (*constIter);
 		// if some schedule violate, prefer the one which does not violate..
-		if (cons1 == 0 && cons2 > 0)
+		if (c1.cons[i] == 0 && c2.cons[i] > 0)
 		  	return -1;
-		if (cons1 > 0 && cons2 == 0)
+		if (c1.cons[i] > 0 && c2.cons[i] == 0)
 			return 1;
 		// if both are infeasible, prefer one which is closer to be feasible
-		if (cons1 > 0 && cons2 > 0)
+		if (c1.cons[i] > 0 && c2.cons[i] > 0)
 		{
-			if (cons1 < cons2)
+			if (c1.cons[i] < c2.cons[i])
 				dom1 = true;
-			else if (cons1 > cons2)
+			else if (c1.cons[i] > c2.cons[i])
 			  	dom2 = true;
 		}
 	}
-	for (std::list <objFunc>::iterator objIter = objectives.begin (); objIter != objectives.end (); objIter++)
+	for (i = 0; i < c1.obj.size (); i++)
 	{
-		double obj1 = sched1->getObjectiveFunction (*objIter);
-		double obj2 = sched2->getObjectiveFunction (*objIter);
-		if (obj1 > obj2)
+		if (c1.obj[i] > c2.obj[i])
 			dom1 = true;
-		else if (obj2 > obj1)
+		else if (c2.obj[i] > c1.obj[i])
 		  	dom2 = true;
 	}
 	if (dom1 && !dom2)
@@ -492,65 +544,99 @@ int Rts2SchedBag::dominatesNSGA (Rts2Schedule *sched1, Rts2Schedule *sched2)
 	return 0;
 }
 
-void Rts2SchedBag::calculateNSGARanks ()
+/**
+ * Lexicographic order of schedules - by constraints feasibility, by
+ * violations and by objectives. Schedule can be dominated only by a
+ * schedule which precedes it in this order.
+ */
+struct NSGACriteriaOrder
 {
-	// temporary structure which holds informations about ranks.
-	// Indexed by population (=schedule) number
-	struct {std::list <int> dominates; int dominated;} domStruct[size()];
-	// list of schedules in fronts
-	std::list <int> fronts[size ()];
+	bool operator () (const NSGACriteria *c1, const NSGACriteria *c2) const
+	{
+		size_t i;
+		for (i = 0; i < c1->cons.size (); i++)
+		{
+			if ((c1->cons[i] == 0) != (c2->cons[i] == 0))
+				return c1->cons[i] == 0;
+		}
+		for (i = 0; i < c1->cons.size (); i++)
+		{
+			if (c1->cons[i] != c2->cons[i])
+				return c1->cons[i] < c2->cons[i];
+		}
+		for (i = 0; i < c1->obj.size (); i++)
+		{
+			if (c1->obj[i] != c2->obj[i])
+				return c1->obj[i] > c2->obj[i];
+		}
+		return false;
+	}
+};
+
+// returns true if a member of the front dominates the schedule
+static bool frontDominates (const std::vector <NSGACriteria *> &front, const NSGACriteria &c)
+{
+	// the last added members are the closest to the schedule
+	for (std::vector <NSGACriteria *>::const_reverse_iterator iter = front.rbegin (); iter != front.rend (); iter++)
+	{
+		if (dominatesNSGA (**iter, c) == -1)
+			return true;
+	}
+	return false;
+}
 
+void Rts2SchedBag::calculateNSGARanks ()
+{
 	NSGAfronts.clear ();
 	NSGAfrontsSize.clear ();
 
-	NSGAfronts.push_back (std::vector <Rts2Schedule *> ());
-	NSGAfrontsSize.push_back (0);
+	std::vector <NSGACriteria> criteria (size ());
+	std::vector <NSGACriteria *> sorted;
+	sorted.reserve (size ());
 
 	for (unsigned int p = 0; p < size (); p++)
 	{
-		domStruct[p].dominated = 0;
-		Rts2Schedule *sched_p = (*this)[p];
-		for (unsigned int q = 0; q < size (); q++)
-		{
-		  	// do not calculate for ourselfs..
-			if (p == q)
-				continue;
-			Rts2Schedule *sched_q = (*this)[q];
-			int dom = dominatesNSGA (sched_p, sched_q);
-			if (dom == -1)
-				domStruct[p].dominates.push_back (q);
-			else if (dom == 1)
-			  	domStruct[p].dominated++;
-		}
-		if (domStruct[p].dominated == 0)
+		NSGACriteria &c = criteria[p];
+		c.sched = (*this)[p];
+		for (std::list <constraintFunc>::iterator constIter = constraints.begin (); constIter != constraints.end (); constIter++)
+			c.cons.push_back (c.sched->getConstraintFunction (*constIter));
+		for (std::list <objFunc>::iterator objIter = objectives.begin (); objIter != objectives.end (); objIter++)
 		{
-			sched_p->setNSGARank (0);
-			fronts[0].push_back (p);
-			NSGAfronts[0].push_back (sched_p);
-			NSGAfrontsSize[0]++;
+			double o = c.sched->getObjectiveFunction (*objIter);
+			c.obj.push_back (std::isnan (o) ? -INFINITY : o);
 		}
+		sorted.push_back (&c);
 	}
-	int i = 0;
-	while (fronts[i].size () > 0)
+
+	std::stable_sort (sorted.begin (), sorted.end (), NSGACriteriaOrder ());
+
+	// fronts members
+	std::vector <std::vector <NSGACriteria *> > fronts;
+
+	for (std::vector <NSGACriteria *>::iterator iter = sorted.begin (); iter != sorted.end (); iter++)
 	{
-		NSGAfronts.push_back (std::vector <Rts2Schedule *> ());
-		NSGAfrontsSize.push_back (0);
-		for (std::list <int>::iterator p = fronts[i].begin (); p != fronts[i].end (); p++)
+		// schedule dominated by a member of a front is dominated by a
+		// member of all previous fronts, so binary search can be used
+		size_t lo = 0;
+		size_t hi = fronts.size ();
+		while (lo < hi)
 		{
-			for (std::list <int>::iterator q = domStruct[*p].dominates.begin (); q != domStruct[*p].dominates.end (); q++)
-			{
-				domStruct[*q].dominated--;
-				if (domStruct[*q].dominated == 0)
-				{
-				 	Rts2Schedule *sched_q = (*this)[*q];
-					sched_q->setNSGARank (i + 1);
-					fronts[i + 1].push_back (*q);
-					NSGAfronts[i + 1].push_back (sched_q);
-					NSGAfrontsSize[i + 1]++;
-				}
-			}
+			size_t mid = (lo + hi) / 2;
+			if (frontDominates (fronts[mid], **iter))
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		if (lo == fronts.size ())
+		{
+			fronts.push_back (std::vector <NSGACriteria *> ());
+			NSGAfronts.push_back (std::vector <Rts2Schedule *> ());
+			NSGAfrontsSize.push_back (0);
 		}
-		i++;
+		fronts[lo].push_back (*iter);
+		(*iter)->sched->setNSGARank (lo);
+		NSGAfronts[lo].push_back ((*iter)->sched);
+		NSGAfrontsSize[lo]++;
 	}
 }
 
@@ -620,6 +706,7 @@ Rts2Schedule * Rts2SchedBag::tournamentNSGA (Rts2Schedule *sched1, Rts2Schedule
 void Rts2SchedBag::doNSGAIIStep ()
 {
 	// we hold pointers to both parent and child population used/produced by previous step
+	evaluate (objectives);
 	calculateNSGARanks ();
 	// pick n members as parents of new population
 	Rts2Schedule *new_pop[popSize];
@@ -72,7 +72,7 @@ Rts2Schedule::Rts2Schedule (Rts2Schedule *sched1, Rts2Schedule *sched2, unsigned
 		}
 		else
 		{
-			lastObs = new Rts2SchedObs (parent->getTicket (), parent->getJDStart (), parent->getObsDuration ());
+			lastObs = new Rts2SchedObs (parent, parent->getJDStart ());
 			push_back (lastObs);
 		}
 		obsSec += parent->getTotalDuration ();
@@ -105,7 +105,7 @@ Rts2Schedule::Rts2Schedule (Rts2Schedule *sched1, Rts2Schedule *sched2, unsigned
 		}
 		else
 		{
-			lastObs = new Rts2SchedObs (parent->getTicket (), parent->getJDStart () + obsCorr, parent->getObsDuration ());
+			lastObs = new Rts2SchedObs (parent, parent->getJDStart () + obsCorr);
 			push_back (lastObs);
 		}
 	}
@@ -183,6 +183,7 @@ int Rts2Schedule::constructSchedule (TicketSet *_ticketSet)
 
 void Rts2Schedule::adjustDuration (Rts2Schedule::iterator schedIter, double _sec)
 {
+	nanLazyMerits ();
 	if ((*schedIter)->getTotalDuration () + _sec > minObsDuration)
 	{
 		(*schedIter)->incTotalDuration (_sec);
@@ -222,6 +223,7 @@ void Rts2Schedule::adjustDuration (Rts2Schedule::iterator schedIter, double _sec
 
 void Rts2Schedule::repairStartTimes ()
 {
+	nanLazyMerits ();
 	// now repair observations start times
 	Rts2Schedule::iterator iter = begin ();
 	double start = (*iter)->getJDEnd ();
@@ -476,6 +478,14 @@ unsigned int Rts2Schedule::violatedObsNum ()
 	return violatedObsN;
 }
 
+void Rts2Schedule::evaluate (std::list <objFunc> &_objectives, std::list <constraintFunc> &_constraints)
+{
+	for (std::list <objFunc>::iterator iter = _objectives.begin (); iter != _objectives.end (); iter++)
+		getObjectiveFunction (*iter);
+	for (std::list <constraintFunc>::iterator iter = _constraints.begin (); iter != _constraints.end (); iter++)
+		getConstraintFunction (*iter);
+}
+
 std::ostream & operator << (std::ostream & _os, Rts2Schedule & schedule)
 {
 	for (Rts2Schedule::iterator iter = schedule.begin (); iter != schedule.end (); iter++)
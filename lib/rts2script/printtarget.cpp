@@ -19,6 +19,7 @@
 
 #include "rts2script/printtarget.h"
 #include "utilsfunc.h"
+#include "ephemcache.h"
 
 #define OPT_FULL_DAY	      OPT_LOCAL + 200
 #define OPT_NAME		  OPT_LOCAL + 201
@@ -529,8 +530,8 @@ int PrintTarget::printTargets (rts2db::TargetSet & set)
 
 	if (printGNUplot)
 	{
-		ln_get_body_next_rst_horizon (JD, obs, ln_get_solar_equ_coords, LN_SOLAR_CIVIL_HORIZON, &t_rst);
-		ln_get_body_next_rst_horizon (JD, obs, ln_get_solar_equ_coords, LN_SOLAR_NAUTIC_HORIZON, &n_rst);
+		ln_get_body_next_rst_horizon (JD, obs, rts2core::SolarEphemeris::getEquCoords, LN_SOLAR_CIVIL_HORIZON, &t_rst);
+		ln_get_body_next_rst_horizon (JD, obs, rts2core::SolarEphemeris::getEquCoords, LN_SOLAR_NAUTIC_HORIZON, &n_rst);
 
 		sset = get_norm_hour (t_rst.set);
 		rise = get_norm_hour (t_rst.rise);
@@ -718,12 +719,10 @@ int PrintTarget::printTargets (rts2db::TargetSet & set)
 		if (addMoon)
 		{
 			struct ln_hrz_posn moonHrz;
-			struct ln_equ_posn moonEqu;
 			for (double i = gbeg; i <= gend; i += step)
 			{
 				double jd = jd_start + i / 24.0;
-				ln_get_lunar_equ_coords (jd, &moonEqu);
-				ln_get_hrz_from_equ (&moonEqu, obs, jd, &moonHrz);
+				rts2core::LunarEphemeris::instance ()->getHrzPosition (&moonHrz, jd, obs);
 				std::cout << i << " " << moonHrz.alt << " " << moonHrz.az << std::endl;
 			}
 			std::cout << "e" << std::endl;
@@ -266,6 +266,7 @@ GPointModel::GPointModel (double in_latitude):TelModel (in_latitude)
 	altaz = false;
 	for (int i = 0; i < 9; i++)
 		params[i] = 0;
+	compile ();
 }
 
 GPointModel::~GPointModel (void)
@@ -294,18 +295,7 @@ int GPointModel::load (const char *modelFile)
 
 int GPointModel::apply (struct ln_equ_posn *pos)
 {
-	double d_tar, r_tar;
-	pos->ra = ln_deg_to_rad (pos->ra);
-	pos->dec = ln_deg_to_rad (pos->dec);
-
-	double lat_r = getLatitudeRadians ();
-
-	d_tar = pos->dec - params[0] - params[1] * cos (pos->ra) - params[2] * sin (pos->ra) - params[3] * (cos (lat_r) * sin (pos->dec) * cos (pos->ra) - sin (lat_r) * cos(pos->dec)) - params[8] * cos (pos->ra);
-	r_tar = pos->ra - params[4] - params[5] / cos (pos->dec) - params[6] * tan (pos->dec) - (params[1] * sin (pos->ra) - params[2] * cos (pos->ra)) * tan (pos->dec) - params[3] * cos (lat_r) * sin (pos->ra) / cos (pos->dec) - params[7] * (sin (lat_r) * tan (pos->dec) + cos (lat_r) * cos (pos->ra));
-
-	pos->ra = ln_rad_to_deg (r_tar);
-	pos->dec = ln_rad_to_deg (d_tar);
-
+	applyPosition (pos->ra, pos->dec);
 	return 0;
 }
 
@@ -319,41 +309,8 @@ int GPointModel::applyVerbose (struct ln_equ_posn *pos)
 
 int GPointModel::reverse (struct ln_equ_posn *pos, struct ln_hrz_posn *hrz)
 {
-	double d_tar, r_tar;
-	double az_r, el_r, ha_r, dec_r;
-	az_r = ln_deg_to_rad (hrz->az);
-	el_r = ln_deg_to_rad (hrz->alt);
-	ha_r = ln_deg_to_rad (pos->ra);
-	dec_r = ln_deg_to_rad (pos->dec);
-
-	double lat_r = getLatitudeRadians ();
-
-	d_tar = dec_r
-		+ params[0]
-		+ params[1] * cos (ha_r)
-		+ params[2] * sin (ha_r)
-		+ params[3] * (cos (lat_r) * sin (dec_r) * cos (ha_r) - sin (lat_r) * cos(dec_r))
-		+ params[8] * cos (ha_r);
-
-	r_tar = ha_r
-		+ params[4]
-		+ params[5] / cos (dec_r)
-		+ params[6] * tan (dec_r)
-		+ (params[1] * sin (ha_r) - params[2] * cos (ha_r)) * tan (dec_r)
-		+ params[3] * cos (lat_r) * sin (ha_r) / cos (dec_r)
-		+ params[7] * (sin (lat_r) * tan (dec_r) + cos (lat_r) * cos (ha_r));
-
-	// now handle extra params
-	std::list <ExtraParam *>::iterator it;
-	for (it = extraParamsHa.begin (); it != extraParamsHa.end (); it++)
-		r_tar += (*it)->getValue (az_r, el_r, ha_r, dec_r);
-
-	for (it = extraParamsDec.begin (); it != extraParamsDec.end (); it++)
-		d_tar += (*it)->getValue (az_r, el_r, ha_r, dec_r);
-
-	pos->ra = ln_rad_to_deg (r_tar);
-	pos->dec = ln_rad_to_deg (d_tar);
-
+	ModelArguments args;
+	reversePosition (pos->ra, pos->dec, hrz->az, hrz->alt, args);
 	return 0;
 }
 
@@ -368,41 +325,278 @@ int GPointModel::reverseVerbose (struct ln_equ_posn *pos, struct ln_hrz_posn *hr
 
 void GPointModel::getErrAltAz (struct ln_hrz_posn *hrz, struct ln_equ_posn *equ, struct ln_hrz_posn *err)
 {
-	long double az_r, el_r, ha_r, dec_r;
-	az_r = ln_deg_to_rad (hrz->az);
-	el_r = ln_deg_to_rad (hrz->alt);
-	ha_r = ln_deg_to_rad (equ->ra);
-	dec_r = ln_deg_to_rad (equ->dec);
+	ModelArguments args;
+	errAltAz (hrz->az, hrz->alt, equ->ra, equ->dec, err->az, err->alt, args);
+}
+
+void GPointModel::apply (size_t n, double *ha, double *dec)
+{
+	for (size_t i = 0; i < n; i++)
+		applyPosition (ha[i], dec[i]);
+}
+
+void GPointModel::reverse (size_t n, double *ha, double *dec, const double *az, const double *alt)
+{
+	ModelArguments args;
+	for (size_t i = 0; i < n; i++)
+		reversePosition (ha[i], dec[i], az[i], alt[i], args);
+}
+
+void GPointModel::getErrAltAz (size_t n, double *az, double *alt, const double *ha, const double *dec, double *err_az, double *err_alt)
+{
+	ModelArguments args;
+	for (size_t i = 0; i < n; i++)
+		errAltAz (az[i], alt[i], ha[i], dec[i], err_az[i], err_alt[i], args);
+}
+
+void GPointModel::compile ()
+{
+	for (int i = 0; i < 9; i++)
+		dparams[i] = params[i];
+	sinLat = sin (getLatitudeRadians ());
+	cosLat = cos (getLatitudeRadians ());
+
+	for (int t = 0; t <= GPOINT_LASTTERM; t++)
+		maxHarmonic[t] = 0;
+
+	compileTerms (extraParamsAz, termsAz);
+	compileTerms (extraParamsEl, termsEl);
+	compileTerms (extraParamsHa, termsHa);
+	compileTerms (extraParamsDec, termsDec);
+}
+
+void GPointModel::compileTerms (std::list <ExtraParam *> &extra, std::vector <ModelTerm> &terms)
+{
+	terms.clear ();
+	for (std::list <ExtraParam *>::iterator it = extra.begin (); it != extra.end (); it++)
+	{
+		ModelTerm t;
+		t.function = (*it)->function;
+		t.param = (*it)->params[0];
+		for (int i = 0; i < 2; i++)
+		{
+			t.terms[i] = (*it)->terms[i];
+			t.consts[i] = (*it)->consts[i];
+			t.harmonics[i] = 0;
+			// angles with integer multiple are taken from precalculated tables
+			if (t.terms[i] < GPOINT_PD && t.consts[i] >= 1 && t.consts[i] <= MAX_HARMONIC && t.consts[i] == floor (t.consts[i]))
+			{
+				t.harmonics[i] = (int) t.consts[i];
+				if (maxHarmonic[t.terms[i]] < t.harmonics[i])
+					maxHarmonic[t.terms[i]] = t.harmonics[i];
+			}
+		}
+		terms.push_back (t);
+	}
+}
+
+void GPointModel::fillArguments (ModelArguments &args, double az, double el, double ha, double dec)
+{
+	args.angle[GPOINT_AZ] = az;
+	args.angle[GPOINT_EL] = el;
+	args.angle[GPOINT_ZD] = M_PI / 2.0 - el;
+	args.angle[GPOINT_HA] = ha;
+	args.angle[GPOINT_DEC] = dec;
+	args.angle[GPOINT_PD] = 0;
+	args.angle[GPOINT_LASTTERM] = 0;
+
+	for (int t = 0; t < GPOINT_PD; t++)
+	{
+		if (maxHarmonic[t] == 0)
+			continue;
+		double s1 = sin (args.angle[t]);
+		double c1 = cos (args.angle[t]);
+		args.sin[1][t] = s1;
+		args.cos[1][t] = c1;
+		// sin ((k - 1) x + x) and cos ((k - 1) x + x)
+		for (int k = 2; k <= maxHarmonic[t]; k++)
+		{
+			args.sin[k][t] = args.sin[k - 1][t] * c1 + args.cos[k - 1][t] * s1;
+			args.cos[k][t] = args.cos[k - 1][t] * c1 - args.sin[k - 1][t] * s1;
+		}
+	}
+}
+
+static inline double termArg (ModelTerm &t, int i, ModelArguments &args)
+{
+	return t.consts[i] * args.angle[t.terms[i]];
+}
+
+static inline double termSin (ModelTerm &t, int i, ModelArguments &args)
+{
+	if (t.harmonics[i] > 0)
+		return args.sin[t.harmonics[i]][t.terms[i]];
+	return sin (termArg (t, i, args));
+}
+
+static inline double termCos (ModelTerm &t, int i, ModelArguments &args)
+{
+	if (t.harmonics[i] > 0)
+		return args.cos[t.harmonics[i]][t.terms[i]];
+	return cos (termArg (t, i, args));
+}
+
+double GPointModel::getTermsValue (std::vector <ModelTerm> &terms, ModelArguments &args)
+{
+	double ret = 0;
+	// must match ExtraParam::getValue
+	for (std::vector <ModelTerm>::iterator it = terms.begin (); it != terms.end (); it++)
+	{
+		ModelTerm &t = *it;
+		switch (t.function)
+		{
+			case GPOINT_OFFSET:
+				ret += t.param;
+				break;
+			case GPOINT_SIN:
+				ret += t.param * termSin (t, 0, args);
+				break;
+			case GPOINT_COS:
+				ret += t.param * termCos (t, 0, args);
+				break;
+			case GPOINT_ABSSIN:
+				ret += t.param * fabs (termSin (t, 0, args));
+				break;
+			case GPOINT_ABSCOS:
+				ret += t.param * fabs (termCos (t, 0, args));
+				break;
+			case GPOINT_TAN:
+				ret += t.param * termSin (t, 0, args) / termCos (t, 0, args);
+				break;
+			case GPOINT_CSC:
+				ret += t.param / termCos (t, 0, args);
+				break;
+			case GPOINT_SEC:
+				ret += t.param / termSin (t, 0, args);
+				break;
+			case GPOINT_COT:
+				ret += t.param * termCos (t, 0, args) / termSin (t, 0, args);
+				break;
+			case GPOINT_SINH:
+				ret += t.param * sinh (termArg (t, 0, args));
+				break;
+			case GPOINT_COSH:
+				ret += t.param * cosh (termArg (t, 0, args));
+				break;
+			case GPOINT_TANH:
+				ret += t.param * tanh (termArg (t, 0, args));
+				break;
+			case GPOINT_SECH:
+				ret += t.param / sinh (termArg (t, 0, args));
+				break;
+			case GPOINT_CSCH:
+				ret += t.param / cosh (termArg (t, 0, args));
+				break;
+			case GPOINT_COTH:
+				ret += t.param / tanh (termArg (t, 0, args));
+				break;
+			case GPOINT_SINCOS:
+				ret += t.param * termSin (t, 0, args) * termCos (t, 1, args);
+				break;
+			case GPOINT_COSCOS:
+				ret += t.param * termCos (t, 0, args) * termCos (t, 1, args);
+				break;
+			case GPOINT_SINSIN:
+				ret += termSin (t, 0, args) * termSin (t, 1, args);
+				break;
+			default:
+				break;
+		}
+	}
+	return ret;
+}
+
+void GPointModel::applyPosition (double &ha, double &dec)
+{
+	double ha_r = ln_deg_to_rad (ha);
+	double dec_r = ln_deg_to_rad (dec);
 
-	long double sin_az = sinl (az_r);
-	long double cos_az = cosl (az_r);
-	long double cos_el = cosl (el_r);
-	long double tan_el = tanl (el_r);
+	double sin_ha = sin (ha_r);
+	double cos_ha = cos (ha_r);
+	double sin_dec = sin (dec_r);
+	double cos_dec = cos (dec_r);
+	double tan_dec = sin_dec / cos_dec;
 
-	err->az = - params[0]
-		+ params[1] * sin_az  * tan_el
-		- params[2] * cos_az * tan_el
-		- params[3] * tan_el
-		+ params[4] / cos_el;
+	double d_tar = dec_r - dparams[0] - dparams[1] * cos_ha - dparams[2] * sin_ha - dparams[3] * (cosLat * sin_dec * cos_ha - sinLat * cos_dec) - dparams[8] * cos_ha;
+	double r_tar = ha_r - dparams[4] - dparams[5] / cos_dec - dparams[6] * tan_dec - (dparams[1] * sin_ha - dparams[2] * cos_ha) * tan_dec - dparams[3] * cosLat * sin_ha / cos_dec - dparams[7] * (sinLat * tan_dec + cosLat * cos_ha);
 
-	err->alt = - params[5]
-		+ params[1] * cos_az
-		+ params[2] * sin_az
-		+ params[6] * cos_el;
+	ha = ln_rad_to_deg (r_tar);
+	dec = ln_rad_to_deg (d_tar);
+}
+
+void GPointModel::reversePosition (double &ha, double &dec, double az, double el, ModelArguments &args)
+{
+	double ha_r = ln_deg_to_rad (ha);
+	double dec_r = ln_deg_to_rad (dec);
+
+	double sin_ha = sin (ha_r);
+	double cos_ha = cos (ha_r);
+	double sin_dec = sin (dec_r);
+	double cos_dec = cos (dec_r);
+	double tan_dec = sin_dec / cos_dec;
+
+	double d_tar = dec_r
+		+ dparams[0]
+		+ dparams[1] * cos_ha
+		+ dparams[2] * sin_ha
+		+ dparams[3] * (cosLat * sin_dec * cos_ha - sinLat * cos_dec)
+		+ dparams[8] * cos_ha;
+
+	double r_tar = ha_r
+		+ dparams[4]
+		+ dparams[5] / cos_dec
+		+ dparams[6] * tan_dec
+		+ (dparams[1] * sin_ha - dparams[2] * cos_ha) * tan_dec
+		+ dparams[3] * cosLat * sin_ha / cos_dec
+		+ dparams[7] * (sinLat * tan_dec + cosLat * cos_ha);
 
 	// now handle extra params
-	std::list <ExtraParam *>::iterator it;
-	for (it = extraParamsAz.begin (); it != extraParamsAz.end (); it++)
-		err->az += (*it)->getValue (az_r, el_r, ha_r, dec_r);
+	if (!(termsHa.empty () && termsDec.empty ()))
+	{
+		fillArguments (args, ln_deg_to_rad (az), ln_deg_to_rad (el), ha_r, dec_r);
+		r_tar += getTermsValue (termsHa, args);
+		d_tar += getTermsValue (termsDec, args);
+	}
 
-	for (it = extraParamsEl.begin (); it != extraParamsEl.end (); it++)
-		err->alt += (*it)->getValue (az_r, el_r, ha_r, dec_r);
+	ha = ln_rad_to_deg (r_tar);
+	dec = ln_rad_to_deg (d_tar);
+}
+
+void GPointModel::errAltAz (double &az, double &el, double ha, double dec, double &err_az, double &err_el, ModelArguments &args)
+{
+	double az_r = ln_deg_to_rad (az);
+	double el_r = ln_deg_to_rad (el);
+
+	double sin_az = sin (az_r);
+	double cos_az = cos (az_r);
+	double sin_el = sin (el_r);
+	double cos_el = cos (el_r);
+	double tan_el = sin_el / cos_el;
+
+	err_az = - dparams[0]
+		+ dparams[1] * sin_az  * tan_el
+		- dparams[2] * cos_az * tan_el
+		- dparams[3] * tan_el
+		+ dparams[4] / cos_el;
+
+	err_el = - dparams[5]
+		+ dparams[1] * cos_az
+		+ dparams[2] * sin_az
+		+ dparams[6] * cos_el;
+
+	// now handle extra params
+	if (!(termsAz.empty () && termsEl.empty ()))
+	{
+		fillArguments (args, az_r, el_r, ln_deg_to_rad (ha), ln_deg_to_rad (dec));
+		err_az += getTermsValue (termsAz, args);
+		err_el += getTermsValue (termsEl, args);
+	}
 
-	err->az = ln_rad_to_deg (err->az);
-	err->alt = ln_rad_to_deg (err->alt);
+	err_az = ln_rad_to_deg (err_az);
+	err_el = ln_rad_to_deg (err_el);
 
-	hrz->az += err->az;
-	hrz->alt += err->alt;
+	az += err_az;
+	el += err_el;
 }
 
 std::istream & GPointModel::load (std::istream & is)
@@ -439,6 +633,7 @@ std::istream & GPointModel::load (std::istream & is)
 		catch (rts2core::Error &er)
 		{	
 			logStream (MESSAGE_ERROR) << "cannot read parameter " << i << sendLog;
+			compile ();
 			return is;
 		}
 		i++;
@@ -487,6 +682,7 @@ std::istream & GPointModel::load (std::istream & is)
 			{
 				logStream (MESSAGE_ERROR) << "invalid axis name " << axis << sendLog;
 				delete p;
+				compile ();
 				return is;
 			}
 		}
@@ -494,10 +690,12 @@ std::istream & GPointModel::load (std::istream & is)
 		{
 			logStream (MESSAGE_ERROR) << "parsing line " << line << ": " << er << sendLog;
 			delete p;
+			compile ();
 			return is;
 		}
 	}
 
+	compile ();
 	return is;
 }
 
@@ -18,6 +18,7 @@
  */
 
 #include <math.h>
+#include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/time.h>
@@ -42,6 +43,30 @@
 
 #ifdef RTS2_LIBERFA
 #include "erfa.h"
+
+// star independent astrometry parameters are calculated again after this number of seconds
+#define ASTROM_REFRESH        5.0
+
+namespace rts2teld
+{
+
+/**
+ * Star independent astrometry parameters calculated by eraApco13, with
+ * site parameters used to calculate them.
+ */
+class AstromCache
+{
+	public:
+		AstromCache () { valid = false; }
+
+		eraASTROM astrom;
+		double utc1;
+		double utc2;
+		double site[8];
+		bool valid;
+};
+
+}
 #endif
 
 #define OPT_BLOCK_ON_STANDBY  OPT_LOCAL + 117
@@ -184,6 +209,12 @@ Telescope::Telescope (int in_argc, char **in_argv, bool diffTrack, bool hasTrack
 		trackingFSize->setValueInteger (20);
 
 		createValue (skyVect, "SKYSPD", "[deg/hour] tracking speeds vector (in RA/DEC)", true, RTS2_DT_DEGREES);
+
+		createValue (trajectorySpan, "trajectory_span", "[s] span of precalculated tracking trajectory, 0 to calculate all tracking positions", false, RTS2_VALUE_WRITABLE | RTS2_DT_TIMEINTERVAL);
+		trajectorySpan->setValueDouble (5);
+		createValue (trajectoryError, "trajectory_error", "[counts] maximal allowed difference of tracking trajectory from calculated position", false, RTS2_VALUE_WRITABLE);
+		trajectoryError->setValueDouble (5);
+		createValue (trajectoryEstimate, "trajectory_estimate", "[counts] estimated error of current tracking trajectory", false);
 	}
 	else
 	{
@@ -192,6 +223,9 @@ Telescope::Telescope (int in_argc, char **in_argv, bool diffTrack, bool hasTrack
 		trackingFrequency = NULL;
 		trackingWarning = NULL;
 		skyVect = NULL;
+		trajectorySpan = NULL;
+		trajectoryError = NULL;
+		trajectoryEstimate = NULL;
 	}
 
 	lastTrackingRun = NAN;
@@ -394,6 +428,7 @@ Telescope::Telescope (int in_argc, char **in_argv, bool diffTrack, bool hasTrack
 	tPointModelFile = NULL;
 	rts2ModelFile = NULL;
 	model = NULL;
+	astromCache = NULL;
 
 	createValue (standbyPark, "standby_park", "Park telescope when switching to standby", false, RTS2_VALUE_WRITABLE);
 	standbyPark->addSelVal ("no");
@@ -435,6 +470,9 @@ Telescope::Telescope (int in_argc, char **in_argv, bool diffTrack, bool hasTrack
 Telescope::~Telescope (void)
 {
 	delete model;
+#ifdef RTS2_LIBERFA
+	delete astromCache;
+#endif
 }
 
 int Telescope::checkTracking (double maxDist)
@@ -572,11 +610,37 @@ int Telescope::calculateTracking (const double utc1, const double utc2, double s
 	int32_t t_dc = dc;
 	int ret = calculateTarget (utc1, utc2, &eqpos, c_ac, c_dc, true, 0, true);
 	if (ret)
+	{
+		trajectory.invalidate ();
 		return ret;
+	}
 
-	ret = calculateTarget (utc1, utc2 + sec_step / 86400.0, &t_eqpos, t_ac, t_dc, false, 0, true);
-	if (ret)
-		return ret;
+	double t_utc2 = utc2 + sec_step / 86400.0;
+
+	// current position differs from trajectory if target, offsets or model changed
+	if (trajectorySpan->getValueDouble () > 0 && trajectoryError->getValueDouble () > 0)
+	{
+		if (trajectory.isValid () && (!trajectory.covers (utc1, t_utc2) || trajectory.getDifference (utc1, utc2, c_ac, c_dc) > trajectoryError->getValueDouble ()))
+			trajectory.invalidate ();
+		if (!trajectory.isValid ())
+			buildTrajectory (utc1, utc2, sec_step, c_ac, c_dc, &eqpos);
+	}
+	else
+	{
+		trajectory.invalidate ();
+	}
+
+	if (trajectory.isValid ())
+	{
+		trajectory.getCounts (utc1, t_utc2, t_ac, t_dc);
+		trajectory.getRaDec (utc1, t_utc2, t_eqpos.ra, t_eqpos.dec);
+	}
+	else
+	{
+		ret = calculateTarget (utc1, t_utc2, &t_eqpos, t_ac, t_dc, false, 0, true);
+		if (ret)
+			return ret;
+	}
 
 	//std::cout << "calculateTracking " << utc1 << " " << utc2 << " " << LibnovaRaDec (&eqpos) << " " << LibnovaRaDec (&t_eqpos) << " " << sec_step << " current " << c_ac << " " << c_dc << " target " << t_ac << " " << t_dc << " ac " << ac << " " << dc << std::endl;
 
@@ -606,6 +670,59 @@ int Telescope::calculateTracking (const double utc1, const double utc2, double s
 	return 0;
 }
 
+bool Telescope::buildTrajectory (const double utc1, const double utc2, double sec_step, int32_t c_ac, int32_t c_dc, struct ln_equ_posn *eqpos)
+{
+	int32_t ac[3], dc[3];
+	double ra[3], dec[3];
+
+	ac[0] = c_ac;
+	dc[0] = c_dc;
+	ra[0] = eqpos->ra;
+	dec[0] = eqpos->dec;
+
+	// trajectory must cover at least next tracking step
+	double span = trajectorySpan->getValueDouble ();
+	if (span < 2 * sec_step)
+		span = 2 * sec_step;
+
+	for (int tries = 0; tries < 3 && span >= sec_step; tries++, span /= 2.0)
+	{
+		struct ln_equ_posn pos;
+		for (int i = 1; i < 3; i++)
+		{
+			ac[i] = c_ac;
+			dc[i] = c_dc;
+			if (calculateTarget (utc1, utc2 + i * span / 2.0 / 86400.0, &pos, ac[i], dc[i], false, 0, true))
+				return false;
+			ra[i] = pos.ra;
+			dec[i] = pos.dec;
+		}
+
+		trajectory.fit (utc1, utc2, span, ac, dc, ra, dec);
+
+		// quadratic interpolation error is close to its maximum at 3/4 of the span
+		int32_t e_ac = c_ac;
+		int32_t e_dc = c_dc;
+		double e_utc2 = utc2 + 0.75 * span / 86400.0;
+		if (calculateTarget (utc1, e_utc2, &pos, e_ac, e_dc, false, 0, true))
+		{
+			trajectory.invalidate ();
+			return false;
+		}
+
+		double err = trajectory.getDifference (utc1, e_utc2, e_ac, e_dc);
+		if (err <= trajectoryError->getValueDouble ())
+		{
+			trajectory.setError (err);
+			trajectoryEstimate->setValueDouble (err);
+			return true;
+		}
+		trajectory.invalidate ();
+	}
+	trajectoryEstimate->setValueDouble (NAN);
+	return false;
+}
+
 int Telescope::sky2counts (const double utc1, const double utc2, struct ln_equ_posn *pos, int32_t &ac, int32_t &dc, bool writeValues, double haMargin, bool forceShortest)
 {
 	return -1;
@@ -2035,20 +2152,42 @@ void Telescope::applyCorrections (struct ln_equ_posn *pos, double utc1, double u
 	double rc = ln_deg_to_rad (pos->ra);
 	double dc = ln_deg_to_rad (pos->dec);
 
-	eraASTROM astrom;
+	double site[8] = {telDUT1->getValueDouble (), ln_deg_to_rad (getLongitude ()), ln_deg_to_rad (getLatitude ()), getAltitude (), getPressure (), telAmbientTemperature->getValueFloat (), telHumidity->getValueFloat () / 100.0, telWavelength->getValueFloat () / 1000.0};
 
-	int status = eraApco13 (utc1, utc2, telDUT1->getValueDouble (), ln_deg_to_rad (getLongitude ()), ln_deg_to_rad (getLatitude ()), getAltitude (), 0, 0, getPressure (), telAmbientTemperature->getValueFloat (), telHumidity->getValueFloat () / 100.0, telWavelength->getValueFloat () / 1000.0, &astrom, &eo);
-	if (status)
+	if (astromCache == NULL)
+		astromCache = new AstromCache ();
+
+	// star independent parameters change slowly, only Earth rotation angle must be updated for every call
+	if (astromCache->valid && fabs ((utc1 - astromCache->utc1) + (utc2 - astromCache->utc2)) * 86400.0 < ASTROM_REFRESH && memcmp (site, astromCache->site, sizeof (site)) == 0)
 	{
-		logStream (MESSAGE_ERROR) << "cannot apply corrections to " << pos->ra << " " << pos->dec << sendLog;
-		return;
+		double ut11, ut12;
+		if (eraUtcut1 (utc1, utc2, site[0], &ut11, &ut12))
+		{
+			logStream (MESSAGE_ERROR) << "cannot apply corrections to " << pos->ra << " " << pos->dec << sendLog;
+			return;
+		}
+		eraAper13 (ut11, ut12, &(astromCache->astrom));
+	}
+	else
+	{
+		int status = eraApco13 (utc1, utc2, site[0], site[1], site[2], site[3], 0, 0, site[4], site[5], site[6], site[7], &(astromCache->astrom), &eo);
+		if (status)
+		{
+			astromCache->valid = false;
+			logStream (MESSAGE_ERROR) << "cannot apply corrections to " << pos->ra << " " << pos->dec << sendLog;
+			return;
+		}
+		astromCache->utc1 = utc1;
+		astromCache->utc2 = utc2;
+		memcpy (astromCache->site, site, sizeof (site));
+		astromCache->valid = true;
 	}
 
 	// transform ICRS to CIRS
-	eraAtciq (rc, dc, ln_deg_to_rad (pmRaDec->getRa ()), ln_deg_to_rad (pmRaDec->getDec ()), 0, 0, &astrom, &ri, &di);
+	eraAtciq (rc, dc, ln_deg_to_rad (pmRaDec->getRa ()), ln_deg_to_rad (pmRaDec->getDec ()), 0, 0, &(astromCache->astrom), &ri, &di);
 
 	// transform CISC to observed
-	eraAtioq (ri, di, &astrom, &aob, &zob, &hob, &dob, &rob);
+	eraAtioq (ri, di, &(astromCache->astrom), &aob, &zob, &hob, &dob, &rob);
 
 	pos->ra = ln_rad_to_deg (rob);
 	pos->dec = ln_rad_to_deg (dob);
@@ -0,0 +1,91 @@
+/*
+ * Tracking trajectory of telescope axes.
+ * Copyright (C) 2026 Petr Kubanek <petr@kubanek.net>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "trajectory.h"
+
+#include <math.h>
+
+using namespace rts2teld;
+
+void Trajectory::fit (double utc1, double utc2, double _span, const int32_t ac[3], const int32_t dc[3], const double ra[3], const double dec[3])
+{
+	start1 = utc1;
+	start2 = utc2;
+	span = _span;
+
+	fitPoly (acc, ac[0], ac[1], ac[2]);
+	fitPoly (dcc, dc[0], dc[1], dc[2]);
+
+	// unwrap RA, so polynomial does not jump across 0/360
+	double r1 = ra[1];
+	double r2 = ra[2];
+	if (r1 - ra[0] > 180)
+		r1 -= 360;
+	else if (r1 - ra[0] < -180)
+		r1 += 360;
+	if (r2 - r1 > 180)
+		r2 -= 360;
+	else if (r2 - r1 < -180)
+		r2 += 360;
+
+	fitPoly (rac, ra[0], r1, r2);
+	fitPoly (decc, dec[0], dec[1], dec[2]);
+
+	error = 0;
+	valid = true;
+}
+
+void Trajectory::getCounts (double utc1, double utc2, int32_t &ac, int32_t &dc)
+{
+	double u = getOffset (utc1, utc2) / span;
+	ac = (int32_t) round (evalPoly (acc, u));
+	dc = (int32_t) round (evalPoly (dcc, u));
+}
+
+void Trajectory::getSpeed (double utc1, double utc2, double &ac_speed, double &dc_speed)
+{
+	double u = getOffset (utc1, utc2) / span;
+	ac_speed = (acc[1] + 2 * u * acc[2]) / span;
+	dc_speed = (dcc[1] + 2 * u * dcc[2]) / span;
+}
+
+void Trajectory::getRaDec (double utc1, double utc2, double &ra, double &dec)
+{
+	double u = getOffset (utc1, utc2) / span;
+	ra = fmod (evalPoly (rac, u), 360);
+	if (ra < 0)
+		ra += 360;
+	dec = evalPoly (decc, u);
+}
+
+double Trajectory::getDifference (double utc1, double utc2, int32_t ac, int32_t dc)
+{
+	double u = getOffset (utc1, utc2) / span;
+	double d_ac = fabs (evalPoly (acc, u) - ac);
+	double d_dc = fabs (evalPoly (dcc, u) - dc);
+	return d_ac > d_dc ? d_ac : d_dc;
+}
+
+void Trajectory::fitPoly (double c[3], double y0, double y1, double y2)
+{
+	// y (u) = c0 + c1 * u + c2 * u^2, y (0) = y0, y (0.5) = y1, y (1) = y2
+	c[0] = y0;
+	c[1] = 4 * y1 - 3 * y0 - y2;
+	c[2] = 2 * y0 - 4 * y1 + 2 * y2;
+}
@@ -256,3 +256,291 @@ void rts2sgp4::ln_observer_cartesian_coords (struct ln_lnlat_posn *observer, dou
 	observer_loc->Y = sin (angle) * rho_cos * EARTH_MAJOR_AXIS / 1000.;
 	observer_loc->Z = rho_sin               * EARTH_MAJOR_AXIS / 1000.;
 }
+
+// constants of near Earth satellites, kept in SatelliteSet::nearConsts
+enum { NC_EPOCH, NC_MO, NC_MDOT, NC_ARGPO, NC_ARGPDOT, NC_NODEO, NC_NODEDOT, NC_NODECF, NC_CC1, NC_BSTARCC4, NC_T2COF, NC_ISIMP,
+	NC_OMGCOF, NC_ETA, NC_XMCOF, NC_DELMO, NC_D2, NC_D3, NC_D4, NC_BSTARCC5, NC_SINMAO, NC_T3COF, NC_T4COF, NC_T5COF,
+	NC_NO, NC_ABASE, NC_ECCO, NC_INCLO, NC_SINIO, NC_COSIO, NC_AYCOF, NC_XLCOF, NC_CON41, NC_X1MTH2, NC_X7THM1, NEAR_CONSTS };
+
+SatelliteSet::SatelliteSet ()
+{
+	double tumin, mu, j3, j4, j3oj2;
+	getgravconst (wgs84, tumin, mu, radiusearthkm, xke, j2, j3, j4, j3oj2);
+	constsValid = true;
+}
+
+int SatelliteSet::add (const char *tle1, const char *tle2)
+{
+	elsetrec satrec;
+	if (init (tle1, tle2, &satrec) || satrec.error != 0)
+		return -1;
+
+	if (satrec.method == 'd')
+		deepSats.push_back (satrecs.size ());
+	else
+		nearSats.push_back (satrecs.size ());
+
+	satrecs.push_back (satrec);
+	constsValid = false;
+
+	return satrecs.size () - 1;
+}
+
+int SatelliteSet::propagate (const double *JD, size_t nJD, double *x, double *y, double *z)
+{
+	return run (JD, nJD, NULL, x, y, z);
+}
+
+int SatelliteSet::topocentric (const double *JD, size_t nJD, struct ln_lnlat_posn *observer, double altitude, double *ra, double *dec, double *delta)
+{
+	double rho_cos, rho_sin;
+	ln_lat_alt_to_parallax (observer, altitude, &rho_cos, &rho_sin);
+
+	// observer position is calculated once for every date
+	std::vector <double> obs (3 * nJD);
+	for (size_t j = 0; j < nJD; j++)
+	{
+		struct ln_rect_posn observer_loc;
+		ln_observer_cartesian_coords (observer, rho_cos, rho_sin, JD[j], &observer_loc);
+		obs[3 * j] = observer_loc.X;
+		obs[3 * j + 1] = observer_loc.Y;
+		obs[3 * j + 2] = observer_loc.Z;
+	}
+
+	return run (JD, nJD, &(obs[0]), ra, dec, delta);
+}
+
+void SatelliteSet::fillConstants ()
+{
+	size_t n = nearSats.size ();
+	nearConsts.resize (NEAR_CONSTS * n);
+
+	for (size_t k = 0; k < n; k++)
+	{
+		elsetrec &s = satrecs[nearSats[k]];
+		double *c = &(nearConsts[0]) + k;
+
+		c[NC_EPOCH * n] = s.jdsatepoch;
+		c[NC_MO * n] = s.mo;
+		c[NC_MDOT * n] = s.mdot;
+		c[NC_ARGPO * n] = s.argpo;
+		c[NC_ARGPDOT * n] = s.argpdot;
+		c[NC_NODEO * n] = s.nodeo;
+		c[NC_NODEDOT * n] = s.nodedot;
+		c[NC_NODECF * n] = s.nodecf;
+		c[NC_CC1 * n] = s.cc1;
+		c[NC_BSTARCC4 * n] = s.bstar * s.cc4;
+		c[NC_T2COF * n] = s.t2cof;
+		c[NC_ISIMP * n] = s.isimp;
+		c[NC_OMGCOF * n] = s.omgcof;
+		c[NC_ETA * n] = s.eta;
+		c[NC_XMCOF * n] = s.xmcof;
+		c[NC_DELMO * n] = s.delmo;
+		c[NC_D2 * n] = s.d2;
+		c[NC_D3 * n] = s.d3;
+		c[NC_D4 * n] = s.d4;
+		c[NC_BSTARCC5 * n] = s.bstar * s.cc5;
+		c[NC_SINMAO * n] = s.sinmao;
+		c[NC_T3COF * n] = s.t3cof;
+		c[NC_T4COF * n] = s.t4cof;
+		c[NC_T5COF * n] = s.t5cof;
+		c[NC_NO * n] = s.no;
+		// semi-major axis without drag, am = abase * tempa^2
+		c[NC_ABASE * n] = pow (xke / s.no, 2.0 / 3.0);
+		c[NC_ECCO * n] = s.ecco;
+		c[NC_INCLO * n] = s.inclo;
+		c[NC_SINIO * n] = sin (s.inclo);
+		c[NC_COSIO * n] = cos (s.inclo);
+		c[NC_AYCOF * n] = s.aycof;
+		c[NC_XLCOF * n] = s.xlcof;
+		c[NC_CON41 * n] = s.con41;
+		c[NC_X1MTH2 * n] = s.x1mth2;
+		c[NC_X7THM1 * n] = s.x7thm1;
+	}
+
+	constsValid = true;
+}
+
+/**
+ * Store propagation result, convert it to topocentric coordinates if
+ * observer position is provided.
+ */
+static inline void storeResult (const double *obs, double X, double Y, double Z, double *r1, double *r2, double *r3)
+{
+	if (obs == NULL)
+	{
+		*r1 = X;
+		*r2 = Y;
+		*r3 = Z;
+		return;
+	}
+	// as in ln_get_satellite_ra_dec_delta
+	double dX = X - obs[0];
+	double dY = Y - obs[1];
+	double dZ = Z - obs[2];
+	*r3 = sqrt (dX * dX + dY * dY + dZ * dZ);
+	*r1 = ln_range_degrees (ln_rad_to_deg (atan2 (dY, dX)));
+	*r2 = ln_rad_to_deg (asin (dZ / *r3));
+}
+
+int SatelliteSet::run (const double *JD, size_t nJD, const double *obs, double *r1, double *r2, double *r3)
+{
+	const double twopi = 2.0 * pi;
+	int errors = 0;
+
+	if (!constsValid)
+		fillConstants ();
+
+	size_t n = nearSats.size ();
+	const double *c = n > 0 ? &(nearConsts[0]) : NULL;
+
+	// near Earth satellites, inlined sgp4 without deep space terms and velocities
+	for (size_t j = 0; j < nJD; j++)
+	{
+		const double *o = obs ? obs + 3 * j : NULL;
+		for (size_t k = 0; k < n; k++)
+		{
+			size_t ri = nearSats[k] * nJD + j;
+
+			double t = (JD[j] - c[NC_EPOCH * n + k]) * 1440.0;
+
+			double xmdf = c[NC_MO * n + k] + c[NC_MDOT * n + k] * t;
+			double argpm = c[NC_ARGPO * n + k] + c[NC_ARGPDOT * n + k] * t;
+			double t2 = t * t;
+			double nodem = c[NC_NODEO * n + k] + c[NC_NODEDOT * n + k] * t + c[NC_NODECF * n + k] * t2;
+			double mm = xmdf;
+			double tempa = 1.0 - c[NC_CC1 * n + k] * t;
+			double tempe = c[NC_BSTARCC4 * n + k] * t;
+			double templ = c[NC_T2COF * n + k] * t2;
+
+			if (c[NC_ISIMP * n + k] != 1)
+			{
+				double delmtemp = 1.0 + c[NC_ETA * n + k] * cos (xmdf);
+				double temp = c[NC_OMGCOF * n + k] * t + c[NC_XMCOF * n + k] * (delmtemp * delmtemp * delmtemp - c[NC_DELMO * n + k]);
+				mm = xmdf + temp;
+				argpm = argpm - temp;
+				double t3 = t2 * t;
+				double t4 = t3 * t;
+				tempa = tempa - c[NC_D2 * n + k] * t2 - c[NC_D3 * n + k] * t3 - c[NC_D4 * n + k] * t4;
+				tempe = tempe + c[NC_BSTARCC5 * n + k] * (sin (mm) - c[NC_SINMAO * n + k]);
+				templ = templ + c[NC_T3COF * n + k] * t3 + t4 * (c[NC_T4COF * n + k] + t * c[NC_T5COF * n + k]);
+			}
+
+			// am = (xke / no)^(2/3) * tempa^2, nm = xke / am^1.5
+			double am = c[NC_ABASE * n + k] * tempa * tempa;
+			double nm = c[NC_NO * n + k] / fabs (tempa * tempa * tempa);
+			double em = c[NC_ECCO * n + k] - tempe;
+
+			if (em >= 1.0 || em < -0.001)
+			{
+				storeResult (NULL, NAN, NAN, NAN, r1 + ri, r2 + ri, r3 + ri);
+				errors++;
+				continue;
+			}
+			if (em < 1.0e-6)
+				em = 1.0e-6;
+
+			mm = mm + c[NC_NO * n + k] * templ;
+			double xlm = mm + argpm + nodem;
+
+			nodem = fmod (nodem, twopi);
+			argpm = fmod (argpm, twopi);
+			xlm = fmod (xlm, twopi);
+			mm = fmod (xlm - argpm - nodem, twopi);
+
+			double sinip = c[NC_SINIO * n + k];
+			double cosip = c[NC_COSIO * n + k];
+
+			// long period periodics
+			double axnl = em * cos (argpm);
+			double temp = 1.0 / (am * (1.0 - em * em));
+			double aynl = em * sin (argpm) + temp * c[NC_AYCOF * n + k];
+			double xl = mm + argpm + nodem + temp * c[NC_XLCOF * n + k] * axnl;
+
+			// solve kepler's equation
+			double u = fmod (xl - nodem, twopi);
+			double eo1 = u;
+			double tem5 = 9999.9;
+			double sineo1 = 0, coseo1 = 0;
+			for (int ktr = 1; fabs (tem5) >= 1.0e-12 && ktr <= 10; ktr++)
+			{
+				sineo1 = sin (eo1);
+				coseo1 = cos (eo1);
+				tem5 = 1.0 - coseo1 * axnl - sineo1 * aynl;
+				tem5 = (u - aynl * coseo1 + axnl * sineo1 - eo1) / tem5;
+				if (fabs (tem5) >= 0.95)
+					tem5 = tem5 > 0.0 ? 0.95 : -0.95;
+				eo1 = eo1 + tem5;
+			}
+
+			// short period preliminary quantities
+			double ecose = axnl * coseo1 + aynl * sineo1;
+			double esine = axnl * sineo1 - aynl * coseo1;
+			double el2 = axnl * axnl + aynl * aynl;
+			double pl = am * (1.0 - el2);
+			if (pl < 0.0)
+			{
+				storeResult (NULL, NAN, NAN, NAN, r1 + ri, r2 + ri, r3 + ri);
+				errors++;
+				continue;
+			}
+
+			double rl = am * (1.0 - ecose);
+			double betal = sqrt (1.0 - el2);
+			temp = esine / (1.0 + betal);
+			double sinu = am / rl * (sineo1 - aynl - axnl * temp);
+			double cosu = am / rl * (coseo1 - axnl + aynl * temp);
+			double su = atan2 (sinu, cosu);
+			double sin2u = (cosu + cosu) * sinu;
+			double cos2u = 1.0 - 2.0 * sinu * sinu;
+			temp = 1.0 / pl;
+			double temp1 = 0.5 * j2 * temp;
+			double temp2 = temp1 * temp;
+
+			// short period periodics
+			double mrt = rl * (1.0 - 1.5 * temp2 * betal * c[NC_CON41 * n + k]) + 0.5 * temp1 * c[NC_X1MTH2 * n + k] * cos2u;
+			su = su - 0.25 * temp2 * c[NC_X7THM1 * n + k] * sin2u;
+			double xnode = nodem + 1.5 * temp2 * cosip * sin2u;
+			double xinc = c[NC_INCLO * n + k] + 1.5 * temp2 * cosip * sinip * cos2u;
+
+			// decaying satellite
+			if (mrt < 1.0)
+			{
+				storeResult (NULL, NAN, NAN, NAN, r1 + ri, r2 + ri, r3 + ri);
+				errors++;
+				continue;
+			}
+
+			// orientation vectors
+			double sinsu = sin (su);
+			double cossu = cos (su);
+			double snod = sin (xnode);
+			double cnod = cos (xnode);
+			double sini = sin (xinc);
+			double cosi = cos (xinc);
+			double xmx = -snod * cosi;
+			double xmy = cnod * cosi;
+
+			storeResult (o, mrt * (xmx * sinsu + cnod * cossu) * radiusearthkm, mrt * (xmy * sinsu + snod * cossu) * radiusearthkm, mrt * sini * sinsu * radiusearthkm, r1 + ri, r2 + ri, r3 + ri);
+		}
+	}
+
+	// deep space satellites
+	for (std::vector <size_t>::iterator iter = deepSats.begin (); iter != deepSats.end (); iter++)
+	{
+		for (size_t j = 0; j < nJD; j++)
+		{
+			size_t ri = (*iter) * nJD + j;
+			struct ln_rect_posn r, v;
+			if (rts2sgp4::propagate (&(satrecs[*iter]), JD[j], &r, &v))
+			{
+				storeResult (NULL, NAN, NAN, NAN, r1 + ri, r2 + ri, r3 + ri);
+				errors++;
+				continue;
+			}
+			storeResult (obs ? obs + 3 * j : NULL, r.X, r.Y, r.Z, r1 + ri, r2 + ri, r3 + ri);
+		}
+	}
+
+	return errors;
+}
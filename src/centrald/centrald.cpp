@@ -23,6 +23,8 @@
 #include "timestamp.h"
 #include "centralstate.h"
 
+#include <algorithm>
+
 using namespace rts2centrald;
 
 void ConnCentrald::setState (rts2_status_t in_value, char *msg)
@@ -380,6 +382,7 @@ int ConnCentrald::command ()
 		if (paramNextInteger (&newMask) || !paramEnd ())
 			return -2;
 		messageMask = newMask;
+		master->messageMaskChanged ();
 		return 0;
 	}
 	else if (getType () == DEVICE_SERVER)
@@ -469,29 +472,23 @@ Centrald::Centrald (int argc, char **argv):Daemon (argc, argv, SERVERD_HARD_OFF
 
 Centrald::~Centrald (void)
 {
-	if (fileLog)
-	{
-		fileLog->close ();
-		delete fileLog;
-	}
+	delete fileLog;
 	// do not report any priority changes
 	priority_client = -2;
 }
 
 void Centrald::openLog ()
 {
-	if (fileLog)
-	{
-		fileLog->close ();
-		delete fileLog;
-	}
 	if (logFile == std::string ("-"))
 	{
+		delete fileLog;
 		fileLog = NULL;
 		return;
 	}
-	fileLog = new std::ofstream ();
-	fileLog->open (logFile.c_str (), std::ios_base::out | std::ios_base::app);
+	// flusher thread is started from idle, after centrald forked to background
+	if (fileLog == NULL)
+		fileLog = new rts2core::AsyncLog ();
+	fileLog->open (logFile.c_str ());
 }
 
 int Centrald::reloadConfig ()
@@ -630,6 +627,7 @@ int Centrald::initValues ()
 
 void Centrald::connectionRemoved (rts2core::Connection * conn)
 {
+	messageMaskChanged ();
 	// update weather
 	weatherChanged (conn->getName (), "connection removed");
 	stopChanged (conn->getName (), "connection removed");
@@ -786,6 +784,9 @@ int Centrald::idle ()
 
 	rts2_status_t call_state;
 
+	if (fileLog && !fileLog->isRunning () && !fileLog->startFailed () && fileLog->start ())
+		logStream (MESSAGE_ERROR) << "cannot start log file thread, messages will be logged synchronously: " << strerror (errno) << sendLog;
+
 	curr_time = time (NULL);
 
 	if (curr_time < next_event_time)
@@ -877,15 +878,64 @@ void Centrald::processMessage (Message & msg)
 	// log it
 	if (fileLog)
 	{
-		(*fileLog) << msg << std::endl;
+		fileLog->log (msg);
 	}
 	else
 	{
 		std::cerr << msg << std::endl;
 	}
 
-	// and send it to all
-	sendMessageAll (msg);
+	// serialize message once for all connections, and only if someone is interested
+	if (getMessageSubscribers (msg.getType ()).empty ())
+		return;
+	pendingMessages.push_back (std::pair <messageType_t, std::string> (msg.getType (), msg.toConn ()));
+}
+
+void Centrald::flushPendingValues ()
+{
+	Daemon::flushPendingValues ();
+
+	if (pendingMessages.empty ())
+		return;
+
+	// sending can call this method again
+	std::vector <std::pair <messageType_t, std::string> > toSend;
+	toSend.swap (pendingMessages);
+
+	// collect all messages for a connection, and write them with a single call
+	std::vector <ConnCentrald *> corked;
+	std::vector <std::pair <messageType_t, std::string> >::iterator iter;
+	for (iter = toSend.begin (); iter != toSend.end (); iter++)
+	{
+		std::vector <ConnCentrald *> &subs = getMessageSubscribers (iter->first);
+		for (std::vector <ConnCentrald *>::iterator siter = subs.begin (); siter != subs.end (); siter++)
+		{
+			if (std::find (corked.begin (), corked.end (), *siter) == corked.end ())
+			{
+				(*siter)->corkTx ();
+				corked.push_back (*siter);
+			}
+			(*siter)->sendMsg (iter->second);
+		}
+	}
+	for (std::vector <ConnCentrald *>::iterator citer = corked.begin (); citer != corked.end (); citer++)
+		(*citer)->uncorkTx ();
+}
+
+std::vector <ConnCentrald *> & Centrald::getMessageSubscribers (messageType_t type)
+{
+	std::map <messageType_t, std::vector <ConnCentrald *> >::iterator iter = messageSubscribers.find (type);
+	if (iter != messageSubscribers.end ())
+		return iter->second;
+
+	std::vector <ConnCentrald *> &subs = messageSubscribers[type];
+	for (connections_t::iterator citer = getConnections ()->begin (); citer != getConnections ()->end (); citer++)
+	{
+		ConnCentrald *conn = (ConnCentrald *) *citer;
+		if (conn->getMessageMask () & ((int) type))
+			subs.push_back (conn);
+	}
+	return subs;
 }
 
 void Centrald::signaledHUP ()
@@ -26,9 +26,13 @@
 
 #include <rts2-config.h>
 #include "daemon.h"
+#include "asynclog.h"
 #include "configuration.h"
 #include "status.h"
 
+#include <map>
+#include <vector>
+
 using namespace rts2core;
 
 #ifndef HOST_NAME_MAX
@@ -129,8 +133,24 @@ class Centrald:public Daemon
 
 		void sendMessage (messageType_t in_messageType, const char *in_messageString);
 
+		// all messages are written to the log file
+		virtual bool isLogged (messageType_t in_messageType) { return true; }
+
 		virtual void message (Message & msg);
 
+		/**
+		 * Sends values and messages queued since the last call. Called
+		 * before any other data are written to a connection.
+		 */
+		virtual void flushPendingValues ();
+
+		/**
+		 * Called when message mask of a connection changed, or the
+		 * connection was removed. Drops cached lists of message
+		 * subscribers.
+		 */
+		void messageMaskChanged () { messageSubscribers.clear (); }
+
 		/**
 		 * Called when conditions which determines weather state changed.
 		 * Those conditions are:
@@ -272,11 +292,24 @@ class Centrald:public Daemon
 		// which sets logfile
 		enum { LOGFILE_ARG, LOGFILE_DEF, LOGFILE_CNF } logFileSource;
 
-		std::ofstream * fileLog;
+		// written by background thread, NULL when logging to stderr
+		rts2core::AsyncLog * fileLog;
 
 		void openLog ();
 		int reloadConfig ();
 
+		// connections which receive messages, indexed by message type
+		std::map <messageType_t, std::vector <ConnCentrald *> > messageSubscribers;
+
+		// messages serialized for connections, waiting to be sent
+		std::vector <std::pair <messageType_t, std::string> > pendingMessages;
+
+		/**
+		 * Returns connections with message mask matching the message
+		 * type.
+		 */
+		std::vector <ConnCentrald *> & getMessageSubscribers (messageType_t type);
+
 		int doOpen ();
 		int doClose ();
 
@@ -383,6 +416,9 @@ class ConnCentrald:public rts2core::Connection
 		 */
 		virtual ~ ConnCentrald (void);
 		virtual int sendMessage (Message & msg);
+
+		int getMessageMask () { return messageMask; }
+
 		int sendConnectedInfo (rts2core::Connection * conn);
 
 		virtual void updateStatusWait (rts2core::Connection * conn);
@@ -126,7 +126,11 @@ Rts2ConnFwGrb::~Rts2ConnFwGrb (void)
 	if (last_target)
 		delete last_target;
 	if (gcn_listen_sock >= 0)
+	{
+		if (getMaster ())
+			getMaster ()->removePollFD (gcn_listen_sock);
 		close (gcn_listen_sock);
+	}
 }
 
 int Rts2ConnFwGrb::idle ()
@@ -230,6 +234,7 @@ int Rts2ConnFwGrb::init_listen ()
 
 	if (gcn_listen_sock >= 0)
 	{
+		getMaster ()->removePollFD (gcn_listen_sock);
 		close (gcn_listen_sock);
 		gcn_listen_sock = -1;
 	}
@@ -293,6 +298,7 @@ void Rts2ConnFwGrb::connectionError (int last_data_size)
 	logStream (MESSAGE_DEBUG) << "Rts2ConnFwGrb::connectionError" << sendLog;
 	if (sock > 0)
 	{
+		getMaster ()->removePollFD (sock);
 		close (sock);
 		sock = -1;
 	}
@@ -311,6 +317,7 @@ int Rts2ConnFwGrb::receive (rts2core::Block *block)
 	if (gcn_listen_sock >= 0 && block->isForRead (gcn_listen_sock))
 	{
 		// try to accept connection..
+		block->removePollFD (sock);
 		close (sock);			 // close previous connections..we support only one GCN connection
 		sock = -1;
 		struct sockaddr_in other_side;
@@ -326,6 +333,7 @@ int Rts2ConnFwGrb::receive (rts2core::Block *block)
 			connectionError (-1);
 		}
 		// close listening socket..when we get connection
+		block->removePollFD (gcn_listen_sock);
 		close (gcn_listen_sock);
 		gcn_listen_sock = -1;
 		setConnState (CONN_CONNECTED);
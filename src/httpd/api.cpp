@@ -63,6 +63,7 @@ digraph "JSON API calls handling" {
 
 #include "httpd.h"
 #include "rts2json/jsonvalue.h"
+#include "ephemcache.h"
 
 #include "rts2db/constraints.h"
 #include "rts2db/planset.h"
@@ -274,7 +275,6 @@ void API::executeJSON (XmlRpc::XmlRpcSource *source, std::string path, XmlRpc::H
 			const double jd_from = ln_get_julian_from_timet (&from);
 			const double jd_to = ln_get_julian_from_timet (&to);
 
-			struct ln_equ_posn equ;
 			struct ln_hrz_posn hrz;
 
 			os << "[" << std::fixed;
@@ -282,8 +282,7 @@ void API::executeJSON (XmlRpc::XmlRpcSource *source, std::string path, XmlRpc::H
 			{
 				if (jd != jd_from)
 					os << ",";
-				ln_get_solar_equ_coords (jd, &equ);
-				ln_get_hrz_from_equ (&equ, Configuration::instance ()->getObserver (), jd, &hrz);
+				rts2core::SolarEphemeris::instance ()->getHrzPosition (&hrz, jd, Configuration::instance ()->getObserver ());
 				os << "[" << hrz.alt << "," << hrz.az << "]";
 			}
 			os << "]";
@@ -20,6 +20,7 @@
 #include "httpd.h"
 #include "rts2json/altaz.h"
 #include "valueplot.h"
+#include "ephemcache.h"
 
 #include "rts2json/bsc.h"
 
@@ -68,11 +69,9 @@ void CurrentPosition::authorizedExecute (XmlRpc::XmlRpcSource *source, std::stri
 	// position of sun & moon
 	if (showSunMoon)
 	{
-		ln_get_solar_equ_coords (JD, &pos);
-		ln_get_hrz_from_equ (&pos, Configuration::instance ()->getObserver (), JD, &hrz);
+		rts2core::SolarEphemeris::instance ()->getHrzPosition (&hrz, JD, Configuration::instance ()->getObserver ());
 		altaz.plot (&hrz, "☉", "OrangeRed", PLOT_TYPE_POINT, 4);
-		ln_get_lunar_equ_coords (JD, &pos);
-		ln_get_hrz_from_equ (&pos, Configuration::instance ()->getObserver (), JD, &hrz);
+		rts2core::LunarEphemeris::instance ()->getHrzPosition (&hrz, JD, Configuration::instance ()->getObserver ());
 		altaz.plot (&hrz, "☾", "grey10", PLOT_TYPE_POINT, 4);
 	}
 
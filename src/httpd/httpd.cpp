@@ -454,6 +454,16 @@ int HttpD::info ()
 {
 	bbQueueSize->setValueInteger (events.bbServers.queueSize ());
 #ifdef RTS2_HAVE_PGSQL
+	if (recordWriter)
+	{
+		size_t queued;
+		double flushTime;
+		unsigned long dropped;
+		recordWriter->getStats (queued, flushTime, dropped);
+		recordsQueue->setValueInteger (queued);
+		recordsFlush->setValueDouble (flushTime);
+		recordsDropped->setValueInteger (dropped);
+	}
 	return DeviceDb::info ();
 #else
 	return rts2core::Device::info ();
@@ -464,6 +474,14 @@ int HttpD::idle ()
 {
 	rts2json::HTTPServer::asyncIdle ();
 #ifdef RTS2_HAVE_PGSQL
+	if (recordWriter && !recordWriter->isRunning () && recordWriter->start ())
+	{
+		logStream (MESSAGE_ERROR) << "value, state and message records will not be written to the database" << sendLog;
+		delete recordWriter;
+		recordWriter = NULL;
+	}
+	if (recordWriter)
+		recordWriter->logErrors ();
 	return DeviceDb::idle ();
 #else
 	return rts2core::Device::idle ();
@@ -612,6 +630,23 @@ int HttpD::init ()
 
 		userLogins.load (lf.c_str ());
 	}
+#ifdef RTS2_HAVE_PGSQL
+	else
+	{
+		int maxQueue;
+		int batchSize;
+		Configuration::instance ()->getInteger ("xmlrpcd", "records_queue", maxQueue, 100000);
+		Configuration::instance ()->getInteger ("xmlrpcd", "records_batch", batchSize, 1000);
+		if (maxQueue < 1 || batchSize < 1)
+		{
+			logStream (MESSAGE_ERROR) << "records_queue and records_batch must be at least 1, are " << maxQueue << " and " << batchSize << sendLog;
+			return -1;
+		}
+
+		// thread is started from idle, after the daemon forked
+		recordWriter = new rts2db::RecordWriter (this, maxQueue, batchSize, 1);
+	}
+#endif
 	// get page prefix
 	Configuration::instance ()->getString ("xmlrpcd", "page_prefix", page_prefix, "");
 
@@ -804,7 +839,14 @@ HttpD::HttpD (int argc, char **argv): rts2core::Device (argc, argv, DEVICE_TYPE_
 
 	bbQueueName = NULL;
 
-#ifndef RTS2_HAVE_PGSQL
+#ifdef RTS2_HAVE_PGSQL
+	recordWriter = NULL;
+
+	createValue (recordsQueue, "records_queue", "number of value, state and message records waiting to be written to the database", false);
+	createValue (recordsFlush, "records_flush", "[s] duration of the last database write of records", false);
+	createValue (recordsDropped, "records_dropped", "number of records which were not written to the database", false);
+	recordsDropped->setValueInteger (0);
+#else
 	config_file = NULL;
 
 	addOption (OPT_CONFIG, "config", 1, "configuration file");
@@ -834,6 +876,9 @@ HttpD::~HttpD ()
 		delete (*iter).second;
 	}
 	sessions.clear ();
+#ifdef RTS2_HAVE_PGSQL
+	delete recordWriter;
+#endif
 #ifdef RTS2_HAVE_LIBJPEG
 	MagickLib::DestroyMagick ();
 #endif /* RTS2_HAVE_LIBJPEG */
@@ -959,11 +1004,8 @@ void HttpD::message (Message & msg)
 {
 // log message to DB, if database is present
 #ifdef RTS2_HAVE_PGSQL
-	if (msg.isNotDebug ())
-	{
-		rts2db::MessageDB msgDB (msg);
-		msgDB.insertDB ();
-	}
+	if (msg.isNotDebug () && recordWriter)
+		recordWriter->recordMessage (msg);
 #endif
 	switch (msg.getID ())
 	{
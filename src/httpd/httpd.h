@@ -28,6 +28,7 @@
 #ifdef RTS2_HAVE_PGSQL
 #include "rts2db/devicedb.h"
 #include "rts2db/plan.h"
+#include "rts2db/recordwriter.h"
 #include "rts2json/addtargetreq.h"
 #include "bbapi.h"
 #else
@@ -483,6 +484,12 @@ class HttpD:public rts2core::Device, XmlRpc::XmlRpcServer, rts2json::HTTPServer
 
 #ifdef RTS2_HAVE_PGSQL
 		void confirmSchedule (rts2db::Plan &plan);
+
+		/**
+		 * Returns writer of value, state and message records. NULL
+		 * when running without database.
+		 */
+		rts2db::RecordWriter *getRecordWriter () { return recordWriter; }
 #endif
 
 	protected:
@@ -528,7 +535,13 @@ class HttpD:public rts2core::Device, XmlRpc::XmlRpcServer, rts2json::HTTPServer
 
 		rts2core::ValueInteger *messageBufferSize;
 
-#ifndef RTS2_HAVE_PGSQL
+#ifdef RTS2_HAVE_PGSQL
+		rts2db::RecordWriter *recordWriter;
+
+		rts2core::ValueInteger *recordsQueue;
+		rts2core::ValueDouble *recordsFlush;
+		rts2core::ValueInteger *recordsDropped;
+#else
 		const char *config_file;
 #endif
 		// user - login fields
@@ -89,13 +89,8 @@ class StateChange
  */
 class StateChangeRecord: public StateChange
 {
-	private:
-		int dbValueId;
 	public:
-		StateChangeRecord (std::string _deviceName, int _changeMask, int _newStateValue):StateChange (_deviceName, _changeMask, _newStateValue)
-		{
-			dbValueId = -1;
-		}
+		StateChangeRecord (std::string _deviceName, int _changeMask, int _newStateValue):StateChange (_deviceName, _changeMask, _newStateValue) {}
 
 		virtual void run (HttpD *_master, rts2core::Connection *_conn, double validTime);
 };
@@ -37,15 +37,10 @@ ValuePlot::ValuePlot (int _recvalId, int _valType, int w, int h):Plot (w, h)
 
 Magick::Image* ValuePlot::getPlot (double _from, double _to, Magick::Image* _image, rts2json::PlotType _plotType, int linewidth, int shadow, bool plotSun, bool plotShadow, bool localDate)
 {
-	// first load values..
-	rts2db::RecordsSet rs (recvalId);
-
 	from = _from;
 	to = _to;
 	plotType = _plotType;
 
-	rs.load (from, to);
-
 	if (_image)
 	{
 		image = _image;
@@ -60,9 +55,28 @@ Magick::Image* ValuePlot::getPlot (double _from, double _to, Magick::Image* _ima
 	image->strokeColor ("black");
 	image->strokeWidth (1);
 
+	// first load values..
+	rts2db::RecordsSet rs (recvalId);
+
+	// long intervals of double values are plotted from downsampled records, one bucket per pixel at most
+	rts2db::cadence_t cadence = rts2db::MINUTE;
+	// raw records are plotted if the database does not have downsampled records
+	bool buckets = (valueType & RTS2_BASE_TYPE) == RTS2_VALUE_DOUBLE && rts2db::RecordAvgSet::selectCadence (from, to, size.width () - y_axis_width, cadence) && rts2db::RecordAvgSet::haveBuckets ();
+	rts2db::RecordAvgSet avg (recvalId, cadence);
+
 	// Y axis scaling
-	min = rs.getMin ();
-	max = rs.getMax ();
+	if (buckets)
+	{
+		avg.load (from, to);
+		min = avg.getMin ();
+		max = avg.getMax ();
+	}
+	else
+	{
+		rs.load (from, to);
+		min = rs.getMin ();
+		max = rs.getMax ();
+	}
 
 	if (min == max)
 	{
@@ -116,7 +130,14 @@ Magick::Image* ValuePlot::getPlot (double _from, double _to, Magick::Image* _ima
 
 	plotXDate (plotShadow, localDate);
 
-	if (!rs.empty ())
+	if (buckets && !avg.empty ())
+	{
+		plotRange (avg, rts2db::getCadenceLength (cadence), Magick::Color (3 * MaxRGB / 5, MaxRGB, 3 * MaxRGB / 5, MaxRGB / 5));
+		if (shadow)
+			plotData (avg, Magick::Color (MaxRGB / 5, MaxRGB / 5, MaxRGB / 5, 3 * MaxRGB / 5), linewidth, shadow);
+		plotData (avg, Magick::Color (0, MaxRGB, 0, MaxRGB / 5), linewidth, 0);
+	}
+	else if (!rs.empty ())
 	{
 		if (shadow)
 			plotData (rs, Magick::Color (MaxRGB / 5, MaxRGB / 5, MaxRGB / 5, 3 * MaxRGB / 5), linewidth, shadow);
@@ -126,7 +147,25 @@ Magick::Image* ValuePlot::getPlot (double _from, double _to, Magick::Image* _ima
 	return image;
 }
 
-void ValuePlot::plotData (rts2db::RecordsSet &rs, Magick::Color col, int linewidth, int shadow)
+void ValuePlot::plotRange (rts2db::RecordAvgSet &avg, int bucketLength, Magick::Color col)
+{
+	image->strokePattern (Magick::Image (Magick::Geometry (1,1), col));
+	image->strokeColor (col);
+	image->strokeWidth (1);
+	image->fillColor (col);
+
+	double w = scaleX * bucketLength / 2.0;
+
+	for (rts2db::RecordAvgSet::iterator iter = avg.begin (); iter != avg.end (); iter++)
+	{
+		double x = y_axis_width + scaleX * (iter->getRecTime () - from);
+		double y_min = size.height () - x_axis_height - scaleY * (iter->getMinimum () - min);
+		double y_max = size.height () - x_axis_height - scaleY * (iter->getMaximum () - min);
+		image->draw (Magick::DrawableRectangle (x - w, y_max, x + w, y_min));
+	}
+}
+
+template <typename T> void ValuePlot::plotData (T &rs, Magick::Color col, int linewidth, int shadow)
 {
 	// reset stroke pattern
 	image->strokePattern (Magick::Image (Magick::Geometry (1,1), col));
@@ -134,7 +173,7 @@ void ValuePlot::plotData (rts2db::RecordsSet &rs, Magick::Color col, int linewid
 	image->strokeWidth (linewidth);
 	image->fillColor (col);
 
-	rts2db::RecordsSet::iterator iter = rs.begin ();
+	typename T::iterator iter = rs.begin ();
 
 	double x = y_axis_width + scaleX * (iter->getRecTime () - from) + shadow;
 	double y = size.height () - x_axis_height - scaleY * (iter->getValue () - min) + shadow;
@@ -23,13 +23,15 @@
 
 #include <Magick++.h>
 #include "rts2db/records.h"
+#include "rts2db/recordsavg.h"
 #include "rts2json/plot.h"
 
 namespace rts2xmlrpc
 {
 
 /**
- * Value graph class.
+ * Value graph class. Double values are plotted from downsampled records
+ * when the plotted interval is longer than plot width in minutes.
  *
  * @author Petr Kubanek <petr@kubanek.net>
  */
@@ -62,7 +64,15 @@ class ValuePlot:public rts2json::Plot
 		int recvalId;
 		int valueType;
 
-		void plotData (rts2db::RecordsSet &rs, Magick::Color col, int linewidth, int shadow);
+		/**
+		 * Plot minimum - maximum range of downsampled records.
+		 */
+		void plotRange (rts2db::RecordAvgSet &avg, int bucketLength, Magick::Color col);
+
+		/**
+		 * Plot line through records or bucket averages.
+		 */
+		template <typename T> void plotData (T &rs, Magick::Color col, int linewidth, int shadow);
 };
 
 }
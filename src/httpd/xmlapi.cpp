@@ -1050,12 +1050,17 @@ void Records::sessionExecute (XmlRpcValue& params, XmlRpcValue& result)
 
 void RecordsAverage::sessionExecute (XmlRpcValue& params, XmlRpcValue& result)
 {
-	if (params.size () != 3)
+	if (params.size () != 3 && params.size () != 4)
 		throw XmlRpcException ("Invalid number of parameters");
 
 	try
 	{
-		rts2db::RecordAvgSet recset = rts2db::RecordAvgSet (params[0], rts2db::HOUR);
+		// optional fourth parameter is maximal number of returned averages; only
+		// hourly averages are available if the database does not have downsampled records
+		rts2db::cadence_t cadence = rts2db::HOUR;
+		if (params.size () == 4 && rts2db::RecordAvgSet::haveBuckets ())
+			rts2db::RecordAvgSet::selectCadence (params[1], params[2], params[3], cadence);
+		rts2db::RecordAvgSet recset = rts2db::RecordAvgSet (params[0], cadence);
 		int i = 0;
 		time_t t;
 		recset.load (params[1], params[2]);
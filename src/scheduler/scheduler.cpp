@@ -25,6 +25,7 @@
 
 #define OPT_START_DATE		OPT_LOCAL + 210
 #define OPT_END_DATE		OPT_LOCAL + 211
+#define OPT_THREADS		OPT_LOCAL + 212
 
 /**
  * Class of the scheduler application.  Prepares schedule, and run
@@ -61,6 +62,9 @@ class Rts2ScheduleApp: public rts2db::AppDb
 		// used algorithm
 		enum {SGA, NSGAII} algorithm;
 
+		// number of threads evaluating schedules
+		int threads;
+
 		// if the programme will print detail schedule informations
 		bool printSchedules;
 
@@ -121,6 +125,8 @@ Rts2ScheduleApp::Rts2ScheduleApp (int argc, char ** argv): rts2db::AppDb (argc,
 	popSize = 100;
 	algorithm = NSGAII;
 
+	threads = sysconf (_SC_NPROCESSORS_ONLN);
+
 	printSchedules = false;
 
 	printMeritsStat = false;
@@ -140,6 +146,7 @@ Rts2ScheduleApp::Rts2ScheduleApp (int argc, char ** argv): rts2db::AppDb (argc,
 
 	addOption (OPT_START_DATE, "start", 1, "produce schedule from this date");
 	addOption (OPT_END_DATE, "end", 1, "produce schedule till this date");
+	addOption (OPT_THREADS, "threads", 1, "number of threads evaluating schedules (default to number of processors)");
 }
 
 Rts2ScheduleApp::~Rts2ScheduleApp (void)
@@ -279,6 +286,14 @@ int Rts2ScheduleApp::processOption (int _opt)
 			return parseDate (optarg, startDate);
 		case OPT_END_DATE:
 			return parseDate (optarg, endDate);
+		case OPT_THREADS:
+			threads = atoi (optarg);
+			if (threads <= 0)
+			{
+				logStream (MESSAGE_ERROR) << "Number of threads must be positive number " << optarg << sendLog;
+				return -1;
+			}
+			break;
 		default:
 			return rts2db::AppDb::processOption (_opt);
 	}
@@ -313,6 +328,7 @@ int Rts2ScheduleApp::init ()
 		std::cout << "Generating schedule for night " << LibnovaDate (obsNight) << std::endl;
 
 		schedBag = new Rts2SchedBag (NAN, NAN);
+		schedBag->setThreads (threads);
 		ret = schedBag->constructSchedulesFromObsSet (popSize, obsNight);
 		if (ret)
 			return ret;
@@ -322,6 +338,7 @@ int Rts2ScheduleApp::init ()
 		std::cout << "Generating schedule from " << LibnovaDate (startDate) << " to " << LibnovaDate (endDate) << std::endl;
 
 		schedBag = new Rts2SchedBag (startDate, endDate);
+		schedBag->setThreads (threads);
 
 		ret = schedBag->constructSchedules (popSize);
 		if (ret)
@@ -0,0 +1,22 @@
+-- downsampled double records, used to plot long intervals
+-- bucket_len is in seconds - 60 (minute), 600 (10 minutes), 3600 (hour) and 86400 (day)
+-- buckets are updated with records inserted by the record writer
+CREATE TABLE records_double_buckets (
+	recval_id		integer REFERENCES recvals(recval_id) not NULL,
+	bucket_len		integer not NULL,
+	bucket			timestamp not NULL,
+	min_value		float8 not NULL,
+	max_value		float8 not NULL,
+	sum_value		float8 not NULL,
+	nrec			integer not NULL,
+	CONSTRAINT records_double_buckets_prkey PRIMARY KEY (recval_id, bucket_len, bucket)
+);
+
+INSERT INTO records_double_buckets
+	SELECT recval_id, bucket_len, to_timestamp (floor (EXTRACT (EPOCH FROM rectime::timestamp with time zone) / bucket_len) * bucket_len),
+		min (value), max (value), sum (value), count (value)
+	FROM records_double, (VALUES (60), (600), (3600), (86400)) AS lengths (bucket_len)
+	WHERE value <> 'NaN' AND value <> 'Infinity' AND value <> '-Infinity'
+	GROUP BY 1, 2, 3;
+
+GRANT ALL ON records_double_buckets TO GROUP observers;